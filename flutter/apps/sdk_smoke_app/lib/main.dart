@@ -231,14 +231,21 @@ class _SmokeHomePageState extends State<SmokeHomePage> {
         _sdk = client;
       });
 
+      // State transitions carry the full state, so only other events need a
+      // round trip.
       _coreSubscription = client.watchCoreEvents().listen((event) {
         setState(() {
           _events.insert(0, '${event.type} ${event.payload}');
           if (_events.length > 20) {
             _events.removeLast();
           }
+          if (event.type == 'core_state_changed') {
+            _state = CoreState.fromMap(event.payload);
+          }
         });
-        _refreshState();
+        if (event.type != 'core_state_changed') {
+          _refreshState();
+        }
       });
 
       _logSubscription = client.watchLogs().listen((event) {
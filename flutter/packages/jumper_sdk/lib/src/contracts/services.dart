@@ -32,6 +32,7 @@ abstract interface class CoreApiClient {
   Future<void> closeConnection({required String id});
   Future<void> closeAllConnections();
   Stream<KernelLogEvent> watchLogs();
+  Future<List<KernelLogEvent>> getRecentLogs({int sinceSeq});
   Stream<TrafficStatEvent> watchTraffic();
   Stream<MemoryStatEvent> watchMemory();
   Stream<ConnectionsSnapshot> watchConnections();
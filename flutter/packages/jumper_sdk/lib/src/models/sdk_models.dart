@@ -2,6 +2,20 @@ enum CoreStatus { stopped, starting, running, stopping, error }
 
 enum JumperNetworkMode { tunnel, systemProxy }
 
+/// How the core's Go runtime trades memory for CPU. The platform derives
+/// GOMAXPROCS, GOMEMLIMIT and GOGC from it and the machine's size; cores
+/// run [balanced] unless told otherwise.
+enum JumperGoRuntimeProfile {
+  off('off'),
+  lowMemory('low-memory'),
+  balanced('balanced'),
+  throughput('throughput');
+
+  const JumperGoRuntimeProfile(this.wireName);
+
+  final String wireName;
+}
+
 enum PluginEvent {
   onStartup,
   onReady,
@@ -106,9 +120,18 @@ class ProxiesSnapshot {
 class ConnectionsSnapshot {
   const ConnectionsSnapshot({
     required this.connections,
+    this.addedIds = const <String>[],
+    this.removedIds = const <String>[],
+    this.changedIds = const <String>[],
   });
 
   final List<Map<String, Object?>> connections;
+
+  /// What changed since the previous snapshot of a `watchConnections`
+  /// stream. Empty for one-off snapshots.
+  final List<String> addedIds;
+  final List<String> removedIds;
+  final List<String> changedIds;
 }
 
 class KernelLogEvent {
@@ -116,29 +139,116 @@ class KernelLogEvent {
     required this.level,
     required this.message,
     required this.timestampMs,
+    this.seq,
+    this.droppedLines,
   });
 
+  factory KernelLogEvent.fromMap(Map<String, Object?> map) {
+    return KernelLogEvent(
+      level: (map['level'] as String?) ?? 'info',
+      message: (map['message'] as String?) ?? '',
+      timestampMs:
+          (map['timestampMs'] as int?) ?? DateTime.now().millisecondsSinceEpoch,
+      seq: map['seq'] as int?,
+      droppedLines: map['dropped'] as int?,
+    );
+  }
+
   final String level;
   final String message;
   final int timestampMs;
+
+  /// Position in the native log buffer, for backfilling with
+  /// `getRecentLogs`. Null on platforms that do not buffer logs.
+  final int? seq;
+
+  /// Lines sampled out or overwritten natively since the plugin started.
+  final int? droppedLines;
 }
 
 class TrafficStatEvent {
   const TrafficStatEvent({
     required this.uploadBytes,
     required this.downloadBytes,
+    this.timestampMs,
   });
 
   final int uploadBytes;
   final int downloadBytes;
+
+  /// When the core reported the sample. Null for synthesized events.
+  final int? timestampMs;
 }
 
 class MemoryStatEvent {
   const MemoryStatEvent({
     required this.rssBytes,
+    this.pssBytes,
+    this.cpuUserMs,
+    this.cpuSystemMs,
+    this.cpuUserDeltaMs,
+    this.cpuSystemDeltaMs,
+    this.threads,
+    this.openFds,
+    this.voluntaryContextSwitches,
+    this.involuntaryContextSwitches,
+    this.ioReadBytes,
+    this.ioWriteBytes,
+    this.ioReadChars,
+    this.ioWriteChars,
+    this.pid,
+    this.timestampMs,
   });
 
+  factory MemoryStatEvent.fromMap(Map<String, Object?> map) {
+    return MemoryStatEvent(
+      rssBytes: (map['rssBytes'] as int?) ?? 0,
+      pssBytes: map['pssBytes'] as int?,
+      cpuUserMs: map['cpuUserMs'] as int?,
+      cpuSystemMs: map['cpuSystemMs'] as int?,
+      cpuUserDeltaMs: map['cpuUserDeltaMs'] as int?,
+      cpuSystemDeltaMs: map['cpuSystemDeltaMs'] as int?,
+      threads: map['threads'] as int?,
+      openFds: map['openFds'] as int?,
+      voluntaryContextSwitches: map['voluntaryContextSwitches'] as int?,
+      involuntaryContextSwitches: map['involuntaryContextSwitches'] as int?,
+      ioReadBytes: map['ioReadBytes'] as int?,
+      ioWriteBytes: map['ioWriteBytes'] as int?,
+      ioReadChars: map['ioReadChars'] as int?,
+      ioWriteChars: map['ioWriteChars'] as int?,
+      pid: map['pid'] as int?,
+      timestampMs: map['timestampMs'] as int?,
+    );
+  }
+
   final int rssBytes;
+
+  /// Proportional set size; null where the kernel does not expose it.
+  final int? pssBytes;
+
+  /// CPU time consumed since the core started.
+  final int? cpuUserMs;
+  final int? cpuSystemMs;
+
+  /// CPU time consumed since the previous sample.
+  final int? cpuUserDeltaMs;
+  final int? cpuSystemDeltaMs;
+
+  final int? threads;
+  final int? openFds;
+  final int? voluntaryContextSwitches;
+  final int? involuntaryContextSwitches;
+
+  /// Bytes that reached storage.
+  final int? ioReadBytes;
+  final int? ioWriteBytes;
+
+  /// Bytes passed through read/write calls, sockets included.
+  final int? ioReadChars;
+  final int? ioWriteChars;
+
+  final int? pid;
+  final int? timestampMs;
 }
 
 class Profile {
@@ -312,6 +422,49 @@ class JumperSdkException implements Exception {
   String toString() => 'JumperSdkException($code): $message';
 }
 
+/// How the core shares the machine with the app. Applied on Linux when the
+/// core is spawned; null fields keep what the core would inherit.
+class JumperCoreScheduling {
+  const JumperCoreScheduling({
+    this.nice,
+    this.ioClass,
+    this.ioLevel,
+    this.cpuAffinity,
+    this.startupNice,
+    this.cpuWeight,
+    this.memoryHighBytes,
+  });
+
+  /// -20 to 19; below the app's needs CAP_SYS_NICE or RLIMIT_NICE.
+  final int? nice;
+
+  /// `realtime`, `best-effort` or `idle`, with [ioLevel] from 0 to 7.
+  final String? ioClass;
+  final int? ioLevel;
+  final List<int>? cpuAffinity;
+
+  /// The nice value the core starts with; it drops to [nice], or the
+  /// app's, once the core is ready.
+  final int? startupNice;
+
+  /// cgroup v2 `cpu.weight` (1 to 10000) and `memory.high`. Either moves the
+  /// core into a cgroup of its own.
+  final int? cpuWeight;
+  final int? memoryHighBytes;
+
+  Map<String, Object?> toMap() {
+    return <String, Object?>{
+      if (nice != null) 'nice': nice,
+      if (ioClass != null) 'ioClass': ioClass,
+      if (ioLevel != null) 'ioLevel': ioLevel,
+      if (cpuAffinity != null) 'cpuAffinity': cpuAffinity,
+      if (startupNice != null) 'startupNice': startupNice,
+      if (cpuWeight != null) 'cpuWeight': cpuWeight,
+      if (memoryHighBytes != null) 'memoryHighBytes': memoryHighBytes,
+    };
+  }
+}
+
 class JumperRuntimeLaunchOptions {
   const JumperRuntimeLaunchOptions({
     required this.binaryPath,
@@ -319,6 +472,8 @@ class JumperRuntimeLaunchOptions {
     this.workingDirectory,
     this.environment = const <String, String>{},
     this.networkMode = JumperNetworkMode.tunnel,
+    this.scheduling,
+    this.goRuntimeProfile,
   });
 
   final String binaryPath;
@@ -326,6 +481,10 @@ class JumperRuntimeLaunchOptions {
   final String? workingDirectory;
   final Map<String, String> environment;
   final JumperNetworkMode networkMode;
+  final JumperCoreScheduling? scheduling;
+
+  /// Variables set in [environment] win over the profile's.
+  final JumperGoRuntimeProfile? goRuntimeProfile;
 
   Map<String, Object?> toMap() {
     return <String, Object?>{
@@ -334,6 +493,9 @@ class JumperRuntimeLaunchOptions {
       if (workingDirectory != null) 'workingDirectory': workingDirectory,
       'environment': environment,
       'networkMode': networkMode.name,
+      if (scheduling != null) 'scheduling': scheduling!.toMap(),
+      if (goRuntimeProfile != null)
+        'goRuntimeProfile': goRuntimeProfile!.wireName,
     };
   }
 }
@@ -55,6 +55,8 @@ class JumperRuntimeBootstrap {
     String? coreBinaryName,
     List<String>? arguments,
     Map<String, String> environment = const <String, String>{},
+    JumperCoreScheduling? scheduling,
+    JumperGoRuntimeProfile? goRuntimeProfile,
   }) async {
     final layout = resolveLayout(
       appBasePath: appBasePath,
@@ -83,6 +85,8 @@ class JumperRuntimeBootstrap {
       arguments: launchArgs,
       workingDirectory: layout.coreWorkingDirectory,
       environment: environment,
+      scheduling: scheduling,
+      goRuntimeProfile: goRuntimeProfile,
     );
   }
 
@@ -71,15 +71,26 @@ class JumperSdkClient
 
   @override
   Stream<KernelLogEvent> watchLogs() {
-    return _platform.watchKernelLogs().map((event) {
-      return KernelLogEvent(
-        level: (event['level'] as String?) ?? 'info',
-        message: (event['message'] as String?) ?? '',
-        timestampMs:
-            (event['timestampMs'] as int?) ??
-            DateTime.now().millisecondsSinceEpoch,
-      );
-    });
+    return _platform.watchKernelLogs().map(KernelLogEvent.fromMap);
+  }
+
+  @override
+  Future<List<KernelLogEvent>> getRecentLogs({int sinceSeq = 0}) async {
+    final payload = await _platform.getRecentLogs(sinceSeq: sinceSeq);
+    final lines = payload['lines'];
+    if (lines is! List) {
+      return const <KernelLogEvent>[];
+    }
+    final dropped = payload['dropped'];
+    return lines
+        .whereType<Map>()
+        .map(
+          (line) => KernelLogEvent.fromMap(<String, Object?>{
+            ...line.cast<String, Object?>(),
+            'dropped': dropped,
+          }),
+        )
+        .toList();
   }
 
   @override
@@ -158,18 +169,83 @@ class JumperSdkClient
   }
 
   @override
-  Stream<ConnectionsSnapshot> watchConnections() {
-    return const Stream<ConnectionsSnapshot>.empty();
+  Stream<ConnectionsSnapshot> watchConnections({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    // The plugin diffs /connections natively and only sends what changed;
+    // apply each delta to the connections seen so far.
+    final live = <String, Map<String, Object?>>{};
+    return _platform
+        .watchConnectionDeltas(intervalMs: interval.inMilliseconds)
+        .map((delta) {
+          if (delta['reset'] == true) {
+            live.clear();
+          }
+          final addedIds = <String>[];
+          for (final raw in (delta['added'] as List?) ?? const <Object?>[]) {
+            final decoded = raw is String ? jsonDecode(raw) : null;
+            if (decoded is Map && decoded['id'] is String) {
+              final connection = Map<String, Object?>.from(decoded);
+              final id = connection['id']! as String;
+              live[id] = connection;
+              addedIds.add(id);
+            }
+          }
+          final removedIds = ((delta['removed'] as List?) ?? const <Object?>[])
+              .whereType<String>()
+              .toList();
+          removedIds.forEach(live.remove);
+          final changedIds = ((delta['changedIds'] as List?) ?? const <Object?>[])
+              .whereType<String>()
+              .toList();
+          final counters = (delta['changedCounters'] as List?)?.cast<int>() ?? const <int>[];
+          for (var i = 0; i < changedIds.length && i * 4 + 3 < counters.length; i++) {
+            final connection = live[changedIds[i]];
+            if (connection == null) {
+              continue;
+            }
+            connection['upload'] = counters[i * 4];
+            connection['download'] = counters[i * 4 + 1];
+            connection['uploadRate'] = counters[i * 4 + 2];
+            connection['downloadRate'] = counters[i * 4 + 3];
+          }
+          return ConnectionsSnapshot(
+            connections: live.values.toList(growable: false),
+            addedIds: addedIds,
+            removedIds: removedIds,
+            changedIds: changedIds,
+          );
+        });
   }
 
   @override
-  Stream<MemoryStatEvent> watchMemory() {
-    return const Stream<MemoryStatEvent>.empty();
+  Stream<MemoryStatEvent> watchMemory({
+    Duration interval = const Duration(seconds: 1),
+  }) {
+    // Native samples only carry changed fields; fold them into the last
+    // known values and start over on every keyframe.
+    final latest = <String, Object?>{};
+    return _platform
+        .watchProcessStats(intervalMs: interval.inMilliseconds)
+        .where((event) => event['keyframe'] == true || latest.isNotEmpty)
+        .map((event) {
+          if (event['keyframe'] == true) {
+            latest.clear();
+          }
+          latest.addAll(event);
+          return MemoryStatEvent.fromMap(latest);
+        });
   }
 
   @override
   Stream<TrafficStatEvent> watchTraffic() {
-    return const Stream<TrafficStatEvent>.empty();
+    return _platform.watchTraffic().map(
+      (frame) => TrafficStatEvent(
+        uploadBytes: frame[0],
+        downloadBytes: frame[1],
+        timestampMs: frame[2],
+      ),
+    );
   }
 
   Future<Map<String, Object?>> setupRuntime({
@@ -196,6 +272,26 @@ class JumperSdkClient
     );
   }
 
+  Future<Map<String, Object?>> rollbackRuntime() {
+    return _platform.rollbackRuntime();
+  }
+
+  Future<Map<String, Object?>> getPluginMetrics({String? textfilePath}) {
+    return _platform.getPluginMetrics(textfilePath: textfilePath);
+  }
+
+  Future<void> setTracing({required bool enabled}) {
+    return _platform.setTracing(enabled: enabled);
+  }
+
+  Future<Map<String, Object?>> dumpTrace({String? path}) {
+    return _platform.dumpTrace(path: path);
+  }
+
+  Future<Map<String, Object?>> getMainThreadStalls({bool clear = false}) {
+    return _platform.getMainThreadStalls(clear: clear);
+  }
+
   @override
   Future<void> enableProxy({required String host, required int port}) {
     _ensureCapability(
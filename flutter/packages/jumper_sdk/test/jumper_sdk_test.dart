@@ -94,12 +94,13 @@ class _FakePlatform extends JumperSdkPlatform {
   }
 
   @override
-  Future<void> startCore({
+  Future<Map<String, Object?>> startCore({
     required String profileId,
     Map<String, Object?>? launchOptions,
     String? networkMode,
   }) async {
     startedNetworkMode = networkMode;
+    return <String, Object?>{};
   }
 
   @override
@@ -138,6 +139,32 @@ void main() {
     }
   });
 
+  test('launch options carry core scheduling', () {
+    const options = JumperRuntimeLaunchOptions(
+      binaryPath: '/opt/sing-box',
+      scheduling: JumperCoreScheduling(nice: 5, startupNice: 0, cpuWeight: 50),
+    );
+
+    expect(options.toMap()['scheduling'], <String, Object?>{
+      'nice': 5,
+      'startupNice': 0,
+      'cpuWeight': 50,
+    });
+  });
+
+  test('launch options name the Go runtime profile', () {
+    const options = JumperRuntimeLaunchOptions(
+      binaryPath: '/opt/sing-box',
+      goRuntimeProfile: JumperGoRuntimeProfile.lowMemory,
+    );
+
+    expect(options.toMap()['goRuntimeProfile'], 'low-memory');
+    expect(
+      const JumperRuntimeLaunchOptions(binaryPath: '/opt/sing-box').toMap(),
+      isNot(contains('goRuntimeProfile')),
+    );
+  });
+
   test('system proxy capability delegates to platform', () async {
     final fake = _FakePlatform();
     final sdk = JumperSdkClient(platform: fake);
@@ -6,36 +6,55 @@ class JumperSdkPlatform {
     return JumperSdkPlatformPlatform.instance.getPlatformVersion();
   }
 
-  Future<void> startCore({
+  Future<Map<String, Object?>> startCore({
     required String profileId,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    bool isolated = false,
   }) {
     return JumperSdkPlatformPlatform.instance.startCore(
       profileId: profileId,
       launchOptions: launchOptions,
       networkMode: networkMode,
+      isolated: isolated,
     );
   }
 
-  Future<void> stopCore() {
-    return JumperSdkPlatformPlatform.instance.stopCore();
+  Future<void> stopCore({int? stopTimeoutMs, String? isolatedProfileId}) {
+    return JumperSdkPlatformPlatform.instance.stopCore(
+      stopTimeoutMs: stopTimeoutMs,
+      isolatedProfileId: isolatedProfileId,
+    );
   }
 
-  Future<void> restartCore({
+  Future<Map<String, Object?>> restartCore({
     String? reason,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    int? stopTimeoutMs,
   }) {
     return JumperSdkPlatformPlatform.instance.restartCore(
       reason: reason,
       launchOptions: launchOptions,
       networkMode: networkMode,
+      stopTimeoutMs: stopTimeoutMs,
+    );
+  }
+
+  Future<Map<String, Object?>> reloadCore({
+    Map<String, Object?>? launchOptions,
+    String? networkMode,
+    int? stopTimeoutMs,
+  }) {
+    return JumperSdkPlatformPlatform.instance.reloadCore(
+      launchOptions: launchOptions,
+      networkMode: networkMode,
+      stopTimeoutMs: stopTimeoutMs,
     );
   }
 
-  Future<Map<String, Object?>> getCoreState() {
-    return JumperSdkPlatformPlatform.instance.getCoreState();
+  Future<Map<String, Object?>> getCoreState({String? isolatedProfileId}) {
+    return JumperSdkPlatformPlatform.instance.getCoreState(isolatedProfileId: isolatedProfileId);
   }
 
   Stream<Map<String, Object?>> watchCoreEvents() {
@@ -46,6 +65,25 @@ class JumperSdkPlatform {
     return JumperSdkPlatformPlatform.instance.watchKernelLogs();
   }
 
+  Stream<List<int>> watchTraffic() {
+    return JumperSdkPlatformPlatform.instance.watchTraffic();
+  }
+
+  Stream<Map<String, Object?>> watchProcessStats({int intervalMs = 1000}) {
+    return JumperSdkPlatformPlatform.instance.watchProcessStats(intervalMs: intervalMs);
+  }
+
+  Stream<Map<String, Object?>> watchConnectionDeltas({int intervalMs = 1000}) {
+    return JumperSdkPlatformPlatform.instance.watchConnectionDeltas(intervalMs: intervalMs);
+  }
+
+  Future<Map<String, Object?>> getRecentLogs({int sinceSeq = 0, String? isolatedProfileId}) {
+    return JumperSdkPlatformPlatform.instance.getRecentLogs(
+      sinceSeq: sinceSeq,
+      isolatedProfileId: isolatedProfileId,
+    );
+  }
+
   Future<Map<String, Object?>> setupRuntime({
     required String version,
     required String platformArch,
@@ -70,6 +108,26 @@ class JumperSdkPlatform {
     );
   }
 
+  Future<Map<String, Object?>> rollbackRuntime() {
+    return JumperSdkPlatformPlatform.instance.rollbackRuntime();
+  }
+
+  Future<Map<String, Object?>> getPluginMetrics({String? textfilePath}) {
+    return JumperSdkPlatformPlatform.instance.getPluginMetrics(textfilePath: textfilePath);
+  }
+
+  Future<void> setTracing({required bool enabled}) {
+    return JumperSdkPlatformPlatform.instance.setTracing(enabled: enabled);
+  }
+
+  Future<Map<String, Object?>> dumpTrace({String? path}) {
+    return JumperSdkPlatformPlatform.instance.dumpTrace(path: path);
+  }
+
+  Future<Map<String, Object?>> getMainThreadStalls({bool clear = false}) {
+    return JumperSdkPlatformPlatform.instance.getMainThreadStalls(clear: clear);
+  }
+
   Future<void> enableSystemProxy({
     required String host,
     required int port,
@@ -10,6 +10,9 @@ class MethodChannelJumperSdkPlatform extends JumperSdkPlatformPlatform {
   final methodChannel = const MethodChannel('jumper_sdk_platform');
   final _coreEventsChannel = const EventChannel('jumper_sdk_platform/core_events');
   final _kernelLogsChannel = const EventChannel('jumper_sdk_platform/kernel_logs');
+  final _trafficChannel = const EventChannel('jumper_sdk_platform/traffic');
+  final _processStatsChannel = const EventChannel('jumper_sdk_platform/process_stats');
+  final _connectionsChannel = const EventChannel('jumper_sdk_platform/connections');
 
   @override
   Future<String?> getPlatformVersion() async {
@@ -20,41 +23,78 @@ class MethodChannelJumperSdkPlatform extends JumperSdkPlatformPlatform {
   }
 
   @override
-  Future<void> startCore({
+  Future<Map<String, Object?>> startCore({
     required String profileId,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    bool isolated = false,
   }) async {
     final payload = <String, Object?>{
       'profileId': profileId,
       'launchOptions': launchOptions,
       'networkMode': networkMode,
+      if (isolated) 'isolated': true,
     };
-    await methodChannel.invokeMethod<void>('startCore', payload);
+    final result = await methodChannel.invokeMethod<Object?>('startCore', payload);
+    return _asStartReport(result);
   }
 
   @override
-  Future<void> stopCore() async {
-    await methodChannel.invokeMethod<void>('stopCore');
+  Future<void> stopCore({int? stopTimeoutMs, String? isolatedProfileId}) async {
+    await methodChannel.invokeMethod<void>('stopCore', <String, Object?>{
+      'stopTimeoutMs': stopTimeoutMs,
+      if (isolatedProfileId != null) 'isolatedProfileId': isolatedProfileId,
+    });
   }
 
   @override
-  Future<void> restartCore({
+  Future<Map<String, Object?>> restartCore({
     String? reason,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    int? stopTimeoutMs,
   }) async {
     final payload = <String, Object?>{
       'reason': reason,
       'launchOptions': launchOptions,
       'networkMode': networkMode,
+      'stopTimeoutMs': stopTimeoutMs,
     };
-    await methodChannel.invokeMethod<void>('restartCore', payload);
+    final result = await methodChannel.invokeMethod<Object?>('restartCore', payload);
+    return _asStartReport(result);
   }
 
   @override
-  Future<Map<String, Object?>> getCoreState() async {
-    final result = await methodChannel.invokeMapMethod<String, Object?>('getCoreState');
+  Future<Map<String, Object?>> reloadCore({
+    Map<String, Object?>? launchOptions,
+    String? networkMode,
+    int? stopTimeoutMs,
+  }) async {
+    final payload = <String, Object?>{
+      'launchOptions': launchOptions,
+      'networkMode': networkMode,
+      'stopTimeoutMs': stopTimeoutMs,
+    };
+    final result = await methodChannel.invokeMethod<Object?>('reloadCore', payload);
+    return _asStartReport(result);
+  }
+
+  // Simulator starts and older native builds reply without a payload.
+  Map<String, Object?> _asStartReport(Object? result) {
+    if (result is Map) {
+      return result.cast<String, Object?>();
+    }
+    return <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getCoreState({String? isolatedProfileId}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'getCoreState',
+      isolatedProfileId == null
+          ? null
+          : <String, Object?>{'isolatedProfileId': isolatedProfileId},
+    );
     return result ?? <String, Object?>{'status': 'stopped'};
   }
 
@@ -73,9 +113,63 @@ class MethodChannelJumperSdkPlatform extends JumperSdkPlatformPlatform {
         .receiveBroadcastStream()
         .where((event) => event is Map)
         .cast<Map>()
+        .expand(_expandLogEvent);
+  }
+
+  // Linux delivers lines in timed batches; other platforms send one map per
+  // line.
+  Iterable<Map<String, Object?>> _expandLogEvent(Map event) {
+    if (event['type'] != 'kernel_log_batch') {
+      return <Map<String, Object?>>[event.cast<String, Object?>()];
+    }
+    final dropped = event['dropped'];
+    final lines = event['lines'];
+    if (lines is! List) {
+      return const <Map<String, Object?>>[];
+    }
+    return lines.whereType<Map>().map(
+      (line) => <String, Object?>{...line.cast<String, Object?>(), 'dropped': dropped},
+    );
+  }
+
+  @override
+  Stream<List<int>> watchTraffic() {
+    return _trafficChannel
+        .receiveBroadcastStream()
+        .where((event) => event is List<int> && event.length >= 3)
+        .cast<List<int>>();
+  }
+
+  @override
+  Stream<Map<String, Object?>> watchProcessStats({int intervalMs = 1000}) {
+    return _processStatsChannel
+        .receiveBroadcastStream(<String, Object?>{'intervalMs': intervalMs})
+        .where((event) => event is Map)
+        .cast<Map>()
+        .map((event) => event.cast<String, Object?>());
+  }
+
+  @override
+  Stream<Map<String, Object?>> watchConnectionDeltas({int intervalMs = 1000}) {
+    return _connectionsChannel
+        .receiveBroadcastStream(<String, Object?>{'intervalMs': intervalMs})
+        .where((event) => event is Map)
+        .cast<Map>()
         .map((event) => event.cast<String, Object?>());
   }
 
+  @override
+  Future<Map<String, Object?>> getRecentLogs({int sinceSeq = 0, String? isolatedProfileId}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'getRecentLogs',
+      <String, Object?>{
+        'sinceSeq': sinceSeq,
+        if (isolatedProfileId != null) 'isolatedProfileId': isolatedProfileId,
+      },
+    );
+    return result ?? <String, Object?>{'lines': <Object?>[]};
+  }
+
   @override
   Future<Map<String, Object?>> setupRuntime({
     required String version,
@@ -112,6 +206,46 @@ class MethodChannelJumperSdkPlatform extends JumperSdkPlatformPlatform {
     return result ?? <String, Object?>{};
   }
 
+  @override
+  Future<Map<String, Object?>> rollbackRuntime() async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'rollbackRuntime',
+    );
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getPluginMetrics({String? textfilePath}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'getPluginMetrics',
+      textfilePath == null ? null : <String, Object?>{'textfilePath': textfilePath},
+    );
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<void> setTracing({required bool enabled}) async {
+    await methodChannel.invokeMethod<void>('setTracing', <String, Object?>{'enabled': enabled});
+  }
+
+  @override
+  Future<Map<String, Object?>> dumpTrace({String? path}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'dumpTrace',
+      path == null ? null : <String, Object?>{'path': path},
+    );
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getMainThreadStalls({bool clear = false}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>(
+      'getMainThreadStalls',
+      <String, Object?>{'clear': clear},
+    );
+    return result ?? <String, Object?>{};
+  }
+
   @override
   Future<void> enableSystemProxy({
     required String host,
@@ -27,38 +27,159 @@ abstract class JumperSdkPlatformPlatform extends PlatformInterface {
     throw UnimplementedError('platformVersion() has not been implemented.');
   }
 
-  Future<void> startCore({
+  /// Starts the core and completes once it is ready. Native implementations
+  /// report `pid`, `readiness` and per-phase `timings` in the result. On
+  /// Linux, the first call after the plugin adopted a core left running by a
+  /// crashed app keeps that core when [launchOptions] match the ones it runs
+  /// with: config changes are applied as by [reloadCore], and the result
+  /// carries `adopted: true`.
+  ///
+  /// With [isolated], Linux starts a second core for [profileId] beside the
+  /// main one, replacing any isolated core already running for it. Its
+  /// config is copied with every inbound and the Clash API moved to free
+  /// ports, reported as `listenPorts` and `controller`; configs with a tun
+  /// inbound fail with `CORE_CONFIG_INVALID`, and more than 32 isolated cores
+  /// with `CORE_INSTANCE_LIMIT`. Such a core is restarted on its own after a
+  /// crash and is addressed by passing [profileId] as `isolatedProfileId` to
+  /// [stopCore], [getCoreState] and [getRecentLogs].
+  ///
+  /// On Linux, `launchOptions.scheduling` sets the core's `nice`, I/O
+  /// priority (`ioClass`, `ioLevel`) and `cpuAffinity` at spawn, which is
+  /// all isolated cores take. `startupNice` holds until the main core is
+  /// ready, and `cpuWeight` or `memoryHighBytes` move it into a cgroup v2 of
+  /// its own, through a systemd scope unless the app's parent cgroup is
+  /// delegated to it.
+  ///
+  /// On Linux and Windows, `launchOptions.goRuntimeProfile` (`off`,
+  /// `low-memory`, `balanced` by default, or `throughput`) sets the core's
+  /// GOMAXPROCS, GOMEMLIMIT and GOGC from the CPUs and memory it may use,
+  /// cgroup limits included. Variables in `environment` win.
+  Future<Map<String, Object?>> startCore({
     required String profileId,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    bool isolated = false,
   }) {
     throw UnimplementedError('startCore() has not been implemented.');
   }
 
-  Future<void> stopCore() {
+  /// Stops the core and everything it started. [stopTimeoutMs] bounds how
+  /// long it gets to exit before it is killed; native implementations
+  /// default to 2000 and report the stop as a `core_stopped` event. With
+  /// [isolatedProfileId], only that isolated core is stopped, reported as
+  /// `instance_stopped`.
+  Future<void> stopCore({int? stopTimeoutMs, String? isolatedProfileId}) {
     throw UnimplementedError('stopCore() has not been implemented.');
   }
 
-  Future<void> restartCore({
+  /// [stopTimeoutMs] applies to stopping the running core, as in [stopCore].
+  Future<Map<String, Object?>> restartCore({
     String? reason,
     Map<String, Object?>? launchOptions,
     String? networkMode,
+    int? stopTimeoutMs,
   }) {
     throw UnimplementedError('restartCore() has not been implemented.');
   }
 
-  Future<Map<String, Object?>> getCoreState() {
+  /// Applies [launchOptions] (or the last ones) to the running core the
+  /// cheapest way it can. When only selector defaults or the clash mode
+  /// changed, the change goes through the Clash API (`mode: "api"`, with
+  /// `applyMs` and the number of `changes`). Otherwise the config is checked
+  /// with `sing-box check` first; a config that fails leaves the core
+  /// untouched and the call fails with `CORE_CONFIG_INVALID`. On Linux a
+  /// core launched with the same options reloads in place
+  /// (`mode: "reload"`, plus a `core_reloaded` event); anything else is
+  /// restarted as by [restartCore], with `mode: "restart"` and a
+  /// `fallbackReason` in the result.
+  Future<Map<String, Object?>> reloadCore({
+    Map<String, Object?>? launchOptions,
+    String? networkMode,
+    int? stopTimeoutMs,
+  }) {
+    throw UnimplementedError('reloadCore() has not been implemented.');
+  }
+
+  /// On Linux the main core's state lists running isolated cores as
+  /// `isolatedProfileIds`, and a running core's `scheduling` holds what was
+  /// `requested` beside the `nice`, `ioClass`, `cpuAffinity`, `cgroup`,
+  /// `cpuWeight` and `memoryHighBytes` it ran with once started or adopted,
+  /// and how it was placed (`placement`, `placementError`). A core we started reports its
+  /// `goRuntime`: the `profile`, the variables it got and the `cpus` and
+  /// `memoryBytes` they were derived from. With [isolatedProfileId] the state of that
+  /// isolated core is returned instead, with `listenPorts`, `controller`,
+  /// `restarts`, `crashLoop`, `uptimeMs` and the process's `rssBytes`,
+  /// `cpuUserMs`, `cpuSystemMs`, `threads` and `openFds`.
+  Future<Map<String, Object?>> getCoreState({String? isolatedProfileId}) {
     throw UnimplementedError('getCoreState() has not been implemented.');
   }
 
+  /// Emits `{type, timestampMs, payload}` maps. `core_state_changed` carries
+  /// the full state as getCoreState reports it plus `message`; on Linux it
+  /// also has a `version` and `previousStatus`, and a new listener first gets
+  /// the recent transitions, ending with the current state. Linux and Windows
+  /// send `core_exited` as soon as the core exits on its own (`exitCode` or
+  /// `signal`, `uptimeMs`, `restartInMs` when a restart is scheduled,
+  /// `crashLoop`, and on Linux `lastLogs`), followed by `core_restarted` or
+  /// `core_restart_failed`. `core_stopped` reports each deliberate stop with
+  /// `stopMs` from the first signal until the core was gone, the `timeoutMs`
+  /// it was given and whether it was `killed`. On Linux `core_reloaded`
+  /// (`pid`, `readyMs`) reports a config reloaded in place;
+  /// `core_config_applied` (`pid`, `applyMs`, `changes`) one applied
+  /// through the Clash API, and `core_adopted` (`pid`, `uptimeMs`) a core
+  /// taken over at registration; the running transition that comes with it
+  /// is replayed to listeners that subscribe later. An adopted core's
+  /// `core_exited` has neither `exitCode` nor `signal`. Isolated cores report
+  /// `instance_exited`, `instance_restarted`, `instance_restart_failed` and
+  /// `instance_stopped`, shaped like their `core_` counterparts plus
+  /// `profileId` and `isolated: true`.
   Stream<Map<String, Object?>> watchCoreEvents() {
     throw UnimplementedError('watchCoreEvents() has not been implemented.');
   }
 
+  /// Emits one map per core log line. Native implementations that batch
+  /// lines also report `seq` and the running `dropped` count on each line.
   Stream<Map<String, Object?>> watchKernelLogs() {
     throw UnimplementedError('watchKernelLogs() has not been implemented.');
   }
 
+  /// Returns buffered core log lines with a sequence number above [sinceSeq]
+  /// as `lines`, plus `nextSeq` and `dropped`. With [isolatedProfileId] the
+  /// lines come from that isolated core.
+  Future<Map<String, Object?>> getRecentLogs({int sinceSeq = 0, String? isolatedProfileId}) {
+    throw UnimplementedError('getRecentLogs() has not been implemented.');
+  }
+
+  /// Emits one `[uploadBytes, downloadBytes, timestampMs]` frame per traffic
+  /// sample of the running core, in bytes per second.
+  Stream<List<int>> watchTraffic() {
+    throw UnimplementedError('watchTraffic() has not been implemented.');
+  }
+
+  /// Emits resource samples of the running core every [intervalMs]. Events
+  /// only carry the fields that changed since the previous one, except for
+  /// events with `keyframe: true`, which carry all of them.
+  Stream<Map<String, Object?>> watchProcessStats({int intervalMs = 1000}) {
+    throw UnimplementedError('watchProcessStats() has not been implemented.');
+  }
+
+  /// Emits what changed in the core's connection table, polled every
+  /// [intervalMs]: `added` as raw JSON objects, `removed` ids, and
+  /// `changedIds` with four `changedCounters` each (upload, download,
+  /// uploadRate, downloadRate). Nothing is sent while nothing changes; an
+  /// event with `reset: true` replaces all previously known connections.
+  Stream<Map<String, Object?>> watchConnectionDeltas({int intervalMs = 1000}) {
+    throw UnimplementedError('watchConnectionDeltas() has not been implemented.');
+  }
+
+  /// Makes the bundled core [version] current in the runtime container.
+  /// Versions are kept side by side, so switching to one that is already
+  /// installed copies nothing (`reused: true`). `binaryInstall` and
+  /// `configInstall` report how each file was installed, `unchanged`
+  /// included, and `collectedVersions` lists old versions removed to stay
+  /// under the container's size cap. When `checksums.json` lists the
+  /// version, a binary that does not match it is not installed;
+  /// `integrityVerified` says whether it was checked.
   Future<Map<String, Object?>> setupRuntime({
     required String version,
     required String platformArch,
@@ -67,6 +188,9 @@ abstract class JumperSdkPlatformPlatform extends PlatformInterface {
     throw UnimplementedError('setupRuntime() has not been implemented.');
   }
 
+  /// Reports the current version from the container index.
+  /// `integrityVerified` is true when the current binary still matches the
+  /// checksum it was installed against.
   Future<Map<String, Object?>> inspectRuntime({
     required String version,
     required String platformArch,
@@ -75,6 +199,50 @@ abstract class JumperSdkPlatformPlatform extends PlatformInterface {
     throw UnimplementedError('inspectRuntime() has not been implemented.');
   }
 
+  /// Makes the version that was current before the last switch current
+  /// again. Fails with `ROLLBACK_RUNTIME_FAILED` when there is none.
+  Future<Map<String, Object?>> rollbackRuntime() {
+    throw UnimplementedError('rollbackRuntime() has not been implemented.');
+  }
+
+  /// Returns latency histograms the plugin keeps since it was loaded, keyed
+  /// `methods` (per method-channel handler), `queueWaits` (time calls waited
+  /// for their worker lane) and `phases` (spawn, first_byte, ready, check,
+  /// reload, stop). Each entry has `count`, `sumMs`, `maxMs`, `p50Ms`,
+  /// `p90Ms`, `p99Ms` and `p999Ms`. With [textfilePath] the histograms are
+  /// also written there as OpenMetrics text for node_exporter's textfile
+  /// collector; a failed write is reported as `textfileError`.
+  Future<Map<String, Object?>> getPluginMetrics({String? textfilePath}) {
+    throw UnimplementedError('getPluginMetrics() has not been implemented.');
+  }
+
+  /// Starts or stops recording begin/end trace events for method calls and
+  /// core lifecycle steps (parse_config, wait_ports, verify_binary, spawn,
+  /// wait_ready, check, reload, stop, install_runtime). Tracing is off until
+  /// enabled, or from launch on with `JUMPER_TRACE` set; enabling it again
+  /// starts from an empty buffer.
+  Future<void> setTracing({required bool enabled}) {
+    throw UnimplementedError('setTracing() has not been implemented.');
+  }
+
+  /// Writes the recorded events to [path] as Chrome trace-event JSON, which
+  /// Perfetto and chrome://tracing open directly, or returns the JSON as
+  /// `trace` without a path. Also reports `enabled`, `events`, `dropped`
+  /// (overwritten once the buffer was full) and `capacity`.
+  Future<Map<String, Object?>> dumpTrace({String? path}) {
+    throw UnimplementedError('dumpTrace() has not been implemented.');
+  }
+
+  /// Returns what the native main-thread watchdog saw since launch or the
+  /// last [clear]: `stalls`, each with `durationMs`, `timestampMs`,
+  /// `pluginAttributed` and the `method` whose handler held the thread; a
+  /// `stallDurations` and a `heartbeatLatency` histogram; `thresholdMs`
+  /// (16), `heartbeatIntervalMs`, `heartbeats`, `dropped`, and
+  /// `worstMethodStallMs`, the longest stall a plugin handler caused.
+  Future<Map<String, Object?>> getMainThreadStalls({bool clear = false}) {
+    throw UnimplementedError('getMainThreadStalls() has not been implemented.');
+  }
+
   Future<void> enableSystemProxy({
     required String host,
     required int port,
@@ -127,6 +295,8 @@ abstract class JumperSdkPlatformPlatform extends PlatformInterface {
     throw UnimplementedError('getTrayStatus() has not been implemented.');
   }
 
+  /// Rebuilds the tunnel by reloading a real core (restarting it on
+  /// Windows). The simulator has nothing to reset.
   Future<void> resetTunnel() {
     throw UnimplementedError('resetTunnel() has not been implemented.');
   }
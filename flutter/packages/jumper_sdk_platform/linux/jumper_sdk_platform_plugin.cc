@@ -1,446 +1,3231 @@
 #include "include/jumper_sdk_platform/jumper_sdk_platform_plugin.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <flutter_linux/flutter_linux.h>
+#include <glib-unix.h>
 #include <gtk/gtk.h>
 #include <signal.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
+#include <chrono>
 #include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "clash_api_stream.h"
+#include "config_planner.h"
+#include "connection_tracker.h"
+#include "core_config.h"
+#include "core_instances.h"
+#include "core_readiness.h"
+#include "core_record.h"
+#include "core_scheduling.h"
+#include "core_state_machine.h"
+#include "core_supervisor.h"
+#include "file_digest.h"
+#include "file_install.h"
+#include "go_runtime_tuning.h"
+#include "kernel_log_buffer.h"
+#include "latency_metrics.h"
+#include "process_launcher.h"
+#include "process_stats.h"
+#include "runtime_store.h"
+#include "stall_watchdog.h"
+#include "trace_recorder.h"
 #include "jumper_sdk_platform_plugin_private.h"
 
 #define JUMPER_SDK_PLATFORM_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), jumper_sdk_platform_plugin_get_type(), \
                               JumperSdkPlatformPlugin))
 
+// startCore/stopCore/restartCore share one serial lane so they run in the
+// order Dart issued them; runtime install and inspection get their own lane.
+static constexpr gint kLifecycleWorkerCount = 1;
+static constexpr gint kRuntimeWorkerCount = 2;
+// Isolated cores are started and stopped on a serial lane of their own, so
+// they neither wait for the main core nor overtake each other.
+static constexpr gint kInstanceWorkerCount = 1;
+static constexpr gsize kMaxCoreInstances = 32;
+// Upper bound for the Clash API to come up after spawn.
+static constexpr gint kCoreReadyTimeoutMs = 6000;
+// How long a stopped core gets to exit before it is killed, unless the call
+// passes stopTimeoutMs.
+static constexpr gint kCoreStopDefaultTimeoutMs = 2000;
+static constexpr gint kCoreStopMaxTimeoutMs = 30000;
+// How long the next start waits for the stopped core's ports to free up.
+static constexpr gint kCorePortReleaseTimeoutMs = 1000;
+// Upper bound for `sing-box check` on a config about to be loaded.
+static constexpr gint kCoreConfigCheckTimeoutMs = 5000;
+// Per call, for config changes applied through the Clash API.
+static constexpr gint kConfigApiTimeoutMs = 1000;
+// Core output sent along with an unexpected exit.
+static constexpr gsize kCoreExitLogLines = 50;
+// Exit checks on kernels without pidfds.
+static constexpr guint kCoreExitPollIntervalMs = 1000;
+// Transitions replayed to a core_events listener that attaches late.
+static constexpr gsize kCoreEventReplayCapacity = 16;
+// Core stdout/stderr is framed into lines off the platform thread and kept in
+// a ring buffer; listeners get it in batches every kLogBatchIntervalMs.
+static constexpr gsize kLogBufferCapacity = 4096;
+static constexpr gsize kLogLowLevelBudgetPerSecond = 200;
+static constexpr gsize kLogSampleRate = 16;
+static constexpr gsize kLogMaxLineBytes = 8 * 1024;
+static constexpr gsize kLogReadChunkBytes = 16 * 1024;
+static constexpr guint kLogBatchIntervalMs = 100;
+static constexpr gsize kLogBatchMaxLines = 512;
+// The core's log file is read as it grows, and emptied once everything in
+// it has been read and it has grown past this size.
+static constexpr off_t kLogTruncateBytes = 1024 * 1024;
+// How often the log file is checked when inotify is unavailable.
+static constexpr gint kLogFollowIntervalMs = 250;
+// Bounds for the sampling cadence a process stats or connections listener
+// may ask for.
+static constexpr gint kSampleDefaultIntervalMs = 1000;
+static constexpr gint kSampleMinIntervalMs = 100;
+static constexpr gint kSampleMaxIntervalMs = 60000;
+// Trace events kept while tracing; a cold connect takes a few dozen.
+static constexpr gsize kTraceCapacity = 16384;
+
+enum {
+  kCoreErrorPortInUse = 1,
+  kCoreErrorNotReady = 2,
+  kCoreErrorIntegrity = 3,
+  kCoreErrorConfigInvalid = 4,
+};
+
 struct _JumperSdkPlatformPlugin {
   GObject parent_instance;
-  gboolean is_running;
-  gint64 pid;
-  gchar* profile_id;
-  gchar* runtime_mode;
-  gchar* network_mode;
+  // The reported core state. Transitions are made on the lifecycle lane;
+  // getCoreState and the core_events channel read it on the platform thread.
+  jumper_sdk_platform::CoreStateMachine* core_state;
+  // Guards pending_starts, scheduling, real_cgroup, real_scheduling and
+  // real_go_runtime.
+  GMutex state_mutex;
+  // Only touched from the lifecycle lane.
   GPid real_pid;
+  // Signals and exit waits go through this rather than the pid; -1 on
+  // kernels without pidfds.
+  gint real_pidfd;
   gboolean has_real_process;
+  // Monotonic spawn time and the first log sequence number of this core.
+  gint64 real_started_at;
+  guint64 real_first_log_seq;
+  // The Clash API the core serves, if its config has one.
+  jumper_sdk_platform::ClashApiEndpoint* real_controller;
+  // The config the core runs with, as the planner sees it. Null when it
+  // could not be read.
+  jumper_sdk_platform::ConfigShape* real_config;
+  // What the next run of the app needs to take the core over, mirrored in
+  // core.json. Null when the core could not be recorded.
+  jumper_sdk_platform::CoreRecord* real_record;
+  // The core was left running by an earlier run of the app and taken over
+  // at registration. It is not our child: its parent reaps it, and how it
+  // ended is never known.
+  gboolean real_adopted;
+  // A startCore with the launch the adopted core runs keeps it, applying
+  // config changes the way reloadCore does. Cleared by the first startCore,
+  // and unset when the binary has been replaced since the core started.
+  gboolean keep_adopted_core;
+  // Fires on the platform thread once the core exits. Created and destroyed
+  // on the lifecycle lane.
+  GSource* exit_watch;
+  // Restarts of a core that exited on its own. Lifecycle lane only.
+  jumper_sdk_platform::RestartBackoff* restart_backoff;
+  GSource* restart_timer;
   gchar* last_binary_path;
   gchar** last_arguments;
   gchar* last_working_directory;
+  // `KEY=VALUE` overrides from launchOptions.environment.
+  gchar** last_environment;
+  // launchOptions.scheduling of the last startCore or restartCore, which
+  // automatic restarts keep. Written on the lifecycle lane.
+  jumper_sdk_platform::CoreSchedulingOptions* scheduling;
+  // Where the running core was moved to apply scheduling's cgroup limits.
+  jumper_sdk_platform::CgroupPlacement* real_cgroup;
+  // The scheduling the running core ended up with, read back once it was
+  // started or adopted. Null without a core, or when it could not be read.
+  jumper_sdk_platform::ProcessSchedulingState* real_scheduling;
+  // launchOptions.goRuntimeProfile, kept like scheduling.
+  jumper_sdk_platform::GoRuntimeProfile go_runtime_profile;
+  // The Go runtime variables the running core was started with. Null for an
+  // adopted core, whose launch we did not tune.
+  jumper_sdk_platform::GoRuntimeTuning* real_go_runtime;
+  // Latency histograms of method calls and core lifecycle steps, recorded
+  // from any thread without locking.
+  jumper_sdk_platform::LatencyRegistry* metrics;
+  // Begin/end events of method calls and lifecycle steps, for dumpTrace.
+  // Off unless setTracing or JUMPER_TRACE turned it on.
+  jumper_sdk_platform::TraceRecorder* trace;
+  // Heartbeats the main loop from a thread of its own and records the
+  // times it was held up, pinned on the handler running then.
+  jumper_sdk_platform::StallWatchdog* stalls;
+  GThreadPool* lifecycle_pool;
+  GThreadPool* runtime_pool;
+  // Cores started with `isolated: true`, keyed by profile id, beside the
+  // main one. Their starts and stops run on instance_pool.
+  jumper_sdk_platform::CoreInstanceRegistry* instances;
+  GThreadPool* instance_pool;
+  // Cancellables of startCore/restartCore calls that have not completed yet,
+  // guarded by state_mutex.
+  GPtrArray* pending_starts;
+  // Lives as long as the plugin so sequence numbers keep increasing across
+  // restarts.
+  jumper_sdk_platform::KernelLogBuffer* kernel_logs;
+  // Reader thread for the current core's log file or pipes. Lifecycle lane
+  // only.
+  struct _CoreLogCapture* log_capture;
+  // Platform thread only.
+  FlEventChannel* kernel_logs_channel;
+  guint kernel_logs_flush_source;
+  guint64 kernel_logs_reported_dropped;
+  // Follows the running core's /traffic endpoint while someone listens.
+  jumper_sdk_platform::ClashApiStream* traffic_stream;
+  FlEventChannel* traffic_channel;
+  // Samples /proc/<pid> of the running core while someone listens.
+  jumper_sdk_platform::ProcessStatsSampler* process_stats;
+  FlEventChannel* process_stats_channel;
+  // Polls the running core's /connections while someone listens.
+  jumper_sdk_platform::ConnectionsPoller* connections;
+  FlEventChannel* connections_channel;
+  // State transitions, exit and automatic restart notices. Platform thread
+  // only.
+  FlEventChannel* core_events_channel;
+  gboolean core_events_listening;
+  guint64 core_events_delivered_version;
 };
 
-G_DEFINE_TYPE(JumperSdkPlatformPlugin, jumper_sdk_platform_plugin, g_object_get_type())
+G_DEFINE_TYPE(JumperSdkPlatformPlugin, jumper_sdk_platform_plugin, g_object_get_type())
+
+// Runs on a worker thread. The returned response is delivered to Flutter on
+// the platform thread.
+typedef FlMethodResponse* (*MethodHandler)(JumperSdkPlatformPlugin* self,
+                                           FlMethodCall* method_call,
+                                           GCancellable* cancellable);
+
+typedef struct {
+  JumperSdkPlatformPlugin* plugin;
+  FlMethodCall* method_call;
+  MethodHandler handler;
+  GCancellable* cancellable;
+  FlMethodResponse* response;
+  // Looked up at dispatch; null for work the plugin queues for itself.
+  jumper_sdk_platform::LatencyHistogram* queue_latency;
+  jumper_sdk_platform::LatencyHistogram* latency;
+  gint64 queued_at_ns;
+} MethodTask;
+
+// steady_clock, as a plain integer a g_new0'd struct can hold.
+static gint64 monotonic_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static gboolean flush_core_events(gpointer user_data);
+
+// Moves the core to |status| and queues the transition for core_events
+// listeners. A |runtime_mode| of nullptr keeps the current one; edges the
+// state machine does not allow are dropped.
+static void transition_core(JumperSdkPlatformPlugin* self,
+                            jumper_sdk_platform::CoreStatus status,
+                            const gchar* runtime_mode,
+                            gint64 pid,
+                            const gchar* message) {
+  jumper_sdk_platform::CoreStateChange change;
+  change.status = status;
+  change.runtime_mode = runtime_mode == nullptr ? "" : runtime_mode;
+  change.pid = pid;
+  change.message = message == nullptr ? "" : message;
+  if (!self->core_state->Apply(change, g_get_real_time() / 1000, nullptr)) {
+    return;
+  }
+  g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, flush_core_events, g_object_ref(self),
+                             g_object_unref);
+}
+
+static void update_network_mode(JumperSdkPlatformPlugin* self, FlValue* args) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+  FlValue* network_mode = fl_value_lookup_string(args, "networkMode");
+  if (network_mode != nullptr &&
+      fl_value_get_type(network_mode) == FL_VALUE_TYPE_STRING &&
+      strlen(fl_value_get_string(network_mode)) > 0) {
+    self->core_state->SetNetworkMode(fl_value_get_string(network_mode));
+  }
+}
+
+typedef struct _CoreLogCapture {
+  gint stdout_fd;
+  gint stderr_fd;
+  // Instead of the pipes, a log file the core writes both streams to, and an
+  // inotify watch on it; -1 without one.
+  gint file_fd;
+  gint notify_fd;
+  // Written to by core_log_capture_free to stop the reader.
+  gint wake_fds[2];
+  jumper_sdk_platform::KernelLogBuffer* buffer;
+  GThread* thread;
+} CoreLogCapture;
+
+static void core_log_capture_append(jumper_sdk_platform::KernelLogBuffer* buffer,
+                                    std::string line) {
+  const auto level = jumper_sdk_platform::ParseKernelLogLevel(line);
+  buffer->Append(level, std::move(line), g_get_real_time() / 1000);
+}
+
+// Reads what is available on |fd|. Returns FALSE once the pipe is closed.
+static gboolean core_log_capture_read(CoreLogCapture* capture,
+                                      gint fd,
+                                      jumper_sdk_platform::LogLineFramer* framer,
+                                      gchar* chunk) {
+  const auto on_line = [capture](std::string line) {
+    core_log_capture_append(capture->buffer, std::move(line));
+  };
+  for (;;) {
+    const ssize_t count = read(fd, chunk, kLogReadChunkBytes);
+    if (count > 0) {
+      framer->Feed(chunk, static_cast<size_t>(count), on_line);
+      continue;
+    }
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return TRUE;
+    }
+    framer->Flush(on_line);
+    return FALSE;
+  }
+}
+
+// Reads what the core appended to its log file since the last call. The file
+// lives as long as the core, so once it has been read to the end and has
+// grown past kLogTruncateBytes it is emptied; the core appends, so its next
+// line lands at the start again. A line written between the size check and
+// the truncate is lost, a window of one system call.
+static void core_log_capture_read_file(CoreLogCapture* capture,
+                                       jumper_sdk_platform::LogLineFramer* framer,
+                                       gchar* chunk,
+                                       off_t* offset) {
+  const auto on_line = [capture](std::string line) {
+    core_log_capture_append(capture->buffer, std::move(line));
+  };
+  for (;;) {
+    const ssize_t count = read(capture->file_fd, chunk, kLogReadChunkBytes);
+    if (count > 0) {
+      framer->Feed(chunk, static_cast<size_t>(count), on_line);
+      *offset += count;
+      continue;
+    }
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    break;
+  }
+  struct stat file_stat;
+  if (*offset >= kLogTruncateBytes && fstat(capture->file_fd, &file_stat) == 0 &&
+      file_stat.st_size == *offset && ftruncate(capture->file_fd, 0) == 0) {
+    lseek(capture->file_fd, 0, SEEK_SET);
+    *offset = 0;
+  }
+}
+
+// Follows the log file until stopped. Reaching its end only means the core
+// has written nothing new yet.
+static void core_log_capture_follow(CoreLogCapture* capture) {
+  jumper_sdk_platform::LogLineFramer framer(kLogMaxLineBytes);
+  std::vector<gchar> chunk(kLogReadChunkBytes);
+  // An adopted core's file starts where it was opened; whatever came
+  // before, written while nobody read it, goes with the first truncate.
+  off_t offset = lseek(capture->file_fd, 0, SEEK_CUR);
+  for (;;) {
+    GPollFD fds[2] = {};
+    fds[0].fd = capture->wake_fds[0];
+    fds[0].events = G_IO_IN;
+    fds[1].fd = capture->notify_fd;
+    fds[1].events = G_IO_IN;
+    if (g_poll(fds, 2, capture->notify_fd >= 0 ? -1 : kLogFollowIntervalMs) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents != 0) {
+      alignas(struct inotify_event) gchar events[4096];
+      while (read(capture->notify_fd, events, sizeof(events)) > 0) {
+      }
+    }
+    core_log_capture_read_file(capture, &framer, chunk.data(), &offset);
+    if (fds[0].revents != 0) {
+      framer.Flush([capture](std::string line) {
+        core_log_capture_append(capture->buffer, std::move(line));
+      });
+      break;
+    }
+  }
+}
+
+static gpointer core_log_capture_thread(gpointer data) {
+  CoreLogCapture* capture = static_cast<CoreLogCapture*>(data);
+  if (capture->file_fd >= 0) {
+    core_log_capture_follow(capture);
+    return nullptr;
+  }
+  jumper_sdk_platform::LogLineFramer stdout_framer(kLogMaxLineBytes);
+  jumper_sdk_platform::LogLineFramer stderr_framer(kLogMaxLineBytes);
+  std::vector<gchar> chunk(kLogReadChunkBytes);
+  gboolean stdout_open = capture->stdout_fd >= 0;
+  gboolean stderr_open = capture->stderr_fd >= 0;
+  while (stdout_open || stderr_open) {
+    GPollFD fds[3] = {};
+    fds[0].fd = capture->wake_fds[0];
+    fds[0].events = G_IO_IN;
+    fds[1].fd = stdout_open ? capture->stdout_fd : -1;
+    fds[1].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+    fds[2].fd = stderr_open ? capture->stderr_fd : -1;
+    fds[2].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+    if (g_poll(fds, 3, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    const gboolean stopping = fds[0].revents != 0;
+    // On stop, drain whatever the core wrote before it exited and leave.
+    if (stdout_open && (fds[1].revents != 0 || stopping)) {
+      stdout_open = core_log_capture_read(capture, capture->stdout_fd, &stdout_framer,
+                                          chunk.data());
+    }
+    if (stderr_open && (fds[2].revents != 0 || stopping)) {
+      stderr_open = core_log_capture_read(capture, capture->stderr_fd, &stderr_framer,
+                                          chunk.data());
+    }
+    if (stopping) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
+// Takes ownership of the descriptors: either both pipe read ends, or
+// |file_fd| open on |file_path| with the others at -1.
+static CoreLogCapture* core_log_capture_new(gint stdout_fd,
+                                            gint stderr_fd,
+                                            gint file_fd,
+                                            const gchar* file_path,
+                                            jumper_sdk_platform::KernelLogBuffer* buffer) {
+  CoreLogCapture* capture = g_new0(CoreLogCapture, 1);
+  capture->stdout_fd = stdout_fd;
+  capture->stderr_fd = stderr_fd;
+  capture->file_fd = file_fd;
+  capture->notify_fd = -1;
+  capture->buffer = buffer;
+  if (file_fd >= 0) {
+    capture->notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (capture->notify_fd >= 0 &&
+        inotify_add_watch(capture->notify_fd, file_path, IN_MODIFY) < 0) {
+      close(capture->notify_fd);
+      capture->notify_fd = -1;
+    }
+  }
+  capture->wake_fds[0] = -1;
+  capture->wake_fds[1] = -1;
+  g_autoptr(GError) error = nullptr;
+  if (!g_unix_open_pipe(capture->wake_fds, FD_CLOEXEC, &error)) {
+    g_warning("Core log capture disabled: %s", error->message);
+  }
+  for (const gint fd : {stdout_fd, stderr_fd}) {
+    if (fd >= 0) {
+      g_unix_set_fd_nonblocking(fd, TRUE, nullptr);
+    }
+  }
+  if (capture->wake_fds[0] >= 0) {
+    capture->thread = g_thread_new("jumper-core-logs", core_log_capture_thread, capture);
+  }
+  return capture;
+}
+
+static void core_log_capture_free(CoreLogCapture* capture) {
+  if (capture->thread != nullptr) {
+    const gchar wake = 1;
+    while (write(capture->wake_fds[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    g_thread_join(capture->thread);
+  }
+  for (const gint fd : {capture->stdout_fd, capture->stderr_fd, capture->file_fd,
+                        capture->notify_fd, capture->wake_fds[0], capture->wake_fds[1]}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  g_free(capture);
+}
+
+static void close_core_pidfd(JumperSdkPlatformPlugin* self) {
+  if (self->real_pidfd >= 0) {
+    close(self->real_pidfd);
+    self->real_pidfd = -1;
+  }
+}
+
+static void clear_exit_watch(JumperSdkPlatformPlugin* self) {
+  if (self->exit_watch != nullptr) {
+    g_source_destroy(self->exit_watch);
+    g_clear_pointer(&self->exit_watch, g_source_unref);
+  }
+}
+
+static void clear_restart_timer(JumperSdkPlatformPlugin* self) {
+  if (self->restart_timer != nullptr) {
+    g_source_destroy(self->restart_timer);
+    g_clear_pointer(&self->restart_timer, g_source_unref);
+  }
+}
+
+// A deliberate start, restart or stop supersedes any automatic restart and
+// gives the next core a fresh crash budget.
+static void cancel_automatic_restart(JumperSdkPlatformPlugin* self) {
+  clear_restart_timer(self);
+  self->restart_backoff->Reset();
+}
+
+static void discard_core_record(JumperSdkPlatformPlugin* self);
+
+// Drops everything tied to a core that has been reaped.
+static void release_core_process(JumperSdkPlatformPlugin* self) {
+  discard_core_record(self);
+  clear_exit_watch(self);
+  close_core_pidfd(self);
+  g_clear_pointer(&self->log_capture, core_log_capture_free);
+  self->traffic_stream->ClearEndpoint();
+  self->connections->ClearEndpoint();
+  self->process_stats->SetPid(0);
+  delete self->real_controller;
+  self->real_controller = nullptr;
+  delete self->real_config;
+  self->real_config = nullptr;
+  g_mutex_lock(&self->state_mutex);
+  jumper_sdk_platform::RemoveCgroup(*self->real_cgroup);
+  *self->real_cgroup = jumper_sdk_platform::CgroupPlacement();
+  delete self->real_scheduling;
+  self->real_scheduling = nullptr;
+  delete self->real_go_runtime;
+  self->real_go_runtime = nullptr;
+  g_mutex_unlock(&self->state_mutex);
+  self->real_pid = 0;
+  self->has_real_process = FALSE;
+  self->real_adopted = FALSE;
+  self->keep_adopted_core = FALSE;
+}
+
+static void post_core_event(JumperSdkPlatformPlugin* self, const gchar* type, FlValue* payload);
+
+// Reads stopTimeoutMs from a lifecycle call, clamped to what a caller may
+// ask for.
+static gint stop_timeout_from_args(FlValue* args) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return kCoreStopDefaultTimeoutMs;
+  }
+  FlValue* value = fl_value_lookup_string(args, "stopTimeoutMs");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return kCoreStopDefaultTimeoutMs;
+  }
+  return static_cast<gint>(CLAMP(fl_value_get_int(value), 0, kCoreStopMaxTimeoutMs));
+}
+
+// Stops the core's whole process group, giving it |timeout_ms| to exit
+// before it is killed, and reaps it so its ports and tun device are released
+// before the next start. Reports the stop as core_stopped. Returns FALSE when
+// no core was running.
+static gboolean stop_real_process(JumperSdkPlatformPlugin* self, gint timeout_ms) {
+  if (!self->has_real_process) {
+    return FALSE;
+  }
+  // This exit is expected; nobody needs to be told about it.
+  clear_exit_watch(self);
+  const GPid pid = self->real_pid;
+  if (pid > 0) {
+    jumper_sdk_platform::TraceScope trace(self->trace, "stop", "core");
+    const auto stop =
+        jumper_sdk_platform::StopProcessGroup(pid, self->real_pidfd, timeout_ms);
+    trace.Close();
+    self->metrics->RecordMilliseconds(jumper_sdk_platform::kCorePhaseLatency, "stop",
+                                      stop.exit_ms);
+    FlValue* payload = fl_value_new_map();
+    fl_value_set_string_take(payload, "pid", fl_value_new_int(pid));
+    fl_value_set_string_take(payload, "stopMs", fl_value_new_float(stop.exit_ms));
+    fl_value_set_string_take(payload, "timeoutMs", fl_value_new_int(timeout_ms));
+    fl_value_set_string_take(payload, "killed", fl_value_new_bool(stop.killed));
+    post_core_event(self, "core_stopped", payload);
+  }
+  release_core_process(self);
+  return TRUE;
+}
+
+// Reaps the core if it has already exited and describes how it ended.
+static gboolean reap_exited_core(JumperSdkPlatformPlugin* self, std::string* reason) {
+  if (!self->has_real_process || self->real_pid <= 0) {
+    *reason = "Core process exited during startup";
+    return TRUE;
+  }
+  if (self->real_adopted) {
+    if (!jumper_sdk_platform::WaitForProcessExit(self->real_pidfd, 0)) {
+      return FALSE;
+    }
+    *reason = "Core process exited";
+    release_core_process(self);
+    return TRUE;
+  }
+  int status = 0;
+  if (waitpid(self->real_pid, &status, WNOHANG) != self->real_pid) {
+    return FALSE;
+  }
+  if (WIFSIGNALED(status)) {
+    *reason = "Core process was killed by signal " + std::to_string(WTERMSIG(status)) +
+              " during startup";
+  } else {
+    *reason = "Core process exited during startup, exit code " +
+              std::to_string(WEXITSTATUS(status));
+  }
+  release_core_process(self);
+  return TRUE;
+}
+
+// Sleeps for up to |timeout_ms|, waking early when |cancellable| fires.
+// Returns FALSE if the start was cancelled.
+static gboolean wait_unless_cancelled(GCancellable* cancellable, gint timeout_ms) {
+  GPollFD poll_fd;
+  if (cancellable == nullptr || !g_cancellable_make_pollfd(cancellable, &poll_fd)) {
+    g_usleep(static_cast<gulong>(timeout_ms) * 1000);
+    return cancellable == nullptr || !g_cancellable_is_cancelled(cancellable);
+  }
+  g_poll(&poll_fd, 1, timeout_ms);
+  g_cancellable_release_fd(cancellable);
+  return !g_cancellable_is_cancelled(cancellable);
+}
+
+// Scans the `-c` config in |launch_args|. A missing or malformed config
+// leaves |config| without a controller or listen ports; sing-box reports the
+// actual problem once spawned.
+static void read_launch_config(gchar** launch_args, jumper_sdk_platform::CoreConfig* config) {
+  for (guint i = 0; launch_args != nullptr && launch_args[i] != nullptr; ++i) {
+    if (strcmp(launch_args[i], "-c") == 0 && launch_args[i + 1] != nullptr) {
+      jumper_sdk_platform::ReadCoreConfig(launch_args[i + 1], config, nullptr);
+      return;
+    }
+  }
+}
+
+// Scans the config |launch_args| loads for the config planner. Returns
+// nullptr when it loads more than one or the config cannot be read.
+static jumper_sdk_platform::ConfigShape* read_launch_shape(gchar** launch_args) {
+  std::vector<std::string> arguments;
+  for (guint i = 0; launch_args != nullptr && launch_args[i] != nullptr; ++i) {
+    arguments.emplace_back(launch_args[i]);
+  }
+  std::string path;
+  if (!jumper_sdk_platform::SingleConfigPath(arguments, &path)) {
+    return nullptr;
+  }
+  auto* shape = new jumper_sdk_platform::ConfigShape();
+  if (!jumper_sdk_platform::ReadConfigShape(path, shape, nullptr)) {
+    delete shape;
+    return nullptr;
+  }
+  return shape;
+}
+
+static void set_real_config(JumperSdkPlatformPlugin* self,
+                            jumper_sdk_platform::ConfigShape* shape) {
+  delete self->real_config;
+  self->real_config = shape;
+}
+
+static gboolean parse_launch_options(FlValue* args,
+                                     gchar** binary_path,
+                                     gchar*** launch_args,
+                                     gchar** working_dir,
+                                     gchar*** environment) {
+  *binary_path = nullptr;
+  *launch_args = nullptr;
+  *working_dir = nullptr;
+  *environment = nullptr;
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FALSE;
+  }
+  FlValue* launch = fl_value_lookup_string(args, "launchOptions");
+  if (launch == nullptr || fl_value_get_type(launch) != FL_VALUE_TYPE_MAP) {
+    return FALSE;
+  }
+  FlValue* binary = fl_value_lookup_string(launch, "binaryPath");
+  if (binary == nullptr || fl_value_get_type(binary) != FL_VALUE_TYPE_STRING) {
+    return FALSE;
+  }
+  const gchar* binary_text = fl_value_get_string(binary);
+  if (binary_text == nullptr || strlen(binary_text) == 0) {
+    return FALSE;
+  }
+  *binary_path = g_strdup(binary_text);
+
+  FlValue* arg_values = fl_value_lookup_string(launch, "arguments");
+  GPtrArray* ptr_array = g_ptr_array_new_with_free_func(g_free);
+  g_ptr_array_add(ptr_array, g_strdup(binary_text));
+  if (arg_values != nullptr && fl_value_get_type(arg_values) == FL_VALUE_TYPE_LIST) {
+    const size_t count = fl_value_get_length(arg_values);
+    for (size_t i = 0; i < count; ++i) {
+      FlValue* entry = fl_value_get_list_value(arg_values, i);
+      if (entry != nullptr && fl_value_get_type(entry) == FL_VALUE_TYPE_STRING) {
+        g_ptr_array_add(ptr_array, g_strdup(fl_value_get_string(entry)));
+      }
+    }
+  }
+  g_ptr_array_add(ptr_array, nullptr);
+  *launch_args = reinterpret_cast<gchar**>(g_ptr_array_free(ptr_array, FALSE));
+
+  FlValue* wd = fl_value_lookup_string(launch, "workingDirectory");
+  if (wd != nullptr && fl_value_get_type(wd) == FL_VALUE_TYPE_STRING) {
+    const gchar* wd_text = fl_value_get_string(wd);
+    if (wd_text != nullptr && strlen(wd_text) > 0) {
+      *working_dir = g_strdup(wd_text);
+    }
+  }
+
+  FlValue* env_values = fl_value_lookup_string(launch, "environment");
+  GPtrArray* env_array = g_ptr_array_new_with_free_func(g_free);
+  if (env_values != nullptr && fl_value_get_type(env_values) == FL_VALUE_TYPE_MAP) {
+    const size_t count = fl_value_get_length(env_values);
+    for (size_t i = 0; i < count; ++i) {
+      FlValue* key = fl_value_get_map_key(env_values, i);
+      FlValue* value = fl_value_get_map_value(env_values, i);
+      if (key != nullptr && fl_value_get_type(key) == FL_VALUE_TYPE_STRING && value != nullptr &&
+          fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+        g_ptr_array_add(env_array, g_strdup_printf("%s=%s", fl_value_get_string(key),
+                                                   fl_value_get_string(value)));
+      }
+    }
+  }
+  g_ptr_array_add(env_array, nullptr);
+  *environment = reinterpret_cast<gchar**>(g_ptr_array_free(env_array, FALSE));
+  return TRUE;
+}
+
+// Reads launchOptions.scheduling: `nice`, `ioClass` (realtime, best-effort
+// or idle) and `ioLevel`, `cpuAffinity`, `startupNice`, `cpuWeight` and
+// `memoryHighBytes`. Values out of range are clamped, unknown ones ignored.
+static jumper_sdk_platform::CoreSchedulingOptions parse_scheduling_options(FlValue* args) {
+  jumper_sdk_platform::CoreSchedulingOptions options;
+  FlValue* launch = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                        ? fl_value_lookup_string(args, "launchOptions")
+                        : nullptr;
+  FlValue* scheduling = launch != nullptr && fl_value_get_type(launch) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(launch, "scheduling")
+                            : nullptr;
+  if (scheduling == nullptr || fl_value_get_type(scheduling) != FL_VALUE_TYPE_MAP) {
+    return options;
+  }
+  const auto lookup_int = [scheduling](const gchar* key, int64_t* value) {
+    FlValue* entry = fl_value_lookup_string(scheduling, key);
+    if (entry == nullptr || fl_value_get_type(entry) != FL_VALUE_TYPE_INT) {
+      return FALSE;
+    }
+    *value = fl_value_get_int(entry);
+    return TRUE;
+  };
+  int64_t value = 0;
+  if (lookup_int("nice", &value)) {
+    options.process.has_nice = true;
+    options.process.nice = static_cast<int>(CLAMP(value, -20, 19));
+  }
+  FlValue* io_class = fl_value_lookup_string(scheduling, "ioClass");
+  if (io_class != nullptr && fl_value_get_type(io_class) == FL_VALUE_TYPE_STRING) {
+    options.process.io_class = jumper_sdk_platform::ParseIoClass(fl_value_get_string(io_class));
+  }
+  if (lookup_int("ioLevel", &value)) {
+    options.process.io_level = static_cast<int>(CLAMP(value, 0, 7));
+  }
+  FlValue* cpus = fl_value_lookup_string(scheduling, "cpuAffinity");
+  if (cpus != nullptr && fl_value_get_type(cpus) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(cpus); ++i) {
+      FlValue* cpu = fl_value_get_list_value(cpus, i);
+      if (cpu != nullptr && fl_value_get_type(cpu) == FL_VALUE_TYPE_INT &&
+          fl_value_get_int(cpu) >= 0 && fl_value_get_int(cpu) < CPU_SETSIZE) {
+        options.process.cpus.push_back(static_cast<int>(fl_value_get_int(cpu)));
+      }
+    }
+  }
+  if (lookup_int("startupNice", &value)) {
+    options.has_startup_nice = true;
+    options.startup_nice = static_cast<int>(CLAMP(value, -20, 19));
+  }
+  if (lookup_int("cpuWeight", &value) && value > 0) {
+    options.cpu_weight = static_cast<uint32_t>(MIN(value, 10000));
+  }
+  if (lookup_int("memoryHighBytes", &value) && value > 0) {
+    options.memory_high_bytes = static_cast<uint64_t>(value);
+  }
+  return options;
+}
+
+// Lifecycle lane.
+static void set_scheduling(JumperSdkPlatformPlugin* self,
+                           const jumper_sdk_platform::CoreSchedulingOptions& options) {
+  g_mutex_lock(&self->state_mutex);
+  *self->scheduling = options;
+  g_mutex_unlock(&self->state_mutex);
+}
+
+// Reads launchOptions.goRuntimeProfile: off, low-memory, balanced or
+// throughput. Cores run balanced unless told otherwise.
+static jumper_sdk_platform::GoRuntimeProfile parse_go_runtime_profile(FlValue* args) {
+  jumper_sdk_platform::GoRuntimeProfile profile = jumper_sdk_platform::GoRuntimeProfile::kBalanced;
+  FlValue* launch = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                        ? fl_value_lookup_string(args, "launchOptions")
+                        : nullptr;
+  FlValue* name = launch != nullptr && fl_value_get_type(launch) == FL_VALUE_TYPE_MAP
+                      ? fl_value_lookup_string(launch, "goRuntimeProfile")
+                      : nullptr;
+  if (name != nullptr && fl_value_get_type(name) == FL_VALUE_TYPE_STRING &&
+      !jumper_sdk_platform::ParseGoRuntimeProfile(fl_value_get_string(name), &profile)) {
+    g_warning("Unknown Go runtime profile %s; the core runs balanced", fl_value_get_string(name));
+  }
+  return profile;
+}
+
+// Adds GOMAXPROCS, GOMEMLIMIT and GOGC for |profile| to the core's
+// environment, sized to the CPUs it is pinned to and the tighter of our
+// cgroup limits and the memory.high it gets.
+static jumper_sdk_platform::GoRuntimeTuning tune_core_go_runtime(
+    jumper_sdk_platform::GoRuntimeProfile profile,
+    const jumper_sdk_platform::CoreSchedulingOptions& scheduling,
+    std::map<std::string, std::string>* environment) {
+  jumper_sdk_platform::MachineResources resources = jumper_sdk_platform::ReadMachineResources();
+  if (!scheduling.process.cpus.empty()) {
+    resources.cpus = static_cast<int>(scheduling.process.cpus.size());
+  }
+  if (scheduling.memory_high_bytes > 0 &&
+      (resources.memory_limit_bytes == 0 ||
+       scheduling.memory_high_bytes < resources.memory_limit_bytes)) {
+    resources.memory_limit_bytes = scheduling.memory_high_bytes;
+  }
+  jumper_sdk_platform::GoRuntimeTuning tuning =
+      jumper_sdk_platform::TuneGoRuntime(profile, resources);
+  jumper_sdk_platform::ApplyGoRuntimeTuning(&tuning, environment);
+  return tuning;
+}
+
+static void watch_core_exit(JumperSdkPlatformPlugin* self);
+
+static gchar* runtime_container_root() {
+  const gchar* user_data = g_get_user_data_dir();
+  if (user_data != nullptr && strlen(user_data) > 0) {
+    return g_build_filename(user_data, "jumper-runtime", nullptr);
+  }
+  return g_build_filename(g_get_home_dir(), ".local", "share", "jumper-runtime", nullptr);
+}
+
+// Where the running core is recorded for the next run of the app.
+static gchar* core_record_path() {
+  g_autofree gchar* root = runtime_container_root();
+  return g_build_filename(root, "core.json", nullptr);
+}
+
+// Where the core's stdout and stderr go. A file rather than pipes lets the
+// core outlive us: Go programs die of SIGPIPE writing to a pipe nobody
+// reads.
+static gchar* core_log_path() {
+  g_autofree gchar* root = runtime_container_root();
+  return g_build_filename(root, "core.log", nullptr);
+}
+
+// Empties the log file for the next core to append to, and opens a separate
+// description to read it through: the appends move the offset they share.
+static gboolean open_core_log(const gchar* path, gint* writer, gint* reader) {
+  g_autofree gchar* directory = g_path_get_dirname(path);
+  g_mkdir_with_parents(directory, 0700);
+  *writer = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0600);
+  *reader = *writer < 0 ? -1 : open(path, O_RDWR | O_CLOEXEC);
+  if (*reader < 0) {
+    if (*writer >= 0) {
+      close(*writer);
+    }
+    *writer = -1;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// `pid.txt` in the core's working directory, as JumperRuntimeLayout names
+// it; nullptr without one.
+static gchar* core_pid_file_path(const std::string& working_directory) {
+  return working_directory.empty()
+             ? nullptr
+             : g_build_filename(working_directory.c_str(), "pid.txt", nullptr);
+}
+
+static gchar** strv_from_vector(const std::vector<std::string>& values) {
+  gchar** strv = g_new0(gchar*, values.size() + 1);
+  for (size_t i = 0; i < values.size(); ++i) {
+    strv[i] = g_strdup(values[i].c_str());
+  }
+  return strv;
+}
+
+// Writes core.json and the pid file. Called again whenever the config the
+// core runs with changes, so the recorded digest is of the config it
+// loaded last. Lifecycle lane.
+static void save_core_record(JumperSdkPlatformPlugin* self) {
+  jumper_sdk_platform::CoreRecord* record = self->real_record;
+  if (record == nullptr) {
+    return;
+  }
+  record->config_path.clear();
+  record->config_sha256.clear();
+  std::string config_path;
+  if (jumper_sdk_platform::SingleConfigPath(record->arguments, &config_path) &&
+      jumper_sdk_platform::Sha256File(config_path, &record->config_sha256, nullptr, nullptr)) {
+    record->config_path = config_path;
+  }
+  g_autofree gchar* record_path = core_record_path();
+  std::string error;
+  if (!jumper_sdk_platform::WriteCoreRecord(record_path, *record, &error)) {
+    g_warning("The core cannot be adopted after a restart: %s", error.c_str());
+  }
+  g_autofree gchar* pid_path = core_pid_file_path(record->working_directory);
+  g_autofree gchar* pid_text = g_strdup_printf("%" G_GINT64_FORMAT "\n", record->pid);
+  if (pid_path != nullptr) {
+    g_file_set_contents(pid_path, pid_text, -1, nullptr);
+  }
+}
+
+// Records a core we started, once it is up. The executable is hashed
+// through /proc, so the digest is of what runs even when the binary was
+// exec'd by descriptor; a managed runtime's comes from the digest cache.
+static void record_started_core(JumperSdkPlatformPlugin* self, const gchar* log_path) {
+  auto record = std::make_unique<jumper_sdk_platform::CoreRecord>();
+  record->pid = self->real_pid;
+  record->start_time = jumper_sdk_platform::ProcessStartTime(self->real_pid);
+  g_autofree gchar* exe_path = g_strdup_printf("/proc/%d/exe", self->real_pid);
+  if (record->start_time == 0 ||
+      !jumper_sdk_platform::Sha256File(exe_path, &record->binary_sha256, nullptr, nullptr)) {
+    return;
+  }
+  record->binary_path = self->last_binary_path;
+  for (gchar** arg = self->last_arguments; *arg != nullptr; ++arg) {
+    record->arguments.emplace_back(*arg);
+  }
+  if (self->last_working_directory != nullptr) {
+    record->working_directory = self->last_working_directory;
+  }
+  for (gchar** entry = self->last_environment; entry != nullptr && *entry != nullptr; ++entry) {
+    record->environment.emplace_back(*entry);
+  }
+  record->log_path = log_path;
+  delete self->real_record;
+  self->real_record = record.release();
+  save_core_record(self);
+}
+
+// The core is gone, or about to be: there is nothing left to adopt.
+static void discard_core_record(JumperSdkPlatformPlugin* self) {
+  if (self->real_record == nullptr) {
+    return;
+  }
+  g_autofree gchar* record_path = core_record_path();
+  unlink(record_path);
+  g_autofree gchar* pid_path = core_pid_file_path(self->real_record->working_directory);
+  if (pid_path != nullptr) {
+    unlink(pid_path);
+  }
+  delete self->real_record;
+  self->real_record = nullptr;
+}
+
+// The binary is opened once: a runtime from the container is checked against
+// its install digest through |binary|, and the child execs the same
+// descriptor, so the file cannot be swapped in between. Bare names resolved
+// through PATH are left unpinned and spawned by name.
+static gboolean pin_core_binary(const gchar* binary_path,
+                                jumper_sdk_platform::PinnedFile* binary,
+                                GError** error) {
+  if (!binary->Open(binary_path, nullptr)) {
+    return TRUE;
+  }
+  g_autofree gchar* runtime_root = runtime_container_root();
+  jumper_sdk_platform::RuntimeStore store(runtime_root, "sing-box");
+  bool managed = false;
+  std::string verify_error;
+  if (!store.VerifyBinary(binary_path, binary, &managed, &verify_error)) {
+    g_set_error_literal(error, g_quark_from_static_string("jumper.core"), kCoreErrorIntegrity,
+                        verify_error.c_str());
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static jumper_sdk_platform::SpawnOptions core_spawn_options(
+    const gchar* binary_path,
+    const jumper_sdk_platform::PinnedFile* binary,
+    gchar** launch_args,
+    const gchar* working_dir,
+    gchar** environment) {
+  jumper_sdk_platform::SpawnOptions spawn;
+  spawn.executable = binary_path;
+  spawn.executable_fd = binary->fd();
+  for (gchar** arg = launch_args; *arg != nullptr; ++arg) {
+    spawn.arguments.emplace_back(*arg);
+  }
+  if (working_dir != nullptr) {
+    spawn.working_directory = working_dir;
+  }
+  for (gchar** entry = environment; entry != nullptr && *entry != nullptr; ++entry) {
+    const gchar* separator = strchr(*entry, '=');
+    if (separator != nullptr) {
+      spawn.environment[std::string(*entry, separator - *entry)] = separator + 1;
+    }
+  }
+  return spawn;
+}
+
+// Moves the core into a cgroup of its own for the scheduling's limits. A
+// core that cannot be moved runs on in ours; getCoreState tells why.
+static void place_core_in_cgroup(JumperSdkPlatformPlugin* self, GPid pid) {
+  jumper_sdk_platform::CgroupPlacement placement;
+  std::string error;
+  if (!jumper_sdk_platform::PlaceInCgroup(pid, *self->scheduling, &placement, &error)) {
+    g_warning("The core stays in the app's cgroup: %s", error.c_str());
+    placement.error = error;
+  }
+  g_mutex_lock(&self->state_mutex);
+  *self->real_cgroup = placement;
+  g_mutex_unlock(&self->state_mutex);
+}
+
+// Lifecycle lane. Reads back what the core runs with once its scheduling
+// has been applied, for getCoreState to report without going to /proc.
+static void capture_core_scheduling(JumperSdkPlatformPlugin* self, GPid pid) {
+  jumper_sdk_platform::ProcessSchedulingState state;
+  const bool read = jumper_sdk_platform::ReadProcessScheduling(pid, &state);
+  g_mutex_lock(&self->state_mutex);
+  delete self->real_scheduling;
+  self->real_scheduling =
+      read ? new jumper_sdk_platform::ProcessSchedulingState(std::move(state)) : nullptr;
+  g_mutex_unlock(&self->state_mutex);
+}
+
+// Spawns the core and blocks until its Clash API answers. Configs without a
+// controller are reported ready as soon as the process is spawned. With a
+// startup nice, the core only drops to its steady priority, and into its
+// cgroup limits, once it is ready.
+static gboolean start_real_process(JumperSdkPlatformPlugin* self,
+                                   gchar* binary_path,
+                                   gchar** launch_args,
+                                   gchar* working_dir,
+                                   gchar** environment,
+                                   gint stop_timeout_ms,
+                                   GCancellable* cancellable,
+                                   std::chrono::steady_clock::time_point started_at,
+                                   jumper_sdk_platform::ReadinessTimings* timings,
+                                   GError** error) {
+  const gboolean replaced = stop_real_process(self, stop_timeout_ms);
+  // A stopCore issued while this start was queued wins over the start.
+  if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+    return FALSE;
+  }
+  jumper_sdk_platform::TraceScope parse_trace(self->trace, "parse_config", "core");
+  jumper_sdk_platform::CoreConfig config;
+  read_launch_config(launch_args, &config);
+  std::unique_ptr<jumper_sdk_platform::ConfigShape> shape(read_launch_shape(launch_args));
+  parse_trace.Close();
+  // The core just stopped may still hold its sockets for a moment; the start
+  // goes ahead as soon as they are gone.
+  jumper_sdk_platform::TraceScope ports_trace(self->trace, "wait_ports", "core");
+  const uint16_t busy_port =
+      replaced ? jumper_sdk_platform::WaitForPortsReleased(
+                     config.listen_ports, kCorePortReleaseTimeoutMs,
+                     [cancellable](int milliseconds) {
+                       return wait_unless_cancelled(cancellable, milliseconds) == TRUE;
+                     })
+               : jumper_sdk_platform::FindPortInUse(config.listen_ports);
+  ports_trace.Close();
+  if (g_cancellable_set_error_if_cancelled(cancellable, error)) {
+    return FALSE;
+  }
+  if (busy_port != 0) {
+    g_set_error(error, g_quark_from_static_string("jumper.core"), kCoreErrorPortInUse,
+                "Port %u from the launch config is already in use", busy_port);
+    return FALSE;
+  }
+
+  jumper_sdk_platform::TraceScope verify_trace(self->trace, "verify_binary", "core");
+  jumper_sdk_platform::PinnedFile binary;
+  if (!pin_core_binary(binary_path, &binary, error)) {
+    return FALSE;
+  }
+  verify_trace.Close();
+  jumper_sdk_platform::TraceScope spawn_trace(self->trace, "spawn", "core");
+  // The Flutter host maps hundreds of megabytes; the launcher starts the
+  // core without copying its page tables, with an explicit environment.
+  jumper_sdk_platform::SpawnOptions spawn =
+      core_spawn_options(binary_path, &binary, launch_args, working_dir, environment);
+  spawn.new_process_group = true;
+  const jumper_sdk_platform::CoreSchedulingOptions& scheduling = *self->scheduling;
+  spawn.scheduling = scheduling.process;
+  if (scheduling.has_startup_nice) {
+    spawn.scheduling.has_nice = true;
+    spawn.scheduling.nice = scheduling.startup_nice;
+  }
+  // Only the spawned environment carries the tuning: last_environment and
+  // the record keep what the app asked for, so an adopted core still
+  // matches its launch.
+  jumper_sdk_platform::GoRuntimeTuning go_runtime =
+      tune_core_go_runtime(self->go_runtime_profile, scheduling, &spawn.environment);
+  // Without the log file the core falls back to pipes and cannot be adopted.
+  g_autofree gchar* log_path = core_log_path();
+  gint log_writer = -1;
+  gint log_reader = -1;
+  const gboolean logs_to_file = open_core_log(log_path, &log_writer, &log_reader);
+  spawn.output_fd = log_writer;
+  jumper_sdk_platform::SpawnedProcess process;
+  std::string spawn_error;
+  const bool started = jumper_sdk_platform::SpawnProcess(spawn, &process, &spawn_error);
+  spawn_trace.Close();
+  binary.Close();
+  if (logs_to_file) {
+    close(log_writer);
+  }
+  if (!started) {
+    if (logs_to_file) {
+      close(log_reader);
+    }
+    g_set_error_literal(error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED, spawn_error.c_str());
+    return FALSE;
+  }
+  const GPid pid = process.pid;
+  self->real_pid = pid;
+  self->real_pidfd = process.pidfd;
+  self->has_real_process = TRUE;
+  self->real_started_at = g_get_monotonic_time();
+  self->real_first_log_seq = self->kernel_logs->next_seq();
+  self->log_capture = logs_to_file ? core_log_capture_new(-1, -1, log_reader, log_path,
+                                                         self->kernel_logs)
+                                   : core_log_capture_new(process.stdout_fd, process.stderr_fd,
+                                                          -1, nullptr, self->kernel_logs);
+  timings->spawn_ms =
+      jumper_sdk_platform::MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+  self->metrics->RecordMilliseconds(jumper_sdk_platform::kCorePhaseLatency, "spawn",
+                                    timings->spawn_ms);
+  g_mutex_lock(&self->state_mutex);
+  self->real_go_runtime = new jumper_sdk_platform::GoRuntimeTuning(std::move(go_runtime));
+  g_mutex_unlock(&self->state_mutex);
+  if (scheduling.wants_cgroup() && !scheduling.has_startup_nice) {
+    place_core_in_cgroup(self, pid);
+  }
+
+  if (config.has_controller) {
+    jumper_sdk_platform::ReadinessHooks hooks;
+    hooks.wait = [cancellable](int milliseconds) {
+      return wait_unless_cancelled(cancellable, milliseconds) == TRUE;
+    };
+    hooks.has_exited = [self](std::string* reason) {
+      return reap_exited_core(self, reason) == TRUE;
+    };
+    std::string ready_error;
+    jumper_sdk_platform::TraceScope ready_trace(self->trace, "wait_ready", "core");
+    const auto result = jumper_sdk_platform::WaitForClashApi(
+        config.controller, started_at, kCoreReadyTimeoutMs, hooks, timings, &ready_error);
+    ready_trace.Close();
+    if (result != jumper_sdk_platform::ReadinessResult::kReady) {
+      stop_real_process(self, kCoreStopDefaultTimeoutMs);
+      if (result == jumper_sdk_platform::ReadinessResult::kCancelled) {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_CANCELLED, ready_error.c_str());
+      } else {
+        g_set_error_literal(error, g_quark_from_static_string("jumper.core"), kCoreErrorNotReady,
+                            ready_error.c_str());
+      }
+      return FALSE;
+    }
+    self->real_controller = new jumper_sdk_platform::ClashApiEndpoint(config.controller);
+    self->traffic_stream->SetEndpoint(config.controller);
+    self->connections->SetEndpoint(config.controller);
+  } else {
+    timings->ready_ms = timings->spawn_ms;
+  }
+  self->metrics->RecordMilliseconds(jumper_sdk_platform::kCorePhaseLatency, "first_byte",
+                                    timings->first_byte_ms);
+  self->metrics->RecordMilliseconds(jumper_sdk_platform::kCorePhaseLatency, "ready",
+                                    timings->ready_ms);
+  if (scheduling.has_startup_nice) {
+    // Without a steady nice of its own the core goes back to ours.
+    jumper_sdk_platform::ReniceProcess(
+        pid, scheduling.process.has_nice ? scheduling.process.nice
+                                         : getpriority(PRIO_PROCESS, getpid()));
+    if (scheduling.wants_cgroup()) {
+      place_core_in_cgroup(self, pid);
+    }
+  }
+  capture_core_scheduling(self, pid);
+
+  self->process_stats->SetPid(pid);
+  set_real_config(self, shape.release());
+
+  g_clear_pointer(&self->last_binary_path, g_free);
+  self->last_binary_path = g_strdup(binary_path);
+  g_strfreev(self->last_arguments);
+  self->last_arguments = g_strdupv(launch_args);
+  g_clear_pointer(&self->last_working_directory, g_free);
+  self->last_working_directory = working_dir == nullptr ? nullptr : g_strdup(working_dir);
+  g_strfreev(self->last_environment);
+  self->last_environment = g_strdupv(environment);
+  if (logs_to_file) {
+    record_started_core(self, log_path);
+  }
+  watch_core_exit(self);
+  return TRUE;
+}
+
+// Runs `sing-box check` on the configs |launch_args| would load, so a broken
+// config is refused while the running core keeps serving. Launches other
+// than `run` have nothing to check.
+static gboolean check_core_config(const gchar* binary_path,
+                                  gchar** launch_args,
+                                  const gchar* working_dir,
+                                  gchar** environment,
+                                  GError** error) {
+  std::vector<std::string> run_arguments;
+  for (gchar** arg = launch_args + 1; *arg != nullptr; ++arg) {
+    run_arguments.emplace_back(*arg);
+  }
+  std::vector<std::string> check_arguments;
+  if (!jumper_sdk_platform::CheckArgumentsFor(run_arguments, &check_arguments)) {
+    return TRUE;
+  }
+  jumper_sdk_platform::PinnedFile binary;
+  if (!pin_core_binary(binary_path, &binary, error)) {
+    return FALSE;
+  }
+  jumper_sdk_platform::SpawnOptions spawn =
+      core_spawn_options(binary_path, &binary, launch_args, working_dir, environment);
+  spawn.arguments.resize(1);
+  spawn.arguments.insert(spawn.arguments.end(), check_arguments.begin(), check_arguments.end());
+  int exit_code = 0;
+  std::string output;
+  std::string run_error;
+  if (!jumper_sdk_platform::RunProcess(spawn, kCoreConfigCheckTimeoutMs, &exit_code, &output,
+                                       &run_error)) {
+    g_set_error_literal(error, g_quark_from_static_string("jumper.core"),
+                        kCoreErrorConfigInvalid, run_error.c_str());
+    return FALSE;
+  }
+  if (exit_code != 0) {
+    g_autofree gchar* message = g_strstrip(g_strdup(output.c_str()));
+    if (strlen(message) == 0) {
+      g_set_error(error, g_quark_from_static_string("jumper.core"), kCoreErrorConfigInvalid,
+                  "sing-box check exited with code %d", exit_code);
+    } else {
+      g_set_error_literal(error, g_quark_from_static_string("jumper.core"),
+                          kCoreErrorConfigInvalid, message);
+    }
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// Has the running core load its config again in place: sing-box reloads on
+// SIGHUP, keeping the process, the tun device and the connections it can
+// carry over. Blocks until the reloaded instance answers on its Clash API,
+// which is the only way to tell it apart from the one it replaces.
+static gboolean reload_real_process(JumperSdkPlatformPlugin* self,
+                                    gchar** launch_args,
+                                    GCancellable* cancellable,
+                                    std::chrono::steady_clock::time_point started_at,
+                                    jumper_sdk_platform::ReadinessTimings* timings,
+                                    GError** error) {
+  jumper_sdk_platform::CoreConfig config;
+  read_launch_config(launch_args, &config);
+  if (self->real_controller == nullptr || !config.has_controller) {
+    g_set_error_literal(error, g_quark_from_static_string("jumper.core"), kCoreErrorNotReady,
+                        "Only a core with a Clash API can be reloaded in place");
+    return FALSE;
+  }
+  std::unique_ptr<jumper_sdk_platform::ConfigShape> shape(read_launch_shape(launch_args));
+  jumper_sdk_platform::TraceScope trace(self->trace, "reload", "core");
+  if (!jumper_sdk_platform::SignalProcess(self->real_pid, self->real_pidfd, SIGHUP)) {
+    g_set_error(error, g_quark_from_static_string("jumper.core"), kCoreErrorNotReady,
+                "Cannot signal the core: %s", g_strerror(errno));
+    return FALSE;
+  }
+  jumper_sdk_platform::ReadinessHooks hooks;
+  hooks.wait = [cancellable](int milliseconds) {
+    return wait_unless_cancelled(cancellable, milliseconds) == TRUE;
+  };
+  hooks.has_exited = [self](std::string* reason) {
+    return reap_exited_core(self, reason) == TRUE;
+  };
+  std::string ready_error;
+  const auto result = jumper_sdk_platform::WaitForClashApiHandover(
+      *self->real_controller, config.controller, started_at, kCoreReadyTimeoutMs, hooks,
+      timings, &ready_error);
+  trace.Close();
+  if (result != jumper_sdk_platform::ReadinessResult::kReady) {
+    if (result == jumper_sdk_platform::ReadinessResult::kCancelled) {
+      g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_CANCELLED, ready_error.c_str());
+    } else {
+      g_set_error_literal(error, g_quark_from_static_string("jumper.core"), kCoreErrorNotReady,
+                          ready_error.c_str());
+    }
+    return FALSE;
+  }
+  self->metrics->RecordMilliseconds(jumper_sdk_platform::kCorePhaseLatency, "reload",
+                                    timings->ready_ms);
+  *self->real_controller = config.controller;
+  set_real_config(self, shape.release());
+  save_core_record(self);
+  self->traffic_stream->SetEndpoint(config.controller);
+  self->connections->SetEndpoint(config.controller);
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(self->real_pid));
+  fl_value_set_string_take(payload, "readyMs", fl_value_new_float(timings->ready_ms));
+  post_core_event(self, "core_reloaded", payload);
+  return TRUE;
+}
+
+static gboolean parse_runtime_request(FlMethodCall* call,
+                                      gboolean require_base_path,
+                                      gchar** version,
+                                      gchar** platform_arch,
+                                      gchar** base_path,
+                                      GError** error) {
+  *version = nullptr;
+  *platform_arch = nullptr;
+  *base_path = nullptr;
+  FlValue* args = fl_method_call_get_args(call);
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    g_set_error(error, g_quark_from_static_string("jumper.runtime"), 1, "Missing arguments");
+    return FALSE;
+  }
+  FlValue* version_value = fl_value_lookup_string(args, "version");
+  FlValue* arch_value = fl_value_lookup_string(args, "platformArch");
+  FlValue* base_value = fl_value_lookup_string(args, "basePath");
+  if (version_value == nullptr || fl_value_get_type(version_value) != FL_VALUE_TYPE_STRING ||
+      strlen(fl_value_get_string(version_value)) == 0) {
+    g_set_error(error, g_quark_from_static_string("jumper.runtime"), 2, "Missing version");
+    return FALSE;
+  }
+  if (arch_value == nullptr || fl_value_get_type(arch_value) != FL_VALUE_TYPE_STRING ||
+      strlen(fl_value_get_string(arch_value)) == 0) {
+    g_set_error(
+        error, g_quark_from_static_string("jumper.runtime"), 3, "Missing platformArch");
+    return FALSE;
+  }
+  const gchar* base_text =
+      (base_value != nullptr && fl_value_get_type(base_value) == FL_VALUE_TYPE_STRING)
+          ? fl_value_get_string(base_value)
+          : "";
+  if (require_base_path && (base_text == nullptr || strlen(base_text) == 0)) {
+    g_set_error(error, g_quark_from_static_string("jumper.runtime"), 4, "Missing basePath");
+    return FALSE;
+  }
+  *version = g_strdup(fl_value_get_string(version_value));
+  *platform_arch = g_strdup(fl_value_get_string(arch_value));
+  *base_path = g_strdup(base_text == nullptr ? "" : base_text);
+  return TRUE;
+}
+
+static FlMethodResponse* core_failure_response(const gchar* code,
+                                               const gchar* message,
+                                               GError* error) {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      code, message, fl_value_new_string(error == nullptr ? "unknown" : error->message)));
+}
+
+static FlMethodResponse* core_started_response(
+    gint64 pid,
+    const jumper_sdk_platform::ReadinessTimings& timings,
+    gboolean probed) {
+  g_autoptr(FlValue) timing_map = fl_value_new_map();
+  fl_value_set_string_take(timing_map, "spawnMs", fl_value_new_float(timings.spawn_ms));
+  if (timings.first_byte_ms >= 0) {
+    fl_value_set_string_take(timing_map, "firstByteMs", fl_value_new_float(timings.first_byte_ms));
+  }
+  fl_value_set_string_take(timing_map, "readyMs", fl_value_new_float(timings.ready_ms));
+  fl_value_set_string_take(timing_map, "probeAttempts", fl_value_new_int(timings.probe_attempts));
+
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(pid));
+  fl_value_set_string_take(
+      payload, "readiness", fl_value_new_string(probed ? "clashApi" : "spawned"));
+  fl_value_set_string(payload, "timings", timing_map);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
+
+static FlMethodResponse* core_start_failure_response(GError* error, gboolean restart) {
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return restart ? core_failure_response(
+                         "RESTART_CORE_CANCELLED", "Core restart was cancelled by stopCore", error)
+                   : core_failure_response(
+                         "START_CORE_CANCELLED", "Core start was cancelled by stopCore", error);
+  }
+  if (g_error_matches(error, g_quark_from_static_string("jumper.core"), kCoreErrorPortInUse)) {
+    return core_failure_response(
+        "CORE_PORT_IN_USE", "A port required by the launch config is already bound", error);
+  }
+  if (g_error_matches(error, g_quark_from_static_string("jumper.core"), kCoreErrorIntegrity)) {
+    return core_failure_response(
+        "CORE_INTEGRITY_FAILED", "Runtime binary failed its integrity check", error);
+  }
+  if (g_error_matches(error, g_quark_from_static_string("jumper.core"), kCoreErrorConfigInvalid)) {
+    return core_failure_response(
+        "CORE_CONFIG_INVALID", "The launch config failed sing-box check", error);
+  }
+  if (g_error_matches(error, g_quark_from_static_string("jumper.core"), kCoreErrorNotReady)) {
+    return restart ? core_failure_response(
+                         "RESTART_CORE_FAILED", "Core restarted but failed readiness gate", error)
+                   : core_failure_response(
+                         "START_CORE_FAILED", "Core started but failed readiness gate", error);
+  }
+  return restart ? core_failure_response(
+                       "RESTART_CORE_FAILED", "Failed to restart core process", error)
+                 : core_failure_response("START_CORE_FAILED", "Failed to start core process", error);
+}
+
+// A start cancelled by stopCore ends stopped; any other failure is an error.
+static jumper_sdk_platform::CoreStatus start_failure_status(GError* error) {
+  return g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)
+             ? jumper_sdk_platform::CoreStatus::kStopped
+             : jumper_sdk_platform::CoreStatus::kError;
+}
+
+static gboolean launch_matches_running_core(JumperSdkPlatformPlugin* self,
+                                            const gchar* binary_path,
+                                            gchar** launch_args,
+                                            const gchar* working_dir,
+                                            gchar** environment);
+static FlMethodResponse* apply_launch_config(JumperSdkPlatformPlugin* self,
+                                             FlValue* args,
+                                             const gchar* binary_path,
+                                             gchar** launch_args,
+                                             const gchar* working_dir,
+                                             gchar** environment,
+                                             GCancellable* cancellable,
+                                             std::chrono::steady_clock::time_point started_at,
+                                             std::string* fallback_reason);
+
+static FlMethodResponse* handle_start_core(JumperSdkPlatformPlugin* self,
+                                           FlMethodCall* method_call,
+                                           GCancellable* cancellable) {
+  const auto started_at = std::chrono::steady_clock::now();
+  cancel_automatic_restart(self);
+  FlValue* args = fl_method_call_get_args(method_call);
+  gchar* binary_path = nullptr;
+  gchar** launch_args = nullptr;
+  gchar* working_dir = nullptr;
+  gchar** environment = nullptr;
+  const gboolean has_launch =
+      parse_launch_options(args, &binary_path, &launch_args, &working_dir, &environment);
+  const gchar* profile_id = "";
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* profile_value = fl_value_lookup_string(args, "profileId");
+    if (profile_value != nullptr && fl_value_get_type(profile_value) == FL_VALUE_TYPE_STRING) {
+      profile_id = fl_value_get_string(profile_value);
+    }
+  }
+  self->core_state->SetProfileId(profile_id);
+  update_network_mode(self, args);
+  if (!has_launch) {
+    transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "simulator", 0,
+                    "core is starting");
+    transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "simulator",
+                    g_get_real_time(), "core started");
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  set_scheduling(self, parse_scheduling_options(args));
+  self->go_runtime_profile = parse_go_runtime_profile(args);
+
+  FlMethodResponse* response = nullptr;
+  // The app asking again for the core it ran before its restart keeps the
+  // adopted one; only config changes are applied. An apply that is refused,
+  // fails or is cancelled goes through the normal start below instead, so
+  // the caller gets the start codes and the state machine sees the outcome.
+  const gboolean keep_adopted = self->keep_adopted_core;
+  self->keep_adopted_core = FALSE;
+  if (keep_adopted &&
+      launch_matches_running_core(self, binary_path, launch_args, working_dir, environment)) {
+    std::string fallback_reason;
+    response = apply_launch_config(self, args, binary_path, launch_args, working_dir,
+                                   environment, cancellable, started_at, &fallback_reason);
+    if (response != nullptr && !FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+      g_clear_object(&response);
+    }
+  }
+  if (response != nullptr) {
+    FlValue* result = FL_IS_METHOD_SUCCESS_RESPONSE(response)
+                          ? fl_method_success_response_get_result(
+                                FL_METHOD_SUCCESS_RESPONSE(response))
+                          : nullptr;
+    if (result != nullptr && fl_value_get_type(result) == FL_VALUE_TYPE_MAP) {
+      fl_value_set_string_take(result, "adopted", fl_value_new_bool(TRUE));
+    }
+    g_free(binary_path);
+    g_strfreev(launch_args);
+    g_free(working_dir);
+    g_strfreev(environment);
+    return response;
+  }
+
+  GError* spawn_error = nullptr;
+  jumper_sdk_platform::ReadinessTimings timings;
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "real", 0, "core is starting");
+  if (!start_real_process(self, binary_path, launch_args, working_dir, environment,
+                          stop_timeout_from_args(args), cancellable, started_at, &timings,
+                          &spawn_error)) {
+    transition_core(self, start_failure_status(spawn_error), "simulator", 0, spawn_error->message);
+    response = core_start_failure_response(spawn_error, FALSE);
+    g_clear_error(&spawn_error);
+  } else {
+    transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "real", self->real_pid,
+                    "core started");
+    response = core_started_response(self->real_pid, timings, timings.probe_attempts > 0);
+  }
+  g_free(binary_path);
+  g_strfreev(launch_args);
+  g_free(working_dir);
+  g_strfreev(environment);
+  return response;
+}
+
+static FlMethodResponse* handle_stop_core(JumperSdkPlatformPlugin* self,
+                                          FlMethodCall* method_call,
+                                          GCancellable* cancellable) {
+  cancel_automatic_restart(self);
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStopping, nullptr,
+                  self->core_state->Snapshot().pid, "core is stopping");
+  stop_real_process(self, stop_timeout_from_args(fl_method_call_get_args(method_call)));
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStopped, nullptr, 0, "core stopped");
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* handle_restart_core(JumperSdkPlatformPlugin* self,
+                                             FlMethodCall* method_call,
+                                             GCancellable* cancellable) {
+  const auto started_at = std::chrono::steady_clock::now();
+  cancel_automatic_restart(self);
+  FlValue* args = fl_method_call_get_args(method_call);
+  gchar* binary_path = nullptr;
+  gchar** launch_args = nullptr;
+  gchar* working_dir = nullptr;
+  gchar** environment = nullptr;
+  gboolean has_launch =
+      parse_launch_options(args, &binary_path, &launch_args, &working_dir, &environment);
+  update_network_mode(self, args);
+  if (has_launch) {
+    set_scheduling(self, parse_scheduling_options(args));
+    self->go_runtime_profile = parse_go_runtime_profile(args);
+  } else if (self->last_arguments != nullptr && self->last_binary_path != nullptr) {
+    has_launch = TRUE;
+    binary_path = g_strdup(self->last_binary_path);
+    launch_args = g_strdupv(self->last_arguments);
+    working_dir =
+        self->last_working_directory == nullptr ? nullptr : g_strdup(self->last_working_directory);
+    environment = g_strdupv(self->last_environment);
+  }
+  if (!has_launch) {
+    transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "simulator", 0,
+                    "core is restarting");
+    transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "simulator",
+                    g_get_real_time(), "core restarted");
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+
+  FlMethodResponse* response = nullptr;
+  GError* spawn_error = nullptr;
+  jumper_sdk_platform::ReadinessTimings timings;
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "real", 0,
+                  "core is restarting");
+  if (!start_real_process(self, binary_path, launch_args, working_dir, environment,
+                          stop_timeout_from_args(args), cancellable, started_at, &timings,
+                          &spawn_error)) {
+    transition_core(self, start_failure_status(spawn_error), "simulator", 0, spawn_error->message);
+    response = core_start_failure_response(spawn_error, TRUE);
+    g_clear_error(&spawn_error);
+  } else {
+    transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "real", self->real_pid,
+                    "core restarted");
+    response = core_started_response(self->real_pid, timings, timings.probe_attempts > 0);
+  }
+  g_free(binary_path);
+  g_strfreev(launch_args);
+  g_free(working_dir);
+  g_strfreev(environment);
+  return response;
+}
+
+// A reload re-reads the files the running core's command line names, so it
+// only applies when nothing else about the launch has changed.
+static gboolean launch_matches_running_core(JumperSdkPlatformPlugin* self,
+                                            const gchar* binary_path,
+                                            gchar** launch_args,
+                                            const gchar* working_dir,
+                                            gchar** environment) {
+  return self->has_real_process && self->last_arguments != nullptr &&
+         self->last_environment != nullptr && environment != nullptr &&
+         g_strcmp0(binary_path, self->last_binary_path) == 0 &&
+         g_strv_equal(launch_args, self->last_arguments) &&
+         g_strcmp0(working_dir, self->last_working_directory) == 0 &&
+         g_strv_equal(environment, self->last_environment);
+}
+
+// Marks a restartCore report with how reloadCore got there.
+static FlMethodResponse* tag_reload_response(FlMethodResponse* response,
+                                             const gchar* mode,
+                                             const gchar* fallback_reason) {
+  if (!FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+    return response;
+  }
+  FlValue* result = fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(response));
+  if (result != nullptr && fl_value_get_type(result) == FL_VALUE_TYPE_MAP) {
+    fl_value_set_string_take(result, "mode", fl_value_new_string(mode));
+    if (fallback_reason != nullptr) {
+      fl_value_set_string_take(result, "fallbackReason", fl_value_new_string(fallback_reason));
+    }
+  }
+  return response;
+}
+
+static FlValue* config_applied_payload(gint64 pid, double apply_ms, gsize changes) {
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(pid));
+  fl_value_set_string_take(payload, "applyMs", fl_value_new_float(apply_ms));
+  fl_value_set_string_take(payload, "changes", fl_value_new_int(static_cast<int64_t>(changes)));
+  return payload;
+}
+
+// Applies a change the planner found limited to selectors and the clash
+// mode. The core keeps running untouched and |shape| becomes the config it
+// runs with. Returns nullptr if any call failed.
+static FlMethodResponse* apply_config_through_api(
+    JumperSdkPlatformPlugin* self,
+    std::unique_ptr<jumper_sdk_platform::ConfigShape> shape,
+    const jumper_sdk_platform::ConfigPlan& plan,
+    std::chrono::steady_clock::time_point started_at,
+    std::string* error) {
+  if (!jumper_sdk_platform::ApplyClashApiCalls(*self->real_controller, plan.calls,
+                                               kConfigApiTimeoutMs, error)) {
+    return nullptr;
+  }
+  set_real_config(self, shape.release());
+  save_core_record(self);
+  const double apply_ms =
+      jumper_sdk_platform::MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+  post_core_event(self, "core_config_applied",
+                  config_applied_payload(self->real_pid, apply_ms, plan.calls.size()));
+  g_autoptr(FlValue) result = config_applied_payload(self->real_pid, apply_ms, plan.calls.size());
+  return tag_reload_response(FL_METHOD_RESPONSE(fl_method_success_response_new(result)),
+                             jumper_sdk_platform::ConfigPlanKindName(plan.kind), nullptr);
+}
+
+// Applies the config |launch_args| loads the cheapest way the planner
+// finds: selector and clash mode changes through the Clash API, other
+// changes to the config contents with a reload that keeps the core's
+// connections. A config that fails `sing-box check` is refused and the
+// running core is left alone; the API path skips the check, as the core
+// itself rejects an unknown outbound or mode. Returns nullptr, with the
+// reason, when only a restart will do.
+static FlMethodResponse* apply_launch_config(JumperSdkPlatformPlugin* self,
+                                             FlValue* args,
+                                             const gchar* binary_path,
+                                             gchar** launch_args,
+                                             const gchar* working_dir,
+                                             gchar** environment,
+                                             GCancellable* cancellable,
+                                             std::chrono::steady_clock::time_point started_at,
+                                             std::string* fallback_reason) {
+  jumper_sdk_platform::ConfigPlan plan;
+  if (self->has_real_process) {
+    const gboolean same_launch =
+        launch_matches_running_core(self, binary_path, launch_args, working_dir, environment);
+    std::unique_ptr<jumper_sdk_platform::ConfigShape> next(
+        same_launch ? read_launch_shape(launch_args) : nullptr);
+    plan = jumper_sdk_platform::PlanConfigChange(self->real_config, next.get(), same_launch,
+                                                 true);
+    if (plan.kind == jumper_sdk_platform::ConfigPlanKind::kApi &&
+        self->real_controller != nullptr) {
+      update_network_mode(self, args);
+      FlMethodResponse* response =
+          apply_config_through_api(self, std::move(next), plan, started_at, &plan.reason);
+      if (response != nullptr) {
+        return response;
+      }
+      // Some selector calls may already have gone through; the reload below
+      // re-reads the whole config, so it also repairs a partial apply.
+      plan.kind = jumper_sdk_platform::ConfigPlanKind::kReload;
+    }
+  }
+
+  GError* reload_error = nullptr;
+  const auto check_started_at = std::chrono::steady_clock::now();
+  jumper_sdk_platform::TraceScope check_trace(self->trace, "check", "core");
+  const gboolean checked =
+      check_core_config(binary_path, launch_args, working_dir, environment, &reload_error);
+  check_trace.Close();
+  self->metrics->Record(jumper_sdk_platform::kCorePhaseLatency, "check",
+                        jumper_sdk_platform::NanosecondsSince(check_started_at));
+  if (!checked) {
+    FlMethodResponse* response = core_start_failure_response(reload_error, TRUE);
+    g_clear_error(&reload_error);
+    return response;
+  }
+  if (!self->has_real_process) {
+    *fallback_reason = "No core is running";
+    return nullptr;
+  }
+  if (plan.kind == jumper_sdk_platform::ConfigPlanKind::kRestart) {
+    *fallback_reason = plan.reason;
+    return nullptr;
+  }
+  update_network_mode(self, args);
+  jumper_sdk_platform::ReadinessTimings timings;
+  FlMethodResponse* response = nullptr;
+  if (reload_real_process(self, launch_args, cancellable, started_at, &timings, &reload_error)) {
+    response = tag_reload_response(core_started_response(self->real_pid, timings, TRUE),
+                                   "reload", nullptr);
+  } else if (g_error_matches(reload_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    response = core_start_failure_response(reload_error, TRUE);
+  } else {
+    *fallback_reason = reload_error->message;
+  }
+  g_clear_error(&reload_error);
+  return response;
+}
+
+// Applies a new config without dropping the core's connections where it
+// can; anything else, or a step that does not come through, falls back to a
+// full restart.
+static FlMethodResponse* handle_reload_core(JumperSdkPlatformPlugin* self,
+                                            FlMethodCall* method_call,
+                                            GCancellable* cancellable) {
+  const auto started_at = std::chrono::steady_clock::now();
+  cancel_automatic_restart(self);
+  FlValue* args = fl_method_call_get_args(method_call);
+  gchar* binary_path = nullptr;
+  gchar** launch_args = nullptr;
+  gchar* working_dir = nullptr;
+  gchar** environment = nullptr;
+  gboolean has_launch =
+      parse_launch_options(args, &binary_path, &launch_args, &working_dir, &environment);
+  if (!has_launch && self->last_arguments != nullptr && self->last_binary_path != nullptr) {
+    has_launch = TRUE;
+    binary_path = g_strdup(self->last_binary_path);
+    launch_args = g_strdupv(self->last_arguments);
+    working_dir =
+        self->last_working_directory == nullptr ? nullptr : g_strdup(self->last_working_directory);
+    environment = g_strdupv(self->last_environment);
+  }
+
+  FlMethodResponse* response = nullptr;
+  std::string fallback_reason = "No launch options to reload";
+  if (has_launch) {
+    response = apply_launch_config(self, args, binary_path, launch_args, working_dir,
+                                   environment, cancellable, started_at, &fallback_reason);
+  }
+  g_free(binary_path);
+  g_strfreev(launch_args);
+  g_free(working_dir);
+  g_strfreev(environment);
+  if (response == nullptr) {
+    response = tag_reload_response(handle_restart_core(self, method_call, cancellable),
+                                   "restart", fallback_reason.c_str());
+  }
+  return response;
+}
+
+// Rebuilds the tun device. A real core reloads in place, which closes and
+// reopens its inbounds, and is restarted if that fails; the simulator has
+// nothing to reset.
+static FlMethodResponse* handle_reset_tunnel(JumperSdkPlatformPlugin* self,
+                                             FlMethodCall* method_call,
+                                             GCancellable* cancellable) {
+  if (!self->has_real_process || self->last_arguments == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  const auto started_at = std::chrono::steady_clock::now();
+  cancel_automatic_restart(self);
+  jumper_sdk_platform::ReadinessTimings timings;
+  GError* reload_error = nullptr;
+  if (reload_real_process(self, self->last_arguments, cancellable, started_at, &timings,
+                          &reload_error)) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  if (g_error_matches(reload_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    FlMethodResponse* response = core_start_failure_response(reload_error, TRUE);
+    g_clear_error(&reload_error);
+    return response;
+  }
+  g_clear_error(&reload_error);
+  return handle_restart_core(self, method_call, cancellable);
+}
+
+static FlMethodResponse* handle_setup_runtime(JumperSdkPlatformPlugin* self,
+                                              FlMethodCall* method_call,
+                                              GCancellable* cancellable) {
+  g_autofree gchar* version = nullptr;
+  g_autofree gchar* platform_arch = nullptr;
+  g_autofree gchar* base_path = nullptr;
+  GError* runtime_error = nullptr;
+  if (!parse_runtime_request(method_call, TRUE, &version, &platform_arch, &base_path, &runtime_error)) {
+    FlMethodResponse* response = core_failure_response(
+        "SETUP_RUNTIME_FAILED", "Failed to setup runtime in container", runtime_error);
+    g_clear_error(&runtime_error);
+    return response;
+  }
+
+  g_autofree gchar* runtime_root = runtime_container_root();
+  g_autofree gchar* source_binary = g_strdup_printf(
+      "%s/engine/runtime-assets/%s/sing-box-%s-%s/sing-box",
+      base_path, platform_arch, version, platform_arch);
+  g_autofree gchar* source_config = g_strdup_printf(
+      "%s/engine/runtime-assets/%s/minimal-config.json",
+      base_path, platform_arch);
+  g_autofree gchar* checksums_path =
+      g_strdup_printf("%s/engine/runtime-assets/checksums.json", base_path);
+
+  // Assets without a checksums.json install unverified; a listed checksum
+  // that does not match fails the setup.
+  std::string expected_sha256;
+  jumper_sdk_platform::ReadRuntimeChecksum(checksums_path, platform_arch, version,
+                                           &expected_sha256, nullptr);
+
+  // Runs at every app launch: when the version is already installed this is
+  // a few stat calls and a link flip.
+  jumper_sdk_platform::RuntimeStore store(runtime_root, "sing-box");
+  jumper_sdk_platform::RuntimeInstallResult install;
+  std::string install_error;
+  jumper_sdk_platform::TraceScope install_trace(self->trace, "install_runtime", "runtime");
+  const bool installed = store.Install(version, platform_arch, source_binary, source_config,
+                                       expected_sha256, &install, &install_error);
+  install_trace.Close();
+  if (!installed) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "SETUP_RUNTIME_FAILED",
+        "Failed to setup runtime in container",
+        fl_value_new_string(install_error.c_str())));
+  }
+
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "installed", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(payload, "binaryPath",
+                           fl_value_new_string(store.CurrentBinaryPath().c_str()));
+  fl_value_set_string_take(payload, "configPath",
+                           fl_value_new_string(store.CurrentConfigPath().c_str()));
+  fl_value_set_string_take(payload, "runtimeRoot", fl_value_new_string(runtime_root));
+  fl_value_set_string_take(payload, "runtimeId",
+                           fl_value_new_string(install.version.id.c_str()));
+  fl_value_set_string_take(payload, "reused", fl_value_new_bool(install.reused));
+  fl_value_set_string_take(payload, "integrityVerified",
+                           fl_value_new_bool(install.integrity_verified));
+  fl_value_set_string_take(payload, "sha256", fl_value_new_string(install.version.sha256.c_str()));
+  fl_value_set_string_take(
+      payload, "binaryInstall",
+      fl_value_new_string(jumper_sdk_platform::InstallMethodName(install.binary_install)));
+  fl_value_set_string_take(
+      payload, "configInstall",
+      fl_value_new_string(jumper_sdk_platform::InstallMethodName(install.config_install)));
+  FlValue* collected = fl_value_new_list();
+  for (const std::string& id : install.collected) {
+    fl_value_append_take(collected, fl_value_new_string(id.c_str()));
+  }
+  fl_value_set_string_take(payload, "collectedVersions", collected);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
+
+static FlValue* runtime_versions_value(const jumper_sdk_platform::RuntimeIndex& index) {
+  FlValue* versions = fl_value_new_list();
+  for (const jumper_sdk_platform::RuntimeVersion& entry : index.versions) {
+    FlValue* item = fl_value_new_map();
+    fl_value_set_string_take(item, "id", fl_value_new_string(entry.id.c_str()));
+    fl_value_set_string_take(item, "version", fl_value_new_string(entry.version.c_str()));
+    fl_value_set_string_take(item, "platformArch",
+                             fl_value_new_string(entry.platform_arch.c_str()));
+    fl_value_set_string_take(item, "bytes", fl_value_new_int(static_cast<int64_t>(entry.bytes)));
+    fl_value_set_string_take(item, "lastUsedMs", fl_value_new_int(entry.last_used_ms));
+    fl_value_set_string_take(item, "current", fl_value_new_bool(entry.id == index.current));
+    fl_value_append_take(versions, item);
+  }
+  return versions;
+}
+
+static FlMethodResponse* handle_inspect_runtime(JumperSdkPlatformPlugin* self,
+                                                FlMethodCall* method_call,
+                                                GCancellable* cancellable) {
+  g_autofree gchar* version = nullptr;
+  g_autofree gchar* platform_arch = nullptr;
+  g_autofree gchar* base_path = nullptr;
+  GError* runtime_error = nullptr;
+  if (!parse_runtime_request(method_call, FALSE, &version, &platform_arch, &base_path, &runtime_error)) {
+    FlMethodResponse* response = core_failure_response(
+        "INSPECT_RUNTIME_FAILED", "Failed to inspect runtime", runtime_error);
+    g_clear_error(&runtime_error);
+    return response;
+  }
+
+  // Answered from the index; only the current version's files are stat'ed.
+  g_autofree gchar* runtime_root = runtime_container_root();
+  jumper_sdk_platform::RuntimeStore store(runtime_root, "sing-box");
+  const jumper_sdk_platform::RuntimeIndex index = store.LoadIndex();
+  const jumper_sdk_platform::RuntimeVersion* current = index.Find(index.current);
+  const std::string binary_path = store.CurrentBinaryPath();
+  const std::string config_path = store.CurrentConfigPath();
+  gboolean binary_exists = g_file_test(binary_path.c_str(), G_FILE_TEST_EXISTS);
+  gboolean config_exists = g_file_test(config_path.c_str(), G_FILE_TEST_EXISTS);
+  const gchar* runtime_version = current != nullptr ? current->version.c_str() : "";
+  gboolean version_matches = g_strcmp0(runtime_version, version) == 0;
+  // Served from the digest cache unless the binary changed since install.
+  gboolean integrity_verified = current != nullptr && !current->expected_sha256.empty() &&
+                                current->sha256 == current->expected_sha256 &&
+                                store.IsIntact(*current);
+
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  fl_value_set_string_take(
+      payload, "ready", fl_value_new_bool(binary_exists && config_exists && version_matches));
+  fl_value_set_string_take(payload, "binaryPath", fl_value_new_string(binary_path.c_str()));
+  fl_value_set_string_take(payload, "configPath", fl_value_new_string(config_path.c_str()));
+  fl_value_set_string_take(payload, "binaryExists", fl_value_new_bool(binary_exists));
+  fl_value_set_string_take(payload, "configExists", fl_value_new_bool(config_exists));
+  fl_value_set_string_take(payload, "runtimeVersion", fl_value_new_string(runtime_version));
+  fl_value_set_string_take(payload, "runtimeId", fl_value_new_string(index.current.c_str()));
+  fl_value_set_string_take(payload, "expectedVersion", fl_value_new_string(version));
+  fl_value_set_string_take(payload, "versionMatches", fl_value_new_bool(version_matches));
+  fl_value_set_string_take(payload, "integrityVerified", fl_value_new_bool(integrity_verified));
+  fl_value_set_string_take(
+      payload, "versionInstalled",
+      fl_value_new_bool(index.FindVersion(version, platform_arch) != nullptr));
+  fl_value_set_string_take(payload, "previousRuntimeId",
+                           fl_value_new_string(index.previous.c_str()));
+  fl_value_set_string_take(payload, "installedVersions", runtime_versions_value(index));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
+
+static FlMethodResponse* handle_rollback_runtime(JumperSdkPlatformPlugin* self,
+                                                 FlMethodCall* method_call,
+                                                 GCancellable* cancellable) {
+  g_autofree gchar* runtime_root = runtime_container_root();
+  jumper_sdk_platform::RuntimeStore store(runtime_root, "sing-box");
+  jumper_sdk_platform::RuntimeVersion current;
+  std::string rollback_error;
+  if (!store.Rollback(&current, &rollback_error)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "ROLLBACK_RUNTIME_FAILED",
+        "Failed to roll back runtime",
+        fl_value_new_string(rollback_error.c_str())));
+  }
+
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "rolledBack", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(payload, "runtimeId", fl_value_new_string(current.id.c_str()));
+  fl_value_set_string_take(payload, "runtimeVersion",
+                           fl_value_new_string(current.version.c_str()));
+  fl_value_set_string_take(payload, "platformArch",
+                           fl_value_new_string(current.platform_arch.c_str()));
+  fl_value_set_string_take(payload, "binaryPath",
+                           fl_value_new_string(store.CurrentBinaryPath().c_str()));
+  fl_value_set_string_take(payload, "configPath",
+                           fl_value_new_string(store.CurrentConfigPath().c_str()));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
+
+static gboolean method_task_respond(gpointer user_data) {
+  MethodTask* task = static_cast<MethodTask*>(user_data);
+  if (task->method_call == nullptr) {
+    return G_SOURCE_REMOVE;
+  }
+  // Encoding a large reply is work on the main thread too.
+  jumper_sdk_platform::StallWatchdogScope stall_scope(task->plugin->stalls,
+                                                      fl_method_call_get_name(task->method_call));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(task->method_call, task->response, &error)) {
+    g_warning("Failed to send method call response: %s", error->message);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static void method_task_free(gpointer user_data) {
+  MethodTask* task = static_cast<MethodTask*>(user_data);
+  g_mutex_lock(&task->plugin->state_mutex);
+  g_ptr_array_remove(task->plugin->pending_starts, task->cancellable);
+  g_mutex_unlock(&task->plugin->state_mutex);
+  g_clear_object(&task->response);
+  g_object_unref(task->cancellable);
+  g_clear_object(&task->method_call);
+  g_object_unref(task->plugin);
+  g_free(task);
+}
+
+// A task handed to the main loop from another thread, e.g. a watchdog
+// heartbeat.
+static gboolean run_main_thread_task(gpointer user_data) {
+  (*static_cast<std::function<void()>*>(user_data))();
+  return G_SOURCE_REMOVE;
+}
+
+static void free_main_thread_task(gpointer user_data) {
+  delete static_cast<std::function<void()>*>(user_data);
+}
+
+static void method_task_run(gpointer data, gpointer user_data) {
+  MethodTask* task = static_cast<MethodTask*>(data);
+  const gint64 started_at_ns = monotonic_ns();
+  if (task->queue_latency != nullptr) {
+    task->queue_latency->Record(started_at_ns - task->queued_at_ns);
+  }
+  const gchar* method =
+      task->method_call == nullptr ? "plugin_task" : fl_method_call_get_name(task->method_call);
+  jumper_sdk_platform::TraceRecorder* trace = task->plugin->trace;
+  trace->Complete(method, "queue", task->queued_at_ns, started_at_ns);
+  jumper_sdk_platform::TraceScope method_trace(trace, method, "method");
+  task->response = task->handler(task->plugin, task->method_call, task->cancellable);
+  method_trace.Close();
+  if (task->latency != nullptr) {
+    task->latency->Record(monotonic_ns() - started_at_ns);
+  }
+  g_main_context_invoke_full(
+      nullptr, G_PRIORITY_DEFAULT, method_task_respond, task, method_task_free);
+}
+
+// Hands a method call to a worker lane. The call holds a reference on the
+// plugin until its response has been delivered on the platform thread.
+// Work the plugin queues for itself passes no |method_call|; its handler
+// returns nullptr and nothing is sent back.
+static void dispatch_method_call(JumperSdkPlatformPlugin* self,
+                                 GThreadPool* pool,
+                                 FlMethodCall* method_call,
+                                 MethodHandler handler,
+                                 gboolean cancelled_by_stop) {
+  MethodTask* task = g_new0(MethodTask, 1);
+  task->plugin = JUMPER_SDK_PLATFORM_PLUGIN(g_object_ref(self));
+  task->method_call =
+      method_call == nullptr ? nullptr : FL_METHOD_CALL(g_object_ref(method_call));
+  task->handler = handler;
+  task->cancellable = g_cancellable_new();
+  if (method_call != nullptr) {
+    const gchar* method = fl_method_call_get_name(method_call);
+    task->queue_latency = self->metrics->Find(jumper_sdk_platform::kMethodQueueLatency, method);
+    task->latency = self->metrics->Find(jumper_sdk_platform::kMethodLatency, method);
+  }
+  task->queued_at_ns = monotonic_ns();
+  if (cancelled_by_stop) {
+    g_mutex_lock(&self->state_mutex);
+    g_ptr_array_add(self->pending_starts, g_object_ref(task->cancellable));
+    g_mutex_unlock(&self->state_mutex);
+  }
+  GError* error = nullptr;
+  if (!g_thread_pool_push(pool, task, &error)) {
+    task->response = core_failure_response(
+        "PLUGIN_EXECUTOR_FAILED", "Failed to schedule method call", error);
+    g_clear_error(&error);
+    method_task_respond(task);
+    method_task_free(task);
+  }
+}
+
+static void cancel_pending_starts(JumperSdkPlatformPlugin* self) {
+  g_mutex_lock(&self->state_mutex);
+  for (guint i = 0; i < self->pending_starts->len; ++i) {
+    g_cancellable_cancel(G_CANCELLABLE(g_ptr_array_index(self->pending_starts, i)));
+  }
+  g_mutex_unlock(&self->state_mutex);
+}
+
+static FlValue* kernel_log_lines_value(const std::vector<jumper_sdk_platform::KernelLogLine>& lines) {
+  FlValue* list = fl_value_new_list();
+  for (const auto& line : lines) {
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "seq", fl_value_new_int(static_cast<int64_t>(line.seq)));
+    fl_value_set_string_take(entry, "level",
+                             fl_value_new_string(jumper_sdk_platform::KernelLogLevelName(line.level)));
+    fl_value_set_string_take(entry, "message", fl_value_new_string(line.message.c_str()));
+    fl_value_set_string_take(entry, "timestampMs", fl_value_new_int(line.timestamp_ms));
+    fl_value_append_take(list, entry);
+  }
+  return list;
+}
+
+// Sends the lines captured since the last tick as one event. Quiet ticks send
+// nothing.
+static gboolean flush_kernel_logs(gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  const auto lines = self->kernel_logs->TakeUndelivered(kLogBatchMaxLines);
+  const guint64 dropped = self->kernel_logs->dropped();
+  if (lines.empty() && dropped == self->kernel_logs_reported_dropped) {
+    return G_SOURCE_CONTINUE;
+  }
+  self->kernel_logs_reported_dropped = dropped;
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string("kernel_log_batch"));
+  fl_value_set_string_take(event, "lines", kernel_log_lines_value(lines));
+  fl_value_set_string_take(event, "dropped", fl_value_new_int(static_cast<int64_t>(dropped)));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(self->kernel_logs_channel, event, nullptr, &error)) {
+    g_warning("Failed to send kernel log batch: %s", error->message);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// The stream carries lines captured after the listener attached; earlier
+// ones are available through getRecentLogs.
+static FlMethodErrorResponse* kernel_logs_listen_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  self->kernel_logs->SkipUndelivered();
+  self->kernel_logs_reported_dropped = self->kernel_logs->dropped();
+  if (self->kernel_logs_flush_source == 0) {
+    self->kernel_logs_flush_source = g_timeout_add(kLogBatchIntervalMs, flush_kernel_logs, self);
+  }
+  return nullptr;
+}
+
+static FlMethodErrorResponse* kernel_logs_cancel_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  if (self->kernel_logs_flush_source != 0) {
+    g_source_remove(self->kernel_logs_flush_source);
+    self->kernel_logs_flush_source = 0;
+  }
+  return nullptr;
+}
+
+// Which of the plugin's event channels a queued event goes to. The channel
+// is looked up on the platform thread, where it may already have been
+// cleared by dispose.
+typedef FlEventChannel* JumperSdkPlatformPlugin::*EventChannelField;
+
+typedef struct {
+  JumperSdkPlatformPlugin* plugin;
+  EventChannelField channel;
+  FlValue* event;
+} EventFrame;
+
+static gboolean send_event_frame(gpointer user_data) {
+  EventFrame* frame = static_cast<EventFrame*>(user_data);
+  FlEventChannel* channel = frame->plugin->*frame->channel;
+  if (channel != nullptr) {
+    fl_event_channel_send(channel, frame->event, nullptr, nullptr);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static void event_frame_free(gpointer user_data) {
+  EventFrame* frame = static_cast<EventFrame*>(user_data);
+  g_object_unref(frame->plugin);
+  fl_value_unref(frame->event);
+  g_free(frame);
+}
+
+// Queues |event| for |channel| from a background thread. Takes ownership of
+// |event|.
+static void post_event(JumperSdkPlatformPlugin* self, EventChannelField channel, FlValue* event) {
+  EventFrame* frame = g_new0(EventFrame, 1);
+  frame->plugin = JUMPER_SDK_PLATFORM_PLUGIN(g_object_ref(self));
+  frame->channel = channel;
+  frame->event = event;
+  g_idle_add_full(G_PRIORITY_DEFAULT, send_event_frame, frame, event_frame_free);
+}
 
-// Called when a method call is received from Flutter.
-static void jumper_sdk_platform_plugin_handle_method_call(
-    JumperSdkPlatformPlugin* self,
-    FlMethodCall* method_call) {
-  g_autoptr(FlMethodResponse) response = nullptr;
+static FlValue* core_state_value(const jumper_sdk_platform::CoreStateSnapshot& state) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "status",
+                           fl_value_new_string(jumper_sdk_platform::CoreStatusName(state.status)));
+  fl_value_set_string_take(value, "runtimeMode", fl_value_new_string(state.runtime_mode.c_str()));
+  fl_value_set_string_take(value, "networkMode", fl_value_new_string(state.network_mode.c_str()));
+  if (state.pid > 0) {
+    fl_value_set_string_take(value, "pid", fl_value_new_int(state.pid));
+  }
+  if (!state.profile_id.empty()) {
+    fl_value_set_string_take(value, "profileId", fl_value_new_string(state.profile_id.c_str()));
+  }
+  fl_value_set_string_take(value, "version",
+                           fl_value_new_int(static_cast<int64_t>(state.version)));
+  return value;
+}
 
-  const gchar* method = fl_method_call_get_name(method_call);
+static FlValue* cpu_list_value(const std::vector<int>& cpus) {
+  FlValue* list = fl_value_new_list();
+  for (int cpu : cpus) {
+    fl_value_append_take(list, fl_value_new_int(cpu));
+  }
+  return list;
+}
 
-  auto stop_real_process = [&]() {
-    if (!self->has_real_process) {
-      return;
-    }
-    if (self->real_pid > 0) {
-      kill(self->real_pid, SIGTERM);
-      g_spawn_close_pid(self->real_pid);
+// What the running core was asked to run with, under `requested`, and what
+// it ran with once that was applied, as captured at start or adoption. Null
+// once the core is gone.
+static FlValue* core_scheduling_value(JumperSdkPlatformPlugin* self) {
+  g_mutex_lock(&self->state_mutex);
+  if (self->real_scheduling == nullptr) {
+    g_mutex_unlock(&self->state_mutex);
+    return nullptr;
+  }
+  const jumper_sdk_platform::ProcessSchedulingState state = *self->real_scheduling;
+  const jumper_sdk_platform::CoreSchedulingOptions options = *self->scheduling;
+  const jumper_sdk_platform::CgroupPlacement placement = *self->real_cgroup;
+  g_mutex_unlock(&self->state_mutex);
+
+  FlValue* requested = fl_value_new_map();
+  if (options.process.has_nice) {
+    fl_value_set_string_take(requested, "nice", fl_value_new_int(options.process.nice));
+  }
+  if (options.process.io_class > 0) {
+    fl_value_set_string_take(
+        requested, "ioClass",
+        fl_value_new_string(jumper_sdk_platform::IoClassName(options.process.io_class)));
+    fl_value_set_string_take(requested, "ioLevel", fl_value_new_int(options.process.io_level));
+  }
+  if (!options.process.cpus.empty()) {
+    fl_value_set_string_take(requested, "cpuAffinity", cpu_list_value(options.process.cpus));
+  }
+  if (options.has_startup_nice) {
+    fl_value_set_string_take(requested, "startupNice", fl_value_new_int(options.startup_nice));
+  }
+  if (options.cpu_weight > 0) {
+    fl_value_set_string_take(requested, "cpuWeight", fl_value_new_int(options.cpu_weight));
+  }
+  if (options.memory_high_bytes > 0) {
+    fl_value_set_string_take(requested, "memoryHighBytes",
+                             fl_value_new_int(static_cast<int64_t>(options.memory_high_bytes)));
+  }
+
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "requested", requested);
+  fl_value_set_string_take(value, "nice", fl_value_new_int(state.nice));
+  if (state.io_class >= 0) {
+    fl_value_set_string_take(
+        value, "ioClass", fl_value_new_string(jumper_sdk_platform::IoClassName(state.io_class)));
+    fl_value_set_string_take(value, "ioLevel", fl_value_new_int(state.io_level));
+  }
+  fl_value_set_string_take(value, "cpuAffinity", cpu_list_value(state.cpus));
+  fl_value_set_string_take(value, "cgroup", fl_value_new_string(state.cgroup.c_str()));
+  fl_value_set_string_take(
+      value, "placement",
+      fl_value_new_string(jumper_sdk_platform::CgroupPlacementName(placement.kind)));
+  if (!placement.error.empty()) {
+    fl_value_set_string_take(value, "placementError",
+                             fl_value_new_string(placement.error.c_str()));
+  }
+  if (state.cpu_weight >= 0) {
+    fl_value_set_string_take(value, "cpuWeight", fl_value_new_int(state.cpu_weight));
+  }
+  if (state.memory_high_bytes >= 0) {
+    fl_value_set_string_take(value, "memoryHighBytes", fl_value_new_int(state.memory_high_bytes));
+  }
+  return value;
+}
+
+// The profile and the Go runtime variables the running core was started
+// with, and the resources they were derived from. Null for an adopted core.
+static FlValue* core_go_runtime_value(JumperSdkPlatformPlugin* self) {
+  g_mutex_lock(&self->state_mutex);
+  const gboolean tuned = self->real_go_runtime != nullptr;
+  const jumper_sdk_platform::GoRuntimeTuning tuning =
+      tuned ? *self->real_go_runtime : jumper_sdk_platform::GoRuntimeTuning();
+  g_mutex_unlock(&self->state_mutex);
+  if (!tuned) {
+    return nullptr;
+  }
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, "profile",
+      fl_value_new_string(jumper_sdk_platform::GoRuntimeProfileName(tuning.profile)));
+  for (const auto& [key, setting] : tuning.environment) {
+    fl_value_set_string_take(value, key.c_str(), fl_value_new_string(setting.c_str()));
+  }
+  fl_value_set_string_take(value, "cpus", fl_value_new_int(tuning.resources.cpus));
+  if (tuning.resources.cpu_quota > 0) {
+    fl_value_set_string_take(value, "cpuQuota", fl_value_new_float(tuning.resources.cpu_quota));
+  }
+  fl_value_set_string_take(value, "memoryBytes",
+                           fl_value_new_int(static_cast<int64_t>(tuning.resources.memory_bytes)));
+  if (tuning.resources.memory_limit_bytes > 0) {
+    fl_value_set_string_take(
+        value, "memoryLimitBytes",
+        fl_value_new_int(static_cast<int64_t>(tuning.resources.memory_limit_bytes)));
+  }
+  return value;
+}
+
+// count, sumMs, maxMs and percentiles of one histogram.
+static FlValue* latency_snapshot_value(const jumper_sdk_platform::LatencySnapshot& snapshot) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "count", fl_value_new_int(static_cast<int64_t>(snapshot.count)));
+  fl_value_set_string_take(value, "sumMs", fl_value_new_float(snapshot.sum_ns / 1e6));
+  fl_value_set_string_take(value, "maxMs", fl_value_new_float(snapshot.max_ns / 1e6));
+  const struct {
+    const gchar* key;
+    double quantile;
+  } percentiles[] = {{"p50Ms", 0.5}, {"p90Ms", 0.9}, {"p99Ms", 0.99}, {"p999Ms", 0.999}};
+  for (const auto& percentile : percentiles) {
+    fl_value_set_string_take(
+        value, percentile.key,
+        fl_value_new_float(snapshot.ValueAtQuantile(percentile.quantile) / 1e6));
+  }
+  return value;
+}
+
+// Runtime lane. Returns every histogram as {methods, queueWaits, phases},
+// each keyed by method or phase. With `textfilePath`, the same histograms
+// are written there as OpenMetrics text for node_exporter's textfile
+// collector; a failed write is reported as `textfileError`.
+static FlMethodResponse* handle_get_plugin_metrics(JumperSdkPlatformPlugin* self,
+                                                   FlMethodCall* method_call,
+                                                   GCancellable* cancellable) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "textfilePath")
+                            : nullptr;
+  const std::vector<jumper_sdk_platform::LatencySeries> series = self->metrics->Snapshot();
+
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  for (const jumper_sdk_platform::LatencyFamily* family :
+       {&jumper_sdk_platform::kMethodLatency, &jumper_sdk_platform::kMethodQueueLatency,
+        &jumper_sdk_platform::kCorePhaseLatency}) {
+    fl_value_set_string_take(payload, family->key, fl_value_new_map());
+  }
+  for (const auto& entry : series) {
+    fl_value_set_string_take(fl_value_lookup_string(payload, entry.family->key),
+                             entry.label_value.c_str(), latency_snapshot_value(entry.snapshot));
+  }
+  if (path_value != nullptr && fl_value_get_type(path_value) == FL_VALUE_TYPE_STRING) {
+    const gchar* path = fl_value_get_string(path_value);
+    bool changed = false;
+    std::string error;
+    fl_value_set_string_take(payload, "textfilePath", fl_value_new_string(path));
+    // Written whole and renamed into place: the collector never reads half
+    // a file.
+    if (!jumper_sdk_platform::InstallTextFile(
+            path, jumper_sdk_platform::FormatOpenMetrics(series), &changed, &error)) {
+      fl_value_set_string_take(payload, "textfileError", fl_value_new_string(error.c_str()));
     }
-    self->real_pid = 0;
-    self->has_real_process = FALSE;
-  };
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
 
-  auto parse_launch_options =
-      [&](FlValue* args, gchar** binary_path, gchar*** launch_args, gchar** working_dir) -> gboolean {
-        *binary_path = nullptr;
-        *launch_args = nullptr;
-        *working_dir = nullptr;
-        if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
-          return FALSE;
-        }
-        FlValue* launch = fl_value_lookup_string(args, "launchOptions");
-        if (launch == nullptr || fl_value_get_type(launch) != FL_VALUE_TYPE_MAP) {
-          return FALSE;
-        }
-        FlValue* binary = fl_value_lookup_string(launch, "binaryPath");
-        if (binary == nullptr || fl_value_get_type(binary) != FL_VALUE_TYPE_STRING) {
-          return FALSE;
-        }
-        const gchar* binary_text = fl_value_get_string(binary);
-        if (binary_text == nullptr || strlen(binary_text) == 0) {
-          return FALSE;
-        }
-        *binary_path = g_strdup(binary_text);
-
-        FlValue* arg_values = fl_value_lookup_string(launch, "arguments");
-        GPtrArray* ptr_array = g_ptr_array_new_with_free_func(g_free);
-        g_ptr_array_add(ptr_array, g_strdup(binary_text));
-        if (arg_values != nullptr && fl_value_get_type(arg_values) == FL_VALUE_TYPE_LIST) {
-          const size_t count = fl_value_get_length(arg_values);
-          for (size_t i = 0; i < count; ++i) {
-            FlValue* entry = fl_value_get_list_value(arg_values, i);
-            if (entry != nullptr && fl_value_get_type(entry) == FL_VALUE_TYPE_STRING) {
-              g_ptr_array_add(ptr_array, g_strdup(fl_value_get_string(entry)));
-            }
-          }
-        }
-        g_ptr_array_add(ptr_array, nullptr);
-        *launch_args = reinterpret_cast<gchar**>(g_ptr_array_free(ptr_array, FALSE));
-
-        FlValue* wd = fl_value_lookup_string(launch, "workingDirectory");
-        if (wd != nullptr && fl_value_get_type(wd) == FL_VALUE_TYPE_STRING) {
-          const gchar* wd_text = fl_value_get_string(wd);
-          if (wd_text != nullptr && strlen(wd_text) > 0) {
-            *working_dir = g_strdup(wd_text);
-          }
-        }
-        return TRUE;
-      };
-
-  auto start_real_process = [&](gchar* binary_path, gchar** launch_args, gchar* working_dir,
-                                GError** error) -> gboolean {
-    stop_real_process();
-    GPid pid = 0;
-    const gboolean started = g_spawn_async(
-        working_dir,
-        launch_args,
-        nullptr,
-        static_cast<GSpawnFlags>(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
-        nullptr,
-        nullptr,
-        &pid,
-        error);
-    if (!started) {
-      return FALSE;
+// What the stall watchdog saw: every heartbeat's delay, the stalls over
+// its threshold with the handler that caused each one, and the worst
+// handler stall.
+static FlValue* main_thread_stalls_value(const jumper_sdk_platform::StallReport& report) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "thresholdMs", fl_value_new_int(report.options.threshold_ms));
+  fl_value_set_string_take(value, "heartbeatIntervalMs",
+                           fl_value_new_int(report.options.heartbeat_interval_ms));
+  fl_value_set_string_take(value, "heartbeats",
+                           fl_value_new_int(static_cast<int64_t>(report.heartbeats)));
+  fl_value_set_string_take(value, "heartbeatLatency",
+                           latency_snapshot_value(report.heartbeat_latency));
+  fl_value_set_string_take(value, "stallDurations", latency_snapshot_value(report.stall_durations));
+  FlValue* stalls = fl_value_new_list();
+  for (const jumper_sdk_platform::StallRecord& record : report.stalls) {
+    FlValue* item = fl_value_new_map();
+    if (!record.method.empty()) {
+      fl_value_set_string_take(item, "method", fl_value_new_string(record.method.c_str()));
     }
-    self->real_pid = pid;
-    self->has_real_process = TRUE;
-    self->pid = pid;
-    g_clear_pointer(&self->last_binary_path, g_free);
-    self->last_binary_path = g_strdup(binary_path);
-    g_strfreev(self->last_arguments);
-    self->last_arguments = g_strdupv(launch_args);
-    g_clear_pointer(&self->last_working_directory, g_free);
-    self->last_working_directory = working_dir == nullptr ? nullptr : g_strdup(working_dir);
-    return TRUE;
-  };
+    fl_value_set_string_take(item, "pluginAttributed", fl_value_new_bool(!record.method.empty()));
+    fl_value_set_string_take(item, "durationMs", fl_value_new_float(record.duration_ms));
+    fl_value_set_string_take(item, "timestampMs", fl_value_new_int(record.timestamp_ms));
+    fl_value_append_take(stalls, item);
+  }
+  fl_value_set_string_take(value, "stalls", stalls);
+  fl_value_set_string_take(value, "dropped",
+                           fl_value_new_int(static_cast<int64_t>(report.dropped)));
+  fl_value_set_string_take(value, "worstMethodStallMs",
+                           fl_value_new_float(report.worst_method_stall_ms));
+  return value;
+}
 
-  auto parse_runtime_request =
-      [&](FlMethodCall* call, gboolean require_base_path, gchar** version, gchar** platform_arch,
-          gchar** base_path, GError** error) -> gboolean {
-        *version = nullptr;
-        *platform_arch = nullptr;
-        *base_path = nullptr;
-        FlValue* args = fl_method_call_get_args(call);
-        if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
-          g_set_error(error, g_quark_from_static_string("jumper.runtime"), 1, "Missing arguments");
-          return FALSE;
-        }
-        FlValue* version_value = fl_value_lookup_string(args, "version");
-        FlValue* arch_value = fl_value_lookup_string(args, "platformArch");
-        FlValue* base_value = fl_value_lookup_string(args, "basePath");
-        if (version_value == nullptr || fl_value_get_type(version_value) != FL_VALUE_TYPE_STRING ||
-            strlen(fl_value_get_string(version_value)) == 0) {
-          g_set_error(error, g_quark_from_static_string("jumper.runtime"), 2, "Missing version");
-          return FALSE;
-        }
-        if (arch_value == nullptr || fl_value_get_type(arch_value) != FL_VALUE_TYPE_STRING ||
-            strlen(fl_value_get_string(arch_value)) == 0) {
-          g_set_error(
-              error, g_quark_from_static_string("jumper.runtime"), 3, "Missing platformArch");
-          return FALSE;
-        }
-        const gchar* base_text =
-            (base_value != nullptr && fl_value_get_type(base_value) == FL_VALUE_TYPE_STRING)
-                ? fl_value_get_string(base_value)
-                : "";
-        if (require_base_path && (base_text == nullptr || strlen(base_text) == 0)) {
-          g_set_error(error, g_quark_from_static_string("jumper.runtime"), 4, "Missing basePath");
-          return FALSE;
-        }
-        *version = g_strdup(fl_value_get_string(version_value));
-        *platform_arch = g_strdup(fl_value_get_string(arch_value));
-        *base_path = g_strdup(base_text == nullptr ? "" : base_text);
-        return TRUE;
-      };
-
-  auto runtime_container_root = [&]() -> gchar* {
-    const gchar* user_data = g_get_user_data_dir();
-    if (user_data != nullptr && strlen(user_data) > 0) {
-      return g_build_filename(user_data, "jumper-runtime", nullptr);
-    }
-    return g_build_filename(g_get_home_dir(), ".local", "share", "jumper-runtime", nullptr);
-  };
+// Runtime lane. Writes the trace events recorded so far as Chrome
+// trace-event JSON to `path`, or returns the JSON as `trace` without one.
+// Also reports `enabled`, `events`, `dropped` and `capacity`.
+static FlMethodResponse* handle_dump_trace(JumperSdkPlatformPlugin* self,
+                                           FlMethodCall* method_call,
+                                           GCancellable* cancellable) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "path")
+                            : nullptr;
+  const std::vector<jumper_sdk_platform::TraceEvent> events = self->trace->Events();
+  const std::string trace =
+      jumper_sdk_platform::FormatChromeTrace(events, getpid(), "jumper_sdk_platform");
 
-  auto copy_file_replace = [&](const gchar* source, const gchar* destination, GError** error) -> gboolean {
-    gchar* bytes = nullptr;
-    gsize length = 0;
-    if (!g_file_get_contents(source, &bytes, &length, error)) {
-      return FALSE;
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "enabled", fl_value_new_bool(self->trace->enabled()));
+  fl_value_set_string_take(payload, "events",
+                           fl_value_new_int(static_cast<int64_t>(events.size())));
+  fl_value_set_string_take(payload, "dropped",
+                           fl_value_new_int(static_cast<int64_t>(self->trace->dropped())));
+  fl_value_set_string_take(payload, "capacity",
+                           fl_value_new_int(static_cast<int64_t>(self->trace->capacity())));
+  if (path_value != nullptr && fl_value_get_type(path_value) == FL_VALUE_TYPE_STRING) {
+    const gchar* path = fl_value_get_string(path_value);
+    bool changed = false;
+    std::string error;
+    if (!jumper_sdk_platform::InstallTextFile(path, trace, &changed, &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "DUMP_TRACE_FAILED", "Failed to write the trace", fl_value_new_string(error.c_str())));
     }
-    gboolean ok = g_file_set_contents(destination, bytes, static_cast<gssize>(length), error);
-    g_free(bytes);
-    return ok;
-  };
+    fl_value_set_string_take(payload, "path", fl_value_new_string(path));
+  } else {
+    fl_value_set_string_take(payload, "trace", fl_value_new_string(trace.c_str()));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
 
-  if (strcmp(method, "getPlatformVersion") == 0) {
-    response = get_platform_version();
-  } else if (strcmp(method, "startCore") == 0) {
-    FlValue* args = fl_method_call_get_args(method_call);
-    gchar* binary_path = nullptr;
-    gchar** launch_args = nullptr;
-    gchar* working_dir = nullptr;
-    const gboolean has_launch =
-        parse_launch_options(args, &binary_path, &launch_args, &working_dir);
-    g_clear_pointer(&self->profile_id, g_free);
-    if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
-      FlValue* profile_id = fl_value_lookup_string(args, "profileId");
-      if (profile_id != nullptr && fl_value_get_type(profile_id) == FL_VALUE_TYPE_STRING) {
-        self->profile_id = g_strdup(fl_value_get_string(profile_id));
-      }
-      FlValue* network_mode = fl_value_lookup_string(args, "networkMode");
-      if (network_mode != nullptr &&
-          fl_value_get_type(network_mode) == FL_VALUE_TYPE_STRING &&
-          strlen(fl_value_get_string(network_mode)) > 0) {
-        g_free(self->network_mode);
-        self->network_mode = g_strdup(fl_value_get_string(network_mode));
-      }
+// Same shape as the macOS plugin's `core_state_changed`, plus the version
+// and the status it came from.
+static FlValue* core_transition_value(const jumper_sdk_platform::CoreTransition& transition) {
+  FlValue* payload = core_state_value(transition.state);
+  fl_value_set_string_take(
+      payload, "previousStatus",
+      fl_value_new_string(jumper_sdk_platform::CoreStatusName(transition.previous_status)));
+  fl_value_set_string_take(payload, "message", fl_value_new_string(transition.message.c_str()));
+  FlValue* event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string("core_state_changed"));
+  fl_value_set_string_take(event, "timestampMs", fl_value_new_int(transition.timestamp_ms));
+  fl_value_set_string_take(event, "payload", payload);
+  return event;
+}
+
+// Sends the transitions the listener has not seen yet, in version order.
+static gboolean flush_core_events(gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  if (self->core_events_channel == nullptr || !self->core_events_listening) {
+    return G_SOURCE_REMOVE;
+  }
+  for (const auto& transition :
+       self->core_state->TransitionsSince(self->core_events_delivered_version)) {
+    g_autoptr(FlValue) event = core_transition_value(transition);
+    g_autoptr(GError) error = nullptr;
+    if (!fl_event_channel_send(self->core_events_channel, event, nullptr, &error)) {
+      g_warning("Failed to send core state event: %s", error->message);
     }
-    if (has_launch) {
-      GError* spawn_error = nullptr;
-      if (!start_real_process(binary_path, launch_args, working_dir, &spawn_error)) {
-        self->is_running = FALSE;
-        self->pid = 0;
-        g_free(self->runtime_mode);
-        self->runtime_mode = g_strdup("simulator");
-        response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-            "START_CORE_FAILED",
-            "Failed to start core process",
-            fl_value_new_string(spawn_error == nullptr ? "unknown" : spawn_error->message)));
-        if (spawn_error != nullptr) {
-          g_error_free(spawn_error);
-        }
-        g_free(binary_path);
-        g_strfreev(launch_args);
-        g_free(working_dir);
-      } else {
-        self->is_running = TRUE;
-        g_free(self->runtime_mode);
-        self->runtime_mode = g_strdup("real");
-        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-        g_free(binary_path);
-        g_strfreev(launch_args);
-        g_free(working_dir);
-      }
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
+    self->core_events_delivered_version = transition.version;
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// A new listener first gets the buffered transitions, the last of which is
+// the current state. One that already saw some passes `sinceVersion`.
+static FlMethodErrorResponse* core_events_listen_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  self->core_events_listening = TRUE;
+  self->core_events_delivered_version = 0;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* since_value = fl_value_lookup_string(args, "sinceVersion");
+    if (since_value != nullptr && fl_value_get_type(since_value) == FL_VALUE_TYPE_INT) {
+      self->core_events_delivered_version =
+          static_cast<guint64>(MAX(fl_value_get_int(since_value), 0));
     }
-    self->is_running = TRUE;
-    g_free(self->runtime_mode);
-    self->runtime_mode = g_strdup("simulator");
-    self->pid = g_get_real_time();
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-  } else if (strcmp(method, "stopCore") == 0) {
-    stop_real_process();
-    self->is_running = FALSE;
-    self->pid = 0;
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-  } else if (strcmp(method, "restartCore") == 0) {
-    FlValue* args = fl_method_call_get_args(method_call);
-    gchar* binary_path = nullptr;
-    gchar** launch_args = nullptr;
-    gchar* working_dir = nullptr;
-    gboolean has_launch = parse_launch_options(args, &binary_path, &launch_args, &working_dir);
-    if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
-      FlValue* network_mode = fl_value_lookup_string(args, "networkMode");
-      if (network_mode != nullptr &&
-          fl_value_get_type(network_mode) == FL_VALUE_TYPE_STRING &&
-          strlen(fl_value_get_string(network_mode)) > 0) {
-        g_free(self->network_mode);
-        self->network_mode = g_strdup(fl_value_get_string(network_mode));
-      }
+  }
+  g_idle_add_full(G_PRIORITY_DEFAULT, flush_core_events, g_object_ref(self), g_object_unref);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* core_events_cancel_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->core_events_listening = FALSE;
+  return nullptr;
+}
+
+// Queues a `{type, timestampMs, payload}` event for core_events listeners.
+// Takes ownership of |payload|.
+static void post_core_event(JumperSdkPlatformPlugin* self, const gchar* type, FlValue* payload) {
+  FlValue* event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string(type));
+  fl_value_set_string_take(event, "timestampMs", fl_value_new_int(g_get_real_time() / 1000));
+  fl_value_set_string_take(event, "payload", payload);
+  post_event(self, &JumperSdkPlatformPlugin::core_events_channel, event);
+}
+
+static FlMethodResponse* handle_scheduled_restart(JumperSdkPlatformPlugin* self,
+                                                  FlMethodCall* method_call,
+                                                  GCancellable* cancellable);
+
+static gboolean on_restart_timer(gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  // Destroyed before the task is queued: the lane only acts on a timer that
+  // has fired, so one replaced in the meantime is ignored.
+  g_source_destroy(g_main_current_source());
+  dispatch_method_call(self, self->lifecycle_pool, nullptr, handle_scheduled_restart, TRUE);
+  return G_SOURCE_REMOVE;
+}
+
+// Lifecycle lane.
+static void schedule_core_restart(JumperSdkPlatformPlugin* self, int64_t delay_ms) {
+  clear_restart_timer(self);
+  self->restart_timer = g_timeout_source_new(static_cast<guint>(delay_ms));
+  g_source_set_callback(self->restart_timer, on_restart_timer, self, nullptr);
+  g_source_attach(self->restart_timer, nullptr);
+}
+
+// A failed automatic restart counts as another crash.
+static void on_automatic_restart_failed(JumperSdkPlatformPlugin* self, GError* error) {
+  const int64_t restart_in_ms =
+      self->restart_backoff->OnExit(g_get_monotonic_time() / 1000, 0);
+  if (restart_in_ms >= 0) {
+    schedule_core_restart(self, restart_in_ms);
+  }
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "message", fl_value_new_string(error->message));
+  fl_value_set_string_take(payload, "attempt", fl_value_new_int(self->restart_backoff->attempt()));
+  if (restart_in_ms >= 0) {
+    fl_value_set_string_take(payload, "restartInMs", fl_value_new_int(restart_in_ms));
+  }
+  fl_value_set_string_take(payload, "crashLoop", fl_value_new_bool(self->restart_backoff->open()));
+  post_core_event(self, "core_restart_failed", payload);
+}
+
+// Lifecycle lane. Starts the core again with the options it last ran with.
+static FlMethodResponse* handle_scheduled_restart(JumperSdkPlatformPlugin* self,
+                                                  FlMethodCall* method_call,
+                                                  GCancellable* cancellable) {
+  // Superseded by a deliberate start or stop, or by a later schedule.
+  if (self->restart_timer == nullptr || !g_source_is_destroyed(self->restart_timer)) {
+    return nullptr;
+  }
+  g_clear_pointer(&self->restart_timer, g_source_unref);
+  if (self->last_binary_path == nullptr || self->last_arguments == nullptr) {
+    return nullptr;
+  }
+  // start_real_process replaces the last_* fields.
+  g_autofree gchar* binary_path = g_strdup(self->last_binary_path);
+  g_auto(GStrv) launch_args = g_strdupv(self->last_arguments);
+  g_autofree gchar* working_dir = g_strdup(self->last_working_directory);
+  g_auto(GStrv) environment = g_strdupv(self->last_environment);
+  const auto started_at = std::chrono::steady_clock::now();
+  jumper_sdk_platform::ReadinessTimings timings;
+  g_autoptr(GError) error = nullptr;
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "real", 0,
+                  "core is restarting after an exit");
+  if (!start_real_process(self, binary_path, launch_args, working_dir, environment,
+                          kCoreStopDefaultTimeoutMs, cancellable, started_at, &timings,
+                          &error)) {
+    transition_core(self, start_failure_status(error), nullptr, 0, error->message);
+    // A stopCore issued meanwhile wins; the stop has reset the backoff.
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      on_automatic_restart_failed(self, error);
     }
-    if (!has_launch && self->last_arguments != nullptr && self->last_binary_path != nullptr) {
-      has_launch = TRUE;
-      binary_path = g_strdup(self->last_binary_path);
-      launch_args = g_strdupv(self->last_arguments);
-      working_dir =
-          self->last_working_directory == nullptr ? nullptr : g_strdup(self->last_working_directory);
-    }
-    if (has_launch) {
-      GError* spawn_error = nullptr;
-      if (!start_real_process(binary_path, launch_args, working_dir, &spawn_error)) {
-        self->is_running = FALSE;
-        self->pid = 0;
-        g_free(self->runtime_mode);
-        self->runtime_mode = g_strdup("simulator");
-        response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-            "RESTART_CORE_FAILED",
-            "Failed to restart core process",
-            fl_value_new_string(spawn_error == nullptr ? "unknown" : spawn_error->message)));
-        if (spawn_error != nullptr) {
-          g_error_free(spawn_error);
-        }
-      } else {
-        self->is_running = TRUE;
-        g_free(self->runtime_mode);
-        self->runtime_mode = g_strdup("real");
-        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-      }
-      g_free(binary_path);
-      g_strfreev(launch_args);
-      g_free(working_dir);
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
+    return nullptr;
+  }
+  transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "real", self->real_pid,
+                  "core restarted");
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(self->real_pid));
+  fl_value_set_string_take(payload, "attempt", fl_value_new_int(self->restart_backoff->attempt()));
+  fl_value_set_string_take(payload, "readyMs", fl_value_new_float(timings.ready_ms));
+  post_core_event(self, "core_restarted", payload);
+  return nullptr;
+}
+
+// Lifecycle lane. Reaps a core that exited without being asked to, tells
+// listeners right away and schedules the restart.
+static FlMethodResponse* handle_core_exit(JumperSdkPlatformPlugin* self,
+                                          FlMethodCall* method_call,
+                                          GCancellable* cancellable) {
+  if (!self->has_real_process || self->real_pid <= 0) {
+    return nullptr;
+  }
+  // Either a notice for a core that has since been stopped and replaced, or
+  // a poll while the core still runs. An adopted core is reaped by its own
+  // parent; its pidfd only says that it is gone.
+  int status = 0;
+  const gboolean known_status = !self->real_adopted;
+  if (known_status ? waitpid(self->real_pid, &status, WNOHANG) != self->real_pid
+                   : !jumper_sdk_platform::WaitForProcessExit(self->real_pidfd, 0)) {
+    return nullptr;
+  }
+  const gint64 pid = self->real_pid;
+  const gint64 uptime_ms = (g_get_monotonic_time() - self->real_started_at) / 1000;
+  const guint64 first_log_seq = self->real_first_log_seq;
+  // Joins the log reader, so whatever the core wrote last is in the buffer.
+  release_core_process(self);
+  g_autofree gchar* description =
+      !known_status         ? g_strdup("core exited")
+      : WIFSIGNALED(status) ? g_strdup_printf("core was killed by signal %d", WTERMSIG(status))
+                            : g_strdup_printf("core exited with code %d", WEXITSTATUS(status));
+  const gboolean clean_exit = known_status && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  transition_core(self,
+                  clean_exit ? jumper_sdk_platform::CoreStatus::kStopped
+                             : jumper_sdk_platform::CoreStatus::kError,
+                  nullptr, 0, description);
+  const auto last_logs = self->kernel_logs->Tail(first_log_seq - 1, kCoreExitLogLines);
+  const int64_t restart_in_ms =
+      self->restart_backoff->OnExit(g_get_monotonic_time() / 1000, uptime_ms);
+  if (restart_in_ms >= 0) {
+    schedule_core_restart(self, restart_in_ms);
+  }
+
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(pid));
+  if (known_status && WIFEXITED(status)) {
+    fl_value_set_string_take(payload, "exitCode", fl_value_new_int(WEXITSTATUS(status)));
+  }
+  if (known_status && WIFSIGNALED(status)) {
+    fl_value_set_string_take(payload, "signal", fl_value_new_int(WTERMSIG(status)));
+  }
+  fl_value_set_string_take(payload, "uptimeMs", fl_value_new_int(uptime_ms));
+  fl_value_set_string_take(payload, "lastLogs", kernel_log_lines_value(last_logs));
+  if (restart_in_ms >= 0) {
+    fl_value_set_string_take(payload, "restartInMs", fl_value_new_int(restart_in_ms));
+  }
+  fl_value_set_string_take(payload, "crashLoop", fl_value_new_bool(self->restart_backoff->open()));
+  post_core_event(self, "core_exited", payload);
+  return nullptr;
+}
+
+// The pidfd turns readable once the core exits. Reaping is left to the lane
+// so it never races stop_real_process.
+static gboolean on_core_pidfd_readable(gint fd, GIOCondition condition, gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  dispatch_method_call(self, self->lifecycle_pool, nullptr, handle_core_exit, FALSE);
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean on_core_exit_poll(gpointer user_data) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(user_data);
+  dispatch_method_call(self, self->lifecycle_pool, nullptr, handle_core_exit, FALSE);
+  return G_SOURCE_CONTINUE;
+}
+
+// Lifecycle lane, right after a successful start or adoption.
+static void watch_core_exit(JumperSdkPlatformPlugin* self) {
+  clear_exit_watch(self);
+  if (self->real_pidfd >= 0) {
+    self->exit_watch = g_unix_fd_source_new(self->real_pidfd, G_IO_IN);
+    g_source_set_callback(self->exit_watch, G_SOURCE_FUNC(on_core_pidfd_readable),
+                          self, nullptr);
+  } else {
+    self->exit_watch = g_timeout_source_new(kCoreExitPollIntervalMs);
+    g_source_set_callback(self->exit_watch, on_core_exit_poll, self, nullptr);
+  }
+  g_source_attach(self->exit_watch, nullptr);
+}
+
+// How long ago a process started, from its /proc start time.
+static gint64 process_uptime_ms(guint64 start_time) {
+  struct timespec now;
+  clock_gettime(CLOCK_BOOTTIME, &now);
+  const gint64 now_ms = static_cast<gint64>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+  const gint64 started_ms = static_cast<gint64>(start_time * 1000 / sysconf(_SC_CLK_TCK));
+  return MAX(now_ms - started_ms, 0);
+}
+
+// Lifecycle lane, queued at registration. Takes over a core that an earlier
+// run of the app left behind when it crashed or was killed, so the tunnel
+// outlives the UI. The record is only trusted once /proc confirms it
+// describes the live process: same start time, same command line, same
+// executable contents.
+static FlMethodResponse* handle_adopt_core(JumperSdkPlatformPlugin* self,
+                                           FlMethodCall* method_call,
+                                           GCancellable* cancellable) {
+  if (self->has_real_process) {
+    return nullptr;
+  }
+  g_autofree gchar* record_path = core_record_path();
+  auto record = std::make_unique<jumper_sdk_platform::CoreRecord>();
+  if (!jumper_sdk_platform::ReadCoreRecord(record_path, record.get(), nullptr)) {
+    unlink(record_path);
+    return nullptr;
+  }
+  const GPid pid = static_cast<GPid>(record->pid);
+  // Opened before the checks, so the process checked is the one signalled
+  // and watched from here on.
+  const gint pidfd = jumper_sdk_platform::OpenProcessFd(pid);
+  g_autofree gchar* exe_path = g_strdup_printf("/proc/%d/exe", pid);
+  std::vector<std::string> arguments;
+  std::string exe_sha256;
+  const gboolean ours =
+      jumper_sdk_platform::ProcessStartTime(pid) == record->start_time &&
+      jumper_sdk_platform::ProcessArguments(pid, &arguments) && arguments == record->arguments &&
+      jumper_sdk_platform::Sha256File(exe_path, &exe_sha256, nullptr, nullptr) &&
+      exe_sha256 == record->binary_sha256;
+  self->real_record = record.release();
+  if (!ours || pidfd < 0) {
+    // Without a pidfd its exit could not be watched, and it still holds the
+    // ports the next start needs.
+    if (ours && kill(-pid, SIGTERM) != 0) {
+      kill(pid, SIGTERM);
     }
-    self->is_running = TRUE;
-    g_free(self->runtime_mode);
-    self->runtime_mode = g_strdup("simulator");
-    self->pid = g_get_real_time();
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-  } else if (strcmp(method, "resetTunnel") == 0) {
-    if (self->is_running) {
-      self->pid = g_get_real_time();
+    if (pidfd >= 0) {
+      close(pidfd);
     }
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-  } else if (strcmp(method, "getCoreState") == 0) {
-    g_autoptr(FlValue) state = fl_value_new_map();
-    fl_value_set_string_take(state, "status",
-                             self->is_running ? fl_value_new_string("running")
-                                              : fl_value_new_string("stopped"));
-    fl_value_set_string_take(
-        state, "runtimeMode",
-        fl_value_new_string(self->runtime_mode != nullptr ? self->runtime_mode : "simulator"));
+    discard_core_record(self);
+    return nullptr;
+  }
+
+  const jumper_sdk_platform::CoreRecord& adopted = *self->real_record;
+  const gint64 uptime_ms = process_uptime_ms(adopted.start_time);
+  self->real_pid = pid;
+  self->real_pidfd = pidfd;
+  self->has_real_process = TRUE;
+  self->real_adopted = TRUE;
+  self->real_started_at = g_get_monotonic_time() - uptime_ms * 1000;
+  self->real_first_log_seq = self->kernel_logs->next_seq();
+  g_clear_pointer(&self->last_binary_path, g_free);
+  self->last_binary_path = g_strdup(adopted.binary_path.c_str());
+  g_strfreev(self->last_arguments);
+  self->last_arguments = strv_from_vector(adopted.arguments);
+  g_clear_pointer(&self->last_working_directory, g_free);
+  self->last_working_directory =
+      adopted.working_directory.empty() ? nullptr : g_strdup(adopted.working_directory.c_str());
+  g_strfreev(self->last_environment);
+  self->last_environment = strv_from_vector(adopted.environment);
+
+  // Lines the core wrote while nobody was reading are skipped.
+  const gint log_fd = open(adopted.log_path.c_str(), O_RDWR | O_CLOEXEC);
+  if (log_fd >= 0) {
+    lseek(log_fd, 0, SEEK_END);
+    self->log_capture =
+        core_log_capture_new(-1, -1, log_fd, adopted.log_path.c_str(), self->kernel_logs);
+  }
+  // A config rewritten since most likely keeps its controller; a wrong guess
+  // only costs the telemetry streams and turns a reload into a restart.
+  jumper_sdk_platform::CoreConfig config;
+  read_launch_config(self->last_arguments, &config);
+  if (config.has_controller) {
+    self->real_controller = new jumper_sdk_platform::ClashApiEndpoint(config.controller);
+    self->traffic_stream->SetEndpoint(config.controller);
+    self->connections->SetEndpoint(config.controller);
+  }
+  // The planner compares against the config on disk only if it is the one
+  // the core loaded.
+  std::string digest;
+  if (!adopted.config_path.empty() &&
+      jumper_sdk_platform::Sha256File(adopted.config_path, &digest, nullptr, nullptr) &&
+      digest == adopted.config_sha256) {
+    set_real_config(self, read_launch_shape(self->last_arguments));
+  }
+  // A runtime updated since is picked up by the next startCore.
+  self->keep_adopted_core =
+      jumper_sdk_platform::Sha256File(adopted.binary_path, &digest, nullptr, nullptr) &&
+      digest == adopted.binary_sha256;
+  g_mutex_lock(&self->state_mutex);
+  *self->real_cgroup = jumper_sdk_platform::FindCgroupPlacement(pid);
+  g_mutex_unlock(&self->state_mutex);
+  capture_core_scheduling(self, pid);
+  self->process_stats->SetPid(pid);
+  watch_core_exit(self);
+
+  transition_core(self, jumper_sdk_platform::CoreStatus::kStarting, "real", 0,
+                  "adopting a running core");
+  transition_core(self, jumper_sdk_platform::CoreStatus::kRunning, "real", pid, "core adopted");
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "pid", fl_value_new_int(pid));
+  fl_value_set_string_take(payload, "uptimeMs", fl_value_new_int(uptime_ms));
+  post_core_event(self, "core_adopted", payload);
+  return nullptr;
+}
+
+// Supervisor thread of the instance registry.
+static void on_core_instance_event(JumperSdkPlatformPlugin* self,
+                                   const jumper_sdk_platform::CoreInstanceEvent& event) {
+  FlValue* payload = fl_value_new_map();
+  fl_value_set_string_take(payload, "profileId", fl_value_new_string(event.profile_id.c_str()));
+  fl_value_set_string_take(payload, "isolated", fl_value_new_bool(TRUE));
+  if (event.pid > 0) {
+    fl_value_set_string_take(payload, "pid", fl_value_new_int(event.pid));
+  }
+  if (event.exit_code >= 0) {
+    fl_value_set_string_take(payload, "exitCode", fl_value_new_int(event.exit_code));
+  }
+  if (event.signal >= 0) {
+    fl_value_set_string_take(payload, "signal", fl_value_new_int(event.signal));
+  }
+  if (!event.message.empty()) {
+    fl_value_set_string_take(payload, "message", fl_value_new_string(event.message.c_str()));
+  }
+  if (event.type == jumper_sdk_platform::CoreInstanceEventType::kExited) {
+    fl_value_set_string_take(payload, "uptimeMs", fl_value_new_int(event.uptime_ms));
+    fl_value_set_string_take(payload, "lastLogs", kernel_log_lines_value(event.last_logs));
+  }
+  if (event.restart_in_ms >= 0) {
+    fl_value_set_string_take(payload, "restartInMs", fl_value_new_int(event.restart_in_ms));
+  }
+  fl_value_set_string_take(payload, "attempt", fl_value_new_int(event.attempt));
+  fl_value_set_string_take(payload, "crashLoop", fl_value_new_bool(event.crash_loop));
+  switch (event.type) {
+    case jumper_sdk_platform::CoreInstanceEventType::kExited:
+      post_core_event(self, "instance_exited", payload);
+      break;
+    case jumper_sdk_platform::CoreInstanceEventType::kRestarted:
+      post_core_event(self, "instance_restarted", payload);
+      break;
+    case jumper_sdk_platform::CoreInstanceEventType::kRestartFailed:
+      post_core_event(self, "instance_restart_failed", payload);
+      break;
+  }
+}
+
+// The profile of the isolated instance a stopCore, getCoreState or
+// getRecentLogs call is for; nullptr for the main core.
+static const gchar* isolated_profile_id(FlValue* args) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return nullptr;
+  }
+  FlValue* value = fl_value_lookup_string(args, "isolatedProfileId");
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING
+             ? fl_value_get_string(value)
+             : nullptr;
+}
+
+static gboolean is_isolated_start(FlValue* args) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FALSE;
+  }
+  FlValue* value = fl_value_lookup_string(args, "isolated");
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL &&
+         fl_value_get_bool(value);
+}
+
+static FlValue* core_instance_state_value(const jumper_sdk_platform::CoreInstanceState& state) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "status",
+                           fl_value_new_string(jumper_sdk_platform::CoreStatusName(state.status)));
+  fl_value_set_string_take(value, "runtimeMode", fl_value_new_string("real"));
+  fl_value_set_string_take(value, "profileId", fl_value_new_string(state.profile_id.c_str()));
+  fl_value_set_string_take(value, "isolated", fl_value_new_bool(TRUE));
+  if (state.pid > 0) {
+    fl_value_set_string_take(value, "pid", fl_value_new_int(state.pid));
     fl_value_set_string_take(
-        state, "networkMode",
-        fl_value_new_string(self->network_mode != nullptr ? self->network_mode : "tunnel"));
-    if (self->pid > 0) {
-      fl_value_set_string_take(state, "pid", fl_value_new_int(self->pid));
-    }
-    if (self->profile_id != nullptr) {
-      fl_value_set_string_take(state, "profileId", fl_value_new_string(self->profile_id));
+        value, "uptimeMs",
+        fl_value_new_int(g_get_monotonic_time() / 1000 - state.started_at_ms));
+  }
+  fl_value_set_string_take(value, "restarts", fl_value_new_int(state.restarts));
+  fl_value_set_string_take(value, "crashLoop", fl_value_new_bool(state.crash_loop));
+  FlValue* ports = fl_value_new_list();
+  for (const uint16_t port : state.listen_ports) {
+    fl_value_append_take(ports, fl_value_new_int(port));
+  }
+  fl_value_set_string_take(value, "listenPorts", ports);
+  if (state.has_controller) {
+    const std::string& host = state.controller.host;
+    g_autofree gchar* controller =
+        host.find(':') == std::string::npos
+            ? g_strdup_printf("%s:%u", host.c_str(), state.controller.port)
+            : g_strdup_printf("[%s]:%u", host.c_str(), state.controller.port);
+    fl_value_set_string_take(value, "controller", fl_value_new_string(controller));
+  }
+  fl_value_set_string_take(value, "message", fl_value_new_string(state.message.c_str()));
+  return value;
+}
+
+static FlMethodResponse* core_instance_failure_response(const gchar* code,
+                                                        const gchar* message,
+                                                        const std::string& detail) {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new(code, message, fl_value_new_string(detail.c_str())));
+}
+
+// Instance lane. Starts a core beside the main one for profileId, on ports of
+// its own, and completes once its Clash API answers.
+static FlMethodResponse* handle_start_instance(JumperSdkPlatformPlugin* self,
+                                               FlMethodCall* method_call,
+                                               GCancellable* cancellable) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  g_autofree gchar* binary_path = nullptr;
+  g_auto(GStrv) launch_args = nullptr;
+  g_autofree gchar* working_dir = nullptr;
+  g_auto(GStrv) environment = nullptr;
+  const gboolean has_launch =
+      parse_launch_options(args, &binary_path, &launch_args, &working_dir, &environment);
+  FlValue* profile_value = fl_value_lookup_string(args, "profileId");
+  const gchar* profile_id =
+      profile_value != nullptr && fl_value_get_type(profile_value) == FL_VALUE_TYPE_STRING
+          ? fl_value_get_string(profile_value)
+          : "";
+  if (!has_launch || profile_id[0] == '\0') {
+    return core_instance_failure_response(
+        "START_CORE_FAILED", "An isolated core needs a profileId and launchOptions",
+        profile_id);
+  }
+  jumper_sdk_platform::PinnedFile binary;
+  g_autoptr(GError) error = nullptr;
+  if (!pin_core_binary(binary_path, &binary, &error)) {
+    return core_start_failure_response(error, FALSE);
+  }
+  jumper_sdk_platform::SpawnOptions spawn =
+      core_spawn_options(binary_path, &binary, launch_args, working_dir, environment);
+  // Nice, I/O class and affinity only: restarts happen without waiting for
+  // readiness, and the cgroup limits are the main core's.
+  jumper_sdk_platform::CoreSchedulingOptions scheduling = parse_scheduling_options(args);
+  spawn.scheduling = scheduling.process;
+  // The Go runtime is sized without the memory.high the instance never gets.
+  scheduling.memory_high_bytes = 0;
+  tune_core_go_runtime(parse_go_runtime_profile(args), scheduling, &spawn.environment);
+  jumper_sdk_platform::CoreInstanceState state;
+  jumper_sdk_platform::ReadinessTimings timings;
+  std::string detail;
+  const auto result = self->instances->Start(
+      profile_id, spawn, kCoreReadyTimeoutMs,
+      [cancellable](int milliseconds) {
+        return wait_unless_cancelled(cancellable, milliseconds) == TRUE;
+      },
+      &state, &timings, &detail);
+  switch (result) {
+    case jumper_sdk_platform::CoreInstanceStartResult::kStarted:
+      break;
+    case jumper_sdk_platform::CoreInstanceStartResult::kLimitReached:
+      return core_instance_failure_response(
+          "CORE_INSTANCE_LIMIT", "Too many isolated cores are running", detail);
+    case jumper_sdk_platform::CoreInstanceStartResult::kConfigInvalid:
+      return core_instance_failure_response(
+          "CORE_CONFIG_INVALID", "The launch config cannot run as an isolated core", detail);
+    case jumper_sdk_platform::CoreInstanceStartResult::kCancelled:
+      return core_instance_failure_response(
+          "START_CORE_CANCELLED", "Isolated core start was cancelled", detail);
+    case jumper_sdk_platform::CoreInstanceStartResult::kSpawnFailed:
+      return core_instance_failure_response(
+          "START_CORE_FAILED", "Failed to start isolated core process", detail);
+    case jumper_sdk_platform::CoreInstanceStartResult::kExited:
+    case jumper_sdk_platform::CoreInstanceStartResult::kNotReady:
+      return core_instance_failure_response(
+          "START_CORE_FAILED", "Isolated core started but failed readiness gate", detail);
+  }
+  FlMethodResponse* response = core_started_response(state.pid, timings, state.has_controller);
+  FlValue* payload = fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(response));
+  g_autoptr(FlValue) state_value = core_instance_state_value(state);
+  for (const gchar* key : {"profileId", "isolated", "listenPorts", "controller"}) {
+    FlValue* entry = fl_value_lookup_string(state_value, key);
+    if (entry != nullptr) {
+      fl_value_set_string(payload, key, entry);
     }
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(state));
-  } else if (strcmp(method, "setupRuntime") == 0) {
-    gchar* version = nullptr;
-    gchar* platform_arch = nullptr;
-    gchar* base_path = nullptr;
-    GError* runtime_error = nullptr;
-    if (!parse_runtime_request(method_call, TRUE, &version, &platform_arch, &base_path, &runtime_error)) {
-      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-          "SETUP_RUNTIME_FAILED",
-          "Failed to setup runtime in container",
-          fl_value_new_string(runtime_error == nullptr ? "unknown" : runtime_error->message)));
-      if (runtime_error != nullptr) {
-        g_error_free(runtime_error);
+  }
+  return response;
+}
+
+// Instance lane.
+static FlMethodResponse* handle_stop_instance(JumperSdkPlatformPlugin* self,
+                                              FlMethodCall* method_call,
+                                              GCancellable* cancellable) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  const std::string profile_id = isolated_profile_id(args);
+  const gint timeout_ms = stop_timeout_from_args(args);
+  jumper_sdk_platform::ProcessStopResult result;
+  if (self->instances->Stop(profile_id, timeout_ms, &result)) {
+    FlValue* payload = fl_value_new_map();
+    fl_value_set_string_take(payload, "profileId", fl_value_new_string(profile_id.c_str()));
+    fl_value_set_string_take(payload, "isolated", fl_value_new_bool(TRUE));
+    fl_value_set_string_take(payload, "stopMs", fl_value_new_float(result.exit_ms));
+    fl_value_set_string_take(payload, "timeoutMs", fl_value_new_int(timeout_ms));
+    fl_value_set_string_take(payload, "killed", fl_value_new_bool(result.killed));
+    post_core_event(self, "instance_stopped", payload);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Runtime lane, as it reads the instance's /proc entries.
+static FlMethodResponse* handle_instance_state(JumperSdkPlatformPlugin* self,
+                                               FlMethodCall* method_call,
+                                               GCancellable* cancellable) {
+  const gchar* profile_id = isolated_profile_id(fl_method_call_get_args(method_call));
+  jumper_sdk_platform::CoreInstanceState state;
+  if (!self->instances->GetState(profile_id, &state)) {
+    g_autoptr(FlValue) stopped = fl_value_new_map();
+    fl_value_set_string_take(stopped, "status", fl_value_new_string("stopped"));
+    fl_value_set_string_take(stopped, "profileId", fl_value_new_string(profile_id));
+    fl_value_set_string_take(stopped, "isolated", fl_value_new_bool(TRUE));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(stopped));
+  }
+  g_autoptr(FlValue) value = core_instance_state_value(state);
+  jumper_sdk_platform::ProcessStats stats;
+  if (state.pid > 0 &&
+      jumper_sdk_platform::ReadProcessStats("/proc", static_cast<int>(state.pid), &stats,
+                                            nullptr)) {
+    const std::pair<const gchar*, int64_t> fields[] = {
+        {"rssBytes", stats.rss_bytes},
+        {"cpuUserMs", stats.cpu_user_ms},
+        {"cpuSystemMs", stats.cpu_system_ms},
+        {"threads", stats.threads},
+        {"openFds", stats.open_fds},
+    };
+    for (const auto& field : fields) {
+      if (field.second >= 0) {
+        fl_value_set_string_take(value, field.first, fl_value_new_int(field.second));
       }
-      g_free(version);
-      g_free(platform_arch);
-      g_free(base_path);
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
     }
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+}
 
-    g_autofree gchar* runtime_root = runtime_container_root();
-    if (g_mkdir_with_parents(runtime_root, 0755) != 0) {
-      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-          "SETUP_RUNTIME_FAILED",
-          "Failed to setup runtime in container",
-          fl_value_new_string("Unable to create runtime root")));
-      g_free(version);
-      g_free(platform_arch);
-      g_free(base_path);
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
+// Runs on the stream thread. Samples are parsed there and only the three
+// numbers cross to the platform thread.
+static void on_traffic_line(JumperSdkPlatformPlugin* self, const std::string& line) {
+  jumper_sdk_platform::TrafficSample sample;
+  if (!jumper_sdk_platform::ParseTrafficSample(line, g_get_real_time() / 1000, &sample)) {
+    return;
+  }
+  const int64_t values[] = {sample.up, sample.down, sample.timestamp_ms};
+  post_event(self, &JumperSdkPlatformPlugin::traffic_channel,
+             fl_value_new_int64_list(values, G_N_ELEMENTS(values)));
+}
+
+static FlMethodErrorResponse* traffic_listen_cb(FlEventChannel* channel,
+                                                FlValue* args,
+                                                gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->traffic_stream->SetActive(true);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* traffic_cancel_cb(FlEventChannel* channel,
+                                                FlValue* args,
+                                                gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->traffic_stream->SetActive(false);
+  return nullptr;
+}
+
+// Runs on the sampler thread. Only fields that changed since the previous
+// sample are sent; `keyframe` events carry all of them.
+static void on_process_stats_sample(JumperSdkPlatformPlugin* self,
+                                    int pid,
+                                    const std::vector<jumper_sdk_platform::ProcessStatField>& fields,
+                                    bool keyframe) {
+  FlValue* event = fl_value_new_map();
+  fl_value_set_string_take(event, "pid", fl_value_new_int(pid));
+  fl_value_set_string_take(event, "timestampMs", fl_value_new_int(g_get_real_time() / 1000));
+  fl_value_set_string_take(event, "keyframe", fl_value_new_bool(keyframe));
+  for (const auto& field : fields) {
+    fl_value_set_string_take(event, field.name, fl_value_new_int(field.value));
+  }
+  post_event(self, &JumperSdkPlatformPlugin::process_stats_channel, event);
+}
+
+// Reads the `intervalMs` a listener passed to receiveBroadcastStream.
+static gint sample_interval_from_args(FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* interval = fl_value_lookup_string(args, "intervalMs");
+    if (interval != nullptr && fl_value_get_type(interval) == FL_VALUE_TYPE_INT) {
+      return CLAMP(static_cast<gint>(fl_value_get_int(interval)), kSampleMinIntervalMs,
+                   kSampleMaxIntervalMs);
     }
+  }
+  return kSampleDefaultIntervalMs;
+}
 
-    g_autofree gchar* source_binary = g_strdup_printf(
-        "%s/engine/runtime-assets/%s/sing-box-%s-%s/sing-box",
-        base_path, platform_arch, version, platform_arch);
-    g_autofree gchar* source_config = g_strdup_printf(
-        "%s/engine/runtime-assets/%s/minimal-config.json",
-        base_path, platform_arch);
-    g_autofree gchar* target_binary = g_build_filename(runtime_root, "sing-box", nullptr);
-    g_autofree gchar* target_config = g_build_filename(runtime_root, "config.json", nullptr);
-    g_autofree gchar* target_version = g_build_filename(runtime_root, "VERSION", nullptr);
-
-    if (!copy_file_replace(source_binary, target_binary, &runtime_error) ||
-        !copy_file_replace(source_config, target_config, &runtime_error) ||
-        !g_file_set_contents(target_version, version, -1, &runtime_error)) {
-      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-          "SETUP_RUNTIME_FAILED",
-          "Failed to setup runtime in container",
-          fl_value_new_string(runtime_error == nullptr ? "unknown" : runtime_error->message)));
-      if (runtime_error != nullptr) {
-        g_error_free(runtime_error);
-      }
-      g_free(version);
-      g_free(platform_arch);
-      g_free(base_path);
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
+static FlMethodErrorResponse* process_stats_listen_cb(FlEventChannel* channel,
+                                                      FlValue* args,
+                                                      gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->process_stats->SetActive(
+      true, sample_interval_from_args(args));
+  return nullptr;
+}
+
+static FlMethodErrorResponse* process_stats_cancel_cb(FlEventChannel* channel,
+                                                      FlValue* args,
+                                                      gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->process_stats->SetActive(
+      false, kSampleDefaultIntervalMs);
+  return nullptr;
+}
+
+// Runs on the poller thread. Added connections are forwarded as the raw JSON
+// the core sent; changed ones only as counters, four per id in
+// `changedCounters`: upload, download, uploadRate, downloadRate.
+static void on_connections_delta(JumperSdkPlatformPlugin* self,
+                                 const jumper_sdk_platform::ConnectionsDelta& delta,
+                                 bool reset,
+                                 int64_t timestamp_ms) {
+  FlValue* event = fl_value_new_map();
+  fl_value_set_string_take(event, "reset", fl_value_new_bool(reset));
+  fl_value_set_string_take(event, "timestampMs", fl_value_new_int(timestamp_ms));
+  FlValue* added = fl_value_new_list();
+  for (const auto& entry : delta.added) {
+    fl_value_append_take(added, fl_value_new_string(entry.json.c_str()));
+  }
+  fl_value_set_string_take(event, "added", added);
+  FlValue* removed = fl_value_new_list();
+  for (const auto& id : delta.removed) {
+    fl_value_append_take(removed, fl_value_new_string(id.c_str()));
+  }
+  fl_value_set_string_take(event, "removed", removed);
+  FlValue* changed_ids = fl_value_new_list();
+  std::vector<int64_t> counters;
+  counters.reserve(delta.changed.size() * 4);
+  for (const auto& change : delta.changed) {
+    fl_value_append_take(changed_ids, fl_value_new_string(change.id.c_str()));
+    counters.push_back(change.upload);
+    counters.push_back(change.download);
+    counters.push_back(change.upload_rate);
+    counters.push_back(change.download_rate);
+  }
+  fl_value_set_string_take(event, "changedIds", changed_ids);
+  fl_value_set_string_take(event, "changedCounters",
+                           fl_value_new_int64_list(counters.data(), counters.size()));
+
+  post_event(self, &JumperSdkPlatformPlugin::connections_channel, event);
+}
+
+static FlMethodErrorResponse* connections_listen_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->connections->SetActive(
+      true, sample_interval_from_args(args));
+  return nullptr;
+}
+
+static FlMethodErrorResponse* connections_cancel_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  JUMPER_SDK_PLATFORM_PLUGIN(user_data)->connections->SetActive(false,
+                                                                kSampleDefaultIntervalMs);
+  return nullptr;
+}
+
+static FlMethodResponse* get_recent_logs(JumperSdkPlatformPlugin* self, FlValue* args) {
+  int64_t since_seq = 0;
+  int64_t limit = static_cast<int64_t>(kLogBufferCapacity);
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* since_value = fl_value_lookup_string(args, "sinceSeq");
+    if (since_value != nullptr && fl_value_get_type(since_value) == FL_VALUE_TYPE_INT) {
+      since_seq = fl_value_get_int(since_value);
     }
-    chmod(target_binary, 0755);
+    FlValue* limit_value = fl_value_lookup_string(args, "limit");
+    if (limit_value != nullptr && fl_value_get_type(limit_value) == FL_VALUE_TYPE_INT) {
+      limit = fl_value_get_int(limit_value);
+    }
+  }
+  // An isolated core's buffer is shared, so it outlives a concurrent stop.
+  std::shared_ptr<jumper_sdk_platform::KernelLogBuffer> instance_logs;
+  const gchar* profile_id = isolated_profile_id(args);
+  if (profile_id != nullptr) {
+    instance_logs = self->instances->Logs(profile_id);
+  }
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  if (profile_id != nullptr && instance_logs == nullptr) {
+    fl_value_set_string_take(payload, "lines", fl_value_new_list());
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+  }
+  const jumper_sdk_platform::KernelLogBuffer* logs =
+      instance_logs != nullptr ? instance_logs.get() : self->kernel_logs;
+  const auto lines = logs->LinesSince(static_cast<uint64_t>(MAX(since_seq, 0)),
+                                      static_cast<size_t>(MAX(limit, 0)));
+  fl_value_set_string_take(payload, "lines", kernel_log_lines_value(lines));
+  fl_value_set_string_take(payload, "nextSeq",
+                           fl_value_new_int(static_cast<int64_t>(logs->next_seq())));
+  fl_value_set_string_take(payload, "dropped",
+                           fl_value_new_int(static_cast<int64_t>(logs->dropped())));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
+}
 
-    g_autoptr(FlValue) payload = fl_value_new_map();
-    fl_value_set_string_take(payload, "installed", fl_value_new_bool(TRUE));
-    fl_value_set_string_take(payload, "binaryPath", fl_value_new_string(target_binary));
-    fl_value_set_string_take(payload, "configPath", fl_value_new_string(target_config));
-    fl_value_set_string_take(payload, "runtimeRoot", fl_value_new_string(runtime_root));
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
-    g_free(version);
-    g_free(platform_arch);
-    g_free(base_path);
+// Called when a method call is received from Flutter. Anything that touches
+// the file system or the core process is handed to a worker lane so the
+// platform thread never blocks.
+static void jumper_sdk_platform_plugin_handle_method_call(
+    JumperSdkPlatformPlugin* self,
+    FlMethodCall* method_call) {
+  const auto started_at = std::chrono::steady_clock::now();
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  const gchar* method = fl_method_call_get_name(method_call);
+  jumper_sdk_platform::StallWatchdogScope stall_scope(self->stalls, method);
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  if (strcmp(method, "startCore") == 0 && is_isolated_start(args)) {
+    dispatch_method_call(self, self->instance_pool, method_call, handle_start_instance, FALSE);
+    return;
+  } else if (strcmp(method, "stopCore") == 0 && isolated_profile_id(args) != nullptr) {
+    dispatch_method_call(self, self->instance_pool, method_call, handle_stop_instance, FALSE);
+    return;
+  } else if (strcmp(method, "getCoreState") == 0 && isolated_profile_id(args) != nullptr) {
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_instance_state, FALSE);
+    return;
+  } else if (strcmp(method, "startCore") == 0) {
+    dispatch_method_call(self, self->lifecycle_pool, method_call, handle_start_core, TRUE);
+    return;
+  } else if (strcmp(method, "restartCore") == 0) {
+    dispatch_method_call(self, self->lifecycle_pool, method_call, handle_restart_core, TRUE);
+    return;
+  } else if (strcmp(method, "reloadCore") == 0) {
+    dispatch_method_call(self, self->lifecycle_pool, method_call, handle_reload_core, TRUE);
+    return;
+  } else if (strcmp(method, "resetTunnel") == 0) {
+    dispatch_method_call(self, self->lifecycle_pool, method_call, handle_reset_tunnel, TRUE);
+    return;
+  } else if (strcmp(method, "stopCore") == 0) {
+    cancel_pending_starts(self);
+    dispatch_method_call(self, self->lifecycle_pool, method_call, handle_stop_core, FALSE);
+    return;
+  } else if (strcmp(method, "setupRuntime") == 0) {
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_setup_runtime, FALSE);
+    return;
   } else if (strcmp(method, "inspectRuntime") == 0) {
-    gchar* version = nullptr;
-    gchar* platform_arch = nullptr;
-    gchar* base_path = nullptr;
-    GError* runtime_error = nullptr;
-    if (!parse_runtime_request(method_call, FALSE, &version, &platform_arch, &base_path, &runtime_error)) {
-      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
-          "INSPECT_RUNTIME_FAILED",
-          "Failed to inspect runtime",
-          fl_value_new_string(runtime_error == nullptr ? "unknown" : runtime_error->message)));
-      if (runtime_error != nullptr) {
-        g_error_free(runtime_error);
-      }
-      g_free(version);
-      g_free(platform_arch);
-      g_free(base_path);
-      fl_method_call_respond(method_call, response, nullptr);
-      return;
-    }
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_inspect_runtime, FALSE);
+    return;
+  } else if (strcmp(method, "rollbackRuntime") == 0) {
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_rollback_runtime, FALSE);
+    return;
+  } else if (strcmp(method, "getPluginMetrics") == 0) {
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_get_plugin_metrics, FALSE);
+    return;
+  } else if (strcmp(method, "dumpTrace") == 0) {
+    dispatch_method_call(self, self->runtime_pool, method_call, handle_dump_trace, FALSE);
+    return;
+  }
 
-    g_autofree gchar* runtime_root = runtime_container_root();
-    g_autofree gchar* binary_path = g_build_filename(runtime_root, "sing-box", nullptr);
-    g_autofree gchar* config_path = g_build_filename(runtime_root, "config.json", nullptr);
-    g_autofree gchar* version_path = g_build_filename(runtime_root, "VERSION", nullptr);
-    gboolean binary_exists = g_file_test(binary_path, G_FILE_TEST_EXISTS);
-    gboolean config_exists = g_file_test(config_path, G_FILE_TEST_EXISTS);
-    gchar* runtime_version = nullptr;
-    gsize runtime_version_len = 0;
-    if (!g_file_get_contents(version_path, &runtime_version, &runtime_version_len, nullptr)) {
-      runtime_version = g_strdup("");
+  jumper_sdk_platform::TraceScope trace(self->trace, method, "method");
+  if (strcmp(method, "getPlatformVersion") == 0) {
+    response = get_platform_version();
+  } else if (strcmp(method, "getMainThreadStalls") == 0) {
+    g_autoptr(FlValue) payload = main_thread_stalls_value(self->stalls->Report());
+    FlValue* clear = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                         ? fl_value_lookup_string(args, "clear")
+                         : nullptr;
+    if (clear != nullptr && fl_value_get_type(clear) == FL_VALUE_TYPE_BOOL &&
+        fl_value_get_bool(clear)) {
+      self->stalls->Clear();
     }
-    gchar* runtime_version_trimmed = g_strstrip(runtime_version);
-    gboolean version_matches = g_strcmp0(runtime_version_trimmed, version) == 0;
-
-    g_autoptr(FlValue) payload = fl_value_new_map();
-    fl_value_set_string_take(
-        payload, "ready", fl_value_new_bool(binary_exists && config_exists && version_matches));
-    fl_value_set_string_take(payload, "binaryPath", fl_value_new_string(binary_path));
-    fl_value_set_string_take(payload, "configPath", fl_value_new_string(config_path));
-    fl_value_set_string_take(payload, "binaryExists", fl_value_new_bool(binary_exists));
-    fl_value_set_string_take(payload, "configExists", fl_value_new_bool(config_exists));
-    fl_value_set_string_take(
-        payload, "runtimeVersion", fl_value_new_string(runtime_version_trimmed == nullptr ? "" : runtime_version_trimmed));
-    fl_value_set_string_take(payload, "expectedVersion", fl_value_new_string(version));
-    fl_value_set_string_take(payload, "versionMatches", fl_value_new_bool(version_matches));
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(payload));
-    g_free(runtime_version);
-    g_free(version);
-    g_free(platform_arch);
-    g_free(base_path);
+  } else if (strcmp(method, "setTracing") == 0) {
+    FlValue* enabled = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                           ? fl_value_lookup_string(args, "enabled")
+                           : nullptr;
+    self->trace->SetEnabled(enabled != nullptr &&
+                            fl_value_get_type(enabled) == FL_VALUE_TYPE_BOOL &&
+                            fl_value_get_bool(enabled));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "getRecentLogs") == 0) {
+    response = get_recent_logs(self, args);
+  } else if (strcmp(method, "getCoreState") == 0) {
+    const jumper_sdk_platform::CoreStateSnapshot snapshot = self->core_state->Snapshot();
+    g_autoptr(FlValue) state = core_state_value(snapshot);
+    FlValue* scheduling =
+        snapshot.runtime_mode == "real" && snapshot.pid > 0 ? core_scheduling_value(self) : nullptr;
+    if (scheduling != nullptr) {
+      fl_value_set_string_take(state, "scheduling", scheduling);
+    }
+    FlValue* go_runtime =
+        snapshot.runtime_mode == "real" && snapshot.pid > 0 ? core_go_runtime_value(self) : nullptr;
+    if (go_runtime != nullptr) {
+      fl_value_set_string_take(state, "goRuntime", go_runtime);
+    }
+    const auto instances = self->instances->States();
+    if (!instances.empty()) {
+      FlValue* profile_ids = fl_value_new_list();
+      for (const auto& instance : instances) {
+        fl_value_append_take(profile_ids, fl_value_new_string(instance.profile_id.c_str()));
+      }
+      fl_value_set_string_take(state, "isolatedProfileIds", profile_ids);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(state));
   } else if (strcmp(method, "enableSystemProxy") == 0 ||
              strcmp(method, "disableSystemProxy") == 0 ||
              strcmp(method, "requestNotificationPermission") == 0 ||
@@ -475,6 +3260,12 @@ static void jumper_sdk_platform_plugin_handle_method_call(
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
   }
 
+  // Unknown names are not kept: each would take a series of its own.
+  if (!FL_IS_METHOD_NOT_IMPLEMENTED_RESPONSE(response)) {
+    self->metrics->Record(jumper_sdk_platform::kMethodLatency, method,
+                          jumper_sdk_platform::NanosecondsSince(started_at));
+  }
+  trace.Close();
   fl_method_call_respond(method_call, response, nullptr);
 }
 
@@ -488,34 +3279,169 @@ FlMethodResponse* get_platform_version() {
 
 static void jumper_sdk_platform_plugin_dispose(GObject* object) {
   JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(object);
-  if (self->has_real_process && self->real_pid > 0) {
-    kill(self->real_pid, SIGTERM);
-    g_spawn_close_pid(self->real_pid);
+  // Pending calls hold a reference on the plugin, so all lanes are idle here.
+  if (self->lifecycle_pool != nullptr) {
+    g_thread_pool_free(self->lifecycle_pool, FALSE, TRUE);
+    self->lifecycle_pool = nullptr;
+  }
+  if (self->runtime_pool != nullptr) {
+    g_thread_pool_free(self->runtime_pool, FALSE, TRUE);
+    self->runtime_pool = nullptr;
+  }
+  if (self->instance_pool != nullptr) {
+    g_thread_pool_free(self->instance_pool, FALSE, TRUE);
+    self->instance_pool = nullptr;
+  }
+  // Unlike the main core, isolated ones are stopped and reaped here: nothing
+  // would take them over.
+  delete self->instances;
+  self->instances = nullptr;
+  g_clear_pointer(&self->pending_starts, g_ptr_array_unref);
+  // The host is going away; the core's group is asked to exit, not waited on.
+  if (self->has_real_process && self->real_pid > 0 && kill(-self->real_pid, SIGTERM) != 0) {
+    jumper_sdk_platform::SignalProcess(self->real_pid, self->real_pidfd, SIGTERM);
   }
-  g_clear_pointer(&self->profile_id, g_free);
-  g_clear_pointer(&self->runtime_mode, g_free);
-  g_clear_pointer(&self->network_mode, g_free);
+  discard_core_record(self);
+  clear_exit_watch(self);
+  clear_restart_timer(self);
+  close_core_pidfd(self);
+  delete self->real_controller;
+  self->real_controller = nullptr;
+  delete self->real_config;
+  self->real_config = nullptr;
+  g_clear_pointer(&self->log_capture, core_log_capture_free);
+  if (self->kernel_logs_flush_source != 0) {
+    g_source_remove(self->kernel_logs_flush_source);
+    self->kernel_logs_flush_source = 0;
+  }
+  g_clear_object(&self->kernel_logs_channel);
+  // Joins the stream thread, so no traffic frame is queued after this.
+  delete self->traffic_stream;
+  self->traffic_stream = nullptr;
+  g_clear_object(&self->traffic_channel);
+  delete self->process_stats;
+  self->process_stats = nullptr;
+  g_clear_object(&self->process_stats_channel);
+  delete self->connections;
+  self->connections = nullptr;
+  g_clear_object(&self->connections_channel);
+  delete self->restart_backoff;
+  self->restart_backoff = nullptr;
+  g_clear_object(&self->core_events_channel);
   g_clear_pointer(&self->last_binary_path, g_free);
   g_strfreev(self->last_arguments);
   g_clear_pointer(&self->last_working_directory, g_free);
+  self->last_arguments = nullptr;
+  g_strfreev(self->last_environment);
+  self->last_environment = nullptr;
+  // A core left running keeps its cgroup.
+  delete self->scheduling;
+  self->scheduling = nullptr;
+  delete self->real_cgroup;
+  self->real_cgroup = nullptr;
+  delete self->real_scheduling;
+  self->real_scheduling = nullptr;
+  delete self->real_go_runtime;
+  self->real_go_runtime = nullptr;
+  delete self->metrics;
+  self->metrics = nullptr;
+  delete self->trace;
+  self->trace = nullptr;
+  // Heartbeats still queued find it gone and do nothing.
+  delete self->stalls;
+  self->stalls = nullptr;
   G_OBJECT_CLASS(jumper_sdk_platform_plugin_parent_class)->dispose(object);
 }
 
+static void jumper_sdk_platform_plugin_finalize(GObject* object) {
+  JumperSdkPlatformPlugin* self = JUMPER_SDK_PLATFORM_PLUGIN(object);
+  delete self->kernel_logs;
+  delete self->core_state;
+  g_mutex_clear(&self->state_mutex);
+  G_OBJECT_CLASS(jumper_sdk_platform_plugin_parent_class)->finalize(object);
+}
+
 static void jumper_sdk_platform_plugin_class_init(JumperSdkPlatformPluginClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = jumper_sdk_platform_plugin_dispose;
+  G_OBJECT_CLASS(klass)->finalize = jumper_sdk_platform_plugin_finalize;
 }
 
 static void jumper_sdk_platform_plugin_init(JumperSdkPlatformPlugin* self) {
-  self->is_running = FALSE;
-  self->pid = 0;
-  self->profile_id = nullptr;
-  self->runtime_mode = g_strdup("simulator");
-  self->network_mode = g_strdup("tunnel");
+  self->core_state = new jumper_sdk_platform::CoreStateMachine(kCoreEventReplayCapacity,
+                                                               g_get_real_time() / 1000);
+  g_mutex_init(&self->state_mutex);
   self->real_pid = 0;
+  self->real_pidfd = -1;
   self->has_real_process = FALSE;
+  self->real_started_at = 0;
+  self->real_first_log_seq = 0;
+  self->real_controller = nullptr;
+  self->real_config = nullptr;
+  self->real_record = nullptr;
+  self->real_adopted = FALSE;
+  self->keep_adopted_core = FALSE;
+  self->exit_watch = nullptr;
+  self->restart_backoff =
+      new jumper_sdk_platform::RestartBackoff(jumper_sdk_platform::RestartBackoffOptions());
+  self->restart_timer = nullptr;
   self->last_binary_path = nullptr;
   self->last_arguments = nullptr;
   self->last_working_directory = nullptr;
+  self->last_environment = nullptr;
+  self->scheduling = new jumper_sdk_platform::CoreSchedulingOptions();
+  self->real_cgroup = new jumper_sdk_platform::CgroupPlacement();
+  self->real_scheduling = nullptr;
+  self->go_runtime_profile = jumper_sdk_platform::GoRuntimeProfile::kBalanced;
+  self->real_go_runtime = nullptr;
+  self->metrics = new jumper_sdk_platform::LatencyRegistry();
+  self->trace = new jumper_sdk_platform::TraceRecorder(kTraceCapacity);
+  // Heartbeats go ahead of other sources, so their delay is time the loop
+  // was blocked rather than time it spent on queued work.
+  self->stalls = new jumper_sdk_platform::StallWatchdog(
+      jumper_sdk_platform::StallWatchdogOptions(), [](std::function<void()> task) {
+        g_main_context_invoke_full(nullptr, G_PRIORITY_HIGH, run_main_thread_task,
+                                   new std::function<void()>(std::move(task)),
+                                   free_main_thread_task);
+      });
+  self->stalls->Start();
+  // Set to trace from launch on, before the app can call setTracing.
+  if (g_getenv("JUMPER_TRACE") != nullptr) {
+    self->trace->SetEnabled(true);
+  }
+  self->lifecycle_pool =
+      g_thread_pool_new(method_task_run, nullptr, kLifecycleWorkerCount, FALSE, nullptr);
+  self->runtime_pool =
+      g_thread_pool_new(method_task_run, nullptr, kRuntimeWorkerCount, FALSE, nullptr);
+  g_autofree gchar* runtime_root = runtime_container_root();
+  g_autofree gchar* instances_root = g_build_filename(runtime_root, "instances", nullptr);
+  self->instances = new jumper_sdk_platform::CoreInstanceRegistry(
+      instances_root, kMaxCoreInstances, jumper_sdk_platform::RestartBackoffOptions(),
+      [self](const jumper_sdk_platform::CoreInstanceEvent& event) {
+        on_core_instance_event(self, event);
+      });
+  self->instance_pool =
+      g_thread_pool_new(method_task_run, nullptr, kInstanceWorkerCount, FALSE, nullptr);
+  self->pending_starts = g_ptr_array_new_with_free_func(g_object_unref);
+  self->kernel_logs = new jumper_sdk_platform::KernelLogBuffer(
+      kLogBufferCapacity, kLogLowLevelBudgetPerSecond, kLogSampleRate);
+  self->log_capture = nullptr;
+  self->kernel_logs_channel = nullptr;
+  self->kernel_logs_flush_source = 0;
+  self->kernel_logs_reported_dropped = 0;
+  self->traffic_stream = new jumper_sdk_platform::ClashApiStream(
+      "/traffic", [self](const std::string& line) { on_traffic_line(self, line); });
+  self->traffic_channel = nullptr;
+  self->process_stats = new jumper_sdk_platform::ProcessStatsSampler(
+      "/proc", [self](int pid, const std::vector<jumper_sdk_platform::ProcessStatField>& fields,
+                      bool keyframe) { on_process_stats_sample(self, pid, fields, keyframe); });
+  self->process_stats_channel = nullptr;
+  self->connections = new jumper_sdk_platform::ConnectionsPoller(
+      [self](const jumper_sdk_platform::ConnectionsDelta& delta, bool reset,
+             int64_t timestamp_ms) { on_connections_delta(self, delta, reset, timestamp_ms); });
+  self->connections_channel = nullptr;
+  self->core_events_channel = nullptr;
+  self->core_events_listening = FALSE;
+  self->core_events_delivered_version = 0;
 }
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
@@ -537,5 +3463,41 @@ void jumper_sdk_platform_plugin_register_with_registrar(FlPluginRegistrar* regis
                                             g_object_ref(plugin),
                                             g_object_unref);
 
+  // The method channel keeps the plugin alive; the event channel only
+  // borrows it so the two do not reference each other.
+  plugin->kernel_logs_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "jumper_sdk_platform/kernel_logs",
+                           FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->kernel_logs_channel, kernel_logs_listen_cb,
+                                       kernel_logs_cancel_cb, plugin, nullptr);
+  plugin->traffic_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "jumper_sdk_platform/traffic",
+                           FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->traffic_channel, traffic_listen_cb,
+                                       traffic_cancel_cb, plugin, nullptr);
+  plugin->process_stats_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "jumper_sdk_platform/process_stats",
+                           FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->process_stats_channel, process_stats_listen_cb,
+                                       process_stats_cancel_cb, plugin, nullptr);
+  plugin->connections_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "jumper_sdk_platform/connections",
+                           FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->connections_channel, connections_listen_cb,
+                                       connections_cancel_cb, plugin, nullptr);
+  plugin->core_events_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "jumper_sdk_platform/core_events",
+                           FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->core_events_channel, core_events_listen_cb,
+                                       core_events_cancel_cb, plugin, nullptr);
+
+  // Ahead of any call from Dart on the lifecycle lane.
+  dispatch_method_call(plugin, plugin->lifecycle_pool, nullptr, handle_adopt_core, FALSE);
+
   g_object_unref(plugin);
 }
@@ -0,0 +1,857 @@
+#include <benchmark/benchmark.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef JUMPER_NATIVE_BENCH_GLIB
+#include <glib.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core_config.h"
+#include "core_readiness.h"
+#include "go_runtime_tuning.h"
+#include "latency_metrics.h"
+#include "net_socket.h"
+#include "process_launcher.h"
+#include "runtime_store.h"
+#include "trace_recorder.h"
+#include "worker_lane.h"
+
+// The native core's hot paths, on their own: config scan throughput against
+// the regex extractions it replaced (GRegex only where GLib is installed),
+// the runtime install copy, spawn cost and spawn to ready, latency
+// recording, and what a method call pays to hop onto a worker lane and back. Google Benchmark flags apply; for numbers to
+// diff between commits:
+//
+//   jumper_native_bench --benchmark_out=bench.json --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json
+//
+// compare.py ships in Google Benchmark's tools/ directory. On Linux, each
+// --sing_box binary is also run under every Go runtime profile, pushing
+// data through its mixed inbound; run-runtime-go-tuning-benchmark.sh passes
+// the bundled ones:
+//
+//   jumper_native_bench --benchmark_filter=GoRuntime --sing_box=path/to/sing-box
+//       [--go_runtime_seconds=10] [--go_runtime_connections=8]
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using jumper_sdk_platform::CoreConfig;
+using jumper_sdk_platform::LatencyHistogram;
+using jumper_sdk_platform::LatencyRegistry;
+using jumper_sdk_platform::RuntimeInstallResult;
+using jumper_sdk_platform::RuntimeStore;
+using jumper_sdk_platform::TraceRecorder;
+using jumper_sdk_platform::TraceScope;
+using jumper_sdk_platform::WorkerLane;
+
+constexpr char kServeClashApiFlag[] = "--serve-clash-api";
+constexpr char kSingBoxFlag[] = "--sing_box=";
+constexpr char kGoRuntimeSecondsFlag[] = "--go_runtime_seconds=";
+constexpr char kGoRuntimeConnectionsFlag[] = "--go_runtime_connections=";
+
+// A scratch directory under the system temp directory, removed on exit.
+class ScratchDirectory {
+ public:
+  explicit ScratchDirectory(const std::string& name) {
+    path_ = fs::temp_directory_path() /
+            (name + "-" + std::to_string(std::chrono::steady_clock::now()
+                                             .time_since_epoch()
+                                             .count()));
+    fs::create_directories(path_);
+  }
+  ~ScratchDirectory() {
+    std::error_code ec;
+    fs::remove_all(path_, ec);
+  }
+
+  ScratchDirectory(const ScratchDirectory&) = delete;
+  ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+  std::string File(const std::string& name) const { return (path_ / name).string(); }
+
+ private:
+  fs::path path_;
+};
+
+bool WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(content.data(), static_cast<std::streamsize>(content.size()));
+  return static_cast<bool>(out);
+}
+
+// A profile config of the size subscriptions reach, |outbounds| nodes long.
+std::string GenerateConfig(int outbounds, uint16_t controller_port) {
+  std::string config =
+      "{\"log\":{\"level\":\"info\",\"timestamp\":true},"
+      "\"inbounds\":[{\"type\":\"mixed\",\"tag\":\"mixed-in\",\"listen\":\"127.0.0.1\","
+      "\"listen_port\":17890},{\"type\":\"tun\",\"tag\":\"tun-in\",\"inet4_address\":"
+      "\"172.19.0.1/30\",\"auto_route\":true,\"stack\":\"mixed\"}],\"outbounds\":[";
+  for (int i = 0; i < outbounds; ++i) {
+    if (i > 0) {
+      config += ',';
+    }
+    config += "{\"type\":\"vmess\",\"tag\":\"node-" + std::to_string(i) +
+              "\",\"server\":\"node-" + std::to_string(i) +
+              ".example.com\",\"server_port\":443,\"uuid\":\"5c1f3e2a-9d4b-4a55-8f6e-"
+              "0123456789ab\",\"security\":\"auto\",\"tls\":{\"enabled\":true,"
+              "\"server_name\":\"cdn.example.com\",\"utls\":{\"enabled\":true,"
+              "\"fingerprint\":\"chrome\"}},\"transport\":{\"type\":\"ws\",\"path\":\"/ray\","
+              "\"headers\":{\"Host\":\"cdn.example.com\"}},\"multiplex\":{\"enabled\":false}}";
+  }
+  config +=
+      "],\"route\":{\"rules\":[{\"domain_suffix\":[\"cn\",\"local\"],\"outbound\":\"direct\"}],"
+      "\"final\":\"node-0\"},\"experimental\":{\"cache_file\":{\"enabled\":true},"
+      "\"clash_api\":{\"external_controller\":\"127.0.0.1:" +
+      std::to_string(controller_port) + "\",\"secret\":\"s3cr\\\"et\"}}}";
+  return config;
+}
+
+// The scan every start does before anything is spawned: map the launch
+// config and pull out ports, controller and TUN.
+void BM_ConfigScan(benchmark::State& state) {
+  ScratchDirectory scratch("jumper-native-bench-scan");
+  const std::string path = scratch.File("config.json");
+  const std::string content = GenerateConfig(static_cast<int>(state.range(0)), 19090);
+  if (!WriteFile(path, content)) {
+    state.SkipWithError("Unable to write the config");
+    return;
+  }
+  for (auto _ : state) {
+    CoreConfig config;
+    std::string error;
+    if (!jumper_sdk_platform::ReadCoreConfig(path, &config, &error)) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(config);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_ConfigScan)->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+// The std::regex extraction the Windows plugin used before the scanner: a
+// flat key/value regex over every inbound and over the clash_api object,
+// after reading the whole file.
+void BM_ConfigScanStdRegex(benchmark::State& state) {
+  ScratchDirectory scratch("jumper-native-bench-regex");
+  const std::string path = scratch.File("config.json");
+  const std::string content = GenerateConfig(static_cast<int>(state.range(0)), 19090);
+  if (!WriteFile(path, content)) {
+    state.SkipWithError("Unable to write the config");
+    return;
+  }
+  const std::regex pair_regex(
+      "\"([^\"]+)\"\\s*:\\s*(\"(?:[^\"\\\\]|\\\\.)*\"|true|false|null|-?\\d+(?:\\.\\d+)?)");
+  for (auto _ : state) {
+    std::ifstream in(path, std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t found = 0;
+    const auto parse_flat = [&found, &pair_regex](const std::string& object) {
+      for (std::sregex_iterator it(object.begin(), object.end(), pair_regex), end; it != end;
+           ++it) {
+        ++found;
+      }
+    };
+    const size_t inbounds = text.find("\"inbounds\"");
+    const size_t outbounds = text.find("\"outbounds\"");
+    if (inbounds != std::string::npos && outbounds != std::string::npos) {
+      parse_flat(text.substr(inbounds, outbounds - inbounds));
+    }
+    const size_t clash_api = text.find("\"clash_api\"");
+    if (clash_api != std::string::npos) {
+      parse_flat(text.substr(clash_api, text.find('}', clash_api) - clash_api + 1));
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_ConfigScanStdRegex)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+#ifdef JUMPER_NATIVE_BENCH_GLIB
+gchar* MatchGroup(const gchar* content, const GRegex* regex) {
+  GMatchInfo* match_info = nullptr;
+  gchar* value = nullptr;
+  if (g_regex_match(regex, content, static_cast<GRegexMatchFlags>(0), &match_info)) {
+    value = g_match_info_fetch(match_info, 1);
+  }
+  g_match_info_free(match_info);
+  return value;
+}
+
+// The GRegex extraction the Linux plugin used before the scanner: listen
+// ports, the controller and the clash_api secret, each a regex over the
+// whole file. The patterns are compiled once, outside the timing.
+void BM_ConfigScanGRegex(benchmark::State& state) {
+  ScratchDirectory scratch("jumper-native-bench-gregex");
+  const std::string path = scratch.File("config.json");
+  const std::string content = GenerateConfig(static_cast<int>(state.range(0)), 19090);
+  if (!WriteFile(path, content)) {
+    state.SkipWithError("Unable to write the config");
+    return;
+  }
+  const auto compile = [](const gchar* pattern) {
+    return g_regex_new(pattern, static_cast<GRegexCompileFlags>(0),
+                       static_cast<GRegexMatchFlags>(0), nullptr);
+  };
+  g_autoptr(GRegex) port_regex = compile("\"listen_port\"\\s*:\\s*(\\d+)");
+  g_autoptr(GRegex) controller_regex =
+      compile("\"external_controller\"\\s*:\\s*\"([^\"]*)\"");
+  g_autoptr(GRegex) secret_regex = compile(
+      "\"clash_api\"\\s*:\\s*\\{[^{}]*?"
+      "\"secret\"\\s*:\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+  if (port_regex == nullptr || controller_regex == nullptr || secret_regex == nullptr) {
+    state.SkipWithError("Unable to compile the patterns");
+    return;
+  }
+  for (auto _ : state) {
+    g_autofree gchar* text = nullptr;
+    if (!g_file_get_contents(path.c_str(), &text, nullptr, nullptr)) {
+      state.SkipWithError("Unable to read the config");
+      break;
+    }
+    std::vector<uint16_t> ports;
+    GMatchInfo* match_info = nullptr;
+    g_regex_match(port_regex, text, static_cast<GRegexMatchFlags>(0), &match_info);
+    while (g_match_info_matches(match_info)) {
+      g_autofree gchar* port = g_match_info_fetch(match_info, 1);
+      ports.push_back(static_cast<uint16_t>(g_ascii_strtoull(port, nullptr, 10)));
+      g_match_info_next(match_info, nullptr);
+    }
+    g_match_info_free(match_info);
+    g_autofree gchar* controller = MatchGroup(text, controller_regex);
+    g_autofree gchar* secret = MatchGroup(text, secret_regex);
+    benchmark::DoNotOptimize(ports.data());
+    benchmark::DoNotOptimize(controller);
+    benchmark::DoNotOptimize(secret);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_ConfigScanGRegex)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+#endif  // JUMPER_NATIVE_BENCH_GLIB
+
+// A fresh install of a |range(0)| MiB binary: hash, copy into the
+// container, rename into place and switch. The container is emptied
+// between iterations, outside the timing, so every install copies.
+void BM_RuntimeInstall(benchmark::State& state) {
+  ScratchDirectory scratch("jumper-native-bench-install");
+  const std::string binary = scratch.File("sing-box");
+  const std::string config = scratch.File("config.json");
+  std::string payload(static_cast<size_t>(state.range(0)) << 20, '\0');
+  uint32_t seed = 2463534242u;
+  for (char& byte : payload) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    byte = static_cast<char>(seed);
+  }
+  if (!WriteFile(binary, payload) || !WriteFile(config, GenerateConfig(100, 19090))) {
+    state.SkipWithError("Unable to write the runtime assets");
+    return;
+  }
+  const std::string root = scratch.File("container");
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    state.ResumeTiming();
+    RuntimeStore store(root, "sing-box");
+    RuntimeInstallResult result;
+    std::string error;
+    if (!store.Install("1.0.0", "bench", binary, config, std::string(), &result, &error)) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(payload.size()));
+}
+BENCHMARK(BM_RuntimeInstall)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+
+#ifndef _WIN32
+
+// Stands in for the core: answers every request on 127.0.0.1:|port| with
+// a 200 `/version` body until it is killed. Runs in the child.
+int ServeClashApi(uint16_t port) {
+  const int listener = socket(AF_INET, SOCK_STREAM, 0);
+  const int reuse = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(listener, 16) != 0) {
+    std::perror("serve-clash-api");
+    return 1;
+  }
+  const std::string body = "{\"version\":\"bench\",\"premium\":false}\n";
+  const std::string response =
+      "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+      std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+  for (;;) {
+    const int client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    char request[1024];
+    if (recv(client, request, sizeof(request), 0) > 0) {
+      send(client, response.data(), response.size(), MSG_NOSIGNAL);
+    }
+    close(client);
+  }
+}
+
+// From the spawn call until the Clash API answers, as LaunchCore sees it,
+// with this binary re-executed as the core. The stop is not timed.
+void BM_SpawnToReady(benchmark::State& state) {
+  std::error_code ec;
+  const std::string self = fs::read_symlink("/proc/self/exe", ec).string();
+  if (ec) {
+    state.SkipWithError("Unable to resolve /proc/self/exe");
+    return;
+  }
+  double ready_ms = 0;
+  double probes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint16_t port = jumper_sdk_platform::PickFreeTcpPort();
+    jumper_sdk_platform::SpawnOptions options;
+    options.executable = self;
+    options.arguments = {self, kServeClashApiFlag, std::to_string(port)};
+    options.new_process_group = true;
+    jumper_sdk_platform::ClashApiEndpoint endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = port;
+    state.ResumeTiming();
+
+    const auto started_at = std::chrono::steady_clock::now();
+    jumper_sdk_platform::SpawnedProcess process;
+    std::string error;
+    if (!jumper_sdk_platform::SpawnProcess(options, &process, &error)) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    jumper_sdk_platform::ReadinessHooks hooks;
+    hooks.wait = [](int milliseconds) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+      return true;
+    };
+    hooks.has_exited = [&process](std::string* reason) {
+      if (waitpid(process.pid, nullptr, WNOHANG) != process.pid) {
+        return false;
+      }
+      process.pid = -1;
+      *reason = "The stand-in core exited";
+      return true;
+    };
+    jumper_sdk_platform::ReadinessTimings timings;
+    const auto result = jumper_sdk_platform::WaitForClashApi(endpoint, started_at, 5000, hooks,
+                                                             &timings, &error);
+
+    state.PauseTiming();
+    if (process.pid > 0) {
+      jumper_sdk_platform::StopProcessGroup(process.pid, process.pidfd, 1000);
+    }
+    for (const int fd : {process.pidfd, process.stdout_fd, process.stderr_fd}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    if (result != jumper_sdk_platform::ReadinessResult::kReady) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    ready_ms += timings.ready_ms;
+    probes += timings.probe_attempts;
+    state.ResumeTiming();
+  }
+  state.counters["ready_ms"] = benchmark::Counter(ready_ms, benchmark::Counter::kAvgIterations);
+  state.counters["probes"] = benchmark::Counter(probes, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SpawnToReady)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// |megabytes| MiB of touched private memory, standing in for the Flutter
+// host's heap so fork-style spawns have page tables to copy.
+class Ballast {
+ public:
+  explicit Ballast(int64_t megabytes) : bytes_(static_cast<size_t>(megabytes) << 20) {
+    if (bytes_ == 0) {
+      return;
+    }
+    data_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      return;
+    }
+    std::memset(data_, 1, bytes_);
+  }
+  ~Ballast() {
+    if (data_ != nullptr) {
+      munmap(data_, bytes_);
+    }
+  }
+  Ballast(const Ballast&) = delete;
+  Ballast& operator=(const Ballast&) = delete;
+
+  bool ok() const { return bytes_ == 0 || data_ != nullptr; }
+
+ private:
+  size_t bytes_;
+  void* data_ = nullptr;
+};
+
+// The spawn alone, from a process carrying |range(0)| MiB of ballast. Each
+// child is reaped outside the timing.
+void BM_SpawnWithBallast(benchmark::State& state) {
+  const Ballast ballast(state.range(0));
+  if (!ballast.ok()) {
+    state.SkipWithError("Unable to map the ballast");
+    return;
+  }
+  jumper_sdk_platform::SpawnOptions options;
+  options.executable = "true";
+  options.arguments = {"true"};
+  for (auto _ : state) {
+    jumper_sdk_platform::SpawnedProcess process;
+    std::string error;
+    if (!jumper_sdk_platform::SpawnProcess(options, &process, &error)) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    state.PauseTiming();
+    waitpid(process.pid, nullptr, 0);
+    for (const int fd : {process.pidfd, process.stdout_fd, process.stderr_fd}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_SpawnWithBallast)->Arg(0)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+// The baseline for BM_SpawnWithBallast: a plain fork() and execvp() of the
+// same child, which copies the ballast's page tables as the old GLib launch
+// did. The gap between the two rows at 512 is what the launcher saves.
+void BM_ForkExecWithBallast(benchmark::State& state) {
+  const Ballast ballast(state.range(0));
+  if (!ballast.ok()) {
+    state.SkipWithError("Unable to map the ballast");
+    return;
+  }
+  char program[] = "true";
+  char* const arguments[] = {program, nullptr};
+  for (auto _ : state) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      execvp(program, arguments);
+      _exit(127);
+    }
+    if (pid < 0) {
+      state.SkipWithError("fork failed");
+      break;
+    }
+    state.PauseTiming();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    state.ResumeTiming();
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      state.SkipWithError("Unable to run true");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_ForkExecWithBallast)->Arg(0)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+constexpr int kGoRuntimeReadyTimeoutMs = 10000;
+constexpr int kGoRuntimeStopTimeoutMs = 3000;
+constexpr int kGoRuntimeIoTimeoutMs = 2000;
+constexpr int kGoRuntimeSampleIntervalMs = 100;
+constexpr size_t kGoRuntimeChunkBytes = 64 * 1024;
+
+// Accepts connections on a loopback port and discards what they send.
+class Sink {
+ public:
+  bool Listen() {
+    listener_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener_ < 0 || bind(listener_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        listen(listener_, 64) != 0 ||
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+      return false;
+    }
+    port_ = ntohs(address.sin_port);
+    acceptor_ = std::thread([this] { Accept(); });
+    return true;
+  }
+
+  // Closing the listener ends accept; readers end with their connections.
+  void Close() {
+    shutdown(listener_, SHUT_RDWR);
+    close(listener_);
+    if (acceptor_.joinable()) {
+      acceptor_.join();
+    }
+    for (std::thread& reader : readers_) {
+      reader.join();
+    }
+  }
+
+  uint16_t port() const { return port_; }
+
+ private:
+  void Accept() {
+    int connection = -1;
+    while ((connection = accept4(listener_, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) {
+      readers_.emplace_back([connection] {
+        std::vector<char> buffer(kGoRuntimeChunkBytes);
+        while (read(connection, buffer.data(), buffer.size()) > 0) {
+        }
+        close(connection);
+      });
+    }
+  }
+
+  int listener_ = -1;
+  uint16_t port_ = 0;
+  std::thread acceptor_;
+  std::vector<std::thread> readers_;
+};
+
+// VmRSS or VmHWM, in bytes.
+uint64_t ReadStatusBytes(pid_t pid, const char* field) {
+  std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, std::char_traits<char>::length(field), field) == 0) {
+      return std::strtoull(line.c_str() + line.find(':') + 1, nullptr, 10) * 1024;
+    }
+  }
+  return 0;
+}
+
+// The release directory and the binary, which tells the versions apart.
+std::string BinaryLabel(const std::string& binary) {
+  const size_t name = binary.rfind('/');
+  if (name == std::string::npos || name == 0) {
+    return binary;
+  }
+  const size_t release = binary.rfind('/', name - 1);
+  return release == std::string::npos ? binary : binary.substr(release + 1);
+}
+
+bool WaitForListener(uint16_t port, pid_t pid) {
+  for (int waited = 0; waited < kGoRuntimeReadyTimeoutMs; waited += 50) {
+    if (jumper_sdk_platform::IsTcpPortInUse(port)) {
+      return true;
+    }
+    if (waitpid(pid, nullptr, WNOHANG) == pid) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
+
+// Opens a tunnel to the sink through the inbound's HTTP CONNECT and writes
+// into it until |stop|.
+void Push(uint16_t inbound, uint16_t sink, const std::atomic<bool>* stop,
+          std::atomic<uint64_t>* sent) {
+  jumper_sdk_platform::TcpConnection connection;
+  const std::string target = "127.0.0.1:" + std::to_string(sink);
+  const std::string request =
+      "CONNECT " + target + " HTTP/1.1\r\nHost: " + target + "\r\n\r\n";
+  if (!connection.Connect("127.0.0.1", inbound, kGoRuntimeIoTimeoutMs, nullptr) ||
+      !connection.SendAll(request.data(), request.size(), kGoRuntimeIoTimeoutMs, nullptr)) {
+    return;
+  }
+  std::string response;
+  char buffer[256];
+  while (response.find("\r\n\r\n") == std::string::npos) {
+    const int received =
+        connection.Receive(buffer, sizeof(buffer), kGoRuntimeIoTimeoutMs, nullptr);
+    if (received <= 0) {
+      return;
+    }
+    response.append(buffer, received);
+  }
+  if (response.compare(0, 12, "HTTP/1.1 200") != 0) {
+    return;
+  }
+  const std::vector<char> chunk(kGoRuntimeChunkBytes, 'x');
+  while (!stop->load() &&
+         connection.SendAll(chunk.data(), chunk.size(), kGoRuntimeIoTimeoutMs, nullptr)) {
+    sent->fetch_add(chunk.size());
+  }
+}
+
+// One sing-box binary under one Go runtime profile, with the variables the
+// plugin would give it on this machine, for |seconds| of |connections|
+// pushing through its mixed inbound. Registered from main for each
+// --sing_box; the variables go in the label.
+void BM_GoRuntime(benchmark::State& state,
+                  std::string binary,
+                  jumper_sdk_platform::GoRuntimeProfile profile,
+                  int seconds,
+                  int connections) {
+  const jumper_sdk_platform::GoRuntimeTuning tuning =
+      jumper_sdk_platform::TuneGoRuntime(profile, jumper_sdk_platform::ReadMachineResources());
+  std::string settings;
+  for (const auto& [key, value] : tuning.environment) {
+    settings += (settings.empty() ? "" : " ") + key + "=" + value;
+  }
+  state.SetLabel(settings.empty() ? "-" : settings);
+  ScratchDirectory scratch("jumper-native-bench-go-runtime");
+  const std::string config_path = scratch.File("config.json");
+  const uint16_t inbound = jumper_sdk_platform::PickFreeTcpPort();
+  Sink sink;
+  if (inbound == 0 ||
+      !WriteFile(config_path,
+                 R"({"log":{"level":"error"},"inbounds":[{"type":"mixed","tag":"mixed-in",)"
+                 R"("listen":"127.0.0.1","listen_port":)" +
+                     std::to_string(inbound) +
+                     R"(}],"outbounds":[{"type":"direct","tag":"direct"}]})") ||
+      !sink.Listen()) {
+    state.SkipWithError("No port, config or sink");
+    return;
+  }
+
+  jumper_sdk_platform::SpawnOptions spawn;
+  spawn.executable = binary;
+  spawn.arguments = {binary, "run", "--disable-color", "-c", config_path, "-D",
+                     scratch.File("")};
+  spawn.environment = tuning.environment;
+  spawn.new_process_group = true;
+  spawn.output_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  jumper_sdk_platform::SpawnedProcess process;
+  std::string error;
+  const bool started = jumper_sdk_platform::SpawnProcess(spawn, &process, &error);
+  close(spawn.output_fd);
+  if (!started || !WaitForListener(inbound, process.pid)) {
+    if (started) {
+      jumper_sdk_platform::StopProcessGroup(process.pid, process.pidfd, kGoRuntimeStopTimeoutMs);
+    }
+    sink.Close();
+    state.SkipWithError(("The core did not come up " + error).c_str());
+    return;
+  }
+
+  const uint64_t idle_rss = ReadStatusBytes(process.pid, "VmRSS");
+  std::atomic<uint64_t> sent{0};
+  uint64_t rss_sum = 0;
+  int samples = 0;
+  for (auto _ : state) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> pushers;
+    const auto started_at = std::chrono::steady_clock::now();
+    for (int i = 0; i < connections; ++i) {
+      pushers.emplace_back(Push, inbound, sink.port(), &stop, &sent);
+    }
+    while (std::chrono::steady_clock::now() - started_at < std::chrono::seconds(seconds)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kGoRuntimeSampleIntervalMs));
+      rss_sum += ReadStatusBytes(process.pid, "VmRSS");
+      ++samples;
+    }
+    stop = true;
+    for (std::thread& pusher : pushers) {
+      pusher.join();
+    }
+  }
+  const uint64_t peak_rss = ReadStatusBytes(process.pid, "VmHWM");
+  jumper_sdk_platform::StopProcessGroup(process.pid, process.pidfd, kGoRuntimeStopTimeoutMs);
+  if (process.pidfd >= 0) {
+    close(process.pidfd);
+  }
+  sink.Close();
+
+  constexpr double kMiB = 1024.0 * 1024.0;
+  state.SetBytesProcessed(static_cast<int64_t>(sent.load()));
+  state.counters["idle_rss_mib"] = idle_rss / kMiB;
+  state.counters["avg_rss_mib"] = samples > 0 ? rss_sum / samples / kMiB : 0.0;
+  state.counters["peak_rss_mib"] = peak_rss / kMiB;
+}
+
+// Registers BM_GoRuntime for every binary and profile.
+void RegisterGoRuntimeBenchmarks(const std::vector<std::string>& binaries,
+                                 int seconds,
+                                 int connections) {
+  const jumper_sdk_platform::GoRuntimeProfile profiles[] = {
+      jumper_sdk_platform::GoRuntimeProfile::kOff,
+      jumper_sdk_platform::GoRuntimeProfile::kLowMemory,
+      jumper_sdk_platform::GoRuntimeProfile::kBalanced,
+      jumper_sdk_platform::GoRuntimeProfile::kThroughput,
+  };
+  for (const std::string& binary : binaries) {
+    for (const auto profile : profiles) {
+      const std::string name = "BM_GoRuntime/" + BinaryLabel(binary) + "/" +
+                               jumper_sdk_platform::GoRuntimeProfileName(profile);
+      benchmark::RegisterBenchmark(name.c_str(), BM_GoRuntime, binary, profile, seconds,
+                                   connections)
+          ->Iterations(1)
+          ->Unit(benchmark::kSecond)
+          ->UseRealTime();
+    }
+  }
+}
+
+#endif  // _WIN32
+
+// What timing a method call costs: recording into a histogram, looking the
+// series up first as dispatch does, and the two clock reads around the
+// handler, each from one thread and from several contending ones.
+LatencyRegistry& SharedRegistry() {
+  static LatencyRegistry registry;
+  return registry;
+}
+
+void BM_LatencyRecord(benchmark::State& state) {
+  LatencyHistogram* histogram =
+      SharedRegistry().Find(jumper_sdk_platform::kMethodLatency, "stopCore");
+  const int64_t scale = state.thread_index() + 1;
+  int64_t i = 0;
+  for (auto _ : state) {
+    histogram->Record(1000 + (i++ & 0xffff) * scale);
+  }
+}
+BENCHMARK(BM_LatencyRecord)->ThreadRange(1, 4);
+
+void BM_LatencyFindAndRecord(benchmark::State& state) {
+  const int64_t scale = state.thread_index() + 1;
+  int64_t i = 0;
+  for (auto _ : state) {
+    SharedRegistry().Record(jumper_sdk_platform::kMethodLatency, "getCoreState",
+                            1000 + (i++ & 0xffff) * scale);
+  }
+}
+BENCHMARK(BM_LatencyFindAndRecord)->ThreadRange(1, 4);
+
+// The histogram holds only the time between the clock reads, so its
+// quantiles are theirs.
+void BM_LatencyClockAndRecord(benchmark::State& state) {
+  LatencyHistogram* histogram =
+      SharedRegistry().Find(jumper_sdk_platform::kMethodLatency, "getPlatformVersion");
+  for (auto _ : state) {
+    const auto started = std::chrono::steady_clock::now();
+    histogram->Record(jumper_sdk_platform::NanosecondsSince(started));
+  }
+  if (state.thread_index() == 0) {
+    const jumper_sdk_platform::LatencySnapshot snapshot = histogram->Snapshot();
+    state.counters["p50_ns"] = static_cast<double>(snapshot.ValueAtQuantile(0.5));
+    state.counters["p99_ns"] = static_cast<double>(snapshot.ValueAtQuantile(0.99));
+  }
+}
+BENCHMARK(BM_LatencyClockAndRecord)->ThreadRange(1, 4);
+
+// One method call through the path the Windows plugin's ScheduleMethodCall
+// takes: histogram lookups, a post to the runtime lane, the queue and
+// method spans, and the reply handed back to the calling thread, which
+// stands in for the platform thread. range(0) turns tracing on.
+void BM_MethodDispatch(benchmark::State& state) {
+  WorkerLane lane(2);
+  LatencyRegistry metrics;
+  TraceRecorder trace(16384);
+  trace.SetEnabled(state.range(0) != 0);
+  std::mutex mutex;
+  std::condition_variable replied;
+  uint64_t replies = 0;
+  uint64_t calls = 0;
+  for (auto _ : state) {
+    LatencyHistogram* queue_latency =
+        metrics.Find(jumper_sdk_platform::kMethodQueueLatency, "getCoreState");
+    LatencyHistogram* latency = metrics.Find(jumper_sdk_platform::kMethodLatency, "getCoreState");
+    const int64_t queued_ns = TraceRecorder::NowNanoseconds();
+    lane.Post([&, queue_latency, latency, queued_ns]() {
+      const int64_t started_ns = TraceRecorder::NowNanoseconds();
+      queue_latency->Record(started_ns - queued_ns);
+      trace.Complete("getCoreState", "queue", queued_ns, started_ns);
+      {
+        TraceScope scope(&trace, "getCoreState", "method");
+      }
+      latency->Record(TraceRecorder::NowNanoseconds() - started_ns);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++replies;
+      }
+      replied.notify_one();
+    });
+    ++calls;
+    std::unique_lock<std::mutex> lock(mutex);
+    replied.wait(lock, [&] { return replies == calls; });
+  }
+  lane.Shutdown();
+}
+BENCHMARK(BM_MethodDispatch)->Arg(0)->Arg(1)->UseRealTime();
+
+}  // namespace
+
+int main(int argc, char** argv) {
+#ifndef _WIN32
+  if (argc == 3 && std::strcmp(argv[1], kServeClashApiFlag) == 0) {
+    return ServeClashApi(static_cast<uint16_t>(std::atoi(argv[2])));
+  }
+#endif
+  // Our own flags are taken out before Google Benchmark sees the rest.
+  std::vector<std::string> sing_boxes;
+  int go_runtime_seconds = 10;
+  int go_runtime_connections = 8;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    const auto value_of = [&](const char* flag) -> const char* {
+      return std::strncmp(argv[i], flag, std::strlen(flag)) == 0 ? argv[i] + std::strlen(flag)
+                                                                 : nullptr;
+    };
+    if (const char* value = value_of(kSingBoxFlag)) {
+      sing_boxes.emplace_back(value);
+    } else if (const char* value = value_of(kGoRuntimeSecondsFlag)) {
+      go_runtime_seconds = std::max(std::atoi(value), 1);
+    } else if (const char* value = value_of(kGoRuntimeConnectionsFlag)) {
+      go_runtime_connections = std::max(std::atoi(value), 1);
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argc = kept;
+#ifndef _WIN32
+  RegisterGoRuntimeBenchmarks(sing_boxes, go_runtime_seconds, go_runtime_connections);
+#endif
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
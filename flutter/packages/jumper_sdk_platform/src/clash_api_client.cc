@@ -0,0 +1,221 @@
+#include "clash_api_client.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include "net_socket.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr size_t kMaxResponseBytes = 8 * 1024 * 1024;
+
+int RemainingMs(std::chrono::steady_clock::time_point deadline) {
+  const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+  return remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+}
+
+std::string ToLower(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+// Returns the value of |name| from a raw header block, or an empty string.
+std::string HeaderValue(const std::string& headers, const std::string& name) {
+  const std::string lowered = ToLower(headers);
+  const std::string needle = "\r\n" + ToLower(name) + ":";
+  const size_t start = lowered.find(needle);
+  if (start == std::string::npos) {
+    return "";
+  }
+  size_t value_start = start + needle.size();
+  const size_t value_end = headers.find("\r\n", value_start);
+  while (value_start < headers.size() && headers[value_start] == ' ') {
+    ++value_start;
+  }
+  return headers.substr(value_start, value_end == std::string::npos
+                                         ? std::string::npos
+                                         : value_end - value_start);
+}
+
+bool DecodeChunkedBody(const std::string& raw, std::string* body) {
+  body->clear();
+  size_t offset = 0;
+  while (offset < raw.size()) {
+    const size_t line_end = raw.find("\r\n", offset);
+    if (line_end == std::string::npos) {
+      return false;
+    }
+    const size_t chunk_size =
+        std::strtoul(raw.substr(offset, line_end - offset).c_str(), nullptr, 16);
+    offset = line_end + 2;
+    if (chunk_size == 0) {
+      return true;
+    }
+    if (offset + chunk_size > raw.size()) {
+      return false;
+    }
+    body->append(raw, offset, chunk_size);
+    offset += chunk_size + 2;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ParseExternalController(const std::string& controller, ClashApiEndpoint* endpoint) {
+  std::string value = controller;
+  value.erase(0, value.find_first_not_of(" \t"));
+  value.erase(value.find_last_not_of(" \t") + 1);
+  if (value.rfind("http://", 0) == 0) {
+    value.erase(0, 7);
+  }
+  while (!value.empty() && value.back() == '/') {
+    value.pop_back();
+  }
+
+  std::string host;
+  std::string port_text;
+  if (!value.empty() && value.front() == '[') {
+    const size_t close = value.find(']');
+    if (close == std::string::npos || close + 1 >= value.size() || value[close + 1] != ':') {
+      return false;
+    }
+    host = value.substr(1, close - 1);
+    port_text = value.substr(close + 2);
+  } else {
+    const size_t colon = value.rfind(':');
+    if (colon == std::string::npos) {
+      return false;
+    }
+    host = value.substr(0, colon);
+    port_text = value.substr(colon + 1);
+  }
+  if (port_text.empty() ||
+      !std::all_of(port_text.begin(), port_text.end(),
+                   [](unsigned char c) { return std::isdigit(c) != 0; })) {
+    return false;
+  }
+  const unsigned long port = std::strtoul(port_text.c_str(), nullptr, 10);
+  if (port == 0 || port > 65535) {
+    return false;
+  }
+  if (host.empty() || host == "0.0.0.0") {
+    host = "127.0.0.1";
+  } else if (host == "::") {
+    host = "::1";
+  }
+  endpoint->host = host;
+  endpoint->port = static_cast<uint16_t>(port);
+  return true;
+}
+
+std::string BuildClashApiRequest(const ClashApiEndpoint& endpoint,
+                                 const std::string& method,
+                                 const std::string& path,
+                                 const std::string& body) {
+  const bool ipv6_literal = endpoint.host.find(':') != std::string::npos;
+  std::string request = method + " " + path + " HTTP/1.1\r\nHost: " +
+                        (ipv6_literal ? "[" + endpoint.host + "]" : endpoint.host) + ":" +
+                        std::to_string(endpoint.port) + "\r\n";
+  if (!endpoint.secret.empty()) {
+    request += "Authorization: Bearer " + endpoint.secret + "\r\n";
+  }
+  if (!body.empty()) {
+    request += "Content-Type: application/json\r\nContent-Length: " +
+               std::to_string(body.size()) + "\r\n";
+  }
+  request += "Connection: close\r\n\r\n";
+  request += body;
+  return request;
+}
+
+bool SendClashApiRequest(const ClashApiEndpoint& endpoint,
+                         const std::string& method,
+                         const std::string& path,
+                         const std::string& body,
+                         int timeout_ms,
+                         HttpResponse* response,
+                         std::string* error) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  TcpConnection connection;
+  if (!connection.Connect(endpoint.host, endpoint.port, RemainingMs(deadline), error)) {
+    return false;
+  }
+
+  const std::string request = BuildClashApiRequest(endpoint, method, path, body);
+  if (!connection.SendAll(request.data(), request.size(), RemainingMs(deadline), error)) {
+    return false;
+  }
+
+  std::string raw;
+  char buffer[4096];
+  size_t header_end = std::string::npos;
+  size_t content_length = std::string::npos;
+  for (;;) {
+    const int received = connection.Receive(buffer, sizeof(buffer), RemainingMs(deadline), error);
+    if (received < 0) {
+      return false;
+    }
+    if (received == 0) {
+      break;
+    }
+    if (raw.empty()) {
+      response->first_byte_at = std::chrono::steady_clock::now();
+    }
+    raw.append(buffer, static_cast<size_t>(received));
+    if (raw.size() > kMaxResponseBytes) {
+      if (error != nullptr) {
+        *error = "Response from " + path + " is too large";
+      }
+      return false;
+    }
+    if (header_end == std::string::npos) {
+      header_end = raw.find("\r\n\r\n");
+      if (header_end != std::string::npos) {
+        const std::string length = HeaderValue(raw.substr(0, header_end + 2), "Content-Length");
+        if (!length.empty()) {
+          content_length = std::strtoul(length.c_str(), nullptr, 10);
+        }
+      }
+    }
+    if (header_end != std::string::npos && content_length != std::string::npos &&
+        raw.size() >= header_end + 4 + content_length) {
+      break;
+    }
+  }
+
+  if (header_end == std::string::npos || raw.compare(0, 5, "HTTP/") != 0) {
+    if (error != nullptr) {
+      *error = "Malformed HTTP response from " + path;
+    }
+    return false;
+  }
+  const size_t status_start = raw.find(' ');
+  response->status = status_start == std::string::npos
+                         ? 0
+                         : std::atoi(raw.c_str() + status_start + 1);
+  const std::string headers = raw.substr(0, header_end + 2);
+  std::string payload = raw.substr(header_end + 4);
+  if (ToLower(HeaderValue(headers, "Transfer-Encoding")) == "chunked") {
+    if (!DecodeChunkedBody(payload, &response->body)) {
+      if (error != nullptr) {
+        *error = "Truncated chunked response from " + path;
+      }
+      return false;
+    }
+  } else {
+    if (content_length != std::string::npos && payload.size() > content_length) {
+      payload.resize(content_length);
+    }
+    response->body = std::move(payload);
+  }
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
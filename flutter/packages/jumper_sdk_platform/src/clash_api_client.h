@@ -0,0 +1,48 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_CLIENT_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_CLIENT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace jumper_sdk_platform {
+
+// Where the core serves its Clash-compatible REST API, taken from
+// `experimental.clash_api` in the launch config.
+struct ClashApiEndpoint {
+  std::string host;
+  uint16_t port = 0;
+  std::string secret;
+};
+
+// Parses an `external_controller` value such as "127.0.0.1:9090", ":9090" or
+// "[::1]:9090". Wildcard and empty hosts are mapped to loopback.
+bool ParseExternalController(const std::string& controller, ClashApiEndpoint* endpoint);
+
+struct HttpResponse {
+  int status = 0;
+  std::string body;
+  // When the first byte of the response arrived.
+  std::chrono::steady_clock::time_point first_byte_at;
+};
+
+// Serializes an HTTP/1.1 request with `Connection: close` and the bearer
+// secret, if any.
+std::string BuildClashApiRequest(const ClashApiEndpoint& endpoint,
+                                 const std::string& method,
+                                 const std::string& path,
+                                 const std::string& body);
+
+// Sends one HTTP/1.1 request with `Connection: close` and reads the whole
+// response. Fails if the exchange takes longer than |timeout_ms|.
+bool SendClashApiRequest(const ClashApiEndpoint& endpoint,
+                         const std::string& method,
+                         const std::string& path,
+                         const std::string& body,
+                         int timeout_ms,
+                         HttpResponse* response,
+                         std::string* error);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_CLIENT_H_
@@ -0,0 +1,274 @@
+#include "clash_api_stream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+
+#include "kernel_log_buffer.h"
+#include "net_socket.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr int kConnectTimeoutMs = 1000;
+// How often a quiet connection checks whether it is still wanted.
+constexpr int kPollIntervalMs = 200;
+// /traffic and /memory emit every second; a connection silent for this long
+// is assumed dead and replaced.
+constexpr int kStallTimeoutMs = 5000;
+constexpr int kInitialBackoffMs = 100;
+constexpr int kMaxBackoffMs = 2000;
+constexpr size_t kMaxHeaderBytes = 16 * 1024;
+constexpr size_t kMaxLineBytes = 64 * 1024;
+
+// Incremental decoder for a `Transfer-Encoding: chunked` body.
+class ChunkedDecoder {
+ public:
+  // Appends the payload bytes in |data| to |out|. Returns false once the
+  // terminating chunk arrives or the framing is broken.
+  bool Feed(const char* data, size_t length, std::string* out) {
+    size_t index = 0;
+    while (index < length) {
+      switch (state_) {
+        case State::kSize: {
+          const char c = data[index++];
+          if (c != '\n') {
+            if (size_line_.size() >= 32) {
+              return false;
+            }
+            size_line_.push_back(c);
+            break;
+          }
+          remaining_ = std::strtoul(size_line_.c_str(), nullptr, 16);
+          size_line_.clear();
+          if (remaining_ == 0) {
+            return false;
+          }
+          state_ = State::kData;
+          break;
+        }
+        case State::kData: {
+          const size_t count = std::min(remaining_, length - index);
+          out->append(data + index, count);
+          index += count;
+          remaining_ -= count;
+          if (remaining_ == 0) {
+            state_ = State::kDataEnd;
+          }
+          break;
+        }
+        case State::kDataEnd:
+          if (data[index++] == '\n') {
+            state_ = State::kSize;
+          }
+          break;
+      }
+    }
+    return true;
+  }
+
+ private:
+  enum class State { kSize, kData, kDataEnd };
+
+  State state_ = State::kSize;
+  std::string size_line_;
+  size_t remaining_ = 0;
+};
+
+bool FindJsonInteger(const std::string& json, const char* key, int64_t* value) {
+  const std::string needle = std::string("\"") + key + "\"";
+  size_t index = json.find(needle);
+  if (index == std::string::npos) {
+    return false;
+  }
+  index = json.find(':', index + needle.size());
+  if (index == std::string::npos) {
+    return false;
+  }
+  const char* start = json.c_str() + index + 1;
+  char* end = nullptr;
+  const long long parsed = std::strtoll(start, &end, 10);
+  if (end == start) {
+    return false;
+  }
+  *value = parsed;
+  return true;
+}
+
+}  // namespace
+
+ClashApiStream::ClashApiStream(std::string path, LineCallback on_line)
+    : path_(std::move(path)), on_line_(std::move(on_line)) {
+  thread_ = std::thread(&ClashApiStream::Run, this);
+}
+
+ClashApiStream::~ClashApiStream() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void ClashApiStream::SetEndpoint(const ClashApiEndpoint& endpoint) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoint_ = endpoint;
+    has_endpoint_ = true;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ClashApiStream::ClearEndpoint() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_endpoint_ = false;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ClashApiStream::SetActive(bool active) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active_ == active) {
+      return;
+    }
+    active_ = active;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ClashApiStream::Run() {
+  int backoff_ms = kInitialBackoffMs;
+  for (;;) {
+    ClashApiEndpoint endpoint;
+    uint64_t generation = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || (active_ && has_endpoint_); });
+      if (stopping_) {
+        return;
+      }
+      endpoint = endpoint_;
+      generation = generation_;
+    }
+
+    if (StreamOnce(endpoint, generation)) {
+      backoff_ms = kInitialBackoffMs;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (generation_ != generation) {
+      // New endpoint or listener: connect right away.
+      backoff_ms = kInitialBackoffMs;
+      continue;
+    }
+    wake_.wait_for(lock, std::chrono::milliseconds(backoff_ms),
+                   [this, generation] { return stopping_ || generation_ != generation; });
+    backoff_ms = std::min(backoff_ms * 2, kMaxBackoffMs);
+  }
+}
+
+bool ClashApiStream::StreamOnce(const ClashApiEndpoint& endpoint, uint64_t generation) {
+  TcpConnection connection;
+  std::string error;
+  if (!connection.Connect(endpoint.host, endpoint.port, kConnectTimeoutMs, &error)) {
+    return false;
+  }
+  const std::string request = BuildClashApiRequest(endpoint, "GET", path_, "");
+  if (!connection.SendAll(request.data(), request.size(), kConnectTimeoutMs, &error)) {
+    return false;
+  }
+
+  bool received_line = false;
+  LogLineFramer framer(kMaxLineBytes);
+  const auto on_line = [this, &received_line](std::string line) {
+    received_line = true;
+    on_line_(line);
+  };
+  ChunkedDecoder decoder;
+  std::string head;
+  std::string payload;
+  bool in_body = false;
+  bool chunked = false;
+  char buffer[4096];
+  auto last_data_at = std::chrono::steady_clock::now();
+  while (IsCurrent(generation)) {
+    if (!connection.WaitReadable(kPollIntervalMs)) {
+      if (std::chrono::steady_clock::now() - last_data_at >
+          std::chrono::milliseconds(kStallTimeoutMs)) {
+        break;
+      }
+      continue;
+    }
+    const int received = connection.Receive(buffer, sizeof(buffer), 0, &error);
+    if (received <= 0) {
+      break;
+    }
+    last_data_at = std::chrono::steady_clock::now();
+
+    const char* data = buffer;
+    size_t length = static_cast<size_t>(received);
+    if (!in_body) {
+      head.append(buffer, length);
+      const size_t header_end = head.find("\r\n\r\n");
+      if (header_end == std::string::npos) {
+        if (head.size() > kMaxHeaderBytes) {
+          break;
+        }
+        continue;
+      }
+      const size_t status_start = head.find(' ');
+      if (head.compare(0, 5, "HTTP/") != 0 || status_start == std::string::npos ||
+          std::atoi(head.c_str() + status_start + 1) != 200) {
+        break;
+      }
+      std::string headers = head.substr(0, header_end);
+      std::transform(headers.begin(), headers.end(), headers.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      chunked = headers.find("\r\ntransfer-encoding: chunked") != std::string::npos;
+      in_body = true;
+      head.erase(0, header_end + 4);
+      data = head.data();
+      length = head.size();
+    }
+
+    if (chunked) {
+      payload.clear();
+      const bool more = decoder.Feed(data, length, &payload);
+      framer.Feed(payload.data(), payload.size(), on_line);
+      if (!more) {
+        break;
+      }
+    } else {
+      framer.Feed(data, length, on_line);
+    }
+    head.clear();
+  }
+  return received_line;
+}
+
+bool ClashApiStream::IsCurrent(uint64_t generation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !stopping_ && generation_ == generation;
+}
+
+bool ParseTrafficSample(const std::string& line, int64_t timestamp_ms, TrafficSample* sample) {
+  int64_t up = 0;
+  int64_t down = 0;
+  if (!FindJsonInteger(line, "up", &up) || !FindJsonInteger(line, "down", &down)) {
+    return false;
+  }
+  sample->up = up;
+  sample->down = down;
+  sample->timestamp_ms = timestamp_ms;
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_STREAM_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_STREAM_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "clash_api_client.h"
+
+namespace jumper_sdk_platform {
+
+// Holds one long-lived GET on a streaming Clash API endpoint such as
+// /traffic, which answers with one JSON document per line for as long as the
+// connection stays open. Lines are handed to |on_line| on the stream's own
+// thread.
+//
+// The stream only connects while it is active and has an endpoint. It
+// reconnects with a capped backoff when the core drops the connection, and
+// moves to the new endpoint as soon as SetEndpoint is called, so a restarted
+// core is picked up without the listener noticing.
+class ClashApiStream {
+ public:
+  using LineCallback = std::function<void(const std::string& line)>;
+
+  ClashApiStream(std::string path, LineCallback on_line);
+  ~ClashApiStream();
+
+  ClashApiStream(const ClashApiStream&) = delete;
+  ClashApiStream& operator=(const ClashApiStream&) = delete;
+
+  void SetEndpoint(const ClashApiEndpoint& endpoint);
+  void ClearEndpoint();
+  // Starts or stops streaming, e.g. when a Dart listener attaches or leaves.
+  void SetActive(bool active);
+
+ private:
+  void Run();
+  // Streams from |endpoint| until the connection ends or the generation
+  // changes. Returns true if any line was received.
+  bool StreamOnce(const ClashApiEndpoint& endpoint, uint64_t generation);
+  bool IsCurrent(uint64_t generation);
+
+  const std::string path_;
+  const LineCallback on_line_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  ClashApiEndpoint endpoint_;
+  bool has_endpoint_ = false;
+  bool active_ = false;
+  bool stopping_ = false;
+  // Bumped on every change so the streaming thread drops a stale connection.
+  uint64_t generation_ = 0;
+  std::thread thread_;
+};
+
+// One /traffic sample: bytes per second in each direction.
+struct TrafficSample {
+  int64_t up = 0;
+  int64_t down = 0;
+  int64_t timestamp_ms = 0;
+};
+
+// Parses a line such as `{"up":120,"down":4096}`.
+bool ParseTrafficSample(const std::string& line, int64_t timestamp_ms, TrafficSample* sample);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CLASH_API_STREAM_H_
@@ -0,0 +1,345 @@
+#include "config_planner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "core_config.h"
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+bool IsJsonSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Appends |json| without the whitespace between tokens, so reformatting a
+// config does not count as a change.
+void AppendCompact(std::string_view json, std::string* out) {
+  bool in_string = false;
+  bool escaped = false;
+  for (const char c : json) {
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+    } else if (c == '"') {
+      in_string = true;
+    } else if (IsJsonSpace(c)) {
+      continue;
+    }
+    out->push_back(c);
+  }
+}
+
+void AppendMember(std::string_view key, std::string_view value, std::string* out) {
+  out->push_back('"');
+  out->append(key);
+  out->append("\":");
+  AppendCompact(value, out);
+  out->push_back(',');
+}
+
+void AppendStringMember(std::string_view key, std::string_view raw, std::string* out) {
+  out->push_back('"');
+  out->append(key);
+  out->append("\":\"");
+  out->append(raw);
+  out->append("\",");
+}
+
+void SkipMember(JsonScanner* scanner, std::string_view key, std::string* out) {
+  std::string_view value;
+  if (scanner->SkipSpan(&value)) {
+    AppendMember(key, value, out);
+  }
+}
+
+// One element of `outbounds`. The type is only known once the object is
+// closed, so the members are collected first.
+void ScanOutbound(JsonScanner* scanner, ConfigShape* shape) {
+  if (scanner->Peek() != JsonType::kObject) {
+    std::string_view value;
+    if (scanner->SkipSpan(&value)) {
+      AppendCompact(value, &shape->fixed);
+    }
+    return;
+  }
+  scanner->EnterObject();
+  std::string members;
+  std::string_view type;
+  std::string_view tag;
+  std::string_view selected;
+  bool has_default = false;
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    const bool is_string = scanner->Peek() == JsonType::kString;
+    if (key == "default" && is_string) {
+      has_default = scanner->ReadString(&selected);
+    } else if ((key == "type" || key == "tag") && is_string) {
+      std::string_view value;
+      if (scanner->ReadString(&value)) {
+        (key == "type" ? type : tag) = value;
+        AppendStringMember(key, value, &members);
+      }
+    } else {
+      SkipMember(scanner, key, &members);
+    }
+  }
+  const bool is_selector = type == "selector";
+  if (has_default && !is_selector) {
+    AppendStringMember("default", selected, &members);
+  }
+  shape->fixed.push_back('{');
+  shape->fixed.append(members);
+  shape->fixed.push_back('}');
+  if (is_selector) {
+    SelectorChoice choice;
+    choice.tag = UnescapeJsonString(tag);
+    choice.has_default = has_default;
+    if (has_default) {
+      choice.selected = UnescapeJsonString(selected);
+    }
+    shape->selectors.push_back(std::move(choice));
+  }
+}
+
+void ScanClashApi(JsonScanner* scanner, ConfigShape* shape) {
+  scanner->EnterObject();
+  shape->fixed.append("\"clash_api\":{");
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    std::string_view mode;
+    if (key != "default_mode" || scanner->Peek() != JsonType::kString) {
+      SkipMember(scanner, key, &shape->fixed);
+    } else if (scanner->ReadString(&mode)) {
+      shape->clash_mode = UnescapeJsonString(mode);
+    }
+  }
+  shape->fixed.append("},");
+}
+
+bool IsUnreserved(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+         c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+// Outbound tags are free text; the Clash API takes them as a path segment.
+std::string EncodePathSegment(const std::string& value) {
+  static const char kHex[] = "0123456789ABCDEF";
+  std::string encoded;
+  encoded.reserve(value.size());
+  for (const char c : value) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (IsUnreserved(byte)) {
+      encoded.push_back(c);
+    } else {
+      encoded.push_back('%');
+      encoded.push_back(kHex[byte >> 4]);
+      encoded.push_back(kHex[byte & 0x0f]);
+    }
+  }
+  return encoded;
+}
+
+ConfigPlan Fallback(bool can_reload, const char* reason) {
+  ConfigPlan plan;
+  plan.kind = can_reload ? ConfigPlanKind::kReload : ConfigPlanKind::kRestart;
+  plan.reason = reason;
+  return plan;
+}
+
+}  // namespace
+
+bool ScanConfigShape(std::string_view content, ConfigShape* shape, std::string* error) {
+  *shape = ConfigShape();
+  JsonScanner scanner(content);
+  std::string_view key;
+  if (scanner.EnterObject()) {
+    shape->fixed.push_back('{');
+    while (scanner.NextMember(&key)) {
+      if (key == "outbounds" && scanner.Peek() == JsonType::kArray) {
+        scanner.EnterArray();
+        shape->fixed.append("\"outbounds\":[");
+        while (scanner.NextElement()) {
+          ScanOutbound(&scanner, shape);
+          shape->fixed.push_back(',');
+        }
+        shape->fixed.append("],");
+      } else if (key == "experimental" && scanner.Peek() == JsonType::kObject) {
+        scanner.EnterObject();
+        shape->fixed.append("\"experimental\":{");
+        while (scanner.NextMember(&key)) {
+          if (key == "clash_api" && scanner.Peek() == JsonType::kObject) {
+            ScanClashApi(&scanner, shape);
+          } else {
+            SkipMember(&scanner, key, &shape->fixed);
+          }
+        }
+        shape->fixed.append("},");
+      } else {
+        SkipMember(&scanner, key, &shape->fixed);
+      }
+    }
+    shape->fixed.push_back('}');
+  } else if (scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Core config is not a JSON object";
+    }
+    return false;
+  }
+  if (!scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Malformed core config near offset " + std::to_string(scanner.offset());
+    }
+    return false;
+  }
+  CoreConfig config;
+  if (ScanCoreConfig(content, &config, nullptr) && config.has_controller) {
+    shape->has_controller = true;
+    shape->controller = config.controller;
+  }
+  return true;
+}
+
+bool ReadConfigShape(const std::string& path, ConfigShape* shape, std::string* error) {
+  MappedFile file;
+  if (!file.Open(path, error)) {
+    *shape = ConfigShape();
+    return false;
+  }
+  return ScanConfigShape(file.view(), shape, error);
+}
+
+bool SingleConfigPath(const std::vector<std::string>& arguments, std::string* path) {
+  int configs = 0;
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    const std::string& arg = arguments[i];
+    if (arg == "-C" || arg == "--config-directory" || arg.rfind("--config-directory=", 0) == 0) {
+      return false;
+    }
+    if ((arg == "-c" || arg == "--config") && i + 1 < arguments.size()) {
+      *path = arguments[++i];
+      ++configs;
+    } else if (arg.rfind("--config=", 0) == 0) {
+      *path = arg.substr(9);
+      ++configs;
+    }
+  }
+  return configs == 1;
+}
+
+const char* ConfigPlanKindName(ConfigPlanKind kind) {
+  switch (kind) {
+    case ConfigPlanKind::kApi:
+      return "api";
+    case ConfigPlanKind::kReload:
+      return "reload";
+    case ConfigPlanKind::kRestart:
+      return "restart";
+  }
+  return "restart";
+}
+
+ConfigPlan PlanConfigChange(const ConfigShape* running,
+                            const ConfigShape* next,
+                            bool same_launch,
+                            bool can_reload) {
+  if (!same_launch) {
+    ConfigPlan plan;
+    plan.reason = "Launch options differ from the running core";
+    return plan;
+  }
+  if (running == nullptr || next == nullptr) {
+    return Fallback(can_reload, "The running and the new config cannot be compared");
+  }
+  if (running->fixed != next->fixed) {
+    return Fallback(can_reload, "The change is not limited to selectors and the clash mode");
+  }
+  if (!running->has_controller) {
+    return Fallback(can_reload, "The config has no Clash API to apply the change through");
+  }
+  ConfigPlan plan;
+  plan.kind = ConfigPlanKind::kApi;
+  // Equal |fixed| texts list the same selectors in the same order.
+  for (size_t i = 0; i < next->selectors.size(); ++i) {
+    const SelectorChoice& before = running->selectors[i];
+    const SelectorChoice& after = next->selectors[i];
+    if (before.has_default == after.has_default && before.selected == after.selected) {
+      continue;
+    }
+    // Without a default the selector falls back to its first outbound,
+    // which only a fresh load knows.
+    if (!after.has_default) {
+      return Fallback(can_reload, "A selector no longer has a default");
+    }
+    plan.calls.push_back({"PUT", "/proxies/" + EncodePathSegment(after.tag),
+                          "{\"name\":" + QuoteJsonString(after.selected) + "}"});
+  }
+  if (running->clash_mode != next->clash_mode) {
+    if (next->clash_mode.empty()) {
+      return Fallback(can_reload, "The clash mode is no longer set");
+    }
+    plan.calls.push_back(
+        {"PATCH", "/configs", "{\"mode\":" + QuoteJsonString(next->clash_mode) + "}"});
+  }
+  return plan;
+}
+
+bool ApplyClashApiCalls(const ClashApiEndpoint& endpoint,
+                        const std::vector<ClashApiCall>& calls,
+                        int timeout_ms,
+                        std::string* error) {
+  std::vector<std::string> errors(calls.size());
+  const auto send = [&endpoint, &calls, &errors, timeout_ms](size_t index) {
+    const ClashApiCall& call = calls[index];
+    HttpResponse response;
+    if (!SendClashApiRequest(endpoint, call.method, call.path, call.body, timeout_ms, &response,
+                             &errors[index])) {
+      if (errors[index].empty()) {
+        errors[index] = call.method + " " + call.path + " failed";
+      }
+      return;
+    }
+    if (response.status < 200 || response.status >= 300) {
+      errors[index] =
+          call.method + " " + call.path + " answered " + std::to_string(response.status);
+      if (!response.body.empty()) {
+        errors[index] += ": " + response.body;
+      }
+    }
+  };
+  // Each call waits on its own round trip, so a few run at once; the
+  // calling thread is one of them. A profile switching many selectors
+  // still gets only this many threads.
+  std::atomic<size_t> next{0};
+  const auto drain = [&send, &next, &calls]() {
+    for (size_t index = next++; index < calls.size(); index = next++) {
+      send(index);
+    }
+  };
+  std::vector<std::thread> workers;
+  const size_t thread_count = std::min(calls.size(), kMaxConcurrentClashApiCalls);
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers.emplace_back(drain);
+  }
+  drain();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (const auto& call_error : errors) {
+    if (!call_error.empty()) {
+      if (error != nullptr) {
+        *error = call_error;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONFIG_PLANNER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONFIG_PLANNER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "clash_api_client.h"
+
+namespace jumper_sdk_platform {
+
+struct SelectorChoice {
+  std::string tag;
+  // The selector's `default`; empty when it has none.
+  std::string selected;
+  bool has_default = false;
+};
+
+// A sing-box config split into what the Clash API can change on a running
+// core and everything else.
+struct ConfigShape {
+  // Whitespace-free text of the config with the `default` of every
+  // `selector` outbound and `experimental.clash_api.default_mode` left out.
+  // Two configs with equal |fixed| differ at most in those values.
+  std::string fixed;
+  std::vector<SelectorChoice> selectors;
+  // `experimental.clash_api.default_mode`; empty when unset.
+  std::string clash_mode;
+  bool has_controller = false;
+  ClashApiEndpoint controller;
+};
+
+bool ScanConfigShape(std::string_view content, ConfigShape* shape, std::string* error);
+
+// Maps the config at |path| and scans it.
+bool ReadConfigShape(const std::string& path, ConfigShape* shape, std::string* error);
+
+// The config a command line loads when it names exactly one, with a single
+// `-c` and no config directory. Otherwise there is nothing to compare.
+bool SingleConfigPath(const std::vector<std::string>& arguments, std::string* path);
+
+enum class ConfigPlanKind {
+  // Applied with Clash API calls; the core keeps running as is.
+  kApi,
+  // The core has to load its config again.
+  kReload,
+  // The core has to be started again.
+  kRestart,
+};
+
+const char* ConfigPlanKindName(ConfigPlanKind kind);
+
+struct ClashApiCall {
+  std::string method;
+  std::string path;
+  std::string body;
+};
+
+struct ConfigPlan {
+  ConfigPlanKind kind = ConfigPlanKind::kRestart;
+  // For kApi; empty when nothing changed.
+  std::vector<ClashApiCall> calls;
+  // Why the cheaper kinds did not apply.
+  std::string reason;
+};
+
+// Picks the cheapest way to take a running core from |running| to |next|.
+// Either may be null when its config could not be read, which leaves
+// nothing to compare. |same_launch| is whether the core would be started
+// exactly as it runs now, apart from the config contents; |can_reload|
+// whether the platform can have the core load its config in place.
+ConfigPlan PlanConfigChange(const ConfigShape* running,
+                            const ConfigShape* next,
+                            bool same_launch,
+                            bool can_reload);
+
+// At most this many Clash API calls are in flight at once.
+constexpr size_t kMaxConcurrentClashApiCalls = 2;
+
+// Sends |calls| concurrently, one connection each and at most
+// kMaxConcurrentClashApiCalls at a time, and waits for all of them. Fails
+// with the first error once any call fails or is not answered with a 2xx
+// status. Calls that went through before the failure stay applied, so the
+// core may be left partly changed.
+bool ApplyClashApiCalls(const ClashApiEndpoint& endpoint,
+                        const std::vector<ClashApiCall>& calls,
+                        int timeout_ms,
+                        std::string* error);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONFIG_PLANNER_H_
@@ -0,0 +1,205 @@
+#include "connection_tracker.h"
+
+#include <chrono>
+
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr int kRequestTimeoutMs = 2000;
+
+int64_t RatePerSecond(int64_t delta, int64_t elapsed_ms) {
+  return elapsed_ms > 0 && delta > 0 ? delta * 1000 / elapsed_ms : 0;
+}
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+bool ParseConnectionsSnapshot(const std::string& body,
+                              std::vector<ConnectionEntry>* entries,
+                              std::string* error) {
+  entries->clear();
+  JsonScanner scanner(body);
+  std::string_view key;
+  const bool is_object = scanner.EnterObject();
+  while (is_object && scanner.NextMember(&key)) {
+    // sing-box reports `null` when there are no connections.
+    if (key != "connections" || scanner.Peek() != JsonType::kArray) {
+      scanner.Skip();
+      continue;
+    }
+    scanner.EnterArray();
+    while (scanner.NextElement()) {
+      if (scanner.Peek() != JsonType::kObject) {
+        scanner.Skip();
+        continue;
+      }
+      const size_t begin = scanner.offset();
+      ConnectionEntry entry;
+      std::string_view id;
+      scanner.EnterObject();
+      while (scanner.NextMember(&key)) {
+        if (key == "id") {
+          scanner.ReadString(&id);
+        } else if (key == "upload") {
+          scanner.ReadInteger(&entry.upload);
+        } else if (key == "download") {
+          scanner.ReadInteger(&entry.download);
+        } else {
+          scanner.Skip();
+        }
+      }
+      if (!id.empty()) {
+        entry.id.assign(id.data(), id.size());
+        entry.json = body.substr(begin, scanner.offset() - begin);
+        entries->push_back(std::move(entry));
+      }
+    }
+  }
+  if (!is_object || !scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Malformed /connections payload";
+    }
+    return false;
+  }
+  return true;
+}
+
+ConnectionsDelta ConnectionTracker::Update(std::vector<ConnectionEntry> entries,
+                                           int64_t timestamp_ms) {
+  ConnectionsDelta delta;
+  const int64_t elapsed_ms = last_timestamp_ms_ < 0 ? 0 : timestamp_ms - last_timestamp_ms_;
+  std::unordered_map<std::string, Counters> next;
+  next.reserve(entries.size());
+  for (auto& entry : entries) {
+    Counters& current = next[entry.id];
+    current.upload = entry.upload;
+    current.download = entry.download;
+    const auto previous = connections_.find(entry.id);
+    if (previous == connections_.end()) {
+      delta.added.push_back(std::move(entry));
+      continue;
+    }
+    const Counters counters = previous->second;
+    connections_.erase(previous);
+    current.moving = counters.upload != entry.upload || counters.download != entry.download;
+    // An idle connection is reported once more so its rates drop to zero.
+    if (!current.moving && !counters.moving) {
+      continue;
+    }
+    ConnectionChange change;
+    change.id = entry.id;
+    change.upload = entry.upload;
+    change.download = entry.download;
+    change.upload_rate = RatePerSecond(entry.upload - counters.upload, elapsed_ms);
+    change.download_rate = RatePerSecond(entry.download - counters.download, elapsed_ms);
+    delta.changed.push_back(std::move(change));
+  }
+  // Whatever was not seen again has closed.
+  for (const auto& closed : connections_) {
+    delta.removed.push_back(closed.first);
+  }
+  connections_.swap(next);
+  last_timestamp_ms_ = timestamp_ms;
+  return delta;
+}
+
+void ConnectionTracker::Reset() {
+  connections_.clear();
+  last_timestamp_ms_ = -1;
+}
+
+ConnectionsPoller::ConnectionsPoller(DeltaCallback on_delta) : on_delta_(std::move(on_delta)) {
+  thread_ = std::thread(&ConnectionsPoller::Run, this);
+}
+
+ConnectionsPoller::~ConnectionsPoller() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void ConnectionsPoller::SetEndpoint(const ClashApiEndpoint& endpoint) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoint_ = endpoint;
+    has_endpoint_ = true;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ConnectionsPoller::ClearEndpoint() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_endpoint_ = false;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ConnectionsPoller::SetActive(bool active, int interval_ms) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_ = active;
+    interval_ms_ = interval_ms;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ConnectionsPoller::Run() {
+  ConnectionTracker tracker;
+  uint64_t tracked_generation = 0;
+  bool reset = true;
+  for (;;) {
+    ClashApiEndpoint endpoint;
+    int interval_ms = 0;
+    uint64_t generation = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || (active_ && has_endpoint_); });
+      if (stopping_) {
+        return;
+      }
+      endpoint = endpoint_;
+      interval_ms = interval_ms_;
+      generation = generation_;
+    }
+    if (generation != tracked_generation) {
+      tracker.Reset();
+      tracked_generation = generation;
+      reset = true;
+    }
+
+    HttpResponse response;
+    std::vector<ConnectionEntry> entries;
+    if (SendClashApiRequest(endpoint, "GET", "/connections", "",
+                            kRequestTimeoutMs, &response, nullptr) &&
+        response.status == 200 && ParseConnectionsSnapshot(response.body, &entries, nullptr)) {
+      const int64_t timestamp_ms = NowMs();
+      const ConnectionsDelta delta = tracker.Update(std::move(entries), timestamp_ms);
+      // A reset is sent even when empty so the listener drops stale state.
+      if (reset || !delta.empty()) {
+        on_delta_(delta, reset, timestamp_ms);
+      }
+      reset = false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                   [this, generation] { return stopping_ || generation_ != generation; });
+  }
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,104 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONNECTION_TRACKER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONNECTION_TRACKER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "clash_api_client.h"
+
+namespace jumper_sdk_platform {
+
+// One entry of the Clash API `/connections` payload. |json| is the entry's
+// raw JSON object, handed on untouched when the connection first appears.
+struct ConnectionEntry {
+  std::string id;
+  int64_t upload = 0;
+  int64_t download = 0;
+  std::string json;
+};
+
+// Splits a `/connections` response body into its entries.
+bool ParseConnectionsSnapshot(const std::string& body,
+                              std::vector<ConnectionEntry>* entries,
+                              std::string* error);
+
+struct ConnectionChange {
+  std::string id;
+  int64_t upload = 0;
+  int64_t download = 0;
+  // Bytes per second since the previous snapshot.
+  int64_t upload_rate = 0;
+  int64_t download_rate = 0;
+};
+
+struct ConnectionsDelta {
+  std::vector<ConnectionEntry> added;
+  std::vector<ConnectionChange> changed;
+  std::vector<std::string> removed;
+
+  bool empty() const { return added.empty() && changed.empty() && removed.empty(); }
+};
+
+// Keeps the last snapshot keyed by connection id and reports what changed.
+// Connections are "changed" when their byte counters moved, and once more
+// when they stop moving.
+class ConnectionTracker {
+ public:
+  ConnectionsDelta Update(std::vector<ConnectionEntry> entries, int64_t timestamp_ms);
+  void Reset();
+
+ private:
+  struct Counters {
+    int64_t upload = 0;
+    int64_t download = 0;
+    bool moving = false;
+  };
+
+  std::unordered_map<std::string, Counters> connections_;
+  int64_t last_timestamp_ms_ = -1;
+};
+
+// Polls `/connections` on its own thread while active and has an endpoint,
+// and hands non-empty deltas to |on_delta| from that thread. |reset| is true
+// for the first delta after the endpoint or listener changed; it lists every
+// live connection as added.
+class ConnectionsPoller {
+ public:
+  using DeltaCallback =
+      std::function<void(const ConnectionsDelta& delta, bool reset, int64_t timestamp_ms)>;
+
+  explicit ConnectionsPoller(DeltaCallback on_delta);
+  ~ConnectionsPoller();
+
+  ConnectionsPoller(const ConnectionsPoller&) = delete;
+  ConnectionsPoller& operator=(const ConnectionsPoller&) = delete;
+
+  void SetEndpoint(const ClashApiEndpoint& endpoint);
+  void ClearEndpoint();
+  void SetActive(bool active, int interval_ms);
+
+ private:
+  void Run();
+
+  const DeltaCallback on_delta_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  ClashApiEndpoint endpoint_;
+  bool has_endpoint_ = false;
+  bool active_ = false;
+  int interval_ms_ = 1000;
+  bool stopping_ = false;
+  uint64_t generation_ = 0;
+  std::thread thread_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CONNECTION_TRACKER_H_
@@ -0,0 +1,456 @@
+#include "core_config.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+bool EqualsIgnoringCase(std::string_view value, std::string_view expected) {
+  if (value.size() != expected.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < value.size(); ++i) {
+    char c = value[i];
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (c != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// One element of `inbounds`. Members may come in any order, so the type is
+// only known once the object is closed.
+void ScanInbound(JsonScanner* scanner, CoreConfig* config) {
+  if (!scanner->EnterObject()) {
+    return;
+  }
+  bool is_tun = false;
+  bool enabled = true;
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    if (key == "type") {
+      std::string_view type;
+      if (scanner->ReadString(&type)) {
+        is_tun = EqualsIgnoringCase(type, "tun");
+      }
+    } else if (key == "enable") {
+      scanner->ReadBool(&enabled);
+    } else if (key == "listen_port") {
+      int64_t port = 0;
+      if (scanner->ReadInteger(&port) && port > 0 && port <= 65535) {
+        config->listen_ports.push_back(static_cast<uint16_t>(port));
+      }
+    } else {
+      scanner->Skip();
+    }
+  }
+  // A missing "enable" means enabled, as in sing-box.
+  if (is_tun && enabled) {
+    config->tun_enabled = true;
+  }
+}
+
+void ScanClashApi(JsonScanner* scanner, CoreConfig* config) {
+  if (!scanner->EnterObject()) {
+    return;
+  }
+  std::string_view controller;
+  std::string_view secret;
+  bool has_secret = false;
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    if (key == "external_controller") {
+      scanner->ReadString(&controller);
+    } else if (key == "secret") {
+      has_secret = scanner->ReadString(&secret);
+    } else {
+      scanner->Skip();
+    }
+  }
+  if (!controller.empty() &&
+      ParseExternalController(UnescapeJsonString(controller), &config->controller)) {
+    config->has_controller = true;
+    if (has_secret) {
+      config->controller.secret = UnescapeJsonString(secret);
+    }
+  }
+}
+
+// A piece of the original config replaced by RelocateCoreConfig.
+struct Splice {
+  size_t offset = 0;
+  size_t length = 0;
+  std::string text;
+};
+
+class ConfigRelocator {
+ public:
+  ConfigRelocator(std::string_view content,
+                  const std::function<uint16_t()>& pick_port,
+                  const std::string& cache_path)
+      : content_(content), scanner_(content), pick_port_(pick_port), cache_path_(cache_path) {}
+
+  bool Run(std::string* relocated, std::string* error) {
+    std::string_view key;
+    if (scanner_.EnterObject()) {
+      while (scanner_.NextMember(&key) && error_.empty()) {
+        if (key == "inbounds" && scanner_.Peek() == JsonType::kArray) {
+          scanner_.EnterArray();
+          while (scanner_.NextElement() && error_.empty()) {
+            RelocateInbound();
+          }
+        } else if (key == "experimental" && scanner_.Peek() == JsonType::kObject) {
+          RelocateExperimental();
+        } else if (key == "log" && scanner_.Peek() == JsonType::kObject) {
+          // The instance's output is captured from stderr.
+          ReplaceStringMember("output", "");
+        } else {
+          scanner_.Skip();
+        }
+      }
+    } else if (scanner_.ok()) {
+      error_ = "Core config is not a JSON object";
+    }
+    if (error_.empty() && !scanner_.ok()) {
+      error_ = "Malformed core config near offset " + std::to_string(scanner_.offset());
+    }
+    if (!error_.empty()) {
+      if (error != nullptr) {
+        *error = error_;
+      }
+      return false;
+    }
+    relocated->clear();
+    relocated->reserve(content_.size() + 16 * splices_.size());
+    size_t copied = 0;
+    for (const Splice& splice : splices_) {
+      relocated->append(content_.substr(copied, splice.offset - copied));
+      relocated->append(splice.text);
+      copied = splice.offset + splice.length;
+    }
+    relocated->append(content_.substr(copied));
+    return true;
+  }
+
+ private:
+  size_t OffsetOf(std::string_view span) const {
+    return static_cast<size_t>(span.data() - content_.data());
+  }
+
+  uint16_t NextPort() {
+    const uint16_t port = pick_port_();
+    if (port == 0) {
+      error_ = "No free port left to relocate the config to";
+    }
+    return port;
+  }
+
+  void RelocateInbound() {
+    if (!scanner_.EnterObject()) {
+      return;
+    }
+    bool is_tun = false;
+    bool enabled = true;
+    std::string_view key;
+    while (scanner_.NextMember(&key)) {
+      if (key == "type") {
+        std::string_view type;
+        if (scanner_.ReadString(&type)) {
+          is_tun = EqualsIgnoringCase(type, "tun");
+        }
+      } else if (key == "enable") {
+        scanner_.ReadBool(&enabled);
+      } else if (key == "listen_port" && scanner_.Peek() == JsonType::kNumber) {
+        std::string_view span;
+        const uint16_t port = scanner_.SkipSpan(&span) ? NextPort() : 0;
+        if (port != 0) {
+          splices_.push_back({OffsetOf(span), span.size(), std::to_string(port)});
+        }
+      } else {
+        scanner_.Skip();
+      }
+    }
+    if (is_tun && enabled && error_.empty()) {
+      error_ = "A tun inbound cannot run beside the main core";
+    }
+  }
+
+  void RelocateExperimental() {
+    scanner_.EnterObject();
+    std::string_view key;
+    while (scanner_.NextMember(&key)) {
+      if (key == "clash_api" && scanner_.Peek() == JsonType::kObject) {
+        RelocateClashApi();
+      } else if (key == "cache_file" && scanner_.Peek() == JsonType::kObject) {
+        RelocateCacheFile();
+      } else {
+        scanner_.Skip();
+      }
+    }
+  }
+
+  void RelocateClashApi() {
+    scanner_.EnterObject();
+    std::string_view key;
+    while (scanner_.NextMember(&key)) {
+      std::string_view raw;
+      ClashApiEndpoint endpoint;
+      if (key != "external_controller" || scanner_.Peek() != JsonType::kString) {
+        scanner_.Skip();
+      } else if (scanner_.ReadString(&raw) &&
+                 ParseExternalController(UnescapeJsonString(raw), &endpoint)) {
+        const uint16_t port = NextPort();
+        const bool ipv6 = endpoint.host.find(':') != std::string::npos;
+        if (port != 0) {
+          splices_.push_back({OffsetOf(raw), raw.size(),
+                              (ipv6 ? "[" + endpoint.host + "]" : endpoint.host) + ":" +
+                                  std::to_string(port)});
+        }
+      }
+    }
+  }
+
+  // The main core holds a lock on its cache file, so the path is set
+  // whether or not the config names one.
+  void RelocateCacheFile() {
+    const size_t open = scanner_.offset();
+    const std::string quoted = QuoteJsonString(cache_path_);
+    scanner_.EnterObject();
+    bool has_members = false;
+    bool has_path = false;
+    std::string_view key;
+    while (scanner_.NextMember(&key)) {
+      std::string_view raw;
+      has_members = true;
+      if (key != "path") {
+        scanner_.Skip();
+      } else if (scanner_.ReadString(&raw)) {
+        has_path = true;
+        splices_.push_back({OffsetOf(raw), raw.size(), quoted.substr(1, quoted.size() - 2)});
+      }
+    }
+    if (!has_path) {
+      splices_.push_back({open + 1, 0, "\"path\":" + quoted + (has_members ? "," : "")});
+    }
+  }
+
+  // Replaces the string member |name| of the object at the cursor with
+  // |value|, which needs no escaping.
+  void ReplaceStringMember(std::string_view name, std::string_view value) {
+    scanner_.EnterObject();
+    std::string_view key;
+    while (scanner_.NextMember(&key)) {
+      std::string_view raw;
+      if (key != name || scanner_.Peek() != JsonType::kString) {
+        scanner_.Skip();
+      } else if (scanner_.ReadString(&raw)) {
+        splices_.push_back({OffsetOf(raw), raw.size(), std::string(value)});
+      }
+    }
+  }
+
+  std::string_view content_;
+  JsonScanner scanner_;
+  const std::function<uint16_t()>& pick_port_;
+  const std::string& cache_path_;
+  std::vector<Splice> splices_;
+  std::string error_;
+};
+
+}  // namespace
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string& path, std::string* error) {
+  Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (error != nullptr) {
+      *error = "Cannot open " + path + ", error " + std::to_string(GetLastError());
+    }
+    return false;
+  }
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size)) {
+    if (error != nullptr) {
+      *error = "Cannot stat " + path + ", error " + std::to_string(GetLastError());
+    }
+    CloseHandle(file);
+    return false;
+  }
+  if (size.QuadPart == 0) {
+    CloseHandle(file);
+    return true;
+  }
+  // The view keeps the mapping alive once both handles are closed.
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void* view = mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  const DWORD map_error = GetLastError();
+  if (mapping != nullptr) {
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+  if (view == nullptr) {
+    if (error != nullptr) {
+      *error = "Cannot map " + path + ", error " + std::to_string(map_error);
+    }
+    return false;
+  }
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(size.QuadPart);
+  return true;
+#else
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (error != nullptr) {
+      *error = "Cannot open " + path + ": " + std::strerror(errno);
+    }
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    if (error != nullptr) {
+      *error = "Cannot stat " + path + ": " + std::strerror(errno);
+    }
+    close(fd);
+    return false;
+  }
+  if (info.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  const int map_errno = errno;
+  close(fd);
+  if (view == MAP_FAILED) {
+    if (error != nullptr) {
+      *error = "Cannot map " + path + ": " + std::strerror(map_errno);
+    }
+    return false;
+  }
+  // Read once front to back.
+  madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(info.st_size);
+  return true;
+#endif
+}
+
+void MappedFile::Close() {
+  if (data_ == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool ScanCoreConfig(std::string_view content, CoreConfig* config, std::string* error) {
+  *config = CoreConfig();
+  JsonScanner scanner(content);
+  std::string_view key;
+  if (scanner.EnterObject()) {
+    while (scanner.NextMember(&key)) {
+      if (key == "inbounds") {
+        if (scanner.EnterArray()) {
+          while (scanner.NextElement()) {
+            ScanInbound(&scanner, config);
+          }
+        }
+      } else if (key == "experimental") {
+        if (scanner.EnterObject()) {
+          while (scanner.NextMember(&key)) {
+            if (key == "clash_api") {
+              ScanClashApi(&scanner, config);
+            } else {
+              scanner.Skip();
+            }
+          }
+        }
+      } else if (key == "log") {
+        if (scanner.EnterObject()) {
+          while (scanner.NextMember(&key)) {
+            std::string_view output;
+            if (key != "output") {
+              scanner.Skip();
+            } else if (scanner.ReadString(&output)) {
+              config->log_output = UnescapeJsonString(output);
+            }
+          }
+        }
+      } else {
+        scanner.Skip();
+      }
+    }
+  } else if (scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Core config is not a JSON object";
+    }
+    return false;
+  }
+  if (config->has_controller) {
+    config->listen_ports.push_back(config->controller.port);
+  }
+  if (!scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Malformed core config near offset " + std::to_string(scanner.offset());
+    }
+    return false;
+  }
+  return true;
+}
+
+bool ReadCoreConfig(const std::string& path, CoreConfig* config, std::string* error) {
+  MappedFile file;
+  if (!file.Open(path, error)) {
+    *config = CoreConfig();
+    return false;
+  }
+  return ScanCoreConfig(file.view(), config, error);
+}
+
+bool RelocateCoreConfig(std::string_view content,
+                        const std::function<uint16_t()>& pick_port,
+                        const std::string& cache_path,
+                        std::string* relocated,
+                        std::string* error) {
+  return ConfigRelocator(content, pick_port, cache_path).Run(relocated, error);
+}
+
+bool CheckArgumentsFor(const std::vector<std::string>& run_arguments,
+                       std::vector<std::string>* check_arguments) {
+  if (run_arguments.empty() || run_arguments.front() != "run") {
+    return false;
+  }
+  // -c, -C and -D are global flags, so check takes them as run does.
+  *check_arguments = run_arguments;
+  check_arguments->front() = "check";
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,79 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_CONFIG_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_CONFIG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "clash_api_client.h"
+
+namespace jumper_sdk_platform {
+
+// Read-only memory mapping of a whole file. Empty files map to an empty
+// view.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  std::string_view view() const { return std::string_view(data_, size_); }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// The parts of a sing-box config the plugins act on before and after
+// spawning the core.
+struct CoreConfig {
+  // True when an inbound has `"type": "tun"` and is not switched off with
+  // `"enable": false`.
+  bool tun_enabled = false;
+  // `experimental.clash_api`, used as the readiness probe and for the
+  // streaming endpoints.
+  bool has_controller = false;
+  ClashApiEndpoint controller;
+  // Every inbound `listen_port`, followed by the controller port. All of
+  // them must be free before the core is spawned.
+  std::vector<uint16_t> listen_ports;
+  // `log.output`; empty when the core logs to stderr.
+  std::string log_output;
+};
+
+// Extracts a CoreConfig from |content| in one pass. Fails on malformed JSON,
+// leaving in |config| whatever was found before the error.
+bool ScanCoreConfig(std::string_view content, CoreConfig* config, std::string* error);
+
+// Maps the config at |path| and scans it.
+bool ReadCoreConfig(const std::string& path, CoreConfig* config, std::string* error);
+
+// Rewrites |content| for a core that runs beside another one: every inbound
+// `listen_port` and the Clash API's `external_controller` get a port from
+// |pick_port|, `log.output` is cleared so the log reaches stderr, and an
+// `experimental.cache_file` is moved to |cache_path|. Every other byte is
+// kept. Fails on malformed JSON, on an enabled tun inbound, which needs the
+// system's routes to itself, and once |pick_port| returns 0.
+bool RelocateCoreConfig(std::string_view content,
+                        const std::function<uint16_t()>& pick_port,
+                        const std::string& cache_path,
+                        std::string* relocated,
+                        std::string* error);
+
+// Turns the arguments of a `sing-box run` command line, argv[0] excluded,
+// into the `sing-box check` command line that validates the same configs.
+// Returns false for any other command.
+bool CheckArgumentsFor(const std::vector<std::string>& run_arguments,
+                       std::vector<std::string>* check_arguments);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_CONFIG_H_
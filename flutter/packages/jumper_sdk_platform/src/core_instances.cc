@@ -0,0 +1,661 @@
+#include "core_instances.h"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include "config_planner.h"
+#include "core_config.h"
+#include "net_socket.h"
+
+namespace jumper_sdk_platform {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Per instance; the main core keeps a larger buffer.
+constexpr size_t kLogCapacity = 1024;
+constexpr size_t kLogLowLevelBudgetPerSecond = 100;
+constexpr size_t kLogSampleRate = 16;
+constexpr size_t kLogMaxLineBytes = 8 * 1024;
+constexpr size_t kLogReadChunkBytes = 16 * 1024;
+// Reads per pipe and wakeup, so one chatty instance cannot hold up the
+// others. Level-triggered epoll brings the loop back for the rest.
+constexpr size_t kLogReadsPerWake = 4;
+constexpr size_t kExitLogLines = 50;
+// Exit checks on kernels without pidfds.
+constexpr int kExitPollIntervalMs = 1000;
+// For the instance a Start replaces, and for every instance at shutdown.
+constexpr int kStopTimeoutMs = 2000;
+constexpr int kShutdownTimeoutMs = 1000;
+constexpr int kMaxEvents = 32;
+// Fresh ports are asked for until one is neither reserved nor taken.
+constexpr int kPortAttempts = 16;
+// Epoll token of the wake eventfd; instance serials start at 1.
+constexpr uint64_t kWakeToken = 0;
+
+int64_t MonotonicMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// Profile ids are free text; directory names keep the readable part.
+std::string DirectoryName(uint64_t serial, const std::string& profile_id) {
+  std::string name = std::to_string(serial) + "-";
+  for (const char c : profile_id.substr(0, 32)) {
+    const bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+    name.push_back(plain ? c : '_');
+  }
+  return name;
+}
+
+bool WriteConfig(const std::string& path, const std::string& content, std::string* error) {
+  {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << content;
+    if (!stream) {
+      if (error != nullptr) {
+        *error = "Unable to write " + path;
+      }
+      return false;
+    }
+  }
+  // Outbound credentials and the Clash API secret.
+  std::error_code ec;
+  fs::permissions(path, fs::perms::owner_read | fs::perms::owner_write, ec);
+  return true;
+}
+
+// Points the single config argument at |path|.
+void ReplaceConfigPath(std::vector<std::string>* arguments, const std::string& path) {
+  for (size_t i = 0; i < arguments->size(); ++i) {
+    std::string& arg = (*arguments)[i];
+    if ((arg == "-c" || arg == "--config") && i + 1 < arguments->size()) {
+      (*arguments)[++i] = path;
+    } else if (arg.rfind("--config=", 0) == 0) {
+      arg = "--config=" + path;
+    }
+  }
+}
+
+}  // namespace
+
+struct CoreInstanceRegistry::Instance {
+  explicit Instance(const RestartBackoffOptions& options)
+      : backoff(options),
+        logs(std::make_shared<KernelLogBuffer>(kLogCapacity, kLogLowLevelBudgetPerSecond,
+                                               kLogSampleRate)),
+        stdout_framer(kLogMaxLineBytes),
+        stderr_framer(kLogMaxLineBytes) {}
+
+  std::string profile_id;
+  uint64_t serial = 0;
+  std::string directory;
+  SpawnOptions spawn;
+  CoreConfig config;
+  std::vector<uint16_t> ports;
+  CoreStatus status = CoreStatus::kStarting;
+  std::string message;
+  pid_t pid = -1;
+  int pidfd = -1;
+  int stdout_fd = -1;
+  int stderr_fd = -1;
+  int64_t started_at_ms = 0;
+  uint64_t first_log_seq = 1;
+  // When the next automatic restart is due; -1 when none is scheduled.
+  int64_t restart_at_ms = -1;
+  int restarts = 0;
+  RestartBackoff backoff;
+  std::shared_ptr<KernelLogBuffer> logs;
+  LogLineFramer stdout_framer;
+  LogLineFramer stderr_framer;
+};
+
+CoreInstanceRegistry::CoreInstanceRegistry(std::string root,
+                                           size_t max_instances,
+                                           const RestartBackoffOptions& backoff,
+                                           EventCallback on_event)
+    : root_(std::move(root)),
+      max_instances_(max_instances),
+      backoff_(backoff),
+      on_event_(std::move(on_event)) {
+  std::error_code ec;
+  fs::remove_all(root_, ec);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = kWakeToken;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+  thread_ = std::thread(&CoreInstanceRegistry::Run, this);
+}
+
+CoreInstanceRegistry::~CoreInstanceRegistry() {
+  std::map<std::string, std::unique_ptr<Instance>> instances;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    instances.swap(instances_);
+    serials_.clear();
+  }
+  Wake();
+  thread_.join();
+  // In parallel, so shutdown takes one grace period however many there are.
+  std::vector<std::thread> stoppers;
+  for (auto& entry : instances) {
+    Instance* instance = entry.second.get();
+    if (instance->pid > 0) {
+      stoppers.emplace_back([instance]() {
+        StopProcessGroup(instance->pid, instance->pidfd, kShutdownTimeoutMs);
+      });
+    }
+  }
+  for (auto& stopper : stoppers) {
+    stopper.join();
+  }
+  for (auto& entry : instances) {
+    CloseProcess(entry.second.get());
+    CloseFd(&entry.second->spawn.executable_fd);
+  }
+  CloseFd(&wake_fd_);
+  CloseFd(&epoll_fd_);
+  std::error_code ec;
+  fs::remove_all(root_, ec);
+}
+
+CoreInstanceStartResult CoreInstanceRegistry::Start(
+    const std::string& profile_id,
+    const SpawnOptions& spawn,
+    int ready_timeout_ms,
+    const std::function<bool(int milliseconds)>& wait,
+    CoreInstanceState* state,
+    ReadinessTimings* timings,
+    std::string* error) {
+  const auto started_at = std::chrono::steady_clock::now();
+  Stop(profile_id, kStopTimeoutMs, nullptr);
+
+  std::string config_path;
+  MappedFile config_file;
+  if (!SingleConfigPath(spawn.arguments, &config_path)) {
+    if (error != nullptr) {
+      *error = "A core instance needs exactly one -c config";
+    }
+    return CoreInstanceStartResult::kConfigInvalid;
+  }
+  if (!config_file.Open(config_path, error)) {
+    return CoreInstanceStartResult::kConfigInvalid;
+  }
+
+  auto instance = std::make_unique<Instance>(backoff_);
+  Instance* started = instance.get();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || instances_.size() >= max_instances_) {
+      if (error != nullptr) {
+        *error = "At most " + std::to_string(max_instances_) + " core instances may run";
+      }
+      return CoreInstanceStartResult::kLimitReached;
+    }
+    instance->profile_id = profile_id;
+    instance->serial = next_serial_++;
+    instance->directory = (fs::path(root_) / DirectoryName(instance->serial, profile_id)).string();
+    const std::string relocated_path = (fs::path(instance->directory) / "config.json").string();
+    std::string relocated;
+    std::error_code ec;
+    fs::create_directories(instance->directory, ec);
+    const auto pick_port = [this, started]() {
+      const uint16_t port = PickPortLocked();
+      if (port != 0) {
+        started->ports.push_back(port);
+      }
+      return port;
+    };
+    if (ec || !RelocateCoreConfig(config_file.view(), pick_port,
+                                  (fs::path(instance->directory) / "cache.db").string(),
+                                  &relocated, error) ||
+        !WriteConfig(relocated_path, relocated, error) ||
+        !ScanCoreConfig(relocated, &instance->config, error)) {
+      if (ec && error != nullptr) {
+        *error = "Unable to create " + instance->directory + ": " + ec.message();
+      }
+      ReleaseLocked(instance.get());
+      return CoreInstanceStartResult::kConfigInvalid;
+    }
+    instance->spawn = spawn;
+    ReplaceConfigPath(&instance->spawn.arguments, relocated_path);
+    instance->spawn.new_process_group = true;
+    instance->spawn.output_fd = -1;
+    instance->spawn.executable_fd =
+        spawn.executable_fd < 0 ? -1 : fcntl(spawn.executable_fd, F_DUPFD_CLOEXEC, 0);
+    if (!SpawnLocked(instance.get(), error)) {
+      CloseFd(&instance->spawn.executable_fd);
+      ReleaseLocked(instance.get());
+      return CoreInstanceStartResult::kSpawnFailed;
+    }
+    instance->status = CoreStatus::kRunning;
+    serials_[instance->serial] = instance.get();
+    instances_[profile_id] = std::move(instance);
+  }
+  const uint64_t serial = started->serial;
+  if (timings != nullptr) {
+    timings->spawn_ms = MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+  }
+
+  // |started| may be removed by a concurrent Stop from here on, so it is
+  // only reached again through its serial.
+  ReadinessResult readiness = ReadinessResult::kReady;
+  std::string readiness_error;
+  ClashApiEndpoint controller;
+  bool has_controller = false;
+  pid_t pid = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_controller = started->config.has_controller;
+    controller = started->config.controller;
+    pid = started->pid;
+  }
+  if (has_controller) {
+    ReadinessHooks hooks;
+    hooks.wait = wait;
+    hooks.has_exited = [this, serial, pid](std::string* reason) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto it = serials_.find(serial);
+      if (it == serials_.end()) {
+        *reason = "core instance was stopped";
+        return true;
+      }
+      if (it->second->pid != pid) {
+        *reason = it->second->message;
+        return true;
+      }
+      return false;
+    };
+    ReadinessTimings probe_timings;
+    readiness = WaitForClashApi(controller, started_at, ready_timeout_ms, hooks,
+                                timings != nullptr ? timings : &probe_timings, &readiness_error);
+  }
+  if (readiness != ReadinessResult::kReady) {
+    std::unique_ptr<Instance> failed;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto it = instances_.find(profile_id);
+      if (it != instances_.end() && it->second->serial == serial) {
+        failed = RemoveLocked(profile_id);
+      }
+    }
+    if (failed != nullptr) {
+      StopRemoved(std::move(failed), kStopTimeoutMs, nullptr);
+    }
+    if (error != nullptr) {
+      *error = readiness_error;
+    }
+    switch (readiness) {
+      case ReadinessResult::kCancelled:
+        return CoreInstanceStartResult::kCancelled;
+      case ReadinessResult::kExited:
+        return CoreInstanceStartResult::kExited;
+      default:
+        return CoreInstanceStartResult::kNotReady;
+    }
+  }
+  if (state != nullptr && !GetState(profile_id, state)) {
+    if (error != nullptr) {
+      *error = "core instance was stopped";
+    }
+    return CoreInstanceStartResult::kCancelled;
+  }
+  return CoreInstanceStartResult::kStarted;
+}
+
+bool CoreInstanceRegistry::Stop(const std::string& profile_id,
+                                int timeout_ms,
+                                ProcessStopResult* result) {
+  std::unique_ptr<Instance> instance;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    instance = RemoveLocked(profile_id);
+  }
+  if (instance == nullptr) {
+    return false;
+  }
+  StopRemoved(std::move(instance), timeout_ms, result);
+  return true;
+}
+
+bool CoreInstanceRegistry::GetState(const std::string& profile_id,
+                                    CoreInstanceState* state) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = instances_.find(profile_id);
+  if (it == instances_.end()) {
+    return false;
+  }
+  *state = StateLocked(*it->second);
+  return true;
+}
+
+std::vector<CoreInstanceState> CoreInstanceRegistry::States() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<CoreInstanceState> states;
+  states.reserve(instances_.size());
+  for (const auto& entry : instances_) {
+    states.push_back(StateLocked(*entry.second));
+  }
+  return states;
+}
+
+std::shared_ptr<KernelLogBuffer> CoreInstanceRegistry::Logs(const std::string& profile_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = instances_.find(profile_id);
+  return it == instances_.end() ? nullptr : it->second->logs;
+}
+
+void CoreInstanceRegistry::Run() {
+  epoll_event events[kMaxEvents];
+  for (;;) {
+    int timeout_ms = -1;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      const int64_t now = MonotonicMs();
+      for (const auto& entry : instances_) {
+        const Instance& instance = *entry.second;
+        int64_t due_in = INT_MAX;
+        if (instance.restart_at_ms >= 0) {
+          due_in = std::max<int64_t>(0, instance.restart_at_ms - now);
+        } else if (instance.pid > 0 && instance.pidfd < 0) {
+          due_in = kExitPollIntervalMs;
+        }
+        if (due_in != INT_MAX && (timeout_ms < 0 || due_in < timeout_ms)) {
+          timeout_ms = static_cast<int>(due_in);
+        }
+      }
+    }
+    const int count = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    std::vector<CoreInstanceEvent> pending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      for (int i = 0; i < count; ++i) {
+        const uint64_t token = events[i].data.u64;
+        if (token == kWakeToken) {
+          uint64_t value = 0;
+          while (read(wake_fd_, &value, sizeof(value)) > 0) {
+          }
+          continue;
+        }
+        // Events for an instance removed since epoll_wait returned.
+        const auto it = serials_.find(token >> 2);
+        if (it == serials_.end()) {
+          continue;
+        }
+        Instance* instance = it->second;
+        const auto source = static_cast<Source>(token & 3);
+        int status = 0;
+        if (source != kPidfd) {
+          ReadOutput(instance, source, kLogReadsPerWake);
+        } else if (instance->pid > 0 && waitpid(instance->pid, &status, WNOHANG) == instance->pid) {
+          OnExitedLocked(instance, status, &pending);
+        }
+      }
+      const int64_t now = MonotonicMs();
+      for (const auto& entry : instances_) {
+        Instance* instance = entry.second.get();
+        int status = 0;
+        if (instance->pid > 0 && instance->pidfd < 0 &&
+            waitpid(instance->pid, &status, WNOHANG) == instance->pid) {
+          OnExitedLocked(instance, status, &pending);
+        } else if (instance->restart_at_ms >= 0 && instance->restart_at_ms <= now) {
+          OnRestartDueLocked(instance, &pending);
+        }
+      }
+    }
+    for (const auto& event : pending) {
+      on_event_(event);
+    }
+  }
+}
+
+void CoreInstanceRegistry::Wake() {
+  const uint64_t one = 1;
+  while (write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+bool CoreInstanceRegistry::SpawnLocked(Instance* instance, std::string* error) {
+  // The ports were free when picked; another process may have taken one
+  // since, or, on a restart, a process the instance left behind.
+  const uint16_t busy = FindPortInUse(instance->config.listen_ports);
+  if (busy != 0) {
+    if (error != nullptr) {
+      *error = "Port " + std::to_string(busy) + " is already in use";
+    }
+    return false;
+  }
+  SpawnedProcess process;
+  if (!SpawnProcess(instance->spawn, &process, error)) {
+    return false;
+  }
+  instance->pid = process.pid;
+  instance->pidfd = process.pidfd;
+  instance->stdout_fd = process.stdout_fd;
+  instance->stderr_fd = process.stderr_fd;
+  instance->started_at_ms = MonotonicMs();
+  instance->first_log_seq = instance->logs->next_seq();
+  instance->message = "core instance is running";
+  for (const Source source : {kPidfd, kStdout, kStderr}) {
+    const int fd = source == kPidfd   ? instance->pidfd
+                   : source == kStdout ? instance->stdout_fd
+                                       : instance->stderr_fd;
+    if (fd < 0) {
+      continue;
+    }
+    if (source != kPidfd) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = (instance->serial << 2) | source;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+  }
+  // The loop may be sleeping until a deadline that no longer matters, or
+  // have no pidfd to watch.
+  Wake();
+  return true;
+}
+
+bool CoreInstanceRegistry::ReadOutput(Instance* instance, Source source, size_t max_reads) {
+  int* fd = source == kStdout ? &instance->stdout_fd : &instance->stderr_fd;
+  LogLineFramer* framer = source == kStdout ? &instance->stdout_framer : &instance->stderr_framer;
+  KernelLogBuffer* logs = instance->logs.get();
+  const auto on_line = [logs](std::string line) {
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+    const KernelLogLevel level = ParseKernelLogLevel(line);
+    logs->Append(level, std::move(line), now_ms);
+  };
+  char chunk[kLogReadChunkBytes];
+  for (size_t reads = 0; *fd >= 0 && reads < max_reads; ++reads) {
+    const ssize_t count = read(*fd, chunk, sizeof(chunk));
+    if (count > 0) {
+      framer->Feed(chunk, static_cast<size_t>(count), on_line);
+      continue;
+    }
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    // Closing the descriptor also takes it out of the epoll set.
+    framer->Flush(on_line);
+    CloseFd(fd);
+    return false;
+  }
+  return *fd >= 0;
+}
+
+void CoreInstanceRegistry::CloseProcess(Instance* instance) {
+  CloseFd(&instance->pidfd);
+  CloseFd(&instance->stdout_fd);
+  CloseFd(&instance->stderr_fd);
+  instance->pid = -1;
+}
+
+void CoreInstanceRegistry::OnExitedLocked(Instance* instance,
+                                          int status,
+                                          std::vector<CoreInstanceEvent>* events) {
+  // The pipes stay readable after the exit until drained; a grandchild that
+  // inherited them could keep them open, so the drain stops at EAGAIN.
+  ReadOutput(instance, kStdout, SIZE_MAX);
+  ReadOutput(instance, kStderr, SIZE_MAX);
+  CoreInstanceEvent event;
+  event.type = CoreInstanceEventType::kExited;
+  event.profile_id = instance->profile_id;
+  event.pid = instance->pid;
+  event.uptime_ms = MonotonicMs() - instance->started_at_ms;
+  if (WIFEXITED(status)) {
+    event.exit_code = WEXITSTATUS(status);
+    event.message = "core instance exited with code " + std::to_string(event.exit_code);
+  } else if (WIFSIGNALED(status)) {
+    event.signal = WTERMSIG(status);
+    event.message = "core instance was killed by signal " + std::to_string(event.signal);
+  }
+  event.last_logs = instance->logs->Tail(instance->first_log_seq - 1, kExitLogLines);
+  CloseProcess(instance);
+  event.restart_in_ms = instance->backoff.OnExit(MonotonicMs(), event.uptime_ms);
+  event.attempt = instance->backoff.attempt();
+  event.crash_loop = instance->backoff.open();
+  instance->restart_at_ms =
+      event.restart_in_ms >= 0 ? MonotonicMs() + event.restart_in_ms : -1;
+  instance->status = CoreStatus::kError;
+  instance->message = event.message;
+  events->push_back(std::move(event));
+}
+
+void CoreInstanceRegistry::OnRestartDueLocked(Instance* instance,
+                                              std::vector<CoreInstanceEvent>* events) {
+  instance->restart_at_ms = -1;
+  CoreInstanceEvent event;
+  event.profile_id = instance->profile_id;
+  std::string error;
+  if (SpawnLocked(instance, &error)) {
+    ++instance->restarts;
+    instance->status = CoreStatus::kRunning;
+    event.type = CoreInstanceEventType::kRestarted;
+    event.pid = instance->pid;
+    event.attempt = instance->backoff.attempt();
+    events->push_back(std::move(event));
+    return;
+  }
+  // A failed restart counts as another crash.
+  event.type = CoreInstanceEventType::kRestartFailed;
+  event.message = error;
+  event.restart_in_ms = instance->backoff.OnExit(MonotonicMs(), 0);
+  event.attempt = instance->backoff.attempt();
+  event.crash_loop = instance->backoff.open();
+  instance->restart_at_ms =
+      event.restart_in_ms >= 0 ? MonotonicMs() + event.restart_in_ms : -1;
+  instance->message = error;
+  events->push_back(std::move(event));
+}
+
+std::unique_ptr<CoreInstanceRegistry::Instance> CoreInstanceRegistry::RemoveLocked(
+    const std::string& profile_id) {
+  const auto it = instances_.find(profile_id);
+  if (it == instances_.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<Instance> instance = std::move(it->second);
+  instances_.erase(it);
+  serials_.erase(instance->serial);
+  // Its descriptors stay open until the process is stopped.
+  for (const int fd : {instance->pidfd, instance->stdout_fd, instance->stderr_fd}) {
+    if (fd >= 0) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+  }
+  return instance;
+}
+
+void CoreInstanceRegistry::StopRemoved(std::unique_ptr<Instance> instance,
+                                       int timeout_ms,
+                                       ProcessStopResult* result) {
+  if (instance->pid > 0) {
+    const ProcessStopResult stopped =
+        StopProcessGroup(instance->pid, instance->pidfd, timeout_ms);
+    if (result != nullptr) {
+      *result = stopped;
+    }
+    ReadOutput(instance.get(), kStdout, SIZE_MAX);
+    ReadOutput(instance.get(), kStderr, SIZE_MAX);
+  }
+  CloseProcess(instance.get());
+  CloseFd(&instance->spawn.executable_fd);
+  std::error_code ec;
+  fs::remove_all(instance->directory, ec);
+  // Only now that the process is gone may its ports be handed out again.
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReleaseLocked(instance.get());
+}
+
+void CoreInstanceRegistry::ReleaseLocked(Instance* instance) {
+  for (const uint16_t port : instance->ports) {
+    reserved_ports_.erase(port);
+  }
+  instance->ports.clear();
+}
+
+CoreInstanceState CoreInstanceRegistry::StateLocked(const Instance& instance) const {
+  CoreInstanceState state;
+  state.profile_id = instance.profile_id;
+  state.status = instance.status;
+  state.pid = instance.pid > 0 ? instance.pid : 0;
+  state.started_at_ms = instance.pid > 0 ? instance.started_at_ms : 0;
+  state.restarts = instance.restarts;
+  state.crash_loop = instance.backoff.open();
+  state.listen_ports = instance.config.listen_ports;
+  state.has_controller = instance.config.has_controller;
+  state.controller = instance.config.controller;
+  state.directory = instance.directory;
+  state.message = instance.message;
+  return state;
+}
+
+uint16_t CoreInstanceRegistry::PickPortLocked() {
+  for (int attempt = 0; attempt < kPortAttempts; ++attempt) {
+    const uint16_t port = PickFreeTcpPort();
+    if (port != 0 && reserved_ports_.count(port) == 0 && !IsTcpPortInUse(port)) {
+      reserved_ports_.insert(port);
+      return port;
+    }
+  }
+  return 0;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,177 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_INSTANCES_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_INSTANCES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clash_api_client.h"
+#include "core_readiness.h"
+#include "core_state_machine.h"
+#include "core_supervisor.h"
+#include "kernel_log_buffer.h"
+#include "process_launcher.h"
+
+namespace jumper_sdk_platform {
+
+// A core running beside the main one, as getCoreState reports it.
+struct CoreInstanceState {
+  std::string profile_id;
+  // kRunning once spawned, kError while an automatic restart is pending or
+  // after the breaker opened.
+  CoreStatus status = CoreStatus::kStopped;
+  int64_t pid = 0;
+  // Monotonic milliseconds when the current process was spawned.
+  int64_t started_at_ms = 0;
+  // Automatic restarts since the instance was started.
+  int restarts = 0;
+  bool crash_loop = false;
+  // Every port the relocated config listens on, the controller's last.
+  std::vector<uint16_t> listen_ports;
+  bool has_controller = false;
+  ClashApiEndpoint controller;
+  // Holds the relocated config and the instance's cache file.
+  std::string directory;
+  std::string message;
+};
+
+enum class CoreInstanceEventType {
+  kExited,
+  kRestarted,
+  kRestartFailed,
+};
+
+struct CoreInstanceEvent {
+  CoreInstanceEventType type = CoreInstanceEventType::kExited;
+  std::string profile_id;
+  int64_t pid = 0;
+  // As with waitpid; -1 when not applicable.
+  int exit_code = -1;
+  int signal = -1;
+  int64_t uptime_ms = 0;
+  // -1 when no restart is scheduled.
+  int64_t restart_in_ms = -1;
+  int attempt = 0;
+  bool crash_loop = false;
+  std::string message;
+  // What the exited process wrote last.
+  std::vector<KernelLogLine> last_logs;
+};
+
+enum class CoreInstanceStartResult {
+  kStarted,
+  kLimitReached,
+  kConfigInvalid,
+  kSpawnFailed,
+  kExited,
+  kNotReady,
+  kCancelled,
+};
+
+// Cores that run beside the main one, keyed by the profile they serve, e.g.
+// a candidate profile under test or an isolated per-app proxy. Each instance
+// runs a copy of its config moved to ports no other instance holds, with
+// its own cache file, log buffer and restart backoff.
+//
+// One thread supervises every instance: it waits on their pidfds and output
+// pipes with epoll, reaps each process as it exits and spawns it again once
+// the backoff allows. Restarted instances count as running once spawned.
+// All other methods may be called from any thread; |on_event| is called on
+// the supervising thread with no lock held.
+class CoreInstanceRegistry {
+ public:
+  using EventCallback = std::function<void(const CoreInstanceEvent& event)>;
+
+  // Instances keep their files under |root|, which is emptied first: no
+  // instance outlives the registry.
+  CoreInstanceRegistry(std::string root,
+                       size_t max_instances,
+                       const RestartBackoffOptions& backoff,
+                       EventCallback on_event);
+  // Stops every instance, killing what is left after a short grace period,
+  // and reaps them all.
+  ~CoreInstanceRegistry();
+
+  CoreInstanceRegistry(const CoreInstanceRegistry&) = delete;
+  CoreInstanceRegistry& operator=(const CoreInstanceRegistry&) = delete;
+
+  // Stops the instance already running for |profile_id|, if any, then spawns
+  // |spawn| with its single `-c` config relocated, and waits up to
+  // |ready_timeout_ms| for its Clash API. |wait| sleeps as in
+  // ReadinessHooks. |spawn.executable_fd| is duplicated and kept for
+  // restarts; its pipes and process group are set here. Whatever fails is
+  // stopped and removed again.
+  CoreInstanceStartResult Start(const std::string& profile_id,
+                                const SpawnOptions& spawn,
+                                int ready_timeout_ms,
+                                const std::function<bool(int milliseconds)>& wait,
+                                CoreInstanceState* state,
+                                ReadinessTimings* timings,
+                                std::string* error);
+
+  // Stops and removes the instance. Returns false when there is none.
+  bool Stop(const std::string& profile_id, int timeout_ms, ProcessStopResult* result);
+
+  bool GetState(const std::string& profile_id, CoreInstanceState* state) const;
+  std::vector<CoreInstanceState> States() const;
+
+  // The instance's output; null when there is no instance. Stays readable
+  // after the instance is removed.
+  std::shared_ptr<KernelLogBuffer> Logs(const std::string& profile_id) const;
+
+ private:
+  struct Instance;
+
+  enum Source : uint64_t {
+    kPidfd = 0,
+    kStdout = 1,
+    kStderr = 2,
+  };
+
+  // Reads what |source| has, up to |max_reads| chunks, into the instance's
+  // log buffer, closing the pipe at its end. Returns false once it is
+  // closed.
+  static bool ReadOutput(Instance* instance, Source source, size_t max_reads);
+  static void CloseProcess(Instance* instance);
+
+  void Run();
+  void Wake();
+  // Stops the process of an instance no longer in the registry, then frees
+  // its files and ports.
+  void StopRemoved(std::unique_ptr<Instance> instance, int timeout_ms, ProcessStopResult* result);
+  // The rest require |mutex_|.
+  bool SpawnLocked(Instance* instance, std::string* error);
+  void OnExitedLocked(Instance* instance, int status, std::vector<CoreInstanceEvent>* events);
+  void OnRestartDueLocked(Instance* instance, std::vector<CoreInstanceEvent>* events);
+  std::unique_ptr<Instance> RemoveLocked(const std::string& profile_id);
+  void ReleaseLocked(Instance* instance);
+  CoreInstanceState StateLocked(const Instance& instance) const;
+  uint16_t PickPortLocked();
+
+  const std::string root_;
+  const size_t max_instances_;
+  const RestartBackoffOptions backoff_;
+  const EventCallback on_event_;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<Instance>> instances_;
+  // By serial, as carried in epoll events.
+  std::map<uint64_t, Instance*> serials_;
+  std::set<uint16_t> reserved_ports_;
+  uint64_t next_serial_ = 1;
+  bool stopping_ = false;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::thread thread_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_INSTANCES_H_
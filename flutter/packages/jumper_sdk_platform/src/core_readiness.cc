@@ -0,0 +1,160 @@
+#include "core_readiness.h"
+
+#include <algorithm>
+
+#include "net_socket.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr int kInitialBackoffMs = 5;
+constexpr int kMaxBackoffMs = 50;
+// Bounds a single attempt so a wedged listener cannot eat the whole budget.
+constexpr int kAttemptTimeoutMs = 500;
+// Sockets of an exited core go away with its last descriptor holder.
+constexpr int kPortReleasePollMs = 10;
+// A reloading core is briefly without its Clash API; short polls catch the
+// gap.
+constexpr int kHandoverPollMs = 2;
+
+}  // namespace
+
+double MillisecondsBetween(std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+uint16_t FindPortInUse(const std::vector<uint16_t>& ports) {
+  for (const uint16_t port : ports) {
+    if (port != 0 && IsTcpPortInUse(port)) {
+      return port;
+    }
+  }
+  return 0;
+}
+
+uint16_t WaitForPortsReleased(const std::vector<uint16_t>& ports,
+                              int timeout_ms,
+                              const std::function<bool(int milliseconds)>& wait) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  for (;;) {
+    const uint16_t busy_port = FindPortInUse(ports);
+    if (busy_port == 0 || std::chrono::steady_clock::now() >= deadline ||
+        !wait(kPortReleasePollMs)) {
+      return busy_port;
+    }
+  }
+}
+
+ReadinessResult WaitForClashApi(const ClashApiEndpoint& endpoint,
+                                std::chrono::steady_clock::time_point started_at,
+                                int timeout_ms,
+                                const ReadinessHooks& hooks,
+                                ReadinessTimings* timings,
+                                std::string* error) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  int backoff_ms = kInitialBackoffMs;
+  std::string last_error = "no response";
+  for (;;) {
+    std::string reason;
+    if (hooks.has_exited && hooks.has_exited(&reason)) {
+      if (error != nullptr) {
+        *error = reason;
+      }
+      return ReadinessResult::kExited;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+    const int remaining_ms = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count());
+    HttpResponse response;
+    std::string attempt_error;
+    timings->probe_attempts += 1;
+    const bool answered =
+        SendClashApiRequest(endpoint, "GET", "/version", "", std::min(remaining_ms, kAttemptTimeoutMs),
+                            &response, &attempt_error);
+    if (timings->first_byte_ms < 0 &&
+        response.first_byte_at != std::chrono::steady_clock::time_point()) {
+      timings->first_byte_ms = MillisecondsBetween(started_at, response.first_byte_at);
+    }
+    if (answered && response.status == 200) {
+      timings->ready_ms = MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+      return ReadinessResult::kReady;
+    }
+    if (answered && (response.status == 401 || response.status == 403)) {
+      if (error != nullptr) {
+        *error = "Clash API rejected the configured secret (HTTP " +
+                 std::to_string(response.status) + ")";
+      }
+      return ReadinessResult::kRejected;
+    }
+    last_error = answered ? "HTTP " + std::to_string(response.status) : attempt_error;
+
+    if (hooks.wait && !hooks.wait(backoff_ms)) {
+      if (error != nullptr) {
+        *error = "Core startup was cancelled by stopCore";
+      }
+      return ReadinessResult::kCancelled;
+    }
+    backoff_ms = std::min(backoff_ms * 2, kMaxBackoffMs);
+  }
+
+  if (error != nullptr) {
+    *error = "Clash API at " + endpoint.host + ":" + std::to_string(endpoint.port) +
+             " not ready after " + std::to_string(timeout_ms) + " ms: " + last_error;
+  }
+  return ReadinessResult::kTimedOut;
+}
+
+ReadinessResult WaitForClashApiHandover(const ClashApiEndpoint& previous,
+                                        const ClashApiEndpoint& endpoint,
+                                        std::chrono::steady_clock::time_point started_at,
+                                        int timeout_ms,
+                                        const ReadinessHooks& hooks,
+                                        ReadinessTimings* timings,
+                                        std::string* error) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  for (;;) {
+    std::string reason;
+    if (hooks.has_exited && hooks.has_exited(&reason)) {
+      if (error != nullptr) {
+        *error = reason;
+      }
+      return ReadinessResult::kExited;
+    }
+    // Connecting, unlike binding, cannot get in the way of the new instance
+    // taking the port back.
+    TcpConnection connection;
+    if (!connection.Connect(previous.host, previous.port, kAttemptTimeoutMs, nullptr)) {
+      break;
+    }
+    connection.Close();
+    if (std::chrono::steady_clock::now() >= deadline) {
+      if (error != nullptr) {
+        *error = "Core kept serving the previous config";
+      }
+      return ReadinessResult::kTimedOut;
+    }
+    if (hooks.wait && !hooks.wait(kHandoverPollMs)) {
+      if (error != nullptr) {
+        *error = "Core reload was cancelled";
+      }
+      return ReadinessResult::kCancelled;
+    }
+  }
+  const int remaining_ms = static_cast<int>(std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                            std::chrono::steady_clock::now())
+          .count(),
+      0));
+  return WaitForClashApi(endpoint, started_at, remaining_ms, hooks, timings, error);
+}
+
+}  // namespace jumper_sdk_platform
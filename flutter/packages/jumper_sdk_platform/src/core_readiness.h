@@ -0,0 +1,79 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_READINESS_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_READINESS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "clash_api_client.h"
+
+namespace jumper_sdk_platform {
+
+// Per-phase startup timings, in milliseconds since the start call began.
+// Phases that were not reached stay negative.
+struct ReadinessTimings {
+  double spawn_ms = -1;
+  double first_byte_ms = -1;
+  double ready_ms = -1;
+  int probe_attempts = 0;
+};
+
+// Platform hooks used while polling. |wait| sleeps for up to the given number
+// of milliseconds and returns false once the start has been cancelled.
+// |has_exited| returns true, with a description in |reason|, once the core
+// process is gone.
+struct ReadinessHooks {
+  std::function<bool(int milliseconds)> wait;
+  std::function<bool(std::string* reason)> has_exited;
+};
+
+enum class ReadinessResult {
+  kReady,
+  kCancelled,
+  kExited,
+  kRejected,
+  kTimedOut,
+};
+
+double MillisecondsBetween(std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end);
+
+// Returns the first port in |ports| that another process already listens on,
+// or 0 when all of them are free.
+uint16_t FindPortInUse(const std::vector<uint16_t>& ports);
+
+// Polls until every port in |ports| is free, for a core that was just
+// stopped and whose sockets may outlive it by a few milliseconds. |wait|
+// sleeps as in ReadinessHooks and may end the wait early by returning false.
+// Returns the port still in use after |timeout_ms|, or 0.
+uint16_t WaitForPortsReleased(const std::vector<uint16_t>& ports,
+                              int timeout_ms,
+                              const std::function<bool(int milliseconds)>& wait);
+
+// Polls `GET /version` on |endpoint| with a short exponential backoff until it
+// answers 200, the process exits, the hooks report cancellation or
+// |timeout_ms| elapses. Fills the first-byte and ready phases of |timings|.
+ReadinessResult WaitForClashApi(const ClashApiEndpoint& endpoint,
+                                std::chrono::steady_clock::time_point started_at,
+                                int timeout_ms,
+                                const ReadinessHooks& hooks,
+                                ReadinessTimings* timings,
+                                std::string* error);
+
+// Waits for a core told to reload its config: first for |previous| to stop
+// accepting connections, as the old instance closes its Clash API, so that
+// it cannot answer for the new one; then for |endpoint| to answer as in
+// WaitForClashApi(). Both phases share |timeout_ms|.
+ReadinessResult WaitForClashApiHandover(const ClashApiEndpoint& previous,
+                                        const ClashApiEndpoint& endpoint,
+                                        std::chrono::steady_clock::time_point started_at,
+                                        int timeout_ms,
+                                        const ReadinessHooks& hooks,
+                                        ReadinessTimings* timings,
+                                        std::string* error);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_READINESS_H_
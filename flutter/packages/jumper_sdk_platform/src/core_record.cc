@@ -0,0 +1,189 @@
+#include "core_record.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// `starttime` in /proc/<pid>/stat, counted from `state` (field 3 in
+// proc(5)).
+constexpr size_t kStatStartTimeIndex = 19;
+
+std::string ReadText(JsonScanner* scanner) {
+  std::string_view raw;
+  return scanner->ReadString(&raw) ? UnescapeJsonString(raw) : std::string();
+}
+
+bool ReadFile(const std::string& path, std::string* content) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  *content = buffer.str();
+  return true;
+}
+
+}  // namespace
+
+std::string SerializeCoreRecord(const CoreRecord& record) {
+  std::string json = "{\n  \"pid\": " + std::to_string(record.pid) +
+                     ",\n  \"startTime\": " + std::to_string(record.start_time) +
+                     ",\n  \"binaryPath\": " + QuoteJsonString(record.binary_path) +
+                     ",\n  \"binarySha256\": " + QuoteJsonString(record.binary_sha256) +
+                     ",\n  \"arguments\": [";
+  for (size_t i = 0; i < record.arguments.size(); ++i) {
+    json += (i == 0 ? "" : ", ") + QuoteJsonString(record.arguments[i]);
+  }
+  json += "],\n  \"workingDirectory\": " + QuoteJsonString(record.working_directory) +
+          ",\n  \"environment\": [";
+  for (size_t i = 0; i < record.environment.size(); ++i) {
+    json += (i == 0 ? "" : ", ") + QuoteJsonString(record.environment[i]);
+  }
+  json += "],\n  \"configPath\": " + QuoteJsonString(record.config_path) +
+          ",\n  \"configSha256\": " + QuoteJsonString(record.config_sha256) +
+          ",\n  \"logPath\": " + QuoteJsonString(record.log_path) + "\n}\n";
+  return json;
+}
+
+bool ParseCoreRecord(const std::string& json, CoreRecord* record, std::string* error) {
+  *record = CoreRecord();
+  JsonScanner scanner(json);
+  std::string_view key;
+  if (scanner.EnterObject()) {
+    while (scanner.NextMember(&key)) {
+      int64_t number = 0;
+      if (key == "pid") {
+        if (scanner.ReadInteger(&number)) {
+          record->pid = number;
+        }
+      } else if (key == "startTime") {
+        if (scanner.ReadInteger(&number) && number > 0) {
+          record->start_time = static_cast<uint64_t>(number);
+        }
+      } else if (key == "binaryPath") {
+        record->binary_path = ReadText(&scanner);
+      } else if (key == "binarySha256") {
+        record->binary_sha256 = ReadText(&scanner);
+      } else if (key == "arguments") {
+        if (scanner.EnterArray()) {
+          while (scanner.NextElement()) {
+            record->arguments.push_back(ReadText(&scanner));
+          }
+        }
+      } else if (key == "workingDirectory") {
+        record->working_directory = ReadText(&scanner);
+      } else if (key == "environment") {
+        if (scanner.EnterArray()) {
+          while (scanner.NextElement()) {
+            record->environment.push_back(ReadText(&scanner));
+          }
+        }
+      } else if (key == "configPath") {
+        record->config_path = ReadText(&scanner);
+      } else if (key == "configSha256") {
+        record->config_sha256 = ReadText(&scanner);
+      } else if (key == "logPath") {
+        record->log_path = ReadText(&scanner);
+      } else {
+        scanner.Skip();
+      }
+    }
+  }
+  if (!scanner.ok() || record->pid <= 0 || record->start_time == 0 ||
+      record->arguments.empty()) {
+    if (error != nullptr) {
+      *error = "Malformed core record";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool WriteCoreRecord(const std::string& path, const CoreRecord& record, std::string* error) {
+  const std::string temp = path + ".tmp";
+  {
+    std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+    stream << SerializeCoreRecord(record);
+    if (!stream) {
+      if (error != nullptr) {
+        *error = "Unable to write " + temp;
+      }
+      return false;
+    }
+  }
+  std::error_code ec;
+  // The environment may carry credentials.
+  fs::permissions(temp, fs::perms::owner_read | fs::perms::owner_write, ec);
+  fs::rename(temp, path, ec);
+  if (ec) {
+    if (error != nullptr) {
+      *error = "Unable to replace " + path + ": " + ec.message();
+    }
+    fs::remove(temp, ec);
+    return false;
+  }
+  return true;
+}
+
+bool ReadCoreRecord(const std::string& path, CoreRecord* record, std::string* error) {
+  std::string json;
+  if (!ReadFile(path, &json)) {
+    *record = CoreRecord();
+    if (error != nullptr) {
+      *error = "No core record at " + path;
+    }
+    return false;
+  }
+  return ParseCoreRecord(json, record, error);
+}
+
+uint64_t ProcessStartTime(int64_t pid) {
+  std::string content;
+  // The command name may contain spaces and parentheses; fields start after
+  // the last ')'.
+  if (pid <= 0 || !ReadFile("/proc/" + std::to_string(pid) + "/stat", &content) ||
+      content.rfind(')') == std::string::npos) {
+    return 0;
+  }
+  std::istringstream fields(content.substr(content.rfind(')') + 1));
+  std::string token;
+  for (size_t i = 0; i <= kStatStartTimeIndex; ++i) {
+    if (!(fields >> token)) {
+      return 0;
+    }
+  }
+  return std::strtoull(token.c_str(), nullptr, 10);
+}
+
+bool ProcessArguments(int64_t pid, std::vector<std::string>* arguments) {
+  std::string content;
+  if (pid <= 0 || !ReadFile("/proc/" + std::to_string(pid) + "/cmdline", &content) ||
+      content.empty()) {
+    return false;
+  }
+  arguments->clear();
+  size_t start = 0;
+  while (start < content.size()) {
+    const size_t end = content.find('\0', start);
+    arguments->push_back(content.substr(start, end == std::string::npos ? end : end - start));
+    if (end == std::string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
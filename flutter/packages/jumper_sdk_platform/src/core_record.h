@@ -0,0 +1,49 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_RECORD_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_RECORD_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+// What a plugin needs to recognise, and take over, a core it launched before
+// the app was restarted.
+struct CoreRecord {
+  int64_t pid = 0;
+  // As /proc reports it, in clock ticks after boot. Tells the core apart
+  // from a later process that was given the same pid.
+  uint64_t start_time = 0;
+  std::string binary_path;
+  // Digest of what the process executes, read through /proc/<pid>/exe.
+  std::string binary_sha256;
+  // argv, argv[0] included.
+  std::vector<std::string> arguments;
+  std::string working_directory;
+  // `KEY=VALUE` overrides in the order they were given.
+  std::vector<std::string> environment;
+  // The single `-c` config and its digest when the core was launched.
+  std::string config_path;
+  std::string config_sha256;
+  // Where the core's stdout and stderr go.
+  std::string log_path;
+};
+
+std::string SerializeCoreRecord(const CoreRecord& record);
+bool ParseCoreRecord(const std::string& json, CoreRecord* record, std::string* error);
+
+// Replaces |path| through a temporary file and a rename, so a reader sees
+// either record whole. Not flushed to disk: after a power loss there is no
+// core left to adopt.
+bool WriteCoreRecord(const std::string& path, const CoreRecord& record, std::string* error);
+bool ReadCoreRecord(const std::string& path, CoreRecord* record, std::string* error);
+
+// Start time of |pid| from /proc/<pid>/stat, or 0 when it is not running.
+uint64_t ProcessStartTime(int64_t pid);
+
+// argv of |pid| from /proc/<pid>/cmdline.
+bool ProcessArguments(int64_t pid, std::vector<std::string>* arguments);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_RECORD_H_
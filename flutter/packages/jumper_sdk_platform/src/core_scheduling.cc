@@ -0,0 +1,347 @@
+#include "core_scheduling.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr char kCgroupRoot[] = "/sys/fs/cgroup";
+// `nice` in /proc/<pid>/stat, counted from `state` (field 3 in proc(5)).
+constexpr size_t kStatNiceIndex = 16;
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassShift = 13;
+constexpr int kIoprioLevelMask = (1 << kIoprioClassShift) - 1;
+// Upper bound for systemd to answer StartTransientUnit.
+constexpr int kSystemdCallTimeoutMs = 2000;
+// Threads started while a renice walks the list inherit the old value from
+// whoever started them, so the list is walked again until it holds no new
+// thread, up to this many times.
+constexpr int kRenicePasses = 4;
+
+bool ReadFile(const std::string& path, std::string* content) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  *content = buffer.str();
+  return true;
+}
+
+// cgroupfs reports a rejected value on the write itself.
+bool WriteFile(const std::string& path, const std::string& content, std::string* error) {
+  const int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  const bool written =
+      fd >= 0 && write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+  const int write_error = errno;
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!written && error != nullptr) {
+    *error = "Unable to write " + path + ": " + std::strerror(write_error);
+  }
+  return written;
+}
+
+int64_t ReadNumber(const std::string& path) {
+  std::string content;
+  if (!ReadFile(path, &content) || content.empty()) {
+    return -1;
+  }
+  if (content.compare(0, 3, "max") == 0) {
+    return 0;
+  }
+  return std::strtoll(content.c_str(), nullptr, 10);
+}
+
+// The cgroup2 path of |pid|, from the `0::` line of /proc/<pid>/cgroup.
+bool ReadCgroup(const std::string& pid, std::string* cgroup) {
+  std::string content;
+  if (!ReadFile("/proc/" + pid + "/cgroup", &content)) {
+    return false;
+  }
+  std::istringstream lines(content);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.compare(0, 3, "0::") == 0) {
+      *cgroup = line.substr(3);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool EndsWith(std::string_view text, std::string_view suffix) {
+  return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+std::string Parent(const std::string& cgroup) {
+  const size_t slash = cgroup.rfind('/');
+  return slash == std::string::npos || slash == 0 ? std::string() : cgroup.substr(0, slash);
+}
+
+// A parent we may create a sibling in. Slices belong to systemd, which
+// does not expect directories it did not create.
+bool IsDelegated(const std::string& parent) {
+  if (parent.empty() || EndsWith(parent, ".slice")) {
+    return false;
+  }
+  const std::string path = kCgroupRoot + parent;
+  return access(path.c_str(), W_OK) == 0 &&
+         access((path + "/cgroup.procs").c_str(), W_OK) == 0 &&
+         access((path + "/cgroup.subtree_control").c_str(), W_OK) == 0;
+}
+
+// Hands |controller| down from |parent| unless it already is.
+bool EnableController(const std::string& parent, const char* controller, std::string* error) {
+  std::string enabled;
+  ReadFile(kCgroupRoot + parent + "/cgroup.subtree_control", &enabled);
+  std::istringstream names(enabled);
+  std::string name;
+  while (names >> name) {
+    if (name == controller) {
+      return true;
+    }
+  }
+  return WriteFile(kCgroupRoot + parent + "/cgroup.subtree_control",
+                   std::string("+") + controller, error);
+}
+
+bool PlaceInCgroupfs(pid_t pid,
+                     const std::string& parent,
+                     const CoreSchedulingOptions& options,
+                     CgroupPlacement* placement,
+                     std::string* error) {
+  const std::string name = parent + "/jumper-core-" + std::to_string(pid);
+  const std::string path = kCgroupRoot + name;
+  if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    if (error != nullptr) {
+      *error = "Unable to create " + path + ": " + std::strerror(errno);
+    }
+    return false;
+  }
+  const bool placed =
+      (options.cpu_weight == 0 ||
+       (EnableController(parent, "cpu", error) &&
+        WriteFile(path + "/cpu.weight", std::to_string(options.cpu_weight), error))) &&
+      (options.memory_high_bytes == 0 ||
+       (EnableController(parent, "memory", error) &&
+        WriteFile(path + "/memory.high", std::to_string(options.memory_high_bytes), error))) &&
+      WriteFile(path + "/cgroup.procs", std::to_string(pid), error);
+  if (!placed) {
+    rmdir(path.c_str());
+    return false;
+  }
+  placement->kind = CgroupPlacementKind::kCgroupfs;
+  placement->name = name;
+  return true;
+}
+
+// systemd-run cannot take in a process that is already running; its
+// StartTransientUnit call can, through the PIDs property.
+bool PlaceInSystemdScope(pid_t pid,
+                         const CoreSchedulingOptions& options,
+                         CgroupPlacement* placement,
+                         std::string* error) {
+  const std::string unit = "jumper-core-" + std::to_string(pid) + ".scope";
+  SpawnOptions call;
+  call.executable = "busctl";
+  call.arguments = {"busctl", "--user", "--quiet", "call", "org.freedesktop.systemd1",
+                    "/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager",
+                    "StartTransientUnit", "ssa(sv)a(sa(sv))", unit, "fail"};
+  std::vector<std::string> properties = {"PIDs", "au", "1", std::to_string(pid),
+                                         "CollectMode", "s", "inactive-or-failed"};
+  if (options.cpu_weight > 0) {
+    properties.insert(properties.end(), {"CPUWeight", "t", std::to_string(options.cpu_weight)});
+  }
+  if (options.memory_high_bytes > 0) {
+    properties.insert(properties.end(),
+                      {"MemoryHigh", "t", std::to_string(options.memory_high_bytes)});
+  }
+  call.arguments.push_back(std::to_string(properties.size() / 3));
+  call.arguments.insert(call.arguments.end(), properties.begin(), properties.end());
+  // No auxiliary units.
+  call.arguments.push_back("0");
+  int exit_code = -1;
+  std::string output;
+  if (!RunProcess(call, kSystemdCallTimeoutMs, &exit_code, &output, error)) {
+    return false;
+  }
+  if (exit_code != 0) {
+    if (error != nullptr) {
+      while (!output.empty() && (output.back() == '\n' || output.back() == ' ')) {
+        output.pop_back();
+      }
+      *error = "systemd refused " + unit + ": " + output;
+    }
+    return false;
+  }
+  placement->kind = CgroupPlacementKind::kSystemdScope;
+  placement->name = unit;
+  return true;
+}
+
+}  // namespace
+
+const char* CgroupPlacementName(CgroupPlacementKind kind) {
+  switch (kind) {
+    case CgroupPlacementKind::kSystemdScope:
+      return "systemd-scope";
+    case CgroupPlacementKind::kCgroupfs:
+      return "cgroupfs";
+    case CgroupPlacementKind::kNone:
+      break;
+  }
+  return "none";
+}
+
+bool PlaceInCgroup(pid_t pid,
+                   const CoreSchedulingOptions& options,
+                   CgroupPlacement* placement,
+                   std::string* error) {
+  *placement = CgroupPlacement();
+  std::string own;
+  if (access((std::string(kCgroupRoot) + "/cgroup.controllers").c_str(), F_OK) != 0 ||
+      !ReadCgroup("self", &own)) {
+    if (error != nullptr) {
+      *error = "No cgroup v2 hierarchy at " + std::string(kCgroupRoot);
+    }
+    return false;
+  }
+  const std::string parent = Parent(own);
+  return IsDelegated(parent) ? PlaceInCgroupfs(pid, parent, options, placement, error)
+                             : PlaceInSystemdScope(pid, options, placement, error);
+}
+
+CgroupPlacement FindCgroupPlacement(pid_t pid) {
+  CgroupPlacement placement;
+  std::string cgroup;
+  if (!ReadCgroup(std::to_string(pid), &cgroup)) {
+    return placement;
+  }
+  const std::string name = "jumper-core-" + std::to_string(pid);
+  const std::string leaf = cgroup.substr(cgroup.rfind('/') + 1);
+  if (leaf == name + ".scope") {
+    placement.kind = CgroupPlacementKind::kSystemdScope;
+    placement.name = leaf;
+  } else if (leaf == name) {
+    placement.kind = CgroupPlacementKind::kCgroupfs;
+    placement.name = cgroup;
+  }
+  return placement;
+}
+
+void RemoveCgroup(const CgroupPlacement& placement) {
+  if (placement.kind == CgroupPlacementKind::kCgroupfs) {
+    rmdir((kCgroupRoot + placement.name).c_str());
+  }
+}
+
+bool ReniceProcess(pid_t pid, int nice) {
+  const std::string tasks = "/proc/" + std::to_string(pid) + "/task";
+  std::set<long> reniced;
+  bool all = true;
+  for (int pass = 0; pass < kRenicePasses; ++pass) {
+    DIR* directory = opendir(tasks.c_str());
+    if (directory == nullptr) {
+      return false;
+    }
+    bool found_new = false;
+    while (const dirent* entry = readdir(directory)) {
+      char* end = nullptr;
+      const long tid = std::strtol(entry->d_name, &end, 10);
+      if (end == entry->d_name || *end != '\0' || !reniced.insert(tid).second) {
+        continue;
+      }
+      found_new = true;
+      // A thread that exited in the meantime is not a failure.
+      if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) != 0 && errno != ESRCH) {
+        all = false;
+      }
+    }
+    closedir(directory);
+    if (!found_new) {
+      break;
+    }
+  }
+  return all;
+}
+
+bool ReadProcessScheduling(pid_t pid, ProcessSchedulingState* state) {
+  *state = ProcessSchedulingState();
+  const std::string id = std::to_string(pid);
+  std::string content;
+  // The command name may contain spaces and parentheses; fields start after
+  // the last ')'.
+  if (pid <= 0 || !ReadFile("/proc/" + id + "/stat", &content) ||
+      content.rfind(')') == std::string::npos) {
+    return false;
+  }
+  std::istringstream fields(content.substr(content.rfind(')') + 1));
+  std::string token;
+  for (size_t i = 0; i <= kStatNiceIndex && fields >> token; ++i) {
+    if (i == kStatNiceIndex) {
+      state->nice = std::atoi(token.c_str());
+    }
+  }
+  const long ioprio = syscall(SYS_ioprio_get, kIoprioWhoProcess, pid);
+  if (ioprio >= 0) {
+    state->io_class = static_cast<int>(ioprio >> kIoprioClassShift);
+    state->io_level = static_cast<int>(ioprio & kIoprioLevelMask);
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if (sched_getaffinity(pid, sizeof(cpus), &cpus) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpus)) {
+        state->cpus.push_back(cpu);
+      }
+    }
+  }
+  if (ReadCgroup(id, &state->cgroup)) {
+    const std::string path = kCgroupRoot + state->cgroup;
+    state->cpu_weight = ReadNumber(path + "/cpu.weight");
+    state->memory_high_bytes = ReadNumber(path + "/memory.high");
+    state->memory_current_bytes = ReadNumber(path + "/memory.current");
+  }
+  return true;
+}
+
+const char* IoClassName(int io_class) {
+  switch (io_class) {
+    case 1:
+      return "realtime";
+    case 2:
+      return "best-effort";
+    case 3:
+      return "idle";
+    default:
+      return "none";
+  }
+}
+
+int ParseIoClass(std::string_view name) {
+  for (int io_class = 1; io_class <= 3; ++io_class) {
+    if (name == IoClassName(io_class)) {
+      return io_class;
+    }
+  }
+  return 0;
+}
+
+}  // namespace jumper_sdk_platform
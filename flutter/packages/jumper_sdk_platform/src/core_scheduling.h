@@ -0,0 +1,101 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SCHEDULING_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SCHEDULING_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "process_launcher.h"
+
+namespace jumper_sdk_platform {
+
+// How the core should share the machine with the app that runs it, from
+// launchOptions.scheduling.
+struct CoreSchedulingOptions {
+  // Set at spawn and inherited by every thread of the core.
+  ProcessScheduling process;
+  // The nice value the core starts with instead of |process.nice|, so it
+  // comes up quickly on a busy machine. Every thread drops to the steady
+  // value once the core is ready.
+  bool has_startup_nice = false;
+  int startup_nice = 0;
+  // cgroup v2 limits; 0 leaves them. When either is set, the core is moved
+  // into a cgroup of its own.
+  uint32_t cpu_weight = 0;
+  uint64_t memory_high_bytes = 0;
+
+  bool wants_cgroup() const { return cpu_weight > 0 || memory_high_bytes > 0; }
+};
+
+enum class CgroupPlacementKind {
+  kNone,
+  // A transient scope the user's systemd manages.
+  kSystemdScope,
+  // A directory we created in a sub-tree delegated to us.
+  kCgroupfs,
+};
+
+struct CgroupPlacement {
+  CgroupPlacementKind kind = CgroupPlacementKind::kNone;
+  // The scope unit, or the directory under the cgroup2 mount.
+  std::string name;
+  // Why the core was left where it was.
+  std::string error;
+};
+
+const char* CgroupPlacementName(CgroupPlacementKind kind);
+
+// Moves |pid| into a cgroup of its own limited by |options|. When the parent
+// of our own cgroup is delegated to us (writable, and not a systemd slice),
+// a sibling directory is created there; otherwise the user's systemd is
+// asked for a transient scope holding |pid|. The whole thread group moves,
+// whenever it started its threads. Returns false, with the reason, when the
+// core stays in our cgroup.
+bool PlaceInCgroup(pid_t pid,
+                   const CoreSchedulingOptions& options,
+                   CgroupPlacement* placement,
+                   std::string* error);
+
+// The placement PlaceInCgroup made for |pid|, recognised by the name it
+// gave the cgroup; kNone for any other cgroup. Lets a core adopted after a
+// restart of the app have its directory removed all the same.
+CgroupPlacement FindCgroupPlacement(pid_t pid);
+
+// Removes a directory PlaceInCgroup created, once its process has been
+// reaped. systemd collects its scopes itself.
+void RemoveCgroup(const CgroupPlacement& placement);
+
+// Sets the nice value of every thread |pid| has: nice is per thread on
+// Linux, and the threads the core started during a boost kept it.
+bool ReniceProcess(pid_t pid, int nice);
+
+// What a process runs with, read back from /proc and the cgroup2 mount.
+// Values that could not be read stay at -1.
+struct ProcessSchedulingState {
+  // Of the main thread.
+  int nice = -1;
+  // As ioprio_get(2); class 0 follows the nice value.
+  int io_class = -1;
+  int io_level = -1;
+  std::vector<int> cpus;
+  // The cgroup path, relative to the cgroup2 mount.
+  std::string cgroup;
+  int64_t cpu_weight = -1;
+  // 0 when unlimited.
+  int64_t memory_high_bytes = -1;
+  int64_t memory_current_bytes = -1;
+};
+
+bool ReadProcessScheduling(pid_t pid, ProcessSchedulingState* state);
+
+// "realtime", "best-effort", "idle" or "none" for class 0.
+const char* IoClassName(int io_class);
+// 0 for an unknown name.
+int ParseIoClass(std::string_view name);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SCHEDULING_H_
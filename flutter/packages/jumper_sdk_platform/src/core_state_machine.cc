@@ -0,0 +1,111 @@
+#include "core_state_machine.h"
+
+#include <algorithm>
+
+namespace jumper_sdk_platform {
+
+const char* CoreStatusName(CoreStatus status) {
+  switch (status) {
+    case CoreStatus::kStopped:
+      return "stopped";
+    case CoreStatus::kStarting:
+      return "starting";
+    case CoreStatus::kRunning:
+      return "running";
+    case CoreStatus::kStopping:
+      return "stopping";
+    case CoreStatus::kError:
+      return "error";
+  }
+  return "stopped";
+}
+
+CoreStateMachine::CoreStateMachine(size_t replay_capacity, int64_t timestamp_ms)
+    : replay_capacity_(std::max<size_t>(replay_capacity, 1)) {
+  state_.version = 1;
+  CoreTransition initial;
+  initial.version = 1;
+  initial.timestamp_ms = timestamp_ms;
+  initial.state = state_;
+  initial.message = "core is stopped";
+  transitions_.push_back(std::move(initial));
+}
+
+bool CoreStateMachine::IsAllowed(CoreStatus from, CoreStatus to) {
+  switch (from) {
+    case CoreStatus::kStopped:
+      return to == CoreStatus::kStarting;
+    case CoreStatus::kStarting:
+      return to != CoreStatus::kStarting;
+    case CoreStatus::kRunning:
+      // running -> running reports a new pid or mode.
+      return true;
+    case CoreStatus::kStopping:
+      return to == CoreStatus::kStopped || to == CoreStatus::kError ||
+             to == CoreStatus::kStarting;
+    case CoreStatus::kError:
+      return to == CoreStatus::kStarting || to == CoreStatus::kStopped;
+  }
+  return false;
+}
+
+bool CoreStateMachine::Apply(const CoreStateChange& change,
+                             int64_t timestamp_ms,
+                             CoreTransition* transition) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::string& runtime_mode =
+      change.runtime_mode.empty() ? state_.runtime_mode : change.runtime_mode;
+  if (change.status == state_.status && change.pid == state_.pid &&
+      runtime_mode == state_.runtime_mode) {
+    return false;
+  }
+  if (!IsAllowed(state_.status, change.status)) {
+    return false;
+  }
+  CoreTransition next;
+  next.previous_status = state_.status;
+  state_.status = change.status;
+  state_.runtime_mode = runtime_mode;
+  state_.pid = change.pid;
+  state_.version += 1;
+  next.version = state_.version;
+  next.timestamp_ms = timestamp_ms;
+  next.state = state_;
+  next.message = change.message;
+  transitions_.push_back(next);
+  while (transitions_.size() > replay_capacity_) {
+    transitions_.pop_front();
+  }
+  if (transition != nullptr) {
+    *transition = std::move(next);
+  }
+  return true;
+}
+
+void CoreStateMachine::SetProfileId(const std::string& profile_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.profile_id = profile_id;
+}
+
+void CoreStateMachine::SetNetworkMode(const std::string& network_mode) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.network_mode = network_mode;
+}
+
+CoreStateSnapshot CoreStateMachine::Snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+std::vector<CoreTransition> CoreStateMachine::TransitionsSince(uint64_t version) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<CoreTransition> result;
+  for (const CoreTransition& transition : transitions_) {
+    if (transition.version > version) {
+      result.push_back(transition);
+    }
+  }
+  return result;
+}
+
+}  // namespace jumper_sdk_platform
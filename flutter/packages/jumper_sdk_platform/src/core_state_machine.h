@@ -0,0 +1,85 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_STATE_MACHINE_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_STATE_MACHINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+// Mirrors the SDK's CoreStatus and the states the macOS plugin reports.
+enum class CoreStatus {
+  kStopped,
+  kStarting,
+  kRunning,
+  kStopping,
+  kError,
+};
+
+const char* CoreStatusName(CoreStatus status);
+
+struct CoreStateSnapshot {
+  CoreStatus status = CoreStatus::kStopped;
+  std::string runtime_mode = "simulator";
+  int64_t pid = 0;
+  std::string profile_id;
+  std::string network_mode = "tunnel";
+  // Version of the transition that produced this state.
+  uint64_t version = 0;
+};
+
+struct CoreStateChange {
+  CoreStatus status = CoreStatus::kStopped;
+  // Keeps the current mode when empty.
+  std::string runtime_mode;
+  int64_t pid = 0;
+  std::string message;
+};
+
+struct CoreTransition {
+  uint64_t version = 0;
+  int64_t timestamp_ms = 0;
+  CoreStatus previous_status = CoreStatus::kStopped;
+  CoreStateSnapshot state;
+  std::string message;
+};
+
+// Owns the reported core state. Every change goes through Apply(), which
+// rejects edges the lifecycle cannot take (e.g. stopped -> running), stamps
+// the next version and keeps the newest |replay_capacity| transitions so a
+// listener that attaches late can catch up. Starts out stopped, as version 1.
+//
+// Thread-safe: the lifecycle lane writes, the platform thread reads.
+class CoreStateMachine {
+ public:
+  CoreStateMachine(size_t replay_capacity, int64_t timestamp_ms);
+
+  CoreStateMachine(const CoreStateMachine&) = delete;
+  CoreStateMachine& operator=(const CoreStateMachine&) = delete;
+
+  // Returns false, leaving the state alone, for a disallowed edge or a change
+  // that alters nothing.
+  bool Apply(const CoreStateChange& change, int64_t timestamp_ms, CoreTransition* transition);
+  // Reported alongside the state; they do not count as transitions.
+  void SetProfileId(const std::string& profile_id);
+  void SetNetworkMode(const std::string& network_mode);
+
+  CoreStateSnapshot Snapshot() const;
+  // Buffered transitions with a version above |version|, oldest first.
+  std::vector<CoreTransition> TransitionsSince(uint64_t version) const;
+
+  static bool IsAllowed(CoreStatus from, CoreStatus to);
+
+ private:
+  mutable std::mutex mutex_;
+  CoreStateSnapshot state_;
+  std::deque<CoreTransition> transitions_;
+  size_t replay_capacity_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_STATE_MACHINE_H_
@@ -0,0 +1,43 @@
+#include "core_supervisor.h"
+
+#include <algorithm>
+
+namespace jumper_sdk_platform {
+
+RestartBackoff::RestartBackoff(const RestartBackoffOptions& options)
+    : options_(options), random_(std::random_device{}()) {}
+
+int64_t RestartBackoff::OnExit(int64_t now_ms, int64_t uptime_ms) {
+  if (open_) {
+    return -1;
+  }
+  if (uptime_ms >= options_.stable_uptime_ms) {
+    attempt_ = 0;
+  }
+  exit_times_.push_back(now_ms);
+  while (!exit_times_.empty() && now_ms - exit_times_.front() > options_.crash_window_ms) {
+    exit_times_.pop_front();
+  }
+  if (static_cast<int>(exit_times_.size()) > options_.max_crashes) {
+    open_ = true;
+    return -1;
+  }
+
+  int64_t delay = options_.initial_delay_ms;
+  for (int i = 0; i < attempt_ && delay < options_.max_delay_ms; ++i) {
+    delay *= 2;
+  }
+  delay = std::min(delay, options_.max_delay_ms);
+  ++attempt_;
+  const int64_t half = delay / 2;
+  std::uniform_int_distribution<int64_t> jitter(0, delay - half);
+  return half + jitter(random_);
+}
+
+void RestartBackoff::Reset() {
+  exit_times_.clear();
+  attempt_ = 0;
+  open_ = false;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,55 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SUPERVISOR_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SUPERVISOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <random>
+
+namespace jumper_sdk_platform {
+
+struct RestartBackoffOptions {
+  int64_t initial_delay_ms = 500;
+  int64_t max_delay_ms = 30000;
+  // A core that ran at least this long counts as healthy: its exit starts
+  // the delays over from |initial_delay_ms|.
+  int64_t stable_uptime_ms = 60000;
+  // More than |max_crashes| exits within |crash_window_ms| open the breaker.
+  int max_crashes = 5;
+  int64_t crash_window_ms = 120000;
+};
+
+// Decides when a core that exited on its own is started again. Delays double
+// per consecutive crash up to |max_delay_ms|, with equal jitter (half fixed,
+// half random) so a crash shared by many machines does not restart them in
+// lockstep. Once the core crash-loops, the breaker opens and no further
+// restart is scheduled until Reset(), i.e. until the next deliberate start.
+//
+// Not thread-safe; each plugin uses it from its lifecycle lane only.
+class RestartBackoff {
+ public:
+  explicit RestartBackoff(const RestartBackoffOptions& options);
+
+  RestartBackoff(const RestartBackoff&) = delete;
+  RestartBackoff& operator=(const RestartBackoff&) = delete;
+
+  // Records an exit at |now_ms| (a monotonic clock) after |uptime_ms| of
+  // running. Returns the delay before the next start, or -1 once the
+  // breaker is open.
+  int64_t OnExit(int64_t now_ms, int64_t uptime_ms);
+  void Reset();
+
+  bool open() const { return open_; }
+  // Restarts scheduled since the last Reset() or stable run.
+  int attempt() const { return attempt_; }
+
+ private:
+  RestartBackoffOptions options_;
+  std::mt19937_64 random_;
+  std::deque<int64_t> exit_times_;
+  int attempt_ = 0;
+  bool open_ = false;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_CORE_SUPERVISOR_H_
@@ -0,0 +1,254 @@
+#include "file_digest.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include "sha256.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+// Runtimes are tens of megabytes; a handful of entries covers every
+// version the container keeps.
+constexpr size_t kMaxCachedDigests = 64;
+
+std::mutex& CacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::string, std::string>& DigestCache() {
+  static std::unordered_map<std::string, std::string> cache;
+  return cache;
+}
+
+bool LookupDigest(const FileIdentity& identity, std::string* hex) {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  const auto it = DigestCache().find(identity.ToString());
+  if (it == DigestCache().end()) {
+    return false;
+  }
+  *hex = it->second;
+  return true;
+}
+
+#ifdef _WIN32
+
+bool ReadIdentity(HANDLE handle, FileIdentity* identity) {
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!GetFileInformationByHandle(handle, &info)) {
+    return false;
+  }
+  identity->device = info.dwVolumeSerialNumber;
+  identity->inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+  identity->size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+  // FILETIME counts 100 ns intervals.
+  identity->mtime_ns = static_cast<int64_t>(
+      ((static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+       info.ftLastWriteTime.dwLowDateTime) *
+      100);
+  return true;
+}
+
+#else
+
+void ReadIdentity(const struct stat& info, FileIdentity* identity) {
+  identity->device = static_cast<uint64_t>(info.st_dev);
+  identity->inode = static_cast<uint64_t>(info.st_ino);
+  identity->size = static_cast<uint64_t>(info.st_size);
+  identity->mtime_ns =
+      static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+#endif
+
+}  // namespace
+
+std::string FileIdentity::ToString() const {
+  char text[96];
+  std::snprintf(text, sizeof(text), "%" PRIu64 ":%" PRIu64 ":%" PRIu64 ":%" PRId64, device, inode,
+                size, mtime_ns);
+  return text;
+}
+
+bool FileIdentity::Parse(const std::string& text, FileIdentity* identity) {
+  FileIdentity parsed;
+  if (std::sscanf(text.c_str(), "%" SCNu64 ":%" SCNu64 ":%" SCNu64 ":%" SCNd64, &parsed.device,
+                  &parsed.inode, &parsed.size, &parsed.mtime_ns) != 4) {
+    return false;
+  }
+  *identity = parsed;
+  return true;
+}
+
+PinnedFile::~PinnedFile() { Close(); }
+
+#ifdef _WIN32
+
+bool PinnedFile::Open(const std::string& path, std::string* error) {
+  Close();
+  // No FILE_SHARE_WRITE or FILE_SHARE_DELETE: nobody can change or replace
+  // the file while it is pinned.
+  handle_ = CreateFileW(std::filesystem::u8path(path).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (handle_ == INVALID_HANDLE_VALUE) {
+    if (error != nullptr) {
+      *error = "Cannot open " + path + ", error " + std::to_string(GetLastError());
+    }
+    return false;
+  }
+  if (!ReadIdentity(handle_, &identity_)) {
+    if (error != nullptr) {
+      *error = "Cannot stat " + path + ", error " + std::to_string(GetLastError());
+    }
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void PinnedFile::Close() {
+  if (handle_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(handle_);
+    handle_ = INVALID_HANDLE_VALUE;
+  }
+  identity_ = FileIdentity();
+}
+
+bool PinnedFile::is_open() const { return handle_ != INVALID_HANDLE_VALUE; }
+
+#else
+
+bool PinnedFile::Open(const std::string& path, std::string* error) {
+  Close();
+  fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    if (error != nullptr) {
+      *error = "Cannot open " + path + ": " + std::strerror(errno);
+    }
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)) {
+    if (error != nullptr) {
+      *error = "Not a regular file: " + path;
+    }
+    Close();
+    return false;
+  }
+  ReadIdentity(info, &identity_);
+  return true;
+}
+
+void PinnedFile::Close() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  identity_ = FileIdentity();
+}
+
+bool PinnedFile::is_open() const { return fd_ >= 0; }
+
+#endif
+
+bool PinnedFile::Sha256(std::string* hex, bool* cached, std::string* error) {
+  *cached = false;
+  if (!is_open()) {
+    if (error != nullptr) {
+      *error = "File is not open";
+    }
+    return false;
+  }
+  if (LookupDigest(identity_, hex)) {
+    *cached = true;
+    return true;
+  }
+
+  jumper_sdk_platform::Sha256 sha;
+  if (identity_.size > 0) {
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingW(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+      if (error != nullptr) {
+        *error = "Cannot map file, error " + std::to_string(GetLastError());
+      }
+      if (mapping != nullptr) {
+        CloseHandle(mapping);
+      }
+      return false;
+    }
+    sha.Update(view, static_cast<size_t>(identity_.size));
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+#else
+    void* view = mmap(nullptr, identity_.size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (view == MAP_FAILED) {
+      if (error != nullptr) {
+        *error = std::string("Cannot map file: ") + std::strerror(errno);
+      }
+      return false;
+    }
+    madvise(view, identity_.size, MADV_SEQUENTIAL);
+    sha.Update(view, static_cast<size_t>(identity_.size));
+    munmap(view, identity_.size);
+#endif
+  }
+  *hex = sha.FinishHex();
+
+#ifndef _WIN32
+  // A write that landed while hashing leaves a digest of neither version;
+  // only cache what provably belongs to this identity.
+  struct stat after;
+  FileIdentity current;
+  if (fstat(fd_, &after) == 0) {
+    ReadIdentity(after, &current);
+  }
+  if (!(current == identity_)) {
+    return true;
+  }
+#endif
+  RememberFileDigest(identity_, *hex);
+  return true;
+}
+
+bool Sha256File(const std::string& path,
+                std::string* hex,
+                FileIdentity* identity,
+                std::string* error) {
+  PinnedFile file;
+  bool cached = false;
+  if (!file.Open(path, error) || !file.Sha256(hex, &cached, error)) {
+    return false;
+  }
+  if (identity != nullptr) {
+    *identity = file.identity();
+  }
+  return true;
+}
+
+void RememberFileDigest(const FileIdentity& identity, const std::string& hex) {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  auto& cache = DigestCache();
+  if (cache.size() >= kMaxCachedDigests) {
+    cache.clear();
+  }
+  cache[identity.ToString()] = hex;
+}
+
+}  // namespace jumper_sdk_platform
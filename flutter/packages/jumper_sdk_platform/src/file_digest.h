@@ -0,0 +1,80 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_DIGEST_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_DIGEST_H_
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include <cstdint>
+#include <string>
+
+namespace jumper_sdk_platform {
+
+// Which file, and which version of it: any write or replacement changes at
+// least one field.
+struct FileIdentity {
+  uint64_t device = 0;
+  uint64_t inode = 0;
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+
+  bool operator==(const FileIdentity& other) const {
+    return device == other.device && inode == other.inode && size == other.size &&
+           mtime_ns == other.mtime_ns;
+  }
+
+  // `device:inode:size:mtime`, as stored in the runtime index.
+  std::string ToString() const;
+  static bool Parse(const std::string& text, FileIdentity* identity);
+};
+
+// A file held open from the moment it is hashed until it is used, so what
+// was verified is what runs. On POSIX the descriptor can be exec'd directly;
+// on Windows the handle denies writers and deleters while it is open.
+class PinnedFile {
+ public:
+  PinnedFile() = default;
+  ~PinnedFile();
+
+  PinnedFile(const PinnedFile&) = delete;
+  PinnedFile& operator=(const PinnedFile&) = delete;
+
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  // SHA-256 of the contents as lowercase hex, served from a process-wide
+  // cache keyed by identity() when this exact file was hashed before.
+  bool Sha256(std::string* hex, bool* cached, std::string* error);
+
+  bool is_open() const;
+  const FileIdentity& identity() const { return identity_; }
+#ifdef _WIN32
+  HANDLE handle() const { return handle_; }
+#else
+  int fd() const { return fd_; }
+#endif
+
+ private:
+#ifdef _WIN32
+  HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+  int fd_ = -1;
+#endif
+  FileIdentity identity_;
+};
+
+// Hashes the file at |path| through a PinnedFile.
+bool Sha256File(const std::string& path,
+                std::string* hex,
+                FileIdentity* identity,
+                std::string* error);
+
+// Seeds the digest cache with a result from an earlier run.
+void RememberFileDigest(const FileIdentity& identity, const std::string& hex);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_DIGEST_H_
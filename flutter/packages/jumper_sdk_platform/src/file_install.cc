@@ -0,0 +1,424 @@
+#include "file_install.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include <cerrno>
+#endif
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr size_t kCompareChunkBytes = 64 * 1024;
+
+bool SameContents(const std::string& first, const std::string& second) {
+  std::ifstream a(std::filesystem::u8path(first), std::ios::binary);
+  std::ifstream b(std::filesystem::u8path(second), std::ios::binary);
+  if (!a || !b) {
+    return false;
+  }
+  std::vector<char> a_chunk(kCompareChunkBytes);
+  std::vector<char> b_chunk(kCompareChunkBytes);
+  for (;;) {
+    a.read(a_chunk.data(), static_cast<std::streamsize>(a_chunk.size()));
+    b.read(b_chunk.data(), static_cast<std::streamsize>(b_chunk.size()));
+    const std::streamsize count = a.gcount();
+    if (count != b.gcount() ||
+        std::memcmp(a_chunk.data(), b_chunk.data(), static_cast<size_t>(count)) != 0) {
+      return false;
+    }
+    if (count == 0) {
+      return a.eof() && b.eof();
+    }
+  }
+}
+
+bool HasContents(const std::string& path, const std::string& contents) {
+  std::ifstream input(std::filesystem::u8path(path), std::ios::binary);
+  if (!input) {
+    return false;
+  }
+  const std::string current((std::istreambuf_iterator<char>(input)),
+                            std::istreambuf_iterator<char>());
+  return current == contents;
+}
+
+#ifdef _WIN32
+
+// Flushes |temp| to disk and moves it over |destination| in one step.
+// Unlike deleting the destination first, a failure leaves the old file.
+bool CommitTempFile(const std::filesystem::path& temp,
+                    const std::filesystem::path& destination,
+                    std::string* error) {
+  HANDLE file = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    FlushFileBuffers(file);
+    CloseHandle(file);
+  }
+  if (!MoveFileExW(temp.c_str(), destination.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    if (error != nullptr) {
+      *error = "Unable to replace " + destination.u8string() + ", error " +
+               std::to_string(GetLastError());
+    }
+    std::error_code ignored;
+    std::filesystem::remove(temp, ignored);
+    return false;
+  }
+  return true;
+}
+
+std::filesystem::path TempPathFor(const std::filesystem::path& destination) {
+  std::filesystem::path temp = destination;
+  temp += L".partial";
+  return temp;
+}
+
+#else
+
+constexpr size_t kStreamBufferBytes = 128 * 1024;
+// Upper bound for one copy_file_range call; the kernel may copy less.
+constexpr size_t kKernelCopyChunkBytes = 1 << 30;
+
+void SetError(std::string* error, const std::string& what, const std::string& path) {
+  if (error != nullptr) {
+    *error = what + " " + path + ": " + std::strerror(errno);
+  }
+}
+
+// Opens a new, empty file next to |path| so the final rename stays on one
+// filesystem.
+int CreateTempFileFor(const std::string& path, std::string* temp_path) {
+  std::vector<char> name(path.begin(), path.end());
+  const char suffix[] = ".XXXXXX";
+  name.insert(name.end(), suffix, suffix + sizeof(suffix));
+  const int fd = mkostemp(name.data(), O_CLOEXEC);
+  if (fd >= 0) {
+    temp_path->assign(name.data());
+  }
+  return fd;
+}
+
+void DiscardTempFile(int fd, const std::string& temp_path) {
+  close(fd);
+  unlink(temp_path.c_str());
+}
+
+// Makes the rename itself durable.
+void SyncParentDirectory(const std::string& path) {
+  const size_t slash = path.rfind('/');
+  const std::string parent = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  const int fd = open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+
+// Flushes and closes |fd|, then renames |temp_path| over |destination|.
+// Consumes |fd| either way.
+bool CommitTempFile(int fd,
+                    const std::string& temp_path,
+                    const std::string& destination,
+                    std::string* error) {
+  if (fsync(fd) != 0) {
+    SetError(error, "Unable to flush", temp_path);
+    DiscardTempFile(fd, temp_path);
+    return false;
+  }
+  close(fd);
+  if (rename(temp_path.c_str(), destination.c_str()) != 0) {
+    SetError(error, "Unable to replace", destination);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  SyncParentDirectory(destination);
+  return true;
+}
+
+bool WriteAll(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    const ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    length -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool CopyContents(int in, int out, InstallMethod* method, std::string* error) {
+#ifdef FICLONE
+  if (ioctl(out, FICLONE, in) == 0) {
+    *method = InstallMethod::kReflink;
+    return true;
+  }
+#endif
+#ifdef SYS_copy_file_range
+  // Called directly: some glibc versions emulate it in user space, which is
+  // the read/write loop below with extra steps.
+  size_t copied_total = 0;
+  for (;;) {
+    const ssize_t copied = syscall(SYS_copy_file_range, in, nullptr, out, nullptr,
+                                   kKernelCopyChunkBytes, 0u);
+    if (copied > 0) {
+      copied_total += static_cast<size_t>(copied);
+      continue;
+    }
+    if (copied == 0) {
+      *method = InstallMethod::kCopyFileRange;
+      return true;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    // Older kernels refuse cross-filesystem copies, and some filesystems any
+    // copy at all. Nothing has been written yet, so streaming can start over.
+    if (copied_total == 0 &&
+        (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+      break;
+    }
+    if (error != nullptr) {
+      *error = std::string("copy_file_range failed: ") + std::strerror(errno);
+    }
+    return false;
+  }
+#endif
+  std::vector<char> buffer(kStreamBufferBytes);
+  for (;;) {
+    const ssize_t count = read(in, buffer.data(), buffer.size());
+    if (count == 0) {
+      break;
+    }
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (error != nullptr) {
+        *error = std::string("read failed: ") + std::strerror(errno);
+      }
+      return false;
+    }
+    if (!WriteAll(out, buffer.data(), static_cast<size_t>(count))) {
+      if (error != nullptr) {
+        *error = std::string("write failed: ") + std::strerror(errno);
+      }
+      return false;
+    }
+  }
+  *method = InstallMethod::kStream;
+  return true;
+}
+
+bool SameTime(const struct timespec& a, const struct timespec& b) {
+  return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+#endif
+
+}  // namespace
+
+const char* InstallMethodName(InstallMethod method) {
+  switch (method) {
+    case InstallMethod::kUnchanged:
+      return "unchanged";
+    case InstallMethod::kReflink:
+      return "reflink";
+    case InstallMethod::kCopyFileRange:
+      return "copy_file_range";
+    case InstallMethod::kStream:
+      return "stream";
+    case InstallMethod::kCopyFile:
+      return "copy";
+  }
+  return "unknown";
+}
+
+#ifdef _WIN32
+
+bool InstallFile(const std::string& source,
+                 const std::string& destination,
+                 bool executable,
+                 InstallMethod* method,
+                 std::string* error) {
+  namespace fs = std::filesystem;
+  const fs::path source_path = fs::u8path(source);
+  const fs::path destination_path = fs::u8path(destination);
+  std::error_code ec;
+  const auto source_size = fs::file_size(source_path, ec);
+  const auto source_time = ec ? fs::file_time_type() : fs::last_write_time(source_path, ec);
+  if (ec) {
+    if (error != nullptr) {
+      *error = "Source file not found: " + source;
+    }
+    return false;
+  }
+  if (fs::file_size(destination_path, ec) == source_size && !ec) {
+    bool current = fs::last_write_time(destination_path, ec) == source_time && !ec;
+    if (!current && SameContents(source, destination)) {
+      // Adopt the source's time so the next check needs no reads.
+      fs::last_write_time(destination_path, source_time, ec);
+      current = true;
+    }
+    if (current) {
+      *method = InstallMethod::kUnchanged;
+      return true;
+    }
+  }
+
+  fs::create_directories(destination_path.parent_path(), ec);
+  const fs::path temp = TempPathFor(destination_path);
+  // CopyFileExW keeps the source's timestamps, and clones blocks itself
+  // where the volume supports it.
+  if (!CopyFileExW(source_path.c_str(), temp.c_str(), nullptr, nullptr, nullptr, 0)) {
+    if (error != nullptr) {
+      *error = "Unable to copy " + source + ", error " + std::to_string(GetLastError());
+    }
+    return false;
+  }
+  if (!CommitTempFile(temp, destination_path, error)) {
+    return false;
+  }
+  *method = InstallMethod::kCopyFile;
+  return true;
+}
+
+bool InstallTextFile(const std::string& path,
+                     const std::string& contents,
+                     bool* changed,
+                     std::string* error) {
+  *changed = false;
+  if (HasContents(path, contents)) {
+    return true;
+  }
+  const std::filesystem::path destination = std::filesystem::u8path(path);
+  const std::filesystem::path temp = TempPathFor(destination);
+  {
+    std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+    output << contents;
+    if (!output.good()) {
+      if (error != nullptr) {
+        *error = "Unable to write file: " + path;
+      }
+      return false;
+    }
+  }
+  if (!CommitTempFile(temp, destination, error)) {
+    return false;
+  }
+  *changed = true;
+  return true;
+}
+
+#else
+
+bool InstallFile(const std::string& source,
+                 const std::string& destination,
+                 bool executable,
+                 InstallMethod* method,
+                 std::string* error) {
+  struct stat source_info;
+  if (stat(source.c_str(), &source_info) != 0 || !S_ISREG(source_info.st_mode)) {
+    if (error != nullptr) {
+      *error = "Source file not found: " + source;
+    }
+    return false;
+  }
+  const mode_t mode = executable ? 0755 : 0644;
+  const struct timespec times[2] = {{0, UTIME_OMIT}, source_info.st_mtim};
+
+  struct stat destination_info;
+  if (stat(destination.c_str(), &destination_info) == 0 && S_ISREG(destination_info.st_mode) &&
+      destination_info.st_size == source_info.st_size) {
+    bool current = SameTime(destination_info.st_mtim, source_info.st_mtim);
+    if (!current && SameContents(source, destination)) {
+      // Adopt the source's time so the next check needs no reads.
+      utimensat(AT_FDCWD, destination.c_str(), times, 0);
+      current = true;
+    }
+    if (current) {
+      if ((destination_info.st_mode & 0777) != mode) {
+        chmod(destination.c_str(), mode);
+      }
+      *method = InstallMethod::kUnchanged;
+      return true;
+    }
+  }
+
+  const int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in < 0) {
+    SetError(error, "Unable to open", source);
+    return false;
+  }
+  std::string temp_path;
+  const int out = CreateTempFileFor(destination, &temp_path);
+  if (out < 0) {
+    SetError(error, "Unable to create a file next to", destination);
+    close(in);
+    return false;
+  }
+  const bool copied = CopyContents(in, out, method, error);
+  close(in);
+  if (!copied) {
+    DiscardTempFile(out, temp_path);
+    return false;
+  }
+  fchmod(out, mode);
+  futimens(out, times);
+  return CommitTempFile(out, temp_path, destination, error);
+}
+
+bool InstallTextFile(const std::string& path,
+                     const std::string& contents,
+                     bool* changed,
+                     std::string* error) {
+  *changed = false;
+  if (HasContents(path, contents)) {
+    return true;
+  }
+  std::string temp_path;
+  const int fd = CreateTempFileFor(path, &temp_path);
+  if (fd < 0) {
+    SetError(error, "Unable to create a file next to", path);
+    return false;
+  }
+  if (!WriteAll(fd, contents.data(), contents.size())) {
+    SetError(error, "Unable to write", temp_path);
+    DiscardTempFile(fd, temp_path);
+    return false;
+  }
+  fchmod(fd, 0644);
+  if (!CommitTempFile(fd, temp_path, path, error)) {
+    return false;
+  }
+  *changed = true;
+  return true;
+}
+
+#endif
+
+}  // namespace jumper_sdk_platform
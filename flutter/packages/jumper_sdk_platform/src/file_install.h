@@ -0,0 +1,47 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_INSTALL_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_INSTALL_H_
+
+#include <string>
+
+namespace jumper_sdk_platform {
+
+// How InstallFile put the destination in place.
+enum class InstallMethod {
+  // The destination already matched the source; nothing was written.
+  kUnchanged,
+  // FICLONE: the copy shares the source's extents.
+  kReflink,
+  // copy_file_range: the kernel copied the bytes without a user-space
+  // buffer.
+  kCopyFileRange,
+  // read/write through a fixed buffer, where neither of the above works.
+  kStream,
+  // CopyFileExW.
+  kCopyFile,
+};
+
+const char* InstallMethodName(InstallMethod method);
+
+// Makes |destination| a copy of |source| without ever exposing a partial
+// file: the bytes go to a temporary file next to it, which is flushed to
+// disk and renamed over the destination.
+//
+// The source's modification time is carried over, so a destination with the
+// same size and mtime is taken as current after a couple of stat calls. Same
+// size with a different mtime falls back to comparing the contents.
+bool InstallFile(const std::string& source,
+                 const std::string& destination,
+                 bool executable,
+                 InstallMethod* method,
+                 std::string* error);
+
+// Replaces |path| with |contents| the same way, unless it already holds
+// exactly that.
+bool InstallTextFile(const std::string& path,
+                     const std::string& contents,
+                     bool* changed,
+                     std::string* error);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_FILE_INSTALL_H_
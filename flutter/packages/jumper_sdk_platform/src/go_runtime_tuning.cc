@@ -0,0 +1,207 @@
+#include "go_runtime_tuning.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr uint64_t kMiB = 1024 * 1024;
+
+struct ProfileShape {
+  GoRuntimeProfile profile;
+  const char* name;
+  // Share of the memory budget the heap may grow to, as 1/n, and the bounds
+  // it is kept within.
+  uint64_t memory_divisor;
+  uint64_t min_memory_limit;
+  uint64_t max_memory_limit;
+  int gc_percent;
+};
+
+constexpr ProfileShape kProfiles[] = {
+    {GoRuntimeProfile::kLowMemory, "low-memory", 16, 64 * kMiB, 256 * kMiB, 50},
+    {GoRuntimeProfile::kBalanced, "balanced", 8, 128 * kMiB, 1024 * kMiB, 100},
+    {GoRuntimeProfile::kThroughput, "throughput", 4, 256 * kMiB, 4096 * kMiB, 200},
+};
+
+// The soft limit leaves this share of a hard one to the memory the Go heap
+// does not account for: stacks, cgo, the binary itself.
+constexpr uint64_t kHardLimitPercent = 90;
+
+#ifndef _WIN32
+
+bool ReadFile(const std::string& path, std::string* content) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  *content = buffer.str();
+  return true;
+}
+
+// A memory.max or memory.high value; 0 for "max" or when unreadable.
+uint64_t ReadMemoryLimit(const std::string& path) {
+  std::string content;
+  if (!ReadFile(path, &content) || content.empty() || content.compare(0, 3, "max") == 0) {
+    return 0;
+  }
+  return std::strtoull(content.c_str(), nullptr, 10);
+}
+
+// cpu.max holds "$QUOTA $PERIOD" or "max $PERIOD"; 0 when unlimited.
+double ReadCpuQuota(const std::string& path) {
+  std::string content;
+  if (!ReadFile(path, &content) || content.compare(0, 3, "max") == 0) {
+    return 0;
+  }
+  std::istringstream fields(content);
+  double quota = 0;
+  double period = 0;
+  return fields >> quota >> period && quota > 0 && period > 0 ? quota / period : 0;
+}
+
+// The lower of two limits where 0 means none.
+template <typename T>
+T Tighter(T a, T b) {
+  return a == 0 ? b : b == 0 ? a : std::min(a, b);
+}
+
+#endif
+
+}  // namespace
+
+const char* GoRuntimeProfileName(GoRuntimeProfile profile) {
+  for (const ProfileShape& shape : kProfiles) {
+    if (shape.profile == profile) {
+      return shape.name;
+    }
+  }
+  return "off";
+}
+
+bool ParseGoRuntimeProfile(std::string_view name, GoRuntimeProfile* profile) {
+  if (name == "off") {
+    *profile = GoRuntimeProfile::kOff;
+    return true;
+  }
+  for (const ProfileShape& shape : kProfiles) {
+    if (name == shape.name) {
+      *profile = shape.profile;
+      return true;
+    }
+  }
+  return false;
+}
+
+MachineResources ReadMachineResources() {
+  MachineResources resources;
+#ifdef _WIN32
+  resources.cpus = std::max(1, static_cast<int>(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS)));
+  MEMORYSTATUSEX memory{};
+  memory.dwLength = sizeof(memory);
+  if (GlobalMemoryStatusEx(&memory)) {
+    resources.memory_bytes = memory.ullTotalPhys;
+  }
+#else
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  resources.cpus = sched_getaffinity(0, sizeof(cpus), &cpus) == 0
+                       ? std::max(1, CPU_COUNT(&cpus))
+                       : std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages > 0 && page_size > 0) {
+    resources.memory_bytes = static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+  }
+  // Limits anywhere above us apply to us too.
+  std::string content;
+  if (ReadFile("/proc/self/cgroup", &content)) {
+    const size_t start = content.find("0::");
+    std::string cgroup = start == std::string::npos
+                             ? std::string()
+                             : content.substr(start + 3, content.find('\n', start) - start - 3);
+    while (cgroup.size() > 1) {
+      const std::string path = "/sys/fs/cgroup" + cgroup;
+      resources.cpu_quota = Tighter(resources.cpu_quota, ReadCpuQuota(path + "/cpu.max"));
+      resources.memory_limit_bytes =
+          Tighter(resources.memory_limit_bytes,
+                  Tighter(ReadMemoryLimit(path + "/memory.max"),
+                          ReadMemoryLimit(path + "/memory.high")));
+      cgroup.resize(cgroup.rfind('/'));
+    }
+  }
+#endif
+  return resources;
+}
+
+GoRuntimeTuning TuneGoRuntime(GoRuntimeProfile profile, const MachineResources& resources) {
+  GoRuntimeTuning tuning;
+  tuning.profile = profile;
+  tuning.resources = resources;
+  const ProfileShape* shape = nullptr;
+  for (const ProfileShape& candidate : kProfiles) {
+    if (candidate.profile == profile) {
+      shape = &candidate;
+    }
+  }
+  if (shape == nullptr) {
+    return tuning;
+  }
+
+  // More threads than the quota allows only get throttled together.
+  int cpus = std::max(1, resources.cpus);
+  if (resources.cpu_quota > 0) {
+    cpus = std::min(cpus, std::max(1, static_cast<int>(std::ceil(resources.cpu_quota))));
+  }
+  int max_procs = cpus;
+  if (profile == GoRuntimeProfile::kLowMemory) {
+    max_procs = std::min(cpus, 2);
+  } else if (profile == GoRuntimeProfile::kBalanced) {
+    max_procs = std::min(cpus, std::max(2, cpus / 2));
+  }
+
+  const uint64_t budget = resources.memory_limit_bytes > 0 && resources.memory_bytes > 0
+                              ? std::min(resources.memory_bytes, resources.memory_limit_bytes)
+                              : std::max(resources.memory_bytes, resources.memory_limit_bytes);
+  uint64_t memory_limit = std::clamp(budget / shape->memory_divisor, shape->min_memory_limit,
+                                     shape->max_memory_limit);
+  if (resources.memory_limit_bytes > 0) {
+    memory_limit = std::min(memory_limit, resources.memory_limit_bytes / 100 * kHardLimitPercent);
+  }
+
+  tuning.environment["GOMAXPROCS"] = std::to_string(max_procs);
+  tuning.environment["GOMEMLIMIT"] = std::to_string(std::max<uint64_t>(memory_limit / kMiB, 1)) +
+                                     "MiB";
+  tuning.environment["GOGC"] = std::to_string(shape->gc_percent);
+  return tuning;
+}
+
+void ApplyGoRuntimeTuning(GoRuntimeTuning* tuning,
+                          std::map<std::string, std::string>* environment) {
+  for (auto& [key, value] : tuning->environment) {
+    const auto [entry, added] = environment->emplace(key, value);
+    if (!added) {
+      value = entry->second;
+    }
+  }
+}
+
+}  // namespace jumper_sdk_platform
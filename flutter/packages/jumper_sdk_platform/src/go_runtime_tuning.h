@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_GO_RUNTIME_TUNING_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_GO_RUNTIME_TUNING_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace jumper_sdk_platform {
+
+// How sing-box's Go runtime trades memory for CPU, as the user picks it.
+enum class GoRuntimeProfile {
+  // Nothing is set; the runtime's defaults apply.
+  kOff,
+  // Few threads and an early, tight GC, for small machines and laptops on
+  // battery.
+  kLowMemory,
+  // Leaves half the CPUs to the app and keeps the heap moderate.
+  kBalanced,
+  // Every CPU and a lazier GC, for routers and heavy downloads.
+  kThroughput,
+};
+
+const char* GoRuntimeProfileName(GoRuntimeProfile profile);
+// "off", "low-memory", "balanced" or "throughput".
+bool ParseGoRuntimeProfile(std::string_view name, GoRuntimeProfile* profile);
+
+// What the core may use. The Go runtime sing-box 1.12 is built with sizes
+// GOMAXPROCS by the affinity mask alone and ignores a cgroup CPU quota; no
+// Go runtime knows of a memory limit but GOMEMLIMIT.
+struct MachineResources {
+  // CPUs we may run on.
+  int cpus = 1;
+  // cgroup v2 cpu.max, in CPUs; 0 when unlimited.
+  double cpu_quota = 0;
+  uint64_t memory_bytes = 0;
+  // The lowest memory.max or memory.high from our cgroup up to the root; 0
+  // when unlimited.
+  uint64_t memory_limit_bytes = 0;
+};
+
+// Reads them for this process: on Linux the affinity mask, physical memory
+// and the cgroup v2 limits above us; on Windows the active processors and
+// physical memory.
+MachineResources ReadMachineResources();
+
+struct GoRuntimeTuning {
+  GoRuntimeProfile profile = GoRuntimeProfile::kOff;
+  MachineResources resources;
+  // GOMAXPROCS, GOMEMLIMIT and GOGC.
+  std::map<std::string, std::string> environment;
+};
+
+// Derives the variables for |profile| from |resources|. GOMEMLIMIT stays
+// below a cgroup memory limit, so the heap is collected before the kernel
+// throttles or kills the core.
+GoRuntimeTuning TuneGoRuntime(GoRuntimeProfile profile, const MachineResources& resources);
+
+// Adds the tuning's variables to a launch |environment| that does not set
+// them already: what the caller set explicitly wins. Afterwards
+// |tuning->environment| holds what the core actually gets, an empty value
+// meaning the variable is removed.
+void ApplyGoRuntimeTuning(GoRuntimeTuning* tuning,
+                          std::map<std::string, std::string>* environment);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_GO_RUNTIME_TUNING_H_
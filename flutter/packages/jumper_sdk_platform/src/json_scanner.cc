@@ -0,0 +1,412 @@
+#include "json_scanner.h"
+
+#include <limits>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool IsScalarChar(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' ||
+         c == 'E';
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Reads the four hex digits at |raw[index]|, or returns -1.
+long ReadHex4(std::string_view raw, size_t index) {
+  if (index + 4 > raw.size()) {
+    return -1;
+  }
+  long value = 0;
+  for (size_t i = index; i < index + 4; ++i) {
+    const int digit = HexValue(raw[i]);
+    if (digit < 0) {
+      return -1;
+    }
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+void AppendUtf8(unsigned long code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+}  // namespace
+
+JsonScanner::JsonScanner(std::string_view json) : json_(json) {}
+
+JsonType JsonScanner::Peek() {
+  SkipSpace();
+  if (!ok_ || index_ >= json_.size()) {
+    return JsonType::kInvalid;
+  }
+  const char c = json_[index_];
+  switch (c) {
+    case '{':
+      return JsonType::kObject;
+    case '[':
+      return JsonType::kArray;
+    case '"':
+      return JsonType::kString;
+    case 't':
+    case 'f':
+      return JsonType::kBool;
+    case 'n':
+      return JsonType::kNull;
+    default:
+      return c == '-' || (c >= '0' && c <= '9') ? JsonType::kNumber : JsonType::kInvalid;
+  }
+}
+
+bool JsonScanner::EnterObject() {
+  if (Peek() != JsonType::kObject) {
+    Skip();
+    return false;
+  }
+  ++index_;
+  after_value_ = false;
+  return true;
+}
+
+bool JsonScanner::NextMember(std::string_view* key) {
+  SkipSpace();
+  if (!ok_ || index_ >= json_.size()) {
+    return Fail();
+  }
+  if (json_[index_] == '}') {
+    ++index_;
+    after_value_ = true;
+    return false;
+  }
+  if (after_value_) {
+    if (json_[index_] != ',') {
+      return Fail();
+    }
+    ++index_;
+    SkipSpace();
+  }
+  if (index_ >= json_.size() || json_[index_] != '"') {
+    return Fail();
+  }
+  const size_t key_start = index_ + 1;
+  if (!SkipStringBody()) {
+    return false;
+  }
+  *key = json_.substr(key_start, index_ - 1 - key_start);
+  SkipSpace();
+  if (index_ >= json_.size() || json_[index_] != ':') {
+    return Fail();
+  }
+  ++index_;
+  after_value_ = false;
+  return true;
+}
+
+bool JsonScanner::EnterArray() {
+  if (Peek() != JsonType::kArray) {
+    Skip();
+    return false;
+  }
+  ++index_;
+  after_value_ = false;
+  return true;
+}
+
+bool JsonScanner::NextElement() {
+  SkipSpace();
+  if (!ok_ || index_ >= json_.size()) {
+    return Fail();
+  }
+  if (json_[index_] == ']') {
+    ++index_;
+    after_value_ = true;
+    return false;
+  }
+  if (after_value_) {
+    if (json_[index_] != ',') {
+      return Fail();
+    }
+    ++index_;
+    SkipSpace();
+    if (index_ >= json_.size() || json_[index_] == ']') {
+      return Fail();
+    }
+  }
+  after_value_ = false;
+  return true;
+}
+
+bool JsonScanner::ReadString(std::string_view* raw) {
+  if (Peek() != JsonType::kString) {
+    Skip();
+    return false;
+  }
+  const size_t start = index_ + 1;
+  if (!SkipStringBody()) {
+    return false;
+  }
+  *raw = json_.substr(start, index_ - 1 - start);
+  after_value_ = true;
+  return true;
+}
+
+bool JsonScanner::ReadInteger(int64_t* value) {
+  if (Peek() != JsonType::kNumber) {
+    Skip();
+    return false;
+  }
+  const size_t start = index_;
+  SkipScalar();
+  after_value_ = true;
+  size_t index = start;
+  const bool negative = json_[index] == '-';
+  if (negative) {
+    ++index;
+  }
+  if (index == index_) {
+    return Fail();
+  }
+  // Accumulated as a negative number so INT64_MIN fits.
+  int64_t parsed = 0;
+  for (; index < index_; ++index) {
+    const char c = json_[index];
+    if (c < '0' || c > '9') {
+      // Fractions and exponents are valid JSON, just not integers.
+      return false;
+    }
+    if (parsed < (std::numeric_limits<int64_t>::min() + (c - '0')) / 10) {
+      return false;
+    }
+    parsed = parsed * 10 - (c - '0');
+  }
+  if (!negative) {
+    if (parsed == std::numeric_limits<int64_t>::min()) {
+      return false;
+    }
+    parsed = -parsed;
+  }
+  *value = parsed;
+  return true;
+}
+
+bool JsonScanner::ReadBool(bool* value) {
+  if (Peek() != JsonType::kBool) {
+    Skip();
+    return false;
+  }
+  const size_t start = index_;
+  SkipScalar();
+  after_value_ = true;
+  const std::string_view token = json_.substr(start, index_ - start);
+  if (token == "true") {
+    *value = true;
+  } else if (token == "false") {
+    *value = false;
+  } else {
+    return Fail();
+  }
+  return true;
+}
+
+bool JsonScanner::Skip() {
+  const JsonType type = Peek();
+  if (type == JsonType::kInvalid) {
+    return Fail();
+  }
+  if (type == JsonType::kString) {
+    if (!SkipStringBody()) {
+      return false;
+    }
+  } else if (type == JsonType::kObject || type == JsonType::kArray) {
+    // Containers are only checked for balanced brackets; nothing inside a
+    // skipped value is looked at.
+    size_t depth = 0;
+    while (index_ < json_.size()) {
+      const char c = json_[index_];
+      if (c == '"') {
+        if (!SkipStringBody()) {
+          return false;
+        }
+        continue;
+      }
+      ++index_;
+      if (c == '{' || c == '[') {
+        ++depth;
+      } else if ((c == '}' || c == ']') && --depth == 0) {
+        break;
+      }
+    }
+    if (depth != 0) {
+      return Fail();
+    }
+  } else {
+    const size_t start = index_;
+    SkipScalar();
+    const std::string_view token = json_.substr(start, index_ - start);
+    if (type != JsonType::kNumber && token != "true" && token != "false" && token != "null") {
+      return Fail();
+    }
+  }
+  after_value_ = true;
+  return true;
+}
+
+bool JsonScanner::SkipSpan(std::string_view* span) {
+  SkipSpace();
+  const size_t start = index_;
+  if (!Skip()) {
+    return false;
+  }
+  *span = json_.substr(start, index_ - start);
+  return true;
+}
+
+void JsonScanner::SkipSpace() {
+  while (index_ < json_.size() && IsSpace(json_[index_])) {
+    ++index_;
+  }
+}
+
+bool JsonScanner::Fail() {
+  ok_ = false;
+  return false;
+}
+
+bool JsonScanner::SkipStringBody() {
+  for (++index_; index_ < json_.size(); ++index_) {
+    if (json_[index_] == '\\') {
+      ++index_;
+    } else if (json_[index_] == '"') {
+      ++index_;
+      return true;
+    }
+  }
+  return Fail();
+}
+
+void JsonScanner::SkipScalar() {
+  while (index_ < json_.size() && IsScalarChar(json_[index_])) {
+    ++index_;
+  }
+}
+
+std::string UnescapeJsonString(std::string_view raw) {
+  std::string out;
+  out.reserve(raw.size());
+  for (size_t index = 0; index < raw.size(); ++index) {
+    const char c = raw[index];
+    if (c != '\\' || index + 1 >= raw.size()) {
+      out.push_back(c);
+      continue;
+    }
+    const char escape = raw[++index];
+    switch (escape) {
+      case 'b':
+        out.push_back('\b');
+        break;
+      case 'f':
+        out.push_back('\f');
+        break;
+      case 'n':
+        out.push_back('\n');
+        break;
+      case 'r':
+        out.push_back('\r');
+        break;
+      case 't':
+        out.push_back('\t');
+        break;
+      case 'u': {
+        long code_point = ReadHex4(raw, index + 1);
+        if (code_point < 0) {
+          out.push_back(escape);
+          break;
+        }
+        index += 4;
+        if (code_point >= 0xD800 && code_point < 0xDC00 && index + 2 < raw.size() &&
+            raw[index + 1] == '\\' && raw[index + 2] == 'u') {
+          const long low = ReadHex4(raw, index + 3);
+          if (low >= 0xDC00 && low < 0xE000) {
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+            index += 6;
+          }
+        }
+        AppendUtf8(static_cast<unsigned long>(code_point), &out);
+        break;
+      }
+      default:
+        // \" \\ \/ and anything unknown stand for themselves.
+        out.push_back(escape);
+        break;
+    }
+  }
+  return out;
+}
+
+std::string QuoteJsonString(std::string_view value) {
+  static const char kHex[] = "0123456789abcdef";
+  std::string out;
+  out.reserve(value.size() + 2);
+  out.push_back('"');
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out.push_back(kHex[(c >> 4) & 0xF]);
+          out.push_back(kHex[c & 0xF]);
+        } else {
+          out.push_back(c);
+        }
+        break;
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace jumper_sdk_platform
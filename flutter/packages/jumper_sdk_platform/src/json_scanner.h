@@ -0,0 +1,87 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_JSON_SCANNER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_JSON_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace jumper_sdk_platform {
+
+enum class JsonType {
+  kObject,
+  kArray,
+  kString,
+  kNumber,
+  kBool,
+  kNull,
+  kInvalid,
+};
+
+// Single-pass pull scanner over a JSON document. It never copies or
+// allocates: keys and strings come back as views into the input, still
+// escaped. Values the caller does not want are skipped without being
+// decoded.
+//
+// Every value reached through NextMember or NextElement must be consumed
+// with exactly one Read*, Skip or Enter* call. Once the input turns out to
+// be malformed every call returns false and ok() stays false.
+//
+//   JsonScanner scanner(json);
+//   std::string_view key;
+//   if (scanner.EnterObject()) {
+//     while (scanner.NextMember(&key)) {
+//       key == "name" ? scanner.ReadString(&name) : scanner.Skip();
+//     }
+//   }
+//   if (!scanner.ok()) { ... }
+class JsonScanner {
+ public:
+  explicit JsonScanner(std::string_view json);
+
+  JsonType Peek();
+
+  bool EnterObject();
+  // Moves to the next member's value and returns its raw key. Returns false
+  // once the object is closed.
+  bool NextMember(std::string_view* key);
+
+  bool EnterArray();
+  // Moves to the next element. Returns false once the array is closed.
+  bool NextElement();
+
+  bool ReadString(std::string_view* raw);
+  bool ReadInteger(int64_t* value);
+  bool ReadBool(bool* value);
+  bool Skip();
+  // Skips the value and returns the text it spans.
+  bool SkipSpan(std::string_view* span);
+
+  bool ok() const { return ok_; }
+  size_t offset() const { return index_; }
+
+ private:
+  void SkipSpace();
+  bool Fail();
+  // Moves past the string opening at |index_|.
+  bool SkipStringBody();
+  // Moves past a number, literal or other scalar token.
+  void SkipScalar();
+
+  std::string_view json_;
+  size_t index_ = 0;
+  bool ok_ = true;
+  // True right after a value, when a ',' or closing bracket must follow.
+  bool after_value_ = false;
+};
+
+// Decodes the escapes in a raw JSON string body, including \u escapes and
+// surrogate pairs, to UTF-8.
+std::string UnescapeJsonString(std::string_view raw);
+
+// Quotes |value| as a JSON string literal.
+std::string QuoteJsonString(std::string_view value);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_JSON_SCANNER_H_
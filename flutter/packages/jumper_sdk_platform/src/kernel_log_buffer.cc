@@ -0,0 +1,201 @@
+#include "kernel_log_buffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+// The level is one of the first few tokens: optional zone, date and time,
+// then the level itself.
+constexpr int kLevelTokenSearchLimit = 5;
+
+bool TokenEquals(const char* token, size_t length, const char* expected) {
+  if (std::strlen(expected) != length) {
+    return false;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    if (std::toupper(static_cast<unsigned char>(token[i])) != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const char* KernelLogLevelName(KernelLogLevel level) {
+  switch (level) {
+    case KernelLogLevel::kTrace:
+      return "trace";
+    case KernelLogLevel::kDebug:
+      return "debug";
+    case KernelLogLevel::kInfo:
+      return "info";
+    case KernelLogLevel::kWarn:
+      return "warn";
+    case KernelLogLevel::kError:
+      return "error";
+    case KernelLogLevel::kFatal:
+      return "fatal";
+  }
+  return "info";
+}
+
+KernelLogLevel ParseKernelLogLevel(const std::string& line) {
+  size_t index = 0;
+  for (int token = 0; token < kLevelTokenSearchLimit && index < line.size(); ++token) {
+    while (index < line.size() && line[index] == ' ') {
+      ++index;
+    }
+    const size_t start = index;
+    while (index < line.size() && line[index] != ' ') {
+      ++index;
+    }
+    const char* text = line.data() + start;
+    const size_t length = index - start;
+    if (TokenEquals(text, length, "TRACE")) {
+      return KernelLogLevel::kTrace;
+    }
+    if (TokenEquals(text, length, "DEBUG")) {
+      return KernelLogLevel::kDebug;
+    }
+    if (TokenEquals(text, length, "INFO")) {
+      return KernelLogLevel::kInfo;
+    }
+    if (TokenEquals(text, length, "WARN") || TokenEquals(text, length, "WARNING")) {
+      return KernelLogLevel::kWarn;
+    }
+    if (TokenEquals(text, length, "ERROR")) {
+      return KernelLogLevel::kError;
+    }
+    if (TokenEquals(text, length, "FATAL") || TokenEquals(text, length, "PANIC")) {
+      return KernelLogLevel::kFatal;
+    }
+  }
+  return KernelLogLevel::kInfo;
+}
+
+LogLineFramer::LogLineFramer(size_t max_line_bytes) : max_line_bytes_(max_line_bytes) {}
+
+void LogLineFramer::Feed(const char* data,
+                         size_t length,
+                         const std::function<void(std::string)>& on_line) {
+  const char* end = data + length;
+  while (data < end) {
+    const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+    const char* segment_end = newline == nullptr ? end : newline;
+    const size_t room =
+        partial_.size() < max_line_bytes_ ? max_line_bytes_ - partial_.size() : 0;
+    partial_.append(data, std::min(room, static_cast<size_t>(segment_end - data)));
+    if (newline == nullptr) {
+      return;
+    }
+    if (!partial_.empty() && partial_.back() == '\r') {
+      partial_.pop_back();
+    }
+    if (!partial_.empty()) {
+      on_line(std::move(partial_));
+    }
+    partial_.clear();
+    data = newline + 1;
+  }
+}
+
+void LogLineFramer::Flush(const std::function<void(std::string)>& on_line) {
+  if (!partial_.empty()) {
+    on_line(std::move(partial_));
+  }
+  partial_.clear();
+}
+
+KernelLogBuffer::KernelLogBuffer(size_t capacity, size_t low_level_budget, size_t sample_rate)
+    : lines_(capacity),
+      capacity_(capacity),
+      low_level_budget_(low_level_budget),
+      sample_rate_(std::max<size_t>(sample_rate, 1)) {}
+
+bool KernelLogBuffer::Append(KernelLogLevel level, std::string message, int64_t timestamp_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (timestamp_ms - window_start_ms_ >= 1000 || timestamp_ms < window_start_ms_) {
+    window_start_ms_ = timestamp_ms;
+    window_count_ = 0;
+    sample_counter_ = 0;
+  }
+  window_count_ += 1;
+  if (level <= KernelLogLevel::kDebug && window_count_ > low_level_budget_ &&
+      sample_counter_++ % sample_rate_ != 0) {
+    dropped_ += 1;
+    return false;
+  }
+
+  const uint64_t seq = next_seq_++;
+  KernelLogLine& slot = lines_[seq % capacity_];
+  if (slot.seq != 0 && slot.seq > delivered_seq_) {
+    // Overwritten before the platform thread got to it.
+    dropped_ += 1;
+    delivered_seq_ = slot.seq;
+  }
+  slot.seq = seq;
+  slot.timestamp_ms = timestamp_ms;
+  slot.level = level;
+  slot.message = std::move(message);
+  return true;
+}
+
+std::vector<KernelLogLine> KernelLogBuffer::TakeUndelivered(size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<KernelLogLine> result;
+  const uint64_t first = std::max(delivered_seq_ + 1, OldestSeqLocked());
+  for (uint64_t seq = first; seq < next_seq_ && result.size() < limit; ++seq) {
+    result.push_back(lines_[seq % capacity_]);
+    delivered_seq_ = seq;
+  }
+  return result;
+}
+
+void KernelLogBuffer::SkipUndelivered() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  delivered_seq_ = next_seq_ - 1;
+}
+
+std::vector<KernelLogLine> KernelLogBuffer::LinesSince(uint64_t since_seq, size_t limit) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<KernelLogLine> result;
+  const uint64_t first = std::max(since_seq + 1, OldestSeqLocked());
+  for (uint64_t seq = first; seq < next_seq_ && result.size() < limit; ++seq) {
+    result.push_back(lines_[seq % capacity_]);
+  }
+  return result;
+}
+
+std::vector<KernelLogLine> KernelLogBuffer::Tail(uint64_t since_seq, size_t count) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<KernelLogLine> result;
+  uint64_t first = std::max(since_seq + 1, OldestSeqLocked());
+  if (first < next_seq_ && next_seq_ - first > count) {
+    first = next_seq_ - count;
+  }
+  for (uint64_t seq = first; seq < next_seq_; ++seq) {
+    result.push_back(lines_[seq % capacity_]);
+  }
+  return result;
+}
+
+uint64_t KernelLogBuffer::next_seq() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_seq_;
+}
+
+uint64_t KernelLogBuffer::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+uint64_t KernelLogBuffer::OldestSeqLocked() const {
+  return next_seq_ > capacity_ ? next_seq_ - capacity_ : 1;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,100 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_KERNEL_LOG_BUFFER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_KERNEL_LOG_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+enum class KernelLogLevel {
+  kTrace,
+  kDebug,
+  kInfo,
+  kWarn,
+  kError,
+  kFatal,
+};
+
+const char* KernelLogLevelName(KernelLogLevel level);
+
+// Finds the level token in a sing-box log line, e.g.
+// "+0800 2024-01-01 12:00:00 INFO [1 0ms] router: ...". Lines without one
+// are treated as info.
+KernelLogLevel ParseKernelLogLevel(const std::string& line);
+
+struct KernelLogLine {
+  uint64_t seq = 0;
+  int64_t timestamp_ms = 0;
+  KernelLogLevel level = KernelLogLevel::kInfo;
+  std::string message;
+};
+
+// Splits a byte stream into lines. Partial lines are held until their
+// newline arrives; overlong lines are cut at |max_line_bytes|.
+class LogLineFramer {
+ public:
+  explicit LogLineFramer(size_t max_line_bytes);
+
+  void Feed(const char* data, size_t length, const std::function<void(std::string)>& on_line);
+  // Emits whatever is left once the stream has ended.
+  void Flush(const std::function<void(std::string)>& on_line);
+
+ private:
+  size_t max_line_bytes_;
+  std::string partial_;
+};
+
+// Bounded, sequence-numbered store of recent core log lines. Writers are
+// the pipe reader threads; the platform thread drains it in batches and
+// serves backfill requests from it.
+//
+// When more than |low_level_budget| lines arrive within one second, trace
+// and debug lines are sampled 1 in |sample_rate| until the next second;
+// every line skipped that way, or overwritten before it was delivered,
+// counts as dropped.
+class KernelLogBuffer {
+ public:
+  KernelLogBuffer(size_t capacity, size_t low_level_budget, size_t sample_rate);
+
+  KernelLogBuffer(const KernelLogBuffer&) = delete;
+  KernelLogBuffer& operator=(const KernelLogBuffer&) = delete;
+
+  // Returns false when the line was sampled out.
+  bool Append(KernelLogLevel level, std::string message, int64_t timestamp_ms);
+  // Returns up to |limit| lines not yet handed out by TakeUndelivered.
+  std::vector<KernelLogLine> TakeUndelivered(size_t limit);
+  // Marks everything stored so far as delivered, e.g. when a new listener
+  // attaches and backfills through LinesSince instead.
+  void SkipUndelivered();
+  // Returns up to |limit| lines with seq > |since_seq|, oldest first.
+  std::vector<KernelLogLine> LinesSince(uint64_t since_seq, size_t limit) const;
+  // Returns the newest |count| lines with seq > |since_seq|, oldest first.
+  std::vector<KernelLogLine> Tail(uint64_t since_seq, size_t count) const;
+
+  uint64_t next_seq() const;
+  uint64_t dropped() const;
+
+ private:
+  // Sequence number of the oldest line still held. Requires |mutex_|.
+  uint64_t OldestSeqLocked() const;
+
+  mutable std::mutex mutex_;
+  std::vector<KernelLogLine> lines_;
+  size_t capacity_;
+  size_t low_level_budget_;
+  size_t sample_rate_;
+  uint64_t next_seq_ = 1;
+  uint64_t delivered_seq_ = 0;
+  uint64_t dropped_ = 0;
+  int64_t window_start_ms_ = 0;
+  size_t window_count_ = 0;
+  size_t sample_counter_ = 0;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_KERNEL_LOG_BUFFER_H_
@@ -0,0 +1,221 @@
+#include "latency_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace jumper_sdk_platform {
+
+const LatencyFamily kMethodLatency = {
+    "jumper_plugin_method_duration_seconds", "method",
+    "Time a method-channel handler took to produce its response.", "methods"};
+const LatencyFamily kMethodQueueLatency = {
+    "jumper_plugin_method_queue_seconds", "method",
+    "Time a method call waited for its worker lane.", "queueWaits"};
+const LatencyFamily kCorePhaseLatency = {
+    "jumper_core_phase_duration_seconds", "phase",
+    "Time a step of the core's lifecycle took.", "phases"};
+
+namespace {
+
+// The exported bucket bounds, in seconds.
+constexpr double kOpenMetricsBounds[] = {0.0001, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                         0.025,  0.05,   0.1,   0.25,   0.5,   1,
+                                         2.5,    5,      10,    30,     60};
+
+uint64_t HashSeries(const LatencyFamily& family, std::string_view label_value) {
+  // FNV-1a over the family's address and the label.
+  uint64_t hash = 1469598103934665603ull ^ reinterpret_cast<uintptr_t>(&family);
+  for (const char c : label_value) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string EscapeLabel(const std::string& value) {
+  std::string escaped;
+  for (const char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string FormatSeconds(double seconds) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g", seconds);
+  return buffer;
+}
+
+}  // namespace
+
+uint64_t LatencySnapshot::ValueAtQuantile(double quantile) const {
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * count)));
+  uint64_t seen = 0;
+  for (size_t index = 0; index < buckets.size(); ++index) {
+    seen += buckets[index];
+    if (seen >= rank) {
+      return std::min(LatencyHistogram::BucketUpperBound(index), max_ns);
+    }
+  }
+  return max_ns;
+}
+
+uint64_t LatencySnapshot::CountAtOrBelow(uint64_t bound_ns) const {
+  uint64_t total = 0;
+  for (size_t index = 0; index < buckets.size(); ++index) {
+    if (LatencyHistogram::BucketUpperBound(index) > bound_ns) {
+      break;
+    }
+    total += buckets[index];
+  }
+  return total;
+}
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+LatencySnapshot LatencyHistogram::Snapshot() const {
+  LatencySnapshot snapshot;
+  snapshot.buckets.resize(kBucketCount);
+  // The count is taken from the buckets so the two always agree.
+  for (size_t index = 0; index < kBucketCount; ++index) {
+    snapshot.buckets[index] = counts_[index].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.buckets[index];
+  }
+  snapshot.sum_ns = sum_.load(std::memory_order_relaxed);
+  snapshot.max_ns = max_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+  const uint64_t lower = static_cast<uint64_t>(kSubBuckets + (index & (kSubBuckets - 1)))
+                         << shift;
+  return lower + (uint64_t{1} << shift) - 1;
+}
+
+struct LatencyRegistry::Series {
+  const LatencyFamily* family;
+  std::string label_value;
+  LatencyHistogram histogram;
+};
+
+LatencyRegistry::LatencyRegistry() {
+  for (auto& slot : slots_) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+LatencyRegistry::~LatencyRegistry() {
+  for (auto& slot : slots_) {
+    delete slot.load(std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram* LatencyRegistry::Find(const LatencyFamily& family,
+                                        std::string_view label_value) {
+  const size_t start = static_cast<size_t>(HashSeries(family, label_value));
+  for (bool locked = false;; locked = true) {
+    std::unique_lock<std::mutex> lock(insert_mutex_, std::defer_lock);
+    if (locked) {
+      lock.lock();
+    }
+    for (size_t probe = 0; probe < kSlotCount; ++probe) {
+      std::atomic<Series*>& slot = slots_[(start + probe) % kSlotCount];
+      Series* series = slot.load(std::memory_order_acquire);
+      if (series == nullptr) {
+        if (!locked) {
+          break;
+        }
+        // Published only once complete; readers see all of it or nothing.
+        series = new Series{&family, std::string(label_value), {}};
+        slot.store(series, std::memory_order_release);
+        return &series->histogram;
+      }
+      if (series->family == &family && series->label_value == label_value) {
+        return &series->histogram;
+      }
+    }
+    if (locked) {
+      return nullptr;
+    }
+  }
+}
+
+void LatencyRegistry::Record(const LatencyFamily& family,
+                             std::string_view label_value,
+                             int64_t nanoseconds) {
+  if (LatencyHistogram* histogram = Find(family, label_value)) {
+    histogram->Record(nanoseconds);
+  }
+}
+
+void LatencyRegistry::RecordMilliseconds(const LatencyFamily& family,
+                                         std::string_view label_value,
+                                         double milliseconds) {
+  if (milliseconds >= 0) {
+    Record(family, label_value, static_cast<int64_t>(milliseconds * 1e6));
+  }
+}
+
+std::vector<LatencySeries> LatencyRegistry::Snapshot() const {
+  std::vector<LatencySeries> all;
+  for (const auto& slot : slots_) {
+    const Series* series = slot.load(std::memory_order_acquire);
+    if (series != nullptr) {
+      all.push_back({series->family, series->label_value, series->histogram.Snapshot()});
+    }
+  }
+  std::sort(all.begin(), all.end(), [](const LatencySeries& a, const LatencySeries& b) {
+    const int names = std::string_view(a.family->name).compare(b.family->name);
+    return names != 0 ? names < 0 : a.label_value < b.label_value;
+  });
+  return all;
+}
+
+std::string FormatOpenMetrics(const std::vector<LatencySeries>& series) {
+  std::string text;
+  const LatencyFamily* family = nullptr;
+  for (const LatencySeries& entry : series) {
+    const std::string name = entry.family->name;
+    if (entry.family != family) {
+      family = entry.family;
+      text += "# TYPE " + name + " histogram\n";
+      text += "# UNIT " + name + " seconds\n";
+      text += "# HELP " + name + " " + family->help + "\n";
+    }
+    const std::string label =
+        std::string(family->label) + "=\"" + EscapeLabel(entry.label_value) + "\"";
+    for (const double bound : kOpenMetricsBounds) {
+      text += name + "_bucket{" + label + ",le=\"" + FormatSeconds(bound) + "\"} " +
+              std::to_string(entry.snapshot.CountAtOrBelow(static_cast<uint64_t>(bound * 1e9))) +
+              "\n";
+    }
+    text += name + "_bucket{" + label + ",le=\"+Inf\"} " + std::to_string(entry.snapshot.count) +
+            "\n";
+    text += name + "_count{" + label + "} " + std::to_string(entry.snapshot.count) + "\n";
+    text += name + "_sum{" + label + "} " + FormatSeconds(entry.snapshot.sum_ns / 1e9) + "\n";
+  }
+  text += "# EOF\n";
+  return text;
+}
+
+}  // namespace jumper_sdk_platform
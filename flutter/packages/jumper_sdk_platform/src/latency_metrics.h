@@ -0,0 +1,159 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_LATENCY_METRICS_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_LATENCY_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace jumper_sdk_platform {
+
+// Counts per bucket, read from a LatencyHistogram at one moment.
+struct LatencySnapshot {
+  uint64_t count = 0;
+  uint64_t sum_ns = 0;
+  uint64_t max_ns = 0;
+  std::vector<uint64_t> buckets;
+
+  // The upper bound of the bucket holding the value below which |quantile|
+  // of the recorded values fall, never above the largest one; 0 when empty.
+  uint64_t ValueAtQuantile(double quantile) const;
+  // Values in buckets that end at or below |bound_ns|.
+  uint64_t CountAtOrBelow(uint64_t bound_ns) const;
+};
+
+// Durations in nanoseconds, in log-linear buckets as HdrHistogram lays them
+// out: each power of two is split into 16, so a value is known to within
+// 1/16 of itself, from 1 ns up to about 4.9 hours. Recording is a handful of
+// relaxed atomic adds, safe from any thread and never blocking; a snapshot
+// taken meanwhile may miss the values being recorded.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kMaxExponent = 44;
+  static constexpr size_t kBucketCount =
+      static_cast<size_t>(kMaxExponent - kSubBucketBits + 1) << kSubBucketBits;
+
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(int64_t nanoseconds) {
+    const uint64_t value = nanoseconds <= 0 ? 0 : static_cast<uint64_t>(nanoseconds);
+    counts_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  LatencySnapshot Snapshot() const;
+
+  static size_t BucketIndex(uint64_t value) {
+    constexpr uint64_t kLargest = (uint64_t{1} << kMaxExponent) - 1;
+    value = value < kLargest ? value : kLargest;
+    if (value < (uint64_t{1} << kSubBucketBits)) {
+      return static_cast<size_t>(value);
+    }
+    const int shift = HighestBit(value) - kSubBucketBits;
+    return (static_cast<size_t>(shift + 1) << kSubBucketBits) +
+           static_cast<size_t>((value >> shift) & ((1u << kSubBucketBits) - 1));
+  }
+  // The largest value that lands in bucket |index|.
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  static int HighestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long bit = 0;
+    _BitScanReverse64(&bit, value);
+    return static_cast<int>(bit);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+  }
+
+  std::atomic<uint64_t> counts_[kBucketCount];
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+// A set of histograms exported under one metric name, one per value of its
+// label.
+struct LatencyFamily {
+  // The OpenMetrics name, unit included.
+  const char* name;
+  const char* label;
+  const char* help;
+  // The key getPluginMetrics reports the family under.
+  const char* key;
+};
+
+// Method-channel handlers, from the moment a worker lane picks them up (or
+// the platform thread runs them) until they have a response.
+extern const LatencyFamily kMethodLatency;
+// How long a method call waited for its worker lane.
+extern const LatencyFamily kMethodQueueLatency;
+// Steps of the core's lifecycle: spawn, first byte, ready, check, reload,
+// stop.
+extern const LatencyFamily kCorePhaseLatency;
+
+struct LatencySeries {
+  const LatencyFamily* family = nullptr;
+  std::string label_value;
+  LatencySnapshot snapshot;
+};
+
+// The plugin's histograms, created on first use and kept for its lifetime.
+// Looking a series up takes no lock: series are published in a fixed
+// open-addressing table and never move or go away. Only creating one takes
+// the insert lock.
+class LatencyRegistry {
+ public:
+  LatencyRegistry();
+  ~LatencyRegistry();
+
+  LatencyRegistry(const LatencyRegistry&) = delete;
+  LatencyRegistry& operator=(const LatencyRegistry&) = delete;
+
+  // Null once the table is full; the value then goes unrecorded.
+  LatencyHistogram* Find(const LatencyFamily& family, std::string_view label_value);
+  void Record(const LatencyFamily& family, std::string_view label_value, int64_t nanoseconds);
+  void RecordMilliseconds(const LatencyFamily& family,
+                          std::string_view label_value,
+                          double milliseconds);
+
+  // Every series, by family name and then label value.
+  std::vector<LatencySeries> Snapshot() const;
+
+ private:
+  struct Series;
+  static constexpr size_t kSlotCount = 256;
+
+  std::atomic<Series*> slots_[kSlotCount];
+  std::mutex insert_mutex_;
+};
+
+// OpenMetrics text for |series|, with cumulative buckets from 100 us to a
+// minute and `# EOF` at the end. node_exporter's textfile collector takes it
+// as Prometheus text; the UNIT and EOF lines read as comments there.
+std::string FormatOpenMetrics(const std::vector<LatencySeries>& series);
+
+inline int64_t NanosecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              start)
+      .count();
+}
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_LATENCY_METRICS_H_
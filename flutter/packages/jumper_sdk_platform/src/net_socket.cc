@@ -0,0 +1,298 @@
+#include "net_socket.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <mutex>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr NativeSocket kInvalidSocket = static_cast<NativeSocket>(-1);
+
+#ifdef _WIN32
+constexpr int kSendFlags = 0;
+
+void EnsureNetworking() {
+  static std::once_flag once;
+  std::call_once(once, []() {
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+  });
+}
+
+int LastSocketError() { return WSAGetLastError(); }
+
+bool IsInProgress(int code) { return code == WSAEWOULDBLOCK || code == WSAEINPROGRESS; }
+
+bool IsAddressInUse(int code) { return code == WSAEADDRINUSE || code == WSAEACCES; }
+
+std::string SocketErrorText(int code) { return "WSA error " + std::to_string(code); }
+
+void CloseNativeSocket(NativeSocket socket) { closesocket(static_cast<SOCKET>(socket)); }
+
+bool SetNonBlocking(NativeSocket socket) {
+  u_long enabled = 1;
+  return ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &enabled) == 0;
+}
+#else
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+void EnsureNetworking() {}
+
+int LastSocketError() { return errno; }
+
+bool IsInProgress(int code) { return code == EINPROGRESS || code == EAGAIN || code == EWOULDBLOCK; }
+
+bool IsAddressInUse(int code) { return code == EADDRINUSE; }
+
+std::string SocketErrorText(int code) { return std::strerror(code); }
+
+void CloseNativeSocket(NativeSocket socket) { close(socket); }
+
+bool SetNonBlocking(NativeSocket socket) {
+  const int flags = fcntl(socket, F_GETFL, 0);
+  return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+#endif
+
+NativeSocket OpenSocket(int family) {
+#if defined(SOCK_CLOEXEC)
+  return static_cast<NativeSocket>(socket(family, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP));
+#else
+  return static_cast<NativeSocket>(socket(family, SOCK_STREAM, IPPROTO_TCP));
+#endif
+}
+
+}  // namespace
+
+TcpConnection::~TcpConnection() { Close(); }
+
+bool TcpConnection::Connect(const std::string& host,
+                            uint16_t port,
+                            int timeout_ms,
+                            std::string* error) {
+  EnsureNetworking();
+  Close();
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_NUMERICSERV;
+  addrinfo* addresses = nullptr;
+  const std::string port_text = std::to_string(port);
+  if (getaddrinfo(host.c_str(), port_text.c_str(), &hints, &addresses) != 0 ||
+      addresses == nullptr) {
+    if (error != nullptr) {
+      *error = "Unable to resolve " + host;
+    }
+    return false;
+  }
+
+  int last_error = 0;
+  for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+    socket_ = OpenSocket(address->ai_family);
+    if (socket_ == kInvalidSocket) {
+      last_error = LastSocketError();
+      continue;
+    }
+    const int no_delay = 1;
+    setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY,
+               reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+    if (!SetNonBlocking(socket_)) {
+      last_error = LastSocketError();
+      Close();
+      continue;
+    }
+    if (connect(socket_, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+      freeaddrinfo(addresses);
+      return true;
+    }
+    last_error = LastSocketError();
+    if (IsInProgress(last_error) && WaitUntilReady(true, timeout_ms)) {
+      int socket_error = 0;
+      socklen_t length = sizeof(socket_error);
+      if (getsockopt(socket_, SOL_SOCKET, SO_ERROR,
+                     reinterpret_cast<char*>(&socket_error), &length) == 0 &&
+          socket_error == 0) {
+        freeaddrinfo(addresses);
+        return true;
+      }
+      last_error = socket_error;
+    }
+    Close();
+  }
+  freeaddrinfo(addresses);
+  if (error != nullptr) {
+    *error = "Connect to " + host + ":" + port_text + " failed: " +
+             (last_error == 0 ? std::string("timed out") : SocketErrorText(last_error));
+  }
+  return false;
+}
+
+bool TcpConnection::SendAll(const char* data,
+                            size_t length,
+                            int timeout_ms,
+                            std::string* error) {
+  size_t sent = 0;
+  while (sent < length) {
+    const int written =
+        static_cast<int>(send(socket_, data + sent, static_cast<int>(length - sent), kSendFlags));
+    if (written > 0) {
+      sent += static_cast<size_t>(written);
+      continue;
+    }
+    const int code = LastSocketError();
+    if (written < 0 && IsInProgress(code) && WaitUntilReady(true, timeout_ms)) {
+      continue;
+    }
+    if (error != nullptr) {
+      *error = "Send failed: " + SocketErrorText(code);
+    }
+    return false;
+  }
+  return true;
+}
+
+int TcpConnection::Receive(char* buffer,
+                           size_t capacity,
+                           int timeout_ms,
+                           std::string* error) {
+  for (;;) {
+    const int received = static_cast<int>(recv(socket_, buffer, static_cast<int>(capacity), 0));
+    if (received >= 0) {
+      return received;
+    }
+    const int code = LastSocketError();
+    if (!IsInProgress(code)) {
+      if (error != nullptr) {
+        *error = "Receive failed: " + SocketErrorText(code);
+      }
+      return -1;
+    }
+    if (!WaitUntilReady(false, timeout_ms)) {
+      if (error != nullptr) {
+        *error = "Receive timed out";
+      }
+      return -1;
+    }
+  }
+}
+
+bool TcpConnection::WaitReadable(int timeout_ms) { return WaitUntilReady(false, timeout_ms); }
+
+void TcpConnection::Close() {
+  if (socket_ != kInvalidSocket) {
+    CloseNativeSocket(socket_);
+    socket_ = kInvalidSocket;
+  }
+}
+
+bool TcpConnection::is_open() const { return socket_ != kInvalidSocket; }
+
+bool TcpConnection::WaitUntilReady(bool for_write, int timeout_ms) {
+#ifdef _WIN32
+  fd_set ready;
+  FD_ZERO(&ready);
+  FD_SET(static_cast<SOCKET>(socket_), &ready);
+  fd_set failed;
+  FD_ZERO(&failed);
+  FD_SET(static_cast<SOCKET>(socket_), &failed);
+  timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+  return select(0, for_write ? nullptr : &ready, for_write ? &ready : nullptr, &failed,
+                &timeout) > 0;
+#else
+  pollfd entry{};
+  entry.fd = socket_;
+  entry.events = for_write ? POLLOUT : POLLIN;
+  int result = 0;
+  do {
+    result = poll(&entry, 1, timeout_ms);
+  } while (result < 0 && errno == EINTR);
+  return result > 0;
+#endif
+}
+
+bool IsTcpPortInUse(uint16_t port) {
+  EnsureNetworking();
+  // Prefer a dual-stack IPv6 socket so that IPv4 listeners are seen as well.
+  NativeSocket probe = OpenSocket(AF_INET6);
+  const bool ipv6 = probe != kInvalidSocket;
+  if (!ipv6) {
+    probe = OpenSocket(AF_INET);
+    if (probe == kInvalidSocket) {
+      return false;
+    }
+  }
+#ifdef _WIN32
+  const int exclusive = 1;
+  setsockopt(probe, SOL_SOCKET, SO_EXCLUSIVEADDRUSE,
+             reinterpret_cast<const char*>(&exclusive), sizeof(exclusive));
+#else
+  // sing-box listeners set SO_REUSEADDR, so sockets lingering in TIME_WAIT do
+  // not block it and must not be reported either.
+  const int reuse = 1;
+  setsockopt(probe, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+  int result = 0;
+  if (ipv6) {
+    const int v6_only = 0;
+    setsockopt(probe, IPPROTO_IPV6, IPV6_V6ONLY,
+               reinterpret_cast<const char*>(&v6_only), sizeof(v6_only));
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(port);
+    address.sin6_addr = in6addr_any;
+    result = bind(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+  } else {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    result = bind(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+  }
+  const bool in_use = result != 0 && IsAddressInUse(LastSocketError());
+  CloseNativeSocket(probe);
+  return in_use;
+}
+
+uint16_t PickFreeTcpPort() {
+  EnsureNetworking();
+  NativeSocket probe = OpenSocket(AF_INET);
+  if (probe == kInvalidSocket) {
+    return 0;
+  }
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  uint16_t port = 0;
+  if (bind(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+      getsockname(probe, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+    port = ntohs(address.sin_port);
+  }
+  CloseNativeSocket(probe);
+  return port;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,53 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_NET_SOCKET_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_NET_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jumper_sdk_platform {
+
+#ifdef _WIN32
+using NativeSocket = uintptr_t;
+#else
+using NativeSocket = int;
+#endif
+
+// Non-blocking TCP client socket whose calls all take a timeout. Used to talk
+// to the core's HTTP APIs on loopback from worker threads.
+class TcpConnection {
+ public:
+  TcpConnection() = default;
+  ~TcpConnection();
+
+  TcpConnection(const TcpConnection&) = delete;
+  TcpConnection& operator=(const TcpConnection&) = delete;
+
+  bool Connect(const std::string& host, uint16_t port, int timeout_ms, std::string* error);
+  bool SendAll(const char* data, size_t length, int timeout_ms, std::string* error);
+  // Returns the number of bytes read, 0 once the peer closed the connection
+  // and -1 on error or timeout.
+  int Receive(char* buffer, size_t capacity, int timeout_ms, std::string* error);
+  // Returns true once data, or the peer's close, is waiting to be received.
+  bool WaitReadable(int timeout_ms);
+  void Close();
+  bool is_open() const;
+
+ private:
+  bool WaitUntilReady(bool for_write, int timeout_ms);
+
+  NativeSocket socket_ = static_cast<NativeSocket>(-1);
+};
+
+// Returns true when something already listens on |port|. The check binds the
+// wildcard address, so a listener on any local address counts.
+bool IsTcpPortInUse(uint16_t port);
+
+// Returns a port the system just handed out for a loopback listener, or 0.
+// The port is released again before returning, so another process may take
+// it first; callers still check it with IsTcpPortInUse() before use.
+uint16_t PickFreeTcpPort();
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_NET_SOCKET_H_
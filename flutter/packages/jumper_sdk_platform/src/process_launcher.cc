@@ -0,0 +1,586 @@
+#include "process_launcher.h"
+
+#ifdef _WIN32
+#include <cwchar>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+#ifdef _WIN32
+
+std::wstring Utf8ToWide(const std::string& text) {
+  if (text.empty()) {
+    return std::wstring();
+  }
+  const int length =
+      MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(length), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), &wide[0], length);
+  return wide;
+}
+
+// Environment names are compared case-insensitively, and the block must be
+// sorted the same way.
+int CompareNames(const std::wstring& a, const std::wstring& b) {
+  return CompareStringOrdinal(a.c_str(), static_cast<int>(a.size()), b.c_str(),
+                              static_cast<int>(b.size()), TRUE);
+}
+
+#else
+
+// Syscalls newer than some of the C libraries we build against; these
+// numbers are shared by every architecture.
+constexpr long kSysPidfdSendSignal = 424;
+constexpr long kSysPidfdOpen = 434;
+constexpr long kSysCloseRange = 436;
+constexpr int kClonePidfd = 0x00001000;
+constexpr unsigned int kCloseRangeCloexec = 1u << 2;
+// ioprio_set(2): the class sits above the 13 bits of level.
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassShift = 13;
+
+// The child only resets signals, moves descriptors around and execs.
+constexpr size_t kChildStackBytes = 64 * 1024;
+// Output RunProcess keeps; a config check reports its error well within it.
+constexpr size_t kRunOutputLimit = 16 * 1024;
+
+// close_range arrived in Linux 5.11. Closing the empty range ~0..~0 is a
+// no-op wherever it exists.
+bool HasCloseRange() {
+  static const bool supported = syscall(kSysCloseRange, ~0u, ~0u, 0u) == 0;
+  return supported;
+}
+
+// Descriptors that would survive an exec, for kernels without close_range.
+std::vector<int> ListInheritableDescriptors() {
+  std::vector<int> descriptors;
+  DIR* directory = opendir("/proc/self/fd");
+  if (directory == nullptr) {
+    return descriptors;
+  }
+  const int directory_fd = dirfd(directory);
+  while (const dirent* entry = readdir(directory)) {
+    char* end = nullptr;
+    const long fd = std::strtol(entry->d_name, &end, 10);
+    if (end == entry->d_name || *end != '\0' || fd < 3 || fd == directory_fd) {
+      continue;
+    }
+    const int flags = fcntl(static_cast<int>(fd), F_GETFD);
+    if (flags >= 0 && (flags & FD_CLOEXEC) == 0) {
+      descriptors.push_back(static_cast<int>(fd));
+    }
+  }
+  closedir(directory);
+  return descriptors;
+}
+
+std::vector<std::string> MergeEnvironment(const std::map<std::string, std::string>& overrides) {
+  std::vector<std::string> environment;
+  for (char** entry = environ; entry != nullptr && *entry != nullptr; ++entry) {
+    const char* separator = std::strchr(*entry, '=');
+    if (separator == nullptr ||
+        overrides.count(std::string(*entry, static_cast<size_t>(separator - *entry))) == 0) {
+      environment.emplace_back(*entry);
+    }
+  }
+  for (const auto& [key, value] : overrides) {
+    if (!value.empty()) {
+      environment.push_back(key + "=" + value);
+    }
+  }
+  return environment;
+}
+
+std::vector<char*> PointerArray(const std::vector<std::string>& strings) {
+  std::vector<char*> pointers;
+  pointers.reserve(strings.size() + 1);
+  for (const std::string& text : strings) {
+    pointers.push_back(const_cast<char*>(text.c_str()));
+  }
+  pointers.push_back(nullptr);
+  return pointers;
+}
+
+// Resolves |name| against the child's PATH, the way execvp would.
+bool FindInPath(const std::string& name,
+                const std::vector<std::string>& environment,
+                std::string* path) {
+  std::string search = "/usr/local/bin:/usr/bin:/bin";
+  for (const std::string& entry : environment) {
+    if (entry.compare(0, 5, "PATH=") == 0) {
+      search = entry.substr(5);
+    }
+  }
+  size_t start = 0;
+  while (start <= search.size()) {
+    size_t end = search.find(':', start);
+    if (end == std::string::npos) {
+      end = search.size();
+    }
+    const std::string directory = search.substr(start, end - start);
+    const std::string candidate = (directory.empty() ? "." : directory) + "/" + name;
+    if (access(candidate.c_str(), X_OK) == 0) {
+      *path = candidate;
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
+// The ioprio_set(2) value for |scheduling|, or 0 to keep ours.
+int IoPriority(const ProcessScheduling& scheduling) {
+  if (scheduling.io_class <= 0) {
+    return 0;
+  }
+  return (std::clamp(scheduling.io_class, 1, 3) << kIoprioClassShift) |
+         std::clamp(scheduling.io_level, 0, 7);
+}
+
+// Keeps the pipe ends clear of 0..2, so moving one into place can never
+// clobber another when the host runs with its standard streams closed.
+int MoveAboveStdio(int fd) {
+  if (fd < 0 || fd > STDERR_FILENO) {
+    return fd;
+  }
+  const int moved = fcntl(fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+  close(fd);
+  return moved;
+}
+
+struct ChildContext {
+  const char* path;
+  int executable_fd;
+  char* const* argv;
+  char* const* envp;
+  const char* working_directory;
+  int stdin_fd;
+  int stdout_fd;
+  int stderr_fd;
+  bool close_range;
+  bool new_process_group;
+  bool set_nice;
+  int nice;
+  // 0 keeps ours.
+  int ioprio;
+  const cpu_set_t* affinity;
+  const int* inheritable;
+  size_t inheritable_count;
+  // Set by the child when it gives up; the parent reads them after the
+  // child has exec'd or exited.
+  int error;
+  const char* failed_step;
+};
+
+// Runs on a borrowed stack in our address space until the exec: no
+// allocation, no locks, nothing but async-signal-safe calls.
+int RunChild(void* arg) {
+  ChildContext* context = static_cast<ChildContext*>(arg);
+
+  // Handlers point at our code, which the exec is about to replace. Reset
+  // them while every signal is still blocked.
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = SIG_DFL;
+  for (int signal = 1; signal < NSIG; ++signal) {
+    sigaction(signal, &action, nullptr);
+  }
+
+  if (dup2(context->stdin_fd, STDIN_FILENO) < 0 ||
+      dup2(context->stdout_fd, STDOUT_FILENO) < 0 ||
+      dup2(context->stderr_fd, STDERR_FILENO) < 0) {
+    context->failed_step = "redirect output of";
+    context->error = errno;
+    _exit(127);
+  }
+  if (context->new_process_group && setpgid(0, 0) != 0) {
+    context->failed_step = "create process group for";
+    context->error = errno;
+    _exit(127);
+  }
+  // Best effort, see ProcessScheduling.
+  if (context->set_nice) {
+    setpriority(PRIO_PROCESS, 0, context->nice);
+  }
+  if (context->ioprio != 0) {
+    syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, context->ioprio);
+  }
+  if (context->affinity != nullptr) {
+    sched_setaffinity(0, sizeof(cpu_set_t), context->affinity);
+  }
+  if (context->working_directory != nullptr && chdir(context->working_directory) != 0) {
+    context->failed_step = "enter working directory for";
+    context->error = errno;
+    _exit(127);
+  }
+  // Mark rather than close, so a close-on-exec executable_fd stays usable
+  // until the exec itself.
+  if (!context->close_range ||
+      syscall(kSysCloseRange, 3u, ~0u, kCloseRangeCloexec) != 0) {
+    for (size_t i = 0; i < context->inheritable_count; ++i) {
+      fcntl(context->inheritable[i], F_SETFD, FD_CLOEXEC);
+    }
+  }
+
+  sigset_t none;
+  sigemptyset(&none);
+  sigprocmask(SIG_SETMASK, &none, nullptr);
+#ifdef SYS_execveat
+  if (context->executable_fd >= 0) {
+    syscall(SYS_execveat, context->executable_fd, "", context->argv, context->envp,
+            AT_EMPTY_PATH);
+  }
+#endif
+  execve(context->path, context->argv, context->envp);
+  context->failed_step = "exec";
+  context->error = errno;
+  _exit(127);
+}
+
+#endif
+
+}  // namespace
+
+#ifdef _WIN32
+
+std::wstring BuildEnvironmentBlock(const std::map<std::string, std::string>& overrides) {
+  // Name and the full `name=value` entry.
+  std::vector<std::pair<std::wstring, std::wstring>> variables;
+  LPWCH inherited = GetEnvironmentStringsW();
+  for (const wchar_t* entry = inherited; entry != nullptr && *entry != L'\0';
+       entry += std::wcslen(entry) + 1) {
+    const std::wstring text(entry);
+    // Names of the per-drive directory entries start with '='.
+    variables.emplace_back(text.substr(0, text.find(L'=', 1)), text);
+  }
+  if (inherited != nullptr) {
+    FreeEnvironmentStringsW(inherited);
+  }
+  for (const auto& [key, value] : overrides) {
+    const std::wstring name = Utf8ToWide(key);
+    variables.erase(std::remove_if(variables.begin(), variables.end(),
+                                   [&name](const auto& variable) {
+                                     return CompareNames(variable.first, name) == CSTR_EQUAL;
+                                   }),
+                    variables.end());
+    if (!value.empty()) {
+      variables.emplace_back(name, name + L"=" + Utf8ToWide(value));
+    }
+  }
+  std::stable_sort(variables.begin(), variables.end(), [](const auto& a, const auto& b) {
+    return CompareNames(a.first, b.first) == CSTR_LESS_THAN;
+  });
+
+  std::wstring block;
+  for (const auto& variable : variables) {
+    block += variable.second;
+    block.push_back(L'\0');
+  }
+  // Terminated by an empty entry; an empty block still needs both nulls.
+  if (block.empty()) {
+    block.push_back(L'\0');
+  }
+  block.push_back(L'\0');
+  return block;
+}
+
+#else
+
+bool SpawnProcess(const SpawnOptions& options, SpawnedProcess* process, std::string* error) {
+  *process = SpawnedProcess();
+  if (options.arguments.empty()) {
+    if (error != nullptr) {
+      *error = "No arguments for " + options.executable;
+    }
+    return false;
+  }
+
+  // Everything the child touches is built here, before it exists.
+  const std::vector<std::string> environment = MergeEnvironment(options.environment);
+  const std::vector<char*> envp = PointerArray(environment);
+  const std::vector<char*> argv = PointerArray(options.arguments);
+  std::string path = options.executable;
+  if (options.executable_fd >= 0) {
+    path = "/proc/self/fd/" + std::to_string(options.executable_fd);
+  } else if (path.find('/') == std::string::npos &&
+             !FindInPath(options.executable, environment, &path)) {
+    if (error != nullptr) {
+      *error = options.executable + " was not found in PATH";
+    }
+    return false;
+  }
+  const bool close_range = HasCloseRange();
+  const std::vector<int> inheritable =
+      close_range ? std::vector<int>() : ListInheritableDescriptors();
+  const ProcessScheduling& scheduling = options.scheduling;
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  for (int cpu : scheduling.cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &affinity);
+    }
+  }
+
+  const bool piped = options.output_fd < 0;
+  int stdout_pipe[2] = {-1, -1};
+  int stderr_pipe[2] = {-1, -1};
+  const int output_fd =
+      piped ? -1 : fcntl(options.output_fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+  const int stdin_fd = MoveAboveStdio(open("/dev/null", O_RDONLY | O_CLOEXEC));
+  void* stack = mmap(nullptr, kChildStackBytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  const auto release = [&]() {
+    for (int fd : {stdin_fd, output_fd, stdout_pipe[0], stdout_pipe[1], stderr_pipe[0],
+                   stderr_pipe[1]}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    if (stack != MAP_FAILED) {
+      munmap(stack, kChildStackBytes);
+    }
+  };
+  if (stdin_fd < 0 || stack == MAP_FAILED ||
+      (piped ? pipe2(stdout_pipe, O_CLOEXEC) != 0 || pipe2(stderr_pipe, O_CLOEXEC) != 0
+             : output_fd < 0)) {
+    if (error != nullptr) {
+      *error = std::string("Cannot prepare launch: ") + std::strerror(errno);
+    }
+    release();
+    return false;
+  }
+  for (int* fd : {&stdout_pipe[0], &stdout_pipe[1], &stderr_pipe[0], &stderr_pipe[1]}) {
+    *fd = MoveAboveStdio(*fd);
+  }
+
+  ChildContext context;
+  context.path = path.c_str();
+  context.executable_fd = options.executable_fd;
+  context.argv = argv.data();
+  context.envp = envp.data();
+  context.working_directory =
+      options.working_directory.empty() ? nullptr : options.working_directory.c_str();
+  context.stdin_fd = stdin_fd;
+  context.stdout_fd = piped ? stdout_pipe[1] : output_fd;
+  context.stderr_fd = piped ? stderr_pipe[1] : output_fd;
+  context.close_range = close_range;
+  context.new_process_group = options.new_process_group;
+  context.set_nice = scheduling.has_nice;
+  context.nice = std::clamp(scheduling.nice, -20, 19);
+  context.ioprio = IoPriority(scheduling);
+  context.affinity = CPU_COUNT(&affinity) > 0 ? &affinity : nullptr;
+  context.inheritable = inheritable.data();
+  context.inheritable_count = inheritable.size();
+  context.error = 0;
+  context.failed_step = nullptr;
+
+  // CLONE_VM | CLONE_VFORK: no page tables are copied and we resume only
+  // once the child has exec'd or died. Signals stay blocked until it has
+  // reset its handlers, so none runs ours on the shared stack. Kernels
+  // before 5.2 ignore CLONE_PIDFD and leave |pidfd| untouched.
+  sigset_t all;
+  sigset_t saved;
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &saved);
+  int pidfd = -1;
+  const pid_t pid =
+      clone(RunChild, static_cast<char*>(stack) + kChildStackBytes,
+            CLONE_VM | CLONE_VFORK | kClonePidfd | SIGCHLD, &context, &pidfd);
+  const int clone_error = errno;
+  pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+
+  if (pid < 0 || context.error != 0) {
+    if (error != nullptr) {
+      *error = pid < 0 ? std::string("clone failed: ") + std::strerror(clone_error)
+                       : std::string("Cannot ") + context.failed_step + " " +
+                             options.executable + ": " + std::strerror(context.error);
+    }
+    if (pid > 0) {
+      waitpid(pid, nullptr, 0);
+    }
+    if (pidfd >= 0) {
+      close(pidfd);
+    }
+    release();
+    return false;
+  }
+
+  process->pid = pid;
+  process->pidfd = pidfd;
+  process->stdout_fd = stdout_pipe[0];
+  process->stderr_fd = stderr_pipe[0];
+  stdout_pipe[0] = -1;
+  stderr_pipe[0] = -1;
+  release();
+  return true;
+}
+
+int OpenProcessFd(pid_t pid) {
+  if (pid <= 0) {
+    return -1;
+  }
+  const long fd = syscall(kSysPidfdOpen, pid, 0u);
+  if (fd < 0) {
+    return -1;
+  }
+  // pidfds are always close-on-exec.
+  return static_cast<int>(fd);
+}
+
+bool SignalProcess(pid_t pid, int pidfd, int signal) {
+  if (pidfd >= 0) {
+    return syscall(kSysPidfdSendSignal, pidfd, signal, nullptr, 0u) == 0;
+  }
+  return pid > 0 && kill(pid, signal) == 0;
+}
+
+bool WaitForProcessExit(int pidfd, int timeout_ms) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  struct pollfd entry = {pidfd, POLLIN, 0};
+  for (;;) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    const int ready = poll(&entry, 1, static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+    if (ready >= 0 || errno != EINTR) {
+      return ready > 0;
+    }
+  }
+}
+
+ProcessStopResult StopProcessGroup(pid_t pid, int pidfd, int timeout_ms) {
+  ProcessStopResult result;
+  const auto started_at = std::chrono::steady_clock::now();
+  // Fails with ESRCH when |pid| leads no group; no other group can carry
+  // its id while it is unreaped.
+  const bool group = kill(-pid, SIGTERM) == 0;
+  if (!group) {
+    SignalProcess(pid, pidfd, SIGTERM);
+  }
+  bool exited = false;
+  if (pidfd >= 0) {
+    exited = WaitForProcessExit(pidfd, timeout_ms);
+  } else {
+    // WNOWAIT leaves the zombie, and with it the group id, in place.
+    const auto deadline = started_at + std::chrono::milliseconds(timeout_ms);
+    for (;;) {
+      siginfo_t info;
+      info.si_pid = 0;
+      if (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT) != 0 ||
+          info.si_pid == pid) {
+        exited = true;
+        break;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+      usleep(10 * 1000);
+    }
+  }
+  result.killed = !exited;
+  if (group) {
+    kill(-pid, SIGKILL);
+  } else if (!exited) {
+    SignalProcess(pid, pidfd, SIGKILL);
+  }
+  // ECHILD for a process we adopted rather than started.
+  while (waitpid(pid, &result.status, 0) < 0 && errno == EINTR) {
+  }
+  result.exit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             started_at)
+                       .count();
+  return result;
+}
+
+bool RunProcess(const SpawnOptions& options,
+                int timeout_ms,
+                int* exit_code,
+                std::string* output,
+                std::string* error) {
+  SpawnedProcess process;
+  if (!SpawnProcess(options, &process, error)) {
+    return false;
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  struct pollfd entries[2] = {{process.stdout_fd, POLLIN, 0}, {process.stderr_fd, POLLIN, 0}};
+  bool timed_out = false;
+  char buffer[4096];
+  while (entries[0].fd >= 0 || entries[1].fd >= 0) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      timed_out = true;
+      break;
+    }
+    if (poll(entries, 2, static_cast<int>(remaining.count())) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    for (struct pollfd& entry : entries) {
+      if (entry.fd < 0 || entry.revents == 0) {
+        continue;
+      }
+      const ssize_t count = read(entry.fd, buffer, sizeof(buffer));
+      if (count > 0) {
+        // Past the limit the pipe is still drained, so the child never blocks.
+        const size_t room = kRunOutputLimit - std::min(output->size(), kRunOutputLimit);
+        output->append(buffer, std::min(static_cast<size_t>(count), room));
+      } else if (count == 0 || errno != EINTR) {
+        close(entry.fd);
+        entry.fd = -1;
+      }
+    }
+  }
+  for (const struct pollfd& entry : entries) {
+    if (entry.fd >= 0) {
+      close(entry.fd);
+    }
+  }
+  if (timed_out) {
+    SignalProcess(process.pid, process.pidfd, SIGKILL);
+  }
+  int status = 0;
+  while (waitpid(process.pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  if (process.pidfd >= 0) {
+    close(process.pidfd);
+  }
+  if (timed_out) {
+    if (error != nullptr) {
+      *error = options.executable + " did not finish within " + std::to_string(timeout_ms) +
+               " ms";
+    }
+    return false;
+  }
+  *exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  return true;
+}
+
+#endif
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,128 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_LAUNCHER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_LAUNCHER_H_
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+#ifdef _WIN32
+
+// UTF-16 environment block for CreateProcess with CREATE_UNICODE_ENVIRONMENT:
+// this process's variables with |overrides| applied, sorted the way Windows
+// expects. An empty override removes the variable. Built up front so the
+// launching thread never touches the process environment other threads read.
+std::wstring BuildEnvironmentBlock(const std::map<std::string, std::string>& overrides);
+
+#else
+
+// Scheduling the child takes on before it execs, so every thread it starts
+// inherits it. Applied best effort: the kernel may refuse a nice below ours
+// without CAP_SYS_NICE or the realtime I/O class without CAP_SYS_ADMIN, and
+// such a refusal does not fail the spawn. Read back what took effect with
+// ReadProcessScheduling().
+struct ProcessScheduling {
+  bool has_nice = false;
+  // -20 (most favourable) to 19.
+  int nice = 0;
+  // As ioprio_set(2): 1 realtime, 2 best-effort, 3 idle, with a level from 0
+  // (highest) to 7. 0 keeps ours.
+  int io_class = 0;
+  int io_level = 0;
+  // CPUs the child may run on; empty keeps our mask.
+  std::vector<int> cpus;
+};
+
+struct SpawnOptions {
+  // Searched in PATH when it contains no slash.
+  std::string executable;
+  // When set, this descriptor is exec'd instead of |executable|, which then
+  // only serves for error messages. It may be close-on-exec.
+  int executable_fd = -1;
+  // argv, argv[0] included.
+  std::vector<std::string> arguments;
+  std::string working_directory;
+  // Applied over this process's environment; an empty value removes the
+  // variable.
+  std::map<std::string, std::string> environment;
+  // Puts the child in a new process group it leads, so StopProcessGroup()
+  // reaches everything it starts.
+  bool new_process_group = false;
+  // When set, stdout and stderr both go to this descriptor instead of
+  // pipes, e.g. an O_APPEND file that outlives us. It may be close-on-exec.
+  int output_fd = -1;
+  ProcessScheduling scheduling;
+};
+
+struct SpawnedProcess {
+  pid_t pid = -1;
+  // -1 on kernels without pidfds (before 5.2).
+  int pidfd = -1;
+  // Read ends of the child's stdout and stderr, close-on-exec. -1 with
+  // SpawnOptions::output_fd.
+  int stdout_fd = -1;
+  int stderr_fd = -1;
+};
+
+// Starts a child without copying this process's page tables: the child
+// shares our memory until it execs, as with vfork. Everything it needs is
+// prepared beforehand, so it neither allocates nor takes locks. stdin is
+// /dev/null, and no descriptor besides stdout and stderr survives the exec.
+// The child must be reaped with waitpid.
+bool SpawnProcess(const SpawnOptions& options, SpawnedProcess* process, std::string* error);
+
+// Opens a pidfd for a running process we did not start, e.g. one found
+// through a pid file. Returns -1 on kernels before 5.3 or when |pid| is gone.
+int OpenProcessFd(pid_t pid);
+
+// Sends |signal| through |pidfd| when there is one, so a recycled pid can
+// never be hit; otherwise through |pid|.
+bool SignalProcess(pid_t pid, int pidfd, int signal);
+
+// Waits up to |timeout_ms| for the process behind |pidfd| to exit, without
+// reaping it. Returns false on timeout.
+bool WaitForProcessExit(int pidfd, int timeout_ms);
+
+struct ProcessStopResult {
+  // From the first signal until the process was reaped.
+  double exit_ms = 0;
+  // The deadline passed and the process was killed.
+  bool killed = false;
+  // As reported by waitpid; 0 for a process that is not our child, which
+  // its own parent reaps.
+  int status = 0;
+};
+
+// Sends SIGTERM to the process group |pid| leads, or to |pid| alone when it
+// leads none, and waits up to |timeout_ms| for |pid| to exit before sending
+// SIGKILL. Whatever is left of the group once |pid| is gone is killed before
+// |pid| is reaped: until then its pid, and so the group id, cannot be
+// reused. Blocks; returns once |pid| has been reaped, or, for a process that
+// is not our child, once its |pidfd| reports the exit.
+ProcessStopResult StopProcessGroup(pid_t pid, int pidfd, int timeout_ms);
+
+// Runs a short-lived command to completion, collecting the start of its
+// stdout and stderr in |output|. Kills it once |timeout_ms| passes. Returns
+// false, with the reason in |error|, if it could not be spawned or did not
+// finish in time; |exit_code| is -1 when a signal ended it.
+bool RunProcess(const SpawnOptions& options,
+                int timeout_ms,
+                int* exit_code,
+                std::string* output,
+                std::string* error);
+
+#endif
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_LAUNCHER_H_
@@ -0,0 +1,264 @@
+#include "process_stats.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+// Fields after the command name in /proc/<pid>/stat, counted from `state`
+// (field 3 in proc(5)).
+constexpr size_t kStatUtimeIndex = 11;
+constexpr size_t kStatStimeIndex = 12;
+constexpr size_t kStatThreadsIndex = 17;
+constexpr size_t kStatRssPagesIndex = 21;
+
+bool ReadProcFile(const std::string& path, std::string* content) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  *content = buffer.str();
+  return true;
+}
+
+// Returns the number after "|key|:" at the start of a line, or -1.
+int64_t FindKeyedValue(const std::string& content, const char* key) {
+  const size_t key_length = std::strlen(key);
+  size_t line_start = 0;
+  while (line_start < content.size()) {
+    if (content.compare(line_start, key_length, key) == 0 &&
+        line_start + key_length < content.size() && content[line_start + key_length] == ':') {
+      return std::strtoll(content.c_str() + line_start + key_length + 1, nullptr, 10);
+    }
+    const size_t line_end = content.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      break;
+    }
+    line_start = line_end + 1;
+  }
+  return -1;
+}
+
+int64_t KibToBytes(int64_t kib) { return kib < 0 ? -1 : kib * 1024; }
+
+int64_t TicksToMs(int64_t ticks) {
+  static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+  if (ticks < 0 || ticks_per_second <= 0) {
+    return -1;
+  }
+  return ticks * 1000 / ticks_per_second;
+}
+
+void AppendField(std::vector<ProcessStatField>* fields, const char* name, int64_t value) {
+  if (value >= 0) {
+    fields->push_back(ProcessStatField{name, value});
+  }
+}
+
+}  // namespace
+
+bool ReadProcessStats(const std::string& proc_root,
+                      int pid,
+                      ProcessStats* stats,
+                      std::string* error) {
+  const std::string base = proc_root + "/" + std::to_string(pid);
+  std::string content;
+  // The command name may contain spaces and parentheses; fields start after
+  // the last ')'.
+  if (!ReadProcFile(base + "/stat", &content) || content.rfind(')') == std::string::npos) {
+    if (error != nullptr) {
+      *error = "Process " + std::to_string(pid) + " is not running";
+    }
+    return false;
+  }
+  std::istringstream fields(content.substr(content.rfind(')') + 1));
+  std::vector<std::string> tokens;
+  for (std::string token; fields >> token;) {
+    tokens.push_back(token);
+  }
+  if (tokens.size() > kStatRssPagesIndex) {
+    stats->cpu_user_ms = TicksToMs(std::strtoll(tokens[kStatUtimeIndex].c_str(), nullptr, 10));
+    stats->cpu_system_ms = TicksToMs(std::strtoll(tokens[kStatStimeIndex].c_str(), nullptr, 10));
+    stats->threads = std::strtoll(tokens[kStatThreadsIndex].c_str(), nullptr, 10);
+    stats->rss_bytes =
+        std::strtoll(tokens[kStatRssPagesIndex].c_str(), nullptr, 10) * sysconf(_SC_PAGESIZE);
+  }
+
+  if (ReadProcFile(base + "/status", &content)) {
+    const int64_t rss = KibToBytes(FindKeyedValue(content, "VmRSS"));
+    if (rss >= 0) {
+      stats->rss_bytes = rss;
+    }
+    stats->voluntary_switches = FindKeyedValue(content, "voluntary_ctxt_switches");
+    stats->involuntary_switches = FindKeyedValue(content, "nonvoluntary_ctxt_switches");
+  }
+  // smaps_rollup needs Linux 4.14.
+  if (ReadProcFile(base + "/smaps_rollup", &content)) {
+    stats->pss_bytes = KibToBytes(FindKeyedValue(content, "Pss"));
+  }
+  if (ReadProcFile(base + "/io", &content)) {
+    stats->io_read_chars = FindKeyedValue(content, "rchar");
+    stats->io_write_chars = FindKeyedValue(content, "wchar");
+    stats->io_read_bytes = FindKeyedValue(content, "read_bytes");
+    stats->io_write_bytes = FindKeyedValue(content, "write_bytes");
+  }
+
+  std::error_code fd_error;
+  std::filesystem::directory_iterator fd_entries(base + "/fd", fd_error);
+  if (!fd_error) {
+    int64_t open_fds = 0;
+    for (const auto& entry : fd_entries) {
+      (void)entry;
+      ++open_fds;
+    }
+    stats->open_fds = open_fds;
+  }
+  return true;
+}
+
+ProcessStatsEncoder::ProcessStatsEncoder(int keyframe_interval)
+    : keyframe_interval_(keyframe_interval) {}
+
+std::vector<ProcessStatField> ProcessStatsEncoder::Encode(const ProcessStats& stats,
+                                                          bool* keyframe) {
+  std::vector<ProcessStatField> current;
+  AppendField(&current, "rssBytes", stats.rss_bytes);
+  AppendField(&current, "pssBytes", stats.pss_bytes);
+  AppendField(&current, "cpuUserMs", stats.cpu_user_ms);
+  AppendField(&current, "cpuSystemMs", stats.cpu_system_ms);
+  if (has_previous_) {
+    if (stats.cpu_user_ms >= 0 && previous_stats_.cpu_user_ms >= 0) {
+      AppendField(&current, "cpuUserDeltaMs", stats.cpu_user_ms - previous_stats_.cpu_user_ms);
+    }
+    if (stats.cpu_system_ms >= 0 && previous_stats_.cpu_system_ms >= 0) {
+      AppendField(&current, "cpuSystemDeltaMs",
+                  stats.cpu_system_ms - previous_stats_.cpu_system_ms);
+    }
+  }
+  AppendField(&current, "threads", stats.threads);
+  AppendField(&current, "openFds", stats.open_fds);
+  AppendField(&current, "voluntaryContextSwitches", stats.voluntary_switches);
+  AppendField(&current, "involuntaryContextSwitches", stats.involuntary_switches);
+  AppendField(&current, "ioReadBytes", stats.io_read_bytes);
+  AppendField(&current, "ioWriteBytes", stats.io_write_bytes);
+  AppendField(&current, "ioReadChars", stats.io_read_chars);
+  AppendField(&current, "ioWriteChars", stats.io_write_chars);
+
+  *keyframe = !has_previous_ || samples_since_keyframe_ >= keyframe_interval_;
+  std::vector<ProcessStatField> changed;
+  if (*keyframe) {
+    changed = current;
+    samples_since_keyframe_ = 0;
+  } else {
+    for (const auto& field : current) {
+      bool same = false;
+      for (const auto& previous : previous_fields_) {
+        if (std::strcmp(previous.name, field.name) == 0) {
+          same = previous.value == field.value;
+          break;
+        }
+      }
+      if (!same) {
+        changed.push_back(field);
+      }
+    }
+  }
+  samples_since_keyframe_ += 1;
+  has_previous_ = true;
+  previous_stats_ = stats;
+  previous_fields_ = std::move(current);
+  return changed;
+}
+
+void ProcessStatsEncoder::Reset() {
+  has_previous_ = false;
+  samples_since_keyframe_ = 0;
+  previous_fields_.clear();
+}
+
+ProcessStatsSampler::ProcessStatsSampler(std::string proc_root, SampleCallback on_sample)
+    : proc_root_(std::move(proc_root)), on_sample_(std::move(on_sample)) {
+  thread_ = std::thread(&ProcessStatsSampler::Run, this);
+}
+
+ProcessStatsSampler::~ProcessStatsSampler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void ProcessStatsSampler::SetPid(int pid) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pid_ == pid) {
+      return;
+    }
+    pid_ = pid;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ProcessStatsSampler::SetActive(bool active, int interval_ms) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_ = active;
+    interval_ms_ = interval_ms;
+    generation_ += 1;
+  }
+  wake_.notify_all();
+}
+
+void ProcessStatsSampler::Run() {
+  // A keyframe every 30 samples bounds how long a missed event can skew the
+  // picture on the Dart side.
+  ProcessStatsEncoder encoder(30);
+  uint64_t encoded_generation = 0;
+  for (;;) {
+    int pid = 0;
+    int interval_ms = 0;
+    uint64_t generation = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || (active_ && pid_ > 0); });
+      if (stopping_) {
+        return;
+      }
+      pid = pid_;
+      interval_ms = interval_ms_;
+      generation = generation_;
+    }
+    if (generation != encoded_generation) {
+      encoder.Reset();
+      encoded_generation = generation;
+    }
+
+    ProcessStats stats;
+    if (ReadProcessStats(proc_root_, pid, &stats, nullptr)) {
+      bool keyframe = false;
+      const auto fields = encoder.Encode(stats, &keyframe);
+      if (keyframe || !fields.empty()) {
+        on_sample_(pid, fields, keyframe);
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                   [this, generation] { return stopping_ || generation_ != generation; });
+  }
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,102 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_STATS_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_STATS_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+// Resource usage of one process as read from procfs. Values that could not
+// be read, e.g. /proc/<pid>/io of a process owned by another user, stay -1.
+struct ProcessStats {
+  int64_t rss_bytes = -1;
+  int64_t pss_bytes = -1;
+  int64_t cpu_user_ms = -1;
+  int64_t cpu_system_ms = -1;
+  int64_t threads = -1;
+  int64_t open_fds = -1;
+  int64_t voluntary_switches = -1;
+  int64_t involuntary_switches = -1;
+  // Bytes that reached the storage layer.
+  int64_t io_read_bytes = -1;
+  int64_t io_write_bytes = -1;
+  // Bytes passed through read/write syscalls, sockets included.
+  int64_t io_read_chars = -1;
+  int64_t io_write_chars = -1;
+};
+
+// Reads /proc/<pid>/{stat,status,smaps_rollup,io,fd} under |proc_root|.
+// Fails only when the process is gone; missing optional files leave their
+// fields at -1.
+bool ReadProcessStats(const std::string& proc_root,
+                      int pid,
+                      ProcessStats* stats,
+                      std::string* error);
+
+struct ProcessStatField {
+  const char* name;
+  int64_t value;
+};
+
+// Turns successive samples into the fields that changed since the previous
+// one. Every |keyframe_interval| samples, and after Reset, all fields are
+// sent so a late listener can rebuild the full picture. CPU time is also
+// reported as the per-interval `cpuUserDeltaMs` and `cpuSystemDeltaMs`.
+class ProcessStatsEncoder {
+ public:
+  explicit ProcessStatsEncoder(int keyframe_interval);
+
+  std::vector<ProcessStatField> Encode(const ProcessStats& stats, bool* keyframe);
+  void Reset();
+
+ private:
+  int keyframe_interval_;
+  int samples_since_keyframe_ = 0;
+  bool has_previous_ = false;
+  ProcessStats previous_stats_;
+  std::vector<ProcessStatField> previous_fields_;
+};
+
+// Samples one process on its own thread while active and hands the encoded
+// fields to |on_sample| from that thread.
+class ProcessStatsSampler {
+ public:
+  using SampleCallback =
+      std::function<void(int pid, const std::vector<ProcessStatField>& fields, bool keyframe)>;
+
+  ProcessStatsSampler(std::string proc_root, SampleCallback on_sample);
+  ~ProcessStatsSampler();
+
+  ProcessStatsSampler(const ProcessStatsSampler&) = delete;
+  ProcessStatsSampler& operator=(const ProcessStatsSampler&) = delete;
+
+  // 0 stops sampling until the next core is running.
+  void SetPid(int pid);
+  void SetActive(bool active, int interval_ms);
+
+ private:
+  void Run();
+
+  const std::string proc_root_;
+  const SampleCallback on_sample_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  int pid_ = 0;
+  bool active_ = false;
+  int interval_ms_ = 1000;
+  bool stopping_ = false;
+  // Bumped when the pid or the listener changes so the next sample is a
+  // keyframe.
+  uint64_t generation_ = 0;
+  std::thread thread_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_PROCESS_STATS_H_
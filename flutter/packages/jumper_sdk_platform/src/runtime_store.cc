@@ -0,0 +1,641 @@
+#include "runtime_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+
+#include "core_config.h"
+#include "file_digest.h"
+#include "json_scanner.h"
+#include "sha256.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kConfigName[] = "config.json";
+constexpr char kIndexName[] = "index.json";
+constexpr char kVersionsName[] = "versions";
+constexpr char kCurrentName[] = "current";
+constexpr char kStagingPrefix[] = ".staging-";
+// Hex digits of the content hash kept in a version id.
+constexpr size_t kIdHashLength = 16;
+
+// Both plugins run runtime calls on a small worker pool, so two installs can
+// overlap; the index is read, changed and written under this.
+std::mutex& StoreMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+fs::path PathOf(const std::string& utf8) { return fs::u8path(utf8); }
+
+bool IsRegularFile(const fs::path& path) {
+  std::error_code ec;
+  return fs::is_regular_file(path, ec);
+}
+
+// Size and mtime of each source, which changes whenever the assets are
+// replaced.
+bool SourceStamp(const std::string& binary,
+                 const std::string& config,
+                 std::string* stamp,
+                 uint64_t* bytes,
+                 std::string* error) {
+  stamp->clear();
+  *bytes = 0;
+  for (const std::string* source : {&binary, &config}) {
+    std::error_code ec;
+    const fs::path path = PathOf(*source);
+    const uintmax_t size = fs::file_size(path, ec);
+    const auto time = ec ? fs::file_time_type() : fs::last_write_time(path, ec);
+    if (ec) {
+      if (error != nullptr) {
+        *error = "Source file not found: " + *source;
+      }
+      return false;
+    }
+    if (!stamp->empty()) {
+      stamp->push_back('/');
+    }
+    *stamp += std::to_string(size) + ":" + std::to_string(time.time_since_epoch().count());
+    *bytes += size;
+  }
+  return true;
+}
+
+std::string VersionId(const std::string& version,
+                      const std::string& platform_arch,
+                      const std::string& hash) {
+  std::string id;
+  for (const std::string* part : {&version, &platform_arch}) {
+    for (const char c : *part) {
+      const bool safe = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+                        (c >= 'A' && c <= 'Z') || c == '.' || c == '-' || c == '_';
+      id.push_back(safe ? c : '_');
+    }
+    id.push_back('-');
+  }
+  return id + hash;
+}
+
+// The string value at the scanner, decoded; empty for any other type.
+std::string ReadText(JsonScanner* scanner) {
+  std::string_view raw;
+  return scanner->ReadString(&raw) ? UnescapeJsonString(raw) : std::string();
+}
+
+int64_t ReadNumber(JsonScanner* scanner) {
+  int64_t value = 0;
+  return scanner->ReadInteger(&value) ? value : 0;
+}
+
+void ScanVersion(JsonScanner* scanner, RuntimeIndex* index) {
+  if (!scanner->EnterObject()) {
+    return;
+  }
+  RuntimeVersion entry;
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    if (key == "id") {
+      entry.id = ReadText(scanner);
+    } else if (key == "version") {
+      entry.version = ReadText(scanner);
+    } else if (key == "platformArch") {
+      entry.platform_arch = ReadText(scanner);
+    } else if (key == "sourceStamp") {
+      entry.source_stamp = ReadText(scanner);
+    } else if (key == "sha256") {
+      entry.sha256 = ReadText(scanner);
+    } else if (key == "expectedSha256") {
+      entry.expected_sha256 = ReadText(scanner);
+    } else if (key == "binaryIdentity") {
+      entry.binary_identity = ReadText(scanner);
+    } else if (key == "bytes") {
+      entry.bytes = static_cast<uint64_t>(std::max<int64_t>(ReadNumber(scanner), 0));
+    } else if (key == "installedAtMs") {
+      entry.installed_at_ms = ReadNumber(scanner);
+    } else if (key == "lastUsedMs") {
+      entry.last_used_ms = ReadNumber(scanner);
+    } else {
+      scanner->Skip();
+    }
+  }
+  // An id is a directory name; anything that could leave `versions/` is
+  // not one of ours.
+  if (!entry.id.empty() && entry.id.find_first_of("/\\") == std::string::npos &&
+      entry.id != "." && entry.id != "..") {
+    index->versions.push_back(std::move(entry));
+  }
+}
+
+// One entry of `artifacts` in checksums.json:
+// {"version": ..., "archive": {...}, "binary": {"path": ..., "sha256": ...}}.
+void ScanArtifact(JsonScanner* scanner, const std::string& version, std::string* sha256) {
+  if (!scanner->EnterObject()) {
+    return;
+  }
+  std::string artifact_version;
+  std::string binary_sha256;
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    if (key == "version") {
+      artifact_version = ReadText(scanner);
+    } else if (key == "binary") {
+      if (scanner->EnterObject()) {
+        while (scanner->NextMember(&key)) {
+          if (key == "sha256") {
+            binary_sha256 = ReadText(scanner);
+          } else {
+            scanner->Skip();
+          }
+        }
+      }
+    } else {
+      scanner->Skip();
+    }
+  }
+  // One version is listed per platform; any other version has no checksum.
+  if (artifact_version == version) {
+    *sha256 = binary_sha256;
+  }
+}
+
+std::string SerializeIndex(const RuntimeIndex& index) {
+  std::string json = "{\n  \"current\": " + QuoteJsonString(index.current) +
+                     ",\n  \"previous\": " + QuoteJsonString(index.previous) +
+                     ",\n  \"versions\": [";
+  for (size_t i = 0; i < index.versions.size(); ++i) {
+    const RuntimeVersion& entry = index.versions[i];
+    json += i == 0 ? "\n" : ",\n";
+    json += "    {\"id\": " + QuoteJsonString(entry.id) +
+            ", \"version\": " + QuoteJsonString(entry.version) +
+            ", \"platformArch\": " + QuoteJsonString(entry.platform_arch) +
+            ", \"bytes\": " + std::to_string(entry.bytes) +
+            ", \"sourceStamp\": " + QuoteJsonString(entry.source_stamp) +
+            ", \"sha256\": " + QuoteJsonString(entry.sha256) +
+            ", \"expectedSha256\": " + QuoteJsonString(entry.expected_sha256) +
+            ", \"binaryIdentity\": " + QuoteJsonString(entry.binary_identity) +
+            ", \"installedAtMs\": " + std::to_string(entry.installed_at_ms) +
+            ", \"lastUsedMs\": " + std::to_string(entry.last_used_ms) + "}";
+  }
+  json += index.versions.empty() ? "]\n}\n" : "\n  ]\n}\n";
+  return json;
+}
+
+}  // namespace
+
+const RuntimeVersion* RuntimeIndex::Find(const std::string& id) const {
+  for (const RuntimeVersion& entry : versions) {
+    if (entry.id == id) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+const RuntimeVersion* RuntimeIndex::FindVersion(const std::string& version,
+                                                const std::string& platform_arch) const {
+  const RuntimeVersion* found = nullptr;
+  for (const RuntimeVersion& entry : versions) {
+    if (entry.version != version || entry.platform_arch != platform_arch) {
+      continue;
+    }
+    if (entry.id == current) {
+      return &entry;
+    }
+    if (found == nullptr || entry.last_used_ms > found->last_used_ms) {
+      found = &entry;
+    }
+  }
+  return found;
+}
+
+RuntimeStore::RuntimeStore(std::string root, std::string binary_name)
+    : root_(std::move(root)), binary_name_(std::move(binary_name)) {}
+
+bool RuntimeStore::Install(const std::string& version,
+                           const std::string& platform_arch,
+                           const std::string& source_binary,
+                           const std::string& source_config,
+                           const std::string& expected_sha256,
+                           RuntimeInstallResult* result,
+                           std::string* error) {
+  std::lock_guard<std::mutex> lock(StoreMutex());
+  *result = RuntimeInstallResult();
+  std::string stamp;
+  uint64_t bytes = 0;
+  if (!SourceStamp(source_binary, source_config, &stamp, &bytes, error)) {
+    return false;
+  }
+  std::error_code ec;
+  const fs::path versions = PathOf(root_) / kVersionsName;
+  fs::create_directories(versions, ec);
+  if (ec) {
+    if (error != nullptr) {
+      *error = "Unable to create " + versions.u8string() + ": " + ec.message();
+    }
+    return false;
+  }
+
+  RuntimeIndex index = LoadIndex();
+  std::string id;
+  FileIdentity installed_identity;
+  // Same assets as an installed version: a switch, decided from a few stat
+  // calls as long as the installed binary is the file hashed last time.
+  for (const RuntimeVersion& entry : index.versions) {
+    if (entry.version == version && entry.platform_arch == platform_arch &&
+        entry.source_stamp == stamp && !entry.sha256.empty() &&
+        IsRegularFile(PathOf(ConfigPath(entry.id)))) {
+      std::string installed_sha256;
+      if (Sha256File(BinaryPath(entry.id), &installed_sha256, &installed_identity, nullptr) &&
+          installed_sha256 == entry.sha256) {
+        id = entry.id;
+      }
+      break;
+    }
+  }
+  if (id.empty()) {
+    std::string binary_sha256;
+    std::string config_sha256;
+    if (!Sha256File(source_binary, &binary_sha256, nullptr, error) ||
+        !Sha256File(source_config, &config_sha256, nullptr, error)) {
+      return false;
+    }
+    if (!expected_sha256.empty() && binary_sha256 != expected_sha256) {
+      if (error != nullptr) {
+        *error = "Checksum mismatch for " + source_binary + ": expected " + expected_sha256 +
+                 ", got " + binary_sha256;
+      }
+      return false;
+    }
+    id = VersionId(version, platform_arch,
+                   Sha256Hex(binary_sha256 + config_sha256).substr(0, kIdHashLength));
+    // Version directories only appear by rename once complete, so one that
+    // exists holds these contents unless it was damaged since.
+    std::string installed_sha256;
+    const bool present =
+        IsRegularFile(PathOf(ConfigPath(id))) &&
+        Sha256File(BinaryPath(id), &installed_sha256, &installed_identity, nullptr) &&
+        installed_sha256 == binary_sha256;
+    if (!present) {
+      const fs::path staging = versions / (kStagingPrefix + id);
+      fs::remove_all(staging, ec);
+      fs::remove_all(PathOf(VersionDirectory(id)), ec);
+      fs::create_directories(staging, ec);
+      if (!InstallFile(source_binary, (staging / binary_name_).u8string(), true,
+                       &result->binary_install, error) ||
+          !InstallFile(source_config, (staging / kConfigName).u8string(), false,
+                       &result->config_install, error)) {
+        fs::remove_all(staging, ec);
+        return false;
+      }
+      // The copy is hashed once more: this is the file that will run, and
+      // its digest seeds the cache for every later check.
+      const std::string staged_binary = (staging / binary_name_).u8string();
+      if (!Sha256File(staged_binary, &installed_sha256, &installed_identity, error)) {
+        fs::remove_all(staging, ec);
+        return false;
+      }
+      if (installed_sha256 != binary_sha256) {
+        if (error != nullptr) {
+          *error = "Installed copy of " + source_binary + " does not match its source";
+        }
+        fs::remove_all(staging, ec);
+        return false;
+      }
+      fs::rename(staging, PathOf(VersionDirectory(id)), ec);
+      if (ec) {
+        if (error != nullptr) {
+          *error = "Unable to move " + staging.u8string() + " into place: " + ec.message();
+        }
+        fs::remove_all(staging, ec);
+        return false;
+      }
+    }
+    result->reused = present;
+    index.versions.erase(std::remove_if(index.versions.begin(), index.versions.end(),
+                                        [&id](const RuntimeVersion& entry) {
+                                          return entry.id == id;
+                                        }),
+                         index.versions.end());
+    RuntimeVersion entry;
+    entry.id = id;
+    entry.version = version;
+    entry.platform_arch = platform_arch;
+    entry.bytes = bytes;
+    entry.sha256 = binary_sha256;
+    entry.installed_at_ms = NowMs();
+    index.versions.push_back(std::move(entry));
+  } else {
+    result->reused = true;
+  }
+  for (RuntimeVersion& entry : index.versions) {
+    if (entry.id != id) {
+      continue;
+    }
+    if (!expected_sha256.empty() && entry.sha256 != expected_sha256) {
+      if (error != nullptr) {
+        *error = "Checksum mismatch for " + source_binary + ": expected " + expected_sha256 +
+                 ", got " + entry.sha256;
+      }
+      return false;
+    }
+    entry.source_stamp = stamp;
+    entry.expected_sha256 = expected_sha256;
+    entry.binary_identity = installed_identity.ToString();
+    result->integrity_verified = !expected_sha256.empty();
+  }
+
+  if (!MakeCurrent(&index, id, error)) {
+    return false;
+  }
+  CollectGarbage(&index, &result->collected);
+  if (!SaveIndex(index, error)) {
+    return false;
+  }
+  result->version = *index.Find(id);
+
+  // Whatever the index no longer names: collected versions, staging left by
+  // an interrupted install, and the flat layout from before versioning.
+  // Removal fails harmlessly for a binary that is still running.
+  for (const fs::directory_entry& entry : fs::directory_iterator(versions, ec)) {
+    const std::string name = entry.path().filename().u8string();
+    if (index.Find(name) == nullptr) {
+      fs::remove_all(entry.path(), ec);
+    }
+  }
+  for (const std::string& legacy :
+       {binary_name_, std::string(kConfigName), std::string("VERSION")}) {
+    fs::remove(PathOf(root_) / legacy, ec);
+  }
+  return true;
+}
+
+bool RuntimeStore::Rollback(RuntimeVersion* current, std::string* error) {
+  std::lock_guard<std::mutex> lock(StoreMutex());
+  RuntimeIndex index = LoadIndex();
+  const std::string target = index.previous;
+  const RuntimeVersion* entry = index.Find(target);
+  if (target.empty() || entry == nullptr || !IsRegularFile(PathOf(BinaryPath(target))) ||
+      !IsRegularFile(PathOf(ConfigPath(target)))) {
+    if (error != nullptr) {
+      *error = "No previous runtime to roll back to";
+    }
+    return false;
+  }
+  if (!entry->sha256.empty() && !IsIntact(*entry)) {
+    if (error != nullptr) {
+      *error = "Previous runtime " + target + " no longer matches its digest";
+    }
+    return false;
+  }
+  if (!MakeCurrent(&index, target, error) || !SaveIndex(index, error)) {
+    return false;
+  }
+  *current = *index.Find(target);
+  return true;
+}
+
+RuntimeIndex RuntimeStore::LoadIndex() const {
+  RuntimeIndex index;
+  MappedFile file;
+  if (!file.Open((PathOf(root_) / kIndexName).u8string(), nullptr)) {
+    return index;
+  }
+  JsonScanner scanner(file.view());
+  std::string_view key;
+  if (scanner.EnterObject()) {
+    while (scanner.NextMember(&key)) {
+      if (key == "current") {
+        index.current = ReadText(&scanner);
+      } else if (key == "previous") {
+        index.previous = ReadText(&scanner);
+      } else if (key == "versions") {
+        if (scanner.EnterArray()) {
+          while (scanner.NextElement()) {
+            ScanVersion(&scanner, &index);
+          }
+        }
+      } else {
+        scanner.Skip();
+      }
+    }
+  }
+  if (!scanner.ok()) {
+    return RuntimeIndex();
+  }
+  // Digests from earlier runs stay valid for as long as the file keeps the
+  // identity it was hashed at.
+  for (const RuntimeVersion& entry : index.versions) {
+    FileIdentity identity;
+    if (!entry.sha256.empty() && FileIdentity::Parse(entry.binary_identity, &identity)) {
+      RememberFileDigest(identity, entry.sha256);
+    }
+  }
+#ifndef _WIN32
+  // The link is flipped before the index is written; if the index write
+  // was lost, the link is what the core would run.
+  std::error_code ec;
+  const fs::path target = fs::read_symlink(PathOf(root_) / kCurrentName, ec);
+  if (!ec) {
+    const std::string linked = target.filename().u8string();
+    if (linked != index.current && index.Find(linked) != nullptr) {
+      index.previous = index.current;
+      index.current = linked;
+    }
+  }
+#endif
+  return index;
+}
+
+bool RuntimeStore::IsIntact(const RuntimeVersion& entry) const {
+  std::string sha256;
+  return !entry.sha256.empty() && Sha256File(BinaryPath(entry.id), &sha256, nullptr, nullptr) &&
+         sha256 == entry.sha256;
+}
+
+bool RuntimeStore::VerifyBinary(const std::string& path,
+                                PinnedFile* binary,
+                                bool* managed,
+                                std::string* error) const {
+  *managed = false;
+  std::error_code ec;
+  const fs::path resolved = fs::canonical(PathOf(path), ec);
+  const fs::path versions = fs::canonical(PathOf(root_) / kVersionsName, ec);
+  if (ec || resolved.parent_path().parent_path() != versions) {
+    return true;
+  }
+  const RuntimeIndex index = LoadIndex();
+  const RuntimeVersion* entry = index.Find(resolved.parent_path().filename().u8string());
+  if (entry == nullptr || entry->sha256.empty()) {
+    return true;
+  }
+  *managed = true;
+  std::string sha256;
+  bool cached = false;
+  if (!binary->Sha256(&sha256, &cached, error)) {
+    return false;
+  }
+  if (sha256 != entry->sha256) {
+    if (error != nullptr) {
+      *error = path + " does not match the runtime installed as " + entry->id;
+    }
+    return false;
+  }
+  return true;
+}
+
+std::string RuntimeStore::CurrentBinaryPath() const {
+#ifdef _WIN32
+  const RuntimeIndex index = LoadIndex();
+  if (!index.current.empty()) {
+    return BinaryPath(index.current);
+  }
+#endif
+  return (PathOf(root_) / kCurrentName / binary_name_).u8string();
+}
+
+std::string RuntimeStore::CurrentConfigPath() const {
+#ifdef _WIN32
+  const RuntimeIndex index = LoadIndex();
+  if (!index.current.empty()) {
+    return ConfigPath(index.current);
+  }
+#endif
+  return (PathOf(root_) / kCurrentName / kConfigName).u8string();
+}
+
+std::string RuntimeStore::BinaryPath(const std::string& id) const {
+  return (PathOf(VersionDirectory(id)) / binary_name_).u8string();
+}
+
+std::string RuntimeStore::ConfigPath(const std::string& id) const {
+  return (PathOf(VersionDirectory(id)) / kConfigName).u8string();
+}
+
+std::string RuntimeStore::VersionDirectory(const std::string& id) const {
+  return (PathOf(root_) / kVersionsName / PathOf(id)).u8string();
+}
+
+bool RuntimeStore::SaveIndex(const RuntimeIndex& index, std::string* error) const {
+  bool changed = false;
+  return InstallTextFile((PathOf(root_) / kIndexName).u8string(), SerializeIndex(index), &changed,
+                         error);
+}
+
+bool RuntimeStore::MakeCurrent(RuntimeIndex* index,
+                               const std::string& id,
+                               std::string* error) const {
+#ifndef _WIN32
+  std::error_code ec;
+  const fs::path link = PathOf(root_) / kCurrentName;
+  const fs::path temp = PathOf(root_) / (std::string(".") + kCurrentName + ".partial");
+  fs::remove(temp, ec);
+  fs::create_directory_symlink(fs::path(kVersionsName) / PathOf(id), temp, ec);
+  if (!ec) {
+    // rename(2) replaces the old link in one step.
+    fs::rename(temp, link, ec);
+  }
+  if (ec) {
+    if (error != nullptr) {
+      *error = "Unable to point " + link.u8string() + " at " + id + ": " + ec.message();
+    }
+    fs::remove(temp, ec);
+    return false;
+  }
+#else
+  (void)error;
+#endif
+  if (index->current != id) {
+    index->previous = index->current;
+    index->current = id;
+  }
+  for (RuntimeVersion& entry : index->versions) {
+    if (entry.id == id) {
+      entry.last_used_ms = NowMs();
+    }
+  }
+  return true;
+}
+
+void RuntimeStore::CollectGarbage(RuntimeIndex* index, std::vector<std::string>* collected) const {
+  uint64_t total = 0;
+  std::vector<const RuntimeVersion*> candidates;
+  for (const RuntimeVersion& entry : index->versions) {
+    total += entry.bytes;
+    if (entry.id != index->current && entry.id != index->previous) {
+      candidates.push_back(&entry);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const RuntimeVersion* a, const RuntimeVersion* b) {
+              return a->last_used_ms < b->last_used_ms;
+            });
+  for (const RuntimeVersion* entry : candidates) {
+    if (total <= size_cap_bytes_) {
+      break;
+    }
+    total -= entry->bytes;
+    collected->push_back(entry->id);
+  }
+  index->versions.erase(
+      std::remove_if(index->versions.begin(), index->versions.end(),
+                     [collected](const RuntimeVersion& entry) {
+                       return std::find(collected->begin(), collected->end(), entry.id) !=
+                              collected->end();
+                     }),
+      index->versions.end());
+}
+
+bool ReadRuntimeChecksum(const std::string& checksums_path,
+                         const std::string& platform_arch,
+                         const std::string& version,
+                         std::string* sha256,
+                         std::string* error) {
+  sha256->clear();
+  MappedFile file;
+  if (!file.Open(checksums_path, error)) {
+    return false;
+  }
+  JsonScanner scanner(file.view());
+  std::string_view key;
+  if (scanner.EnterObject()) {
+    while (scanner.NextMember(&key)) {
+      if (key == "artifacts") {
+        if (scanner.EnterObject()) {
+          while (scanner.NextMember(&key)) {
+            if (UnescapeJsonString(key) == platform_arch) {
+              ScanArtifact(&scanner, version, sha256);
+            } else {
+              scanner.Skip();
+            }
+          }
+        }
+      } else {
+        scanner.Skip();
+      }
+    }
+  }
+  if (!scanner.ok()) {
+    if (error != nullptr) {
+      *error = "Malformed JSON in " + checksums_path + " at offset " +
+               std::to_string(scanner.offset());
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,148 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_RUNTIME_STORE_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_RUNTIME_STORE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "file_digest.h"
+#include "file_install.h"
+
+namespace jumper_sdk_platform {
+
+// One installed runtime: a sing-box binary and the config it shipped with.
+struct RuntimeVersion {
+  // `<version>-<platformArch>-<content hash>`, also the directory name.
+  std::string id;
+  std::string version;
+  std::string platform_arch;
+  // Binary plus config.
+  uint64_t bytes = 0;
+  // Size and mtime of the source files the version was installed from, so
+  // reinstalling from the same assets needs no hashing.
+  std::string source_stamp;
+  // SHA-256 of the installed binary.
+  std::string sha256;
+  // What checksums.json listed for it at install; empty when it listed
+  // nothing for this version.
+  std::string expected_sha256;
+  // FileIdentity of the installed binary when |sha256| was computed. While
+  // it holds, the digest is reused instead of rehashing the file.
+  std::string binary_identity;
+  int64_t installed_at_ms = 0;
+  int64_t last_used_ms = 0;
+};
+
+// The contents of `index.json`.
+struct RuntimeIndex {
+  std::string current;
+  // What was current before the last switch; the rollback target.
+  std::string previous;
+  std::vector<RuntimeVersion> versions;
+
+  const RuntimeVersion* Find(const std::string& id) const;
+  // The installed version matching |version| and |platform_arch|, preferring
+  // the current one.
+  const RuntimeVersion* FindVersion(const std::string& version,
+                                    const std::string& platform_arch) const;
+};
+
+struct RuntimeInstallResult {
+  RuntimeVersion version;
+  // The version was already installed and only became current.
+  bool reused = false;
+  InstallMethod binary_install = InstallMethod::kUnchanged;
+  InstallMethod config_install = InstallMethod::kUnchanged;
+  // The installed binary matches a checksum from checksums.json.
+  bool integrity_verified = false;
+  // Ids removed by the collection that followed the install.
+  std::vector<std::string> collected;
+};
+
+// Content-addressed runtime container:
+//
+//   <root>/index.json              current, previous and every version
+//   <root>/versions/<id>/sing-box  immutable once renamed into place
+//   <root>/current -> versions/<id>
+//
+// Switching to an installed version rewrites the index and flips the
+// `current` link; nothing is copied. The link is a symlink replaced by
+// rename, so a reader sees the old or the new version, never neither.
+// Windows has no unprivileged symlinks, so there the index alone says which
+// version is current and paths point into `versions/`.
+//
+// Calls are serialized inside the process; concurrent processes are not
+// expected to share a container.
+class RuntimeStore {
+ public:
+  // Versions other than the current and previous are evicted, least
+  // recently used first, once the container exceeds this.
+  static constexpr uint64_t kDefaultSizeCapBytes = 256ull * 1024 * 1024;
+
+  RuntimeStore(std::string root, std::string binary_name);
+
+  // Makes |version| current, installing it from the source files unless a
+  // version with the same contents is already in the container, then
+  // collects old versions. A non-empty |expected_sha256| must match the
+  // binary, or nothing is installed or switched.
+  bool Install(const std::string& version,
+               const std::string& platform_arch,
+               const std::string& source_binary,
+               const std::string& source_config,
+               const std::string& expected_sha256,
+               RuntimeInstallResult* result,
+               std::string* error);
+
+  // Swaps the current and previous versions, unless the previous one no
+  // longer matches its digest.
+  bool Rollback(RuntimeVersion* current, std::string* error);
+
+  // Reads the index. A missing or unreadable index is an empty container.
+  RuntimeIndex LoadIndex() const;
+
+  // True when |entry|'s binary still hashes to what was installed. While
+  // the file keeps its identity this is an open and an fstat.
+  bool IsIntact(const RuntimeVersion& entry) const;
+
+  // Checks |binary|, opened from |path|, against the digest recorded when
+  // it was installed. Binaries outside the container are not checked and
+  // leave |managed| false.
+  bool VerifyBinary(const std::string& path,
+                    PinnedFile* binary,
+                    bool* managed,
+                    std::string* error) const;
+
+  // Paths of the current version's files. These go through the `current`
+  // link where there is one, so they keep working across switches.
+  std::string CurrentBinaryPath() const;
+  std::string CurrentConfigPath() const;
+  std::string BinaryPath(const std::string& id) const;
+  std::string ConfigPath(const std::string& id) const;
+
+  const std::string& root() const { return root_; }
+
+  void set_size_cap_bytes(uint64_t cap) { size_cap_bytes_ = cap; }
+
+ private:
+  std::string VersionDirectory(const std::string& id) const;
+  bool SaveIndex(const RuntimeIndex& index, std::string* error) const;
+  // Points `current` at |id| and records the switch in |index|.
+  bool MakeCurrent(RuntimeIndex* index, const std::string& id, std::string* error) const;
+  void CollectGarbage(RuntimeIndex* index, std::vector<std::string>* collected) const;
+
+  std::string root_;
+  std::string binary_name_;
+  uint64_t size_cap_bytes_ = kDefaultSizeCapBytes;
+};
+
+// Looks up the binary checksum for |platform_arch| in checksums.json. Leaves
+// |sha256| empty when the file lists a different version.
+bool ReadRuntimeChecksum(const std::string& checksums_path,
+                         const std::string& platform_arch,
+                         const std::string& version,
+                         std::string* sha256,
+                         std::string* error);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_RUNTIME_STORE_H_
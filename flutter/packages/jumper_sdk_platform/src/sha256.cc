@@ -0,0 +1,238 @@
+#include "sha256.h"
+
+#include <cstring>
+
+#include "sha256_internal.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JUMPER_SHA256_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2,
+};
+
+inline uint32_t RotateRight(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+}  // namespace
+
+namespace sha256_internal {
+
+void CompressPortable(uint32_t state[8], const uint8_t* data, size_t blocks) {
+  uint32_t w[64];
+  for (; blocks > 0; --blocks, data += 64) {
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (static_cast<uint32_t>(data[i * 4]) << 24) |
+             (static_cast<uint32_t>(data[i * 4 + 1]) << 16) |
+             (static_cast<uint32_t>(data[i * 4 + 2]) << 8) | static_cast<uint32_t>(data[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+      const uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+      const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+      const uint32_t choose = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + choose + kRoundConstants[i] + w[i];
+      const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+      const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + s0 + majority;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+}  // namespace sha256_internal
+
+namespace {
+
+using sha256_internal::CompressFunction;
+using sha256_internal::CompressPortable;
+
+#ifdef JUMPER_SHA256_X86
+
+bool DetectShaNi() {
+#ifdef _MSC_VER
+  int leaf1[4];
+  int leaf7[4];
+  __cpuid(leaf1, 1);
+  __cpuidex(leaf7, 7, 0);
+  const unsigned int ecx1 = static_cast<unsigned int>(leaf1[2]);
+  const unsigned int ebx7 = static_cast<unsigned int>(leaf7[1]);
+#else
+  unsigned int eax = 0, ebx = 0, ecx1 = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx)) {
+    return false;
+  }
+  unsigned int ebx7 = 0, ecx = 0;
+  if (!__get_cpuid_count(7, 0, &eax, &ebx7, &ecx, &edx)) {
+    return false;
+  }
+#endif
+  const bool ssse3 = (ecx1 & (1u << 9)) != 0;
+  const bool sse41 = (ecx1 & (1u << 19)) != 0;
+  const bool sha = (ebx7 & (1u << 29)) != 0;
+  return ssse3 && sse41 && sha;
+}
+
+#ifndef _MSC_VER
+__attribute__((target("sha,sse4.1,ssse3")))
+#endif
+void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+  // Byte order within each 32-bit word, for loading big-endian message words.
+  const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  // The instructions want the state as ABEF and CDGH.
+  __m128i swapped = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)),
+                                      0xB1);
+  __m128i cdgh =
+      _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+  __m128i abef = _mm_alignr_epi8(swapped, cdgh, 8);
+  cdgh = _mm_blend_epi16(cdgh, swapped, 0xF0);
+
+  for (; blocks > 0; --blocks, data += 64) {
+    const __m128i abef_saved = abef;
+    const __m128i cdgh_saved = cdgh;
+    __m128i w[4];
+    for (int group = 0; group < 16; ++group) {
+      __m128i& current = w[group & 3];
+      if (group < 4) {
+        current = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + group * 16)), byte_swap);
+      } else {
+        const __m128i& previous = w[(group - 1) & 3];
+        current = _mm_sha256msg1_epu32(current, w[(group - 3) & 3]);
+        current = _mm_add_epi32(current, _mm_alignr_epi8(previous, w[(group - 2) & 3], 4));
+        current = _mm_sha256msg2_epu32(current, previous);
+      }
+      __m128i message = _mm_add_epi32(
+          current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kRoundConstants + group * 4)));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+      message = _mm_shuffle_epi32(message, 0x0E);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+    }
+    abef = _mm_add_epi32(abef, abef_saved);
+    cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+  }
+
+  swapped = _mm_shuffle_epi32(abef, 0x1B);
+  cdgh = _mm_shuffle_epi32(cdgh, 0xB1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(swapped, cdgh, 0xF0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(cdgh, swapped, 8));
+}
+
+#endif
+
+CompressFunction SelectCompress() {
+#ifdef JUMPER_SHA256_X86
+  if (DetectShaNi()) {
+    return CompressShaNi;
+  }
+#endif
+  return CompressPortable;
+}
+
+// Picked once; CPUID is not free.
+const CompressFunction kCompress = SelectCompress();
+
+}  // namespace
+
+namespace sha256_internal {
+
+CompressFunction HardwareCompress() { return kCompress != CompressPortable ? kCompress : nullptr; }
+
+}  // namespace sha256_internal
+
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab,
+             0x5be0cd19} {}
+
+void Sha256::Update(const void* data, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  total_bytes_ += length;
+  if (buffered_ > 0) {
+    const size_t take = length < 64 - buffered_ ? length : 64 - buffered_;
+    std::memcpy(buffer_ + buffered_, bytes, take);
+    buffered_ += take;
+    bytes += take;
+    length -= take;
+    if (buffered_ < 64) {
+      return;
+    }
+    kCompress(state_, buffer_, 1);
+    buffered_ = 0;
+  }
+  if (length >= 64) {
+    kCompress(state_, bytes, length / 64);
+    bytes += length & ~static_cast<size_t>(63);
+    length &= 63;
+  }
+  std::memcpy(buffer_, bytes, length);
+  buffered_ = length;
+}
+
+std::string Sha256::FinishHex() {
+  const uint64_t bit_length = total_bytes_ * 8;
+  uint8_t padding[72] = {0x80};
+  const size_t pad = (buffered_ < 56 ? 56 : 120) - buffered_;
+  for (int i = 0; i < 8; ++i) {
+    padding[pad + i] = static_cast<uint8_t>(bit_length >> (56 - i * 8));
+  }
+  Update(padding, pad + 8);
+
+  static const char kHex[] = "0123456789abcdef";
+  std::string hex(64, '0');
+  for (int i = 0; i < 8; ++i) {
+    for (int nibble = 0; nibble < 8; ++nibble) {
+      hex[i * 8 + nibble] = kHex[(state_[i] >> (28 - nibble * 4)) & 0xF];
+    }
+  }
+  return hex;
+}
+
+bool Sha256::HasHardwareSupport() { return kCompress != CompressPortable; }
+
+std::string Sha256Hex(std::string_view data) {
+  Sha256 sha;
+  sha.Update(data.data(), data.size());
+  return sha.FinishHex();
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,35 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace jumper_sdk_platform {
+
+// Incremental SHA-256. Blocks go through the CPU's SHA extensions when it
+// has them (x86 SHA-NI), otherwise through portable code.
+class Sha256 {
+ public:
+  Sha256();
+
+  void Update(const void* data, size_t length);
+  // Lowercase hex digest. The object must not be updated afterwards.
+  std::string FinishHex();
+
+  // True when blocks are hashed with SHA-NI on this machine.
+  static bool HasHardwareSupport();
+
+ private:
+  uint32_t state_[8];
+  uint8_t buffer_[64];
+  size_t buffered_ = 0;
+  uint64_t total_bytes_ = 0;
+};
+
+std::string Sha256Hex(std::string_view data);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_H_
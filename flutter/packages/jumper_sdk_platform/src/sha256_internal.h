@@ -0,0 +1,24 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_INTERNAL_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_INTERNAL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The block functions behind Sha256, for tests that need to check the path
+// the CPU did not select. Not for use outside sha256.cc and its tests.
+namespace jumper_sdk_platform {
+namespace sha256_internal {
+
+// Hashes |blocks| 64-byte blocks from |data| into |state|.
+using CompressFunction = void (*)(uint32_t state[8], const uint8_t* data, size_t blocks);
+
+void CompressPortable(uint32_t state[8], const uint8_t* data, size_t blocks);
+
+// The SHA-NI function Sha256 uses on this machine, or null where it uses
+// CompressPortable.
+CompressFunction HardwareCompress();
+
+}  // namespace sha256_internal
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_SHA256_INTERNAL_H_
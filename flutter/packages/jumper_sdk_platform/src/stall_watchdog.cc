@@ -0,0 +1,171 @@
+#include "stall_watchdog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <utility>
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+int64_t SteadyNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t WallMilliseconds() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+struct StallWatchdog::State {
+  explicit State(const StallWatchdogOptions& options)
+      : threshold_ns(static_cast<int64_t>(options.threshold_ms) * 1000000),
+        max_records(std::max<size_t>(options.max_records, 1)) {}
+
+  // Requires |mutex|.
+  void AddStall(std::string method, int64_t duration_ns) {
+    const double duration_ms = duration_ns / 1e6;
+    stall_durations->Record(duration_ns);
+    if (!method.empty()) {
+      worst_method_stall_ms = std::max(worst_method_stall_ms, duration_ms);
+    }
+    stalls.push_back({std::move(method), duration_ms, WallMilliseconds()});
+    if (stalls.size() > max_records) {
+      stalls.pop_front();
+      ++dropped;
+    }
+  }
+
+  void OnHeartbeat(int64_t posted_ns) {
+    const int64_t latency_ns = SteadyNanoseconds() - posted_ns;
+    std::lock_guard<std::mutex> lock(mutex);
+    ++heartbeats;
+    heartbeat_latency->Record(latency_ns);
+    if (latency_ns >= threshold_ns && !held_by_method) {
+      AddStall(std::string(), latency_ns);
+    }
+    heartbeat_pending = false;
+  }
+
+  const int64_t threshold_ns;
+  const size_t max_records;
+  mutable std::mutex mutex;
+  std::string_view method;
+  int64_t method_started_ns = 0;
+  bool in_method = false;
+  bool heartbeat_pending = false;
+  // A handler stalled while the pending heartbeat waited, and was recorded
+  // for it.
+  bool held_by_method = false;
+  uint64_t heartbeats = 0;
+  std::unique_ptr<LatencyHistogram> heartbeat_latency = std::make_unique<LatencyHistogram>();
+  std::unique_ptr<LatencyHistogram> stall_durations = std::make_unique<LatencyHistogram>();
+  std::deque<StallRecord> stalls;
+  uint64_t dropped = 0;
+  double worst_method_stall_ms = 0;
+};
+
+StallWatchdog::StallWatchdog(StallWatchdogOptions options, PostToMainThread post)
+    : options_(options), post_(std::move(post)), state_(std::make_shared<State>(options)) {}
+
+StallWatchdog::~StallWatchdog() {
+  Stop();
+}
+
+void StallWatchdog::Start() {
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = std::thread([this] { Run(); });
+}
+
+void StallWatchdog::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    running_ = false;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void StallWatchdog::Run() {
+  const auto interval = std::chrono::milliseconds(std::max(options_.heartbeat_interval_ms, 1));
+  std::unique_lock<std::mutex> lock(run_mutex_);
+  while (!wake_.wait_for(lock, interval, [this] { return !running_; })) {
+    int64_t posted_ns = 0;
+    {
+      std::lock_guard<std::mutex> state_lock(state_->mutex);
+      // One heartbeat at a time: a late one is the stall being measured.
+      if (state_->heartbeat_pending) {
+        continue;
+      }
+      posted_ns = SteadyNanoseconds();
+      state_->heartbeat_pending = true;
+      state_->held_by_method = false;
+    }
+    lock.unlock();
+    post_([state = std::weak_ptr<State>(state_), posted_ns] {
+      if (const auto alive = state.lock()) {
+        alive->OnHeartbeat(posted_ns);
+      }
+    });
+    lock.lock();
+  }
+}
+
+void StallWatchdog::EnterMethod(std::string_view method) {
+  const int64_t now_ns = SteadyNanoseconds();
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->method = method;
+  state_->method_started_ns = now_ns;
+  state_->in_method = true;
+}
+
+void StallWatchdog::LeaveMethod() {
+  const int64_t now_ns = SteadyNanoseconds();
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  if (!state_->in_method) {
+    return;
+  }
+  state_->in_method = false;
+  const int64_t duration_ns = now_ns - state_->method_started_ns;
+  if (duration_ns >= state_->threshold_ns) {
+    state_->AddStall(std::string(state_->method), duration_ns);
+    state_->held_by_method = state_->heartbeat_pending;
+  }
+}
+
+StallReport StallWatchdog::Report() const {
+  StallReport report;
+  report.options = options_;
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  report.heartbeats = state_->heartbeats;
+  report.heartbeat_latency = state_->heartbeat_latency->Snapshot();
+  report.stall_durations = state_->stall_durations->Snapshot();
+  report.stalls.assign(state_->stalls.begin(), state_->stalls.end());
+  report.dropped = state_->dropped;
+  report.worst_method_stall_ms = state_->worst_method_stall_ms;
+  return report;
+}
+
+void StallWatchdog::Clear() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->heartbeats = 0;
+  state_->heartbeat_latency = std::make_unique<LatencyHistogram>();
+  state_->stall_durations = std::make_unique<LatencyHistogram>();
+  state_->stalls.clear();
+  state_->dropped = 0;
+  state_->worst_method_stall_ms = 0;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,117 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_STALL_WATCHDOG_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_STALL_WATCHDOG_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "latency_metrics.h"
+
+namespace jumper_sdk_platform {
+
+struct StallWatchdogOptions {
+  // How often the main loop is asked to answer. Handler stalls are timed
+  // directly, so this only bounds how short a stall from elsewhere may be
+  // and still be seen.
+  int heartbeat_interval_ms = 100;
+  int threshold_ms = 16;
+  // Stall records kept, newest last.
+  size_t max_records = 256;
+};
+
+// A time the main thread did not get back to its loop for at least the
+// threshold.
+struct StallRecord {
+  // The plugin handler that held the thread; empty when a heartbeat came
+  // back late while no handler ran, i.e. the engine or another plugin held
+  // it.
+  std::string method;
+  double duration_ms = 0;
+  // Wall clock, when the stall ended.
+  int64_t timestamp_ms = 0;
+};
+
+struct StallReport {
+  StallWatchdogOptions options;
+  uint64_t heartbeats = 0;
+  // How late every heartbeat ran, stall or not.
+  LatencySnapshot heartbeat_latency;
+  // Every stall recorded, dropped ones included.
+  LatencySnapshot stall_durations;
+  std::vector<StallRecord> stalls;
+  // Stalls no longer in |stalls|.
+  uint64_t dropped = 0;
+  // The longest stall a plugin handler caused; what release gates check.
+  double worst_method_stall_ms = 0;
+};
+
+// Watches the platform thread from a thread of its own. Every heartbeat
+// interval it posts a heartbeat to the main loop and times how late it
+// runs; the main thread brackets each plugin handler it runs with
+// EnterMethod and LeaveMethod, so a stall is pinned on the handler that
+// caused it with its exact duration. A stall a handler caused is recorded
+// once, by LeaveMethod, not again by the heartbeat it held up.
+class StallWatchdog {
+ public:
+  // Runs a task on the main thread. Tasks still queued when the watchdog
+  // goes away do nothing.
+  using PostToMainThread = std::function<void(std::function<void()>)>;
+
+  StallWatchdog(StallWatchdogOptions options, PostToMainThread post);
+  ~StallWatchdog();
+
+  StallWatchdog(const StallWatchdog&) = delete;
+  StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+  void Start();
+  void Stop();
+
+  // Main thread. |method| must outlive the matching LeaveMethod.
+  void EnterMethod(std::string_view method);
+  void LeaveMethod();
+
+  StallReport Report() const;
+  // Forgets the records and histograms, e.g. between test runs.
+  void Clear();
+
+ private:
+  struct State;
+
+  void Run();
+
+  StallWatchdogOptions options_;
+  PostToMainThread post_;
+  // Shared with queued heartbeats, which hold it weakly.
+  std::shared_ptr<State> state_;
+  std::mutex run_mutex_;
+  std::condition_variable wake_;
+  bool running_ = false;
+  std::thread thread_;
+};
+
+// Brackets a plugin handler on the main thread with EnterMethod and
+// LeaveMethod.
+class StallWatchdogScope {
+ public:
+  StallWatchdogScope(StallWatchdog* watchdog, std::string_view method) : watchdog_(watchdog) {
+    watchdog_->EnterMethod(method);
+  }
+  ~StallWatchdogScope() { watchdog_->LeaveMethod(); }
+
+  StallWatchdogScope(const StallWatchdogScope&) = delete;
+  StallWatchdogScope& operator=(const StallWatchdogScope&) = delete;
+
+ private:
+  StallWatchdog* watchdog_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_STALL_WATCHDOG_H_
@@ -0,0 +1,62 @@
+#include "config_planner.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "test/profile_config.h"
+
+namespace jumper_sdk_platform {
+namespace test {
+
+namespace {
+
+std::string ReplaceFirst(std::string text, const std::string& from, const std::string& to) {
+  text.replace(text.find(from), from.size(), to);
+  return text;
+}
+
+}  // namespace
+
+TEST(ConfigPlanner, PlansApiReloadAndRestart) {
+  ConfigShape running;
+  std::string error;
+  ASSERT_TRUE(ScanConfigShape(kProfileConfig, &running, &error)) << error;
+  ASSERT_EQ(running.selectors.size(), 1u);
+  EXPECT_EQ(running.selectors[0].tag, "proxy");
+  EXPECT_EQ(running.selectors[0].selected, "auto");
+  EXPECT_EQ(running.clash_mode, "rule");
+
+  // Selector and mode changes go through the Clash API.
+  ConfigShape switched;
+  ASSERT_TRUE(ScanConfigShape(
+      ReplaceFirst(ReplaceFirst(kProfileConfig, R"("default": "auto")", R"("default": "direct")"),
+                   R"("default_mode": "rule")", R"("default_mode": "global")"),
+      &switched, &error));
+  const ConfigPlan api = PlanConfigChange(&running, &switched, true, true);
+  EXPECT_EQ(api.kind, ConfigPlanKind::kApi);
+  ASSERT_EQ(api.calls.size(), 2u);
+  EXPECT_EQ(api.calls[0].method, "PUT");
+  EXPECT_EQ(api.calls[0].path, "/proxies/proxy");
+  EXPECT_EQ(api.calls[0].body, R"({"name":"direct"})");
+  EXPECT_EQ(api.calls[1].method, "PATCH");
+  EXPECT_EQ(api.calls[1].path, "/configs");
+  EXPECT_EQ(api.calls[1].body, R"({"mode":"global"})");
+  EXPECT_TRUE(PlanConfigChange(&running, &running, true, true).calls.empty());
+
+  // Anything else needs the config loaded again, or a restart where the
+  // platform cannot reload.
+  ConfigShape moved;
+  ASSERT_TRUE(ScanConfigShape(ReplaceFirst(kProfileConfig, "7890", "7891"), &moved, &error));
+  EXPECT_EQ(PlanConfigChange(&running, &moved, true, true).kind, ConfigPlanKind::kReload);
+  EXPECT_EQ(PlanConfigChange(&running, &moved, true, false).kind, ConfigPlanKind::kRestart);
+  EXPECT_EQ(PlanConfigChange(&running, nullptr, true, true).kind, ConfigPlanKind::kReload);
+
+  // A different launch always restarts.
+  const ConfigPlan restart = PlanConfigChange(&running, &switched, false, true);
+  EXPECT_EQ(restart.kind, ConfigPlanKind::kRestart);
+  EXPECT_FALSE(restart.reason.empty());
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,71 @@
+#include "connection_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+namespace {
+
+ConnectionEntry Connection(const std::string& id, int64_t upload, int64_t download) {
+  ConnectionEntry entry;
+  entry.id = id;
+  entry.upload = upload;
+  entry.download = download;
+  return entry;
+}
+
+}  // namespace
+
+TEST(ConnectionTracker, ReportsDeltasBetweenSnapshots) {
+  std::vector<ConnectionEntry> entries;
+  std::string error;
+  ASSERT_TRUE(ParseConnectionsSnapshot(
+      R"({"downloadTotal": 6, "uploadTotal": 5, "connections": [)"
+      R"({"id": "a", "upload": 5, "download": 6, "metadata": {"host": "example.com"}}]})",
+      &entries, &error));
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].id, "a");
+  EXPECT_EQ(entries[0].upload, 5);
+  EXPECT_EQ(entries[0].download, 6);
+  EXPECT_EQ(entries[0].json.front(), '{');
+  EXPECT_EQ(entries[0].json.back(), '}');
+  ASSERT_TRUE(ParseConnectionsSnapshot(R"({"connections": null})", &entries, &error));
+  EXPECT_TRUE(entries.empty());
+
+  ConnectionTracker tracker;
+  ConnectionsDelta delta = tracker.Update({Connection("a", 0, 0), Connection("b", 10, 10)}, 1000);
+  EXPECT_EQ(delta.added.size(), 2u);
+  EXPECT_TRUE(delta.changed.empty());
+
+  // Only moving counters are reported, with their rates.
+  delta = tracker.Update(
+      {Connection("a", 500, 1000), Connection("b", 10, 10), Connection("c", 0, 0)}, 1500);
+  ASSERT_EQ(delta.added.size(), 1u);
+  EXPECT_EQ(delta.added[0].id, "c");
+  ASSERT_EQ(delta.changed.size(), 1u);
+  EXPECT_EQ(delta.changed[0].id, "a");
+  EXPECT_EQ(delta.changed[0].upload_rate, 1000);
+  EXPECT_EQ(delta.changed[0].download_rate, 2000);
+  EXPECT_TRUE(delta.removed.empty());
+
+  // A connection that stops moving is reported once more, at rate zero.
+  delta = tracker.Update({Connection("a", 500, 1000)}, 2500);
+  ASSERT_EQ(delta.changed.size(), 1u);
+  EXPECT_EQ(delta.changed[0].upload_rate, 0);
+  EXPECT_EQ(delta.changed[0].download_rate, 0);
+  std::sort(delta.removed.begin(), delta.removed.end());
+  EXPECT_EQ(delta.removed, (std::vector<std::string>{"b", "c"}));
+  EXPECT_TRUE(tracker.Update({Connection("a", 500, 1000)}, 3500).empty());
+
+  tracker.Reset();
+  EXPECT_EQ(tracker.Update({Connection("a", 500, 1000)}, 4500).added.size(), 1u);
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,40 @@
+#include "core_config.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "test/profile_config.h"
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(CoreConfig, ScansProfileConfig) {
+  CoreConfig config;
+  std::string error;
+  ASSERT_TRUE(ScanCoreConfig(kProfileConfig, &config, &error)) << error;
+  EXPECT_TRUE(config.tun_enabled);
+  ASSERT_TRUE(config.has_controller);
+  EXPECT_EQ(config.controller.host, "127.0.0.1");
+  EXPECT_EQ(config.controller.port, 9090);
+  EXPECT_EQ(config.controller.secret, "s3cr\"et");
+  // Inbound ports first, then the controller's.
+  EXPECT_EQ(config.listen_ports, (std::vector<uint16_t>{7890, 9090}));
+  EXPECT_EQ(config.log_output, "box.log");
+
+  CoreConfig disabled_tun;
+  ASSERT_TRUE(ScanCoreConfig(
+      R"({"inbounds": [{"type": "tun", "enable": false}, {"type": "socks", "listen_port": 1080}]})",
+      &disabled_tun, &error));
+  EXPECT_FALSE(disabled_tun.tun_enabled);
+  EXPECT_FALSE(disabled_tun.has_controller);
+  EXPECT_EQ(disabled_tun.listen_ports, (std::vector<uint16_t>{1080}));
+
+  CoreConfig broken;
+  EXPECT_FALSE(ScanCoreConfig(R"({"inbounds": [}")", &broken, &error));
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
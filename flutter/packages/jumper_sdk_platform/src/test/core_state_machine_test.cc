@@ -0,0 +1,54 @@
+#include "core_state_machine.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(CoreStateMachine, ReplaysRecentTransitions) {
+  CoreStateMachine machine(3, 100);
+  EXPECT_EQ(machine.Snapshot().status, CoreStatus::kStopped);
+  EXPECT_EQ(machine.Snapshot().version, 1u);
+
+  CoreStateChange change;
+  change.status = CoreStatus::kRunning;
+  EXPECT_FALSE(machine.Apply(change, 200, nullptr));
+  change.status = CoreStatus::kStarting;
+  change.runtime_mode = "real";
+  ASSERT_TRUE(machine.Apply(change, 200, nullptr));
+  change.status = CoreStatus::kRunning;
+  change.pid = 42;
+  change.message = "core started";
+  CoreTransition transition;
+  ASSERT_TRUE(machine.Apply(change, 300, &transition));
+  EXPECT_EQ(transition.version, 3u);
+  EXPECT_EQ(transition.previous_status, CoreStatus::kStarting);
+  // A change that alters nothing is not a transition.
+  EXPECT_FALSE(machine.Apply(change, 350, nullptr));
+  change.status = CoreStatus::kStopping;
+  change.runtime_mode.clear();
+  ASSERT_TRUE(machine.Apply(change, 400, nullptr));
+  change.status = CoreStatus::kStopped;
+  change.pid = 0;
+  ASSERT_TRUE(machine.Apply(change, 500, nullptr));
+
+  // Only the newest three are kept for a listener that attaches late.
+  const std::vector<CoreTransition> replay = machine.TransitionsSince(0);
+  ASSERT_EQ(replay.size(), 3u);
+  EXPECT_EQ(replay[0].version, 3u);
+  EXPECT_EQ(replay[0].state.status, CoreStatus::kRunning);
+  EXPECT_EQ(replay[0].state.runtime_mode, "real");
+  EXPECT_EQ(replay[0].state.pid, 42);
+  EXPECT_EQ(replay[0].message, "core started");
+  EXPECT_EQ(replay[2].version, 5u);
+  EXPECT_EQ(replay[2].state.status, CoreStatus::kStopped);
+  EXPECT_EQ(replay[2].timestamp_ms, 500);
+  ASSERT_EQ(machine.TransitionsSince(4).size(), 1u);
+  EXPECT_TRUE(machine.TransitionsSince(5).empty());
+  EXPECT_EQ(machine.Snapshot().version, 5u);
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,51 @@
+#include "core_supervisor.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(RestartBackoff, DoublesDelaysAndOpensOnCrashLoop) {
+  RestartBackoffOptions options;
+  options.initial_delay_ms = 100;
+  options.max_delay_ms = 400;
+  options.stable_uptime_ms = 1000;
+  options.max_crashes = 3;
+  options.crash_window_ms = 10000;
+  RestartBackoff backoff(options);
+
+  // Equal jitter: each delay lies between half and all of the doubled one.
+  const int64_t first = backoff.OnExit(0, 10);
+  EXPECT_GE(first, 50);
+  EXPECT_LE(first, 100);
+  const int64_t second = backoff.OnExit(100, 10);
+  EXPECT_GE(second, 100);
+  EXPECT_LE(second, 200);
+  const int64_t third = backoff.OnExit(200, 10);
+  EXPECT_GE(third, 200);
+  EXPECT_LE(third, 400);
+  EXPECT_EQ(backoff.attempt(), 3);
+  EXPECT_FALSE(backoff.open());
+  // A fourth exit within the window is a crash loop.
+  EXPECT_EQ(backoff.OnExit(300, 10), -1);
+  EXPECT_TRUE(backoff.open());
+  EXPECT_EQ(backoff.OnExit(20000, 5000), -1);
+
+  backoff.Reset();
+  EXPECT_FALSE(backoff.open());
+  EXPECT_LE(backoff.OnExit(30000, 10), 100);
+  EXPECT_GE(backoff.OnExit(30100, 10), 100);
+  // A stable run starts the delays over.
+  EXPECT_LE(backoff.OnExit(30200, 5000), 100);
+  EXPECT_EQ(backoff.attempt(), 1);
+  // Exits outside the window do not add up to a loop.
+  for (int64_t now = 50000; now < 100000; now += 11000) {
+    EXPECT_GE(backoff.OnExit(now, 10), 0);
+  }
+  EXPECT_FALSE(backoff.open());
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,67 @@
+#include "json_scanner.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test/profile_config.h"
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(JsonScanner, WalksProfileConfig) {
+  JsonScanner scanner(kProfileConfig);
+  std::string_view key;
+  std::vector<std::string> outbound_types;
+  std::string_view secret;
+  ASSERT_TRUE(scanner.EnterObject());
+  while (scanner.NextMember(&key)) {
+    if (key == "outbounds" && scanner.EnterArray()) {
+      while (scanner.NextElement() && scanner.EnterObject()) {
+        while (scanner.NextMember(&key)) {
+          std::string_view type;
+          if (key == "type" && scanner.ReadString(&type)) {
+            outbound_types.emplace_back(type);
+          } else if (key != "type") {
+            scanner.Skip();
+          }
+        }
+      }
+    } else if (key == "experimental") {
+      std::string_view span;
+      ASSERT_TRUE(scanner.SkipSpan(&span));
+      JsonScanner experimental(span);
+      ASSERT_TRUE(experimental.EnterObject());
+      while (experimental.NextMember(&key)) {
+        if (key == "clash_api" && experimental.EnterObject()) {
+          while (experimental.NextMember(&key)) {
+            key == "secret" ? experimental.ReadString(&secret) : experimental.Skip();
+          }
+        } else {
+          experimental.Skip();
+        }
+      }
+      EXPECT_TRUE(experimental.ok());
+    } else {
+      scanner.Skip();
+    }
+  }
+  EXPECT_TRUE(scanner.ok());
+  EXPECT_EQ(outbound_types,
+            (std::vector<std::string>{"selector", "urltest", "vmess", "direct"}));
+  // Strings come back still escaped.
+  EXPECT_EQ(secret, "s3cr\\\"et");
+  EXPECT_EQ(UnescapeJsonString(secret), "s3cr\"et");
+  EXPECT_EQ(UnescapeJsonString("caf\\u00e9 \\ud83d\\ude00"), "caf\xc3\xa9 \xf0\x9f\x98\x80");
+
+  JsonScanner truncated(R"({"inbounds": [{"listen_port": 7890)");
+  ASSERT_TRUE(truncated.EnterObject());
+  ASSERT_TRUE(truncated.NextMember(&key));
+  EXPECT_FALSE(truncated.Skip());
+  EXPECT_FALSE(truncated.ok());
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
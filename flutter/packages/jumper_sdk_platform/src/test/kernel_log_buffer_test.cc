@@ -0,0 +1,62 @@
+#include "kernel_log_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(KernelLogBuffer, CountsSampledAndOverwrittenLines) {
+  LogLineFramer framer(8);
+  std::vector<std::string> lines;
+  const auto on_line = [&lines](std::string line) { lines.push_back(std::move(line)); };
+  const std::string head = "one\r\ntw";
+  const std::string rest = "o\n\nthis line is long\ntail";
+  framer.Feed(head.data(), head.size(), on_line);
+  framer.Feed(rest.data(), rest.size(), on_line);
+  EXPECT_EQ(lines, (std::vector<std::string>{"one", "two", "this lin"}));
+  framer.Flush(on_line);
+  EXPECT_EQ(lines.back(), "tail");
+
+  // Six lines through four slots: the first two are overwritten before
+  // anyone took them.
+  KernelLogBuffer ring(4, 100, 1);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(ring.Append(KernelLogLevel::kInfo, "line " + std::to_string(i), 5000));
+  }
+  EXPECT_EQ(ring.next_seq(), 7u);
+  EXPECT_EQ(ring.dropped(), 2u);
+  std::vector<KernelLogLine> taken = ring.TakeUndelivered(10);
+  ASSERT_EQ(taken.size(), 4u);
+  EXPECT_EQ(taken.front().seq, 3u);
+  EXPECT_EQ(taken.front().message, "line 2");
+  EXPECT_EQ(taken.back().seq, 6u);
+  EXPECT_TRUE(ring.TakeUndelivered(10).empty());
+  ASSERT_EQ(ring.LinesSince(4, 10).size(), 2u);
+  EXPECT_EQ(ring.LinesSince(4, 10).front().seq, 5u);
+  ASSERT_EQ(ring.Tail(0, 1).size(), 1u);
+  EXPECT_EQ(ring.Tail(0, 1).front().seq, 6u);
+  // Delivered lines count as delivered once overwritten.
+  ring.Append(KernelLogLevel::kInfo, "line 6", 5000);
+  EXPECT_EQ(ring.dropped(), 2u);
+
+  // Past two lines a second, debug is kept 1 in 2; errors always are.
+  KernelLogBuffer sampled(16, 2, 2);
+  int kept = 0;
+  for (int i = 0; i < 6; ++i) {
+    kept += sampled.Append(KernelLogLevel::kDebug, "debug", 5000) ? 1 : 0;
+  }
+  EXPECT_EQ(kept, 4);
+  EXPECT_TRUE(sampled.Append(KernelLogLevel::kError, "error", 5000));
+  EXPECT_EQ(sampled.dropped(), 2u);
+  EXPECT_EQ(sampled.next_seq(), 6u);
+  // A new second starts a new budget.
+  EXPECT_TRUE(sampled.Append(KernelLogLevel::kDebug, "debug", 6000));
+  EXPECT_EQ(sampled.TakeUndelivered(16).back().seq, 6u);
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,36 @@
+#include "latency_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(LatencySnapshot, ValueAtQuantile) {
+  EXPECT_EQ(LatencySnapshot().ValueAtQuantile(0.5), 0u);
+
+  LatencyHistogram histogram;
+  for (int64_t value = 1; value <= 100; ++value) {
+    histogram.Record(value);
+  }
+  const LatencySnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 100u);
+  EXPECT_EQ(snapshot.max_ns, 100u);
+  // Values below 16 have buckets of their own.
+  EXPECT_EQ(snapshot.ValueAtQuantile(0.0), 1u);
+  EXPECT_EQ(snapshot.ValueAtQuantile(0.1), 10u);
+  // Above, a bucket is 1/16 of its power of two wide.
+  const uint64_t median = snapshot.ValueAtQuantile(0.5);
+  EXPECT_GE(median, 50u);
+  EXPECT_LE(median, 50u + 50u / 16);
+  const uint64_t p99 = snapshot.ValueAtQuantile(0.99);
+  EXPECT_GE(p99, 99u);
+  EXPECT_LE(p99, 100u);
+  // Never above the largest value recorded.
+  EXPECT_EQ(snapshot.ValueAtQuantile(1.0), 100u);
+  EXPECT_EQ(snapshot.ValueAtQuantile(2.0), 100u);
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
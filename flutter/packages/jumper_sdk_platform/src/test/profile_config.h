@@ -0,0 +1,35 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TEST_PROFILE_CONFIG_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TEST_PROFILE_CONFIG_H_
+
+namespace jumper_sdk_platform {
+namespace test {
+
+// A profile as the app writes it: tun and mixed inbounds, a selector over a
+// urltest group, and the Clash API with an escaped secret.
+inline constexpr char kProfileConfig[] = R"({
+  "log": {"level": "info", "output": "box.log", "timestamp": true},
+  "dns": {"servers": [{"tag": "remote", "address": "tls://8.8.8.8"}]},
+  "inbounds": [
+    {"type": "tun", "tag": "tun-in", "inet4_address": "172.19.0.1/30",
+     "auto_route": true, "strict_route": true, "stack": "system", "sniff": true},
+    {"type": "mixed", "tag": "mixed-in", "listen": "127.0.0.1", "listen_port": 7890}
+  ],
+  "outbounds": [
+    {"type": "selector", "tag": "proxy", "outbounds": ["auto", "direct"], "default": "auto"},
+    {"type": "urltest", "tag": "auto", "outbounds": ["hk-01"], "interval": "3m"},
+    {"type": "vmess", "tag": "hk-01", "server": "hk.example.com", "server_port": 443,
+     "uuid": "5c1f3e2a-9d4b-4a55-8f6e-0123456789ab", "security": "auto"},
+    {"type": "direct", "tag": "direct"}
+  ],
+  "route": {"rules": [{"domain_suffix": ["cn"], "outbound": "direct"}], "final": "proxy"},
+  "experimental": {
+    "cache_file": {"enabled": true},
+    "clash_api": {"external_controller": "127.0.0.1:9090", "secret": "s3cr\"et",
+                  "default_mode": "rule"}
+  }
+})";
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TEST_PROFILE_CONFIG_H_
@@ -0,0 +1,75 @@
+#include "sha256.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "sha256_internal.h"
+
+namespace jumper_sdk_platform {
+namespace test {
+
+namespace {
+
+// Pads |input| and runs it through |compress| alone, so each block function
+// is checked whichever one Sha256 picked on this machine.
+std::string DigestWith(sha256_internal::CompressFunction compress, const std::string& input) {
+  std::string message = input;
+  message.push_back('\x80');
+  message.append((120 - message.size() % 64) % 64, '\0');
+  const uint64_t bit_length = static_cast<uint64_t>(input.size()) * 8;
+  for (int i = 0; i < 8; ++i) {
+    message.push_back(static_cast<char>(bit_length >> (56 - i * 8)));
+  }
+  uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  compress(state, reinterpret_cast<const uint8_t*>(message.data()), message.size() / 64);
+
+  static const char kHex[] = "0123456789abcdef";
+  std::string hex;
+  for (uint32_t word : state) {
+    for (int nibble = 0; nibble < 8; ++nibble) {
+      hex.push_back(kHex[(word >> (28 - nibble * 4)) & 0xF]);
+    }
+  }
+  return hex;
+}
+
+}  // namespace
+
+TEST(Sha256, KnownAnswersOnBothPaths) {
+  const std::string million(1000000, 'a');
+  const struct {
+    std::string input;
+    const char* digest;
+  } vectors[] = {
+      {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+      {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+      {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+       "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+      {million, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+  };
+  const sha256_internal::CompressFunction hardware = sha256_internal::HardwareCompress();
+  EXPECT_EQ(hardware != nullptr, Sha256::HasHardwareSupport());
+  for (const auto& vector : vectors) {
+    // The selected path, in one call and in uneven pieces that straddle
+    // blocks.
+    EXPECT_EQ(Sha256Hex(vector.input), vector.digest);
+    Sha256 pieces;
+    for (size_t offset = 0; offset < vector.input.size(); offset += 37) {
+      pieces.Update(vector.input.data() + offset,
+                    std::min<size_t>(37, vector.input.size() - offset));
+    }
+    EXPECT_EQ(pieces.FinishHex(), vector.digest);
+
+    EXPECT_EQ(DigestWith(sha256_internal::CompressPortable, vector.input), vector.digest);
+    if (hardware != nullptr) {
+      EXPECT_EQ(DigestWith(hardware, vector.input), vector.digest);
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,43 @@
+#include "trace_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(TraceRecorder, FormatsChromeTrace) {
+  TraceRecorder recorder(2);
+  recorder.Instant("ignored", "core");
+  EXPECT_TRUE(recorder.Events().empty());
+
+  recorder.SetEnabled(true);
+  recorder.Instant("overwritten", "core");
+  recorder.Complete("startCore", "queue", 1000, 3500);
+  recorder.Instant(std::string(60, 'n'), "core");
+  EXPECT_EQ(recorder.dropped(), 1u);
+  const std::vector<TraceEvent> events = recorder.Events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, 'X');
+  EXPECT_EQ(std::string(events[1].name), std::string(TraceEvent::kMaxNameBytes, 'n'));
+
+  const std::string json = FormatChromeTrace(events, 42, "jumper \"core\"");
+  JsonScanner scanner(json);
+  EXPECT_TRUE(scanner.Skip());
+  EXPECT_TRUE(scanner.ok());
+  EXPECT_NE(
+      json.find(R"("name":"process_name","pid":42,"tid":0,"args":{"name":"jumper \"core\""})"),
+      std::string::npos);
+  EXPECT_NE(json.find(R"({"ph":"X","cat":"queue","name":"startCore","ts":1.000,"pid":42)"),
+            std::string::npos);
+  EXPECT_NE(json.find(R"("dur":2.500})"), std::string::npos);
+  EXPECT_NE(json.find(R"("s":"t"})"), std::string::npos);
+  EXPECT_EQ(json.back(), '\n');
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
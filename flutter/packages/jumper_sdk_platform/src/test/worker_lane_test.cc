@@ -0,0 +1,54 @@
+#include "worker_lane.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jumper_sdk_platform {
+namespace test {
+
+TEST(WorkerLane, RunsQueuedTasksBeforeShuttingDown) {
+  // One thread runs its tasks in submission order.
+  WorkerLane serial(1);
+  std::mutex mutex;
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i) {
+    serial.Post([&mutex, &order, i]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    });
+  }
+  serial.Shutdown();
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+  // A second shutdown, as the destructor does, is harmless.
+  serial.Shutdown();
+
+  // Several threads drain one queue; a slow task does not hold up the rest.
+  WorkerLane pool(4);
+  std::atomic<int> done{0};
+  std::atomic<bool> release{false};
+  pool.Post([&release, &done]() {
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+    done.fetch_add(1);
+  });
+  for (int i = 0; i < 50; ++i) {
+    pool.Post([&done]() { done.fetch_add(1); });
+  }
+  while (done.load() < 50) {
+    std::this_thread::yield();
+  }
+  release = true;
+  pool.Shutdown();
+  EXPECT_EQ(done.load(), 51);
+}
+
+}  // namespace test
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,1161 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core_config.h"
+#include "json_scanner.h"
+
+// A stand-in for sing-box that takes the same command line and serves the
+// Clash API endpoints the plugins use, with none of the proxying. It makes
+// a core's bad days reproducible on any Linux box: slow starts, stalled
+// API calls, log floods, thousands of connections, crashes.
+//
+//   fake-sing-box run [--disable-color] -c config.json [-D dir]
+//   fake-sing-box check -c config.json
+//   fake-sing-box version
+//
+// `run` reads `experimental.clash_api`, the inbounds, the outbounds and
+// `log` from the config, binds every inbound `listen_port`, and answers
+// /version, /proxies, /connections, /traffic, /memory, /logs and /configs
+// on the controller. SIGHUP reloads the config as sing-box does: the API
+// goes away and comes back. SIGTERM and SIGINT stop it.
+//
+// Behaviour is set through the environment, which launch options can pass:
+//
+//   FAKE_SING_BOX_STARTUP_DELAY_MS     before the API listens, and on reload
+//   FAKE_SING_BOX_LATENCY_MS           added to every API response
+//   FAKE_SING_BOX_STALL_EVERY          every Nth API request also waits
+//   FAKE_SING_BOX_STALL_MS               this long
+//   FAKE_SING_BOX_LOG_RATE             log lines per second (default 1)
+//   FAKE_SING_BOX_CONNECTIONS          live connections (default 16)
+//   FAKE_SING_BOX_CHURN_PERCENT        of them replaced each second (default 10)
+//   FAKE_SING_BOX_EXIT_AFTER_MS        exits on its own once ready for this long
+//   FAKE_SING_BOX_EXIT_AFTER_REQUESTS  dies on the Nth API request, unanswered
+//   FAKE_SING_BOX_EXIT_CODE            for those exits (default 1)
+//   FAKE_SING_BOX_EXIT_SIGNAL          dies by this signal instead, e.g. 11
+//   FAKE_SING_BOX_STOP_DELAY_MS        taken to exit after SIGTERM
+//   FAKE_SING_BOX_IGNORE_SIGTERM       set to 1 to only die by SIGKILL
+
+namespace {
+
+using jumper_sdk_platform::JsonScanner;
+using jumper_sdk_platform::JsonType;
+using jumper_sdk_platform::QuoteJsonString;
+using jumper_sdk_platform::UnescapeJsonString;
+
+constexpr char kVersion[] = "1.12.22-fake";
+constexpr size_t kMaxRequestBytes = 64 * 1024;
+constexpr size_t kLogBacklog = 4096;
+
+int64_t EnvInteger(const char* name, int64_t fallback) {
+  const char* value = std::getenv(name);
+  if (value == nullptr || *value == '\0') {
+    return fallback;
+  }
+  char* end = nullptr;
+  const long long parsed = std::strtoll(value, &end, 10);
+  return end != nullptr && *end == '\0' ? parsed : fallback;
+}
+
+struct Knobs {
+  int64_t startup_delay_ms = 0;
+  int64_t latency_ms = 0;
+  int64_t stall_every = 0;
+  int64_t stall_ms = 0;
+  int64_t log_rate = 1;
+  int64_t connections = 16;
+  int64_t churn_percent = 10;
+  int64_t exit_after_ms = 0;
+  int64_t exit_after_requests = 0;
+  int64_t exit_code = 1;
+  int64_t exit_signal = 0;
+  int64_t stop_delay_ms = 0;
+  bool ignore_sigterm = false;
+
+  static Knobs FromEnvironment() {
+    Knobs knobs;
+    knobs.startup_delay_ms = EnvInteger("FAKE_SING_BOX_STARTUP_DELAY_MS", 0);
+    knobs.latency_ms = EnvInteger("FAKE_SING_BOX_LATENCY_MS", 0);
+    knobs.stall_every = EnvInteger("FAKE_SING_BOX_STALL_EVERY", 0);
+    knobs.stall_ms = EnvInteger("FAKE_SING_BOX_STALL_MS", 0);
+    knobs.log_rate = EnvInteger("FAKE_SING_BOX_LOG_RATE", 1);
+    knobs.connections = EnvInteger("FAKE_SING_BOX_CONNECTIONS", 16);
+    knobs.churn_percent = EnvInteger("FAKE_SING_BOX_CHURN_PERCENT", 10);
+    knobs.exit_after_ms = EnvInteger("FAKE_SING_BOX_EXIT_AFTER_MS", 0);
+    knobs.exit_after_requests = EnvInteger("FAKE_SING_BOX_EXIT_AFTER_REQUESTS", 0);
+    knobs.exit_code = EnvInteger("FAKE_SING_BOX_EXIT_CODE", 1);
+    knobs.exit_signal = EnvInteger("FAKE_SING_BOX_EXIT_SIGNAL", 0);
+    knobs.stop_delay_ms = EnvInteger("FAKE_SING_BOX_STOP_DELAY_MS", 0);
+    knobs.ignore_sigterm = EnvInteger("FAKE_SING_BOX_IGNORE_SIGTERM", 0) != 0;
+    return knobs;
+  }
+};
+
+void SleepMilliseconds(int64_t milliseconds) {
+  if (milliseconds > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  }
+}
+
+struct Outbound {
+  std::string type;
+  std::string tag;
+  // Selector and urltest members.
+  std::vector<std::string> members;
+  std::string now;
+};
+
+struct LoadedConfig {
+  jumper_sdk_platform::CoreConfig core;
+  std::vector<Outbound> outbounds;
+  std::string mode = "rule";
+  std::string log_level = "info";
+  bool log_disabled = false;
+  bool log_timestamp = true;
+};
+
+std::string ReadString(JsonScanner* scanner) {
+  std::string_view raw;
+  return scanner->ReadString(&raw) ? UnescapeJsonString(raw) : std::string();
+}
+
+void ScanOutbound(JsonScanner* scanner, Outbound* outbound) {
+  std::string_view key;
+  while (scanner->NextMember(&key)) {
+    if (key == "type") {
+      outbound->type = ReadString(scanner);
+    } else if (key == "tag") {
+      outbound->tag = ReadString(scanner);
+    } else if (key == "default") {
+      outbound->now = ReadString(scanner);
+    } else if (key == "outbounds" && scanner->EnterArray()) {
+      while (scanner->NextElement()) {
+        outbound->members.push_back(ReadString(scanner));
+      }
+    } else {
+      scanner->Skip();
+    }
+  }
+}
+
+// What CoreConfig leaves out: outbounds, the clash mode and `log`.
+bool ScanExtras(std::string_view content, LoadedConfig* config, std::string* error) {
+  JsonScanner scanner(content);
+  std::string_view key;
+  if (!scanner.EnterObject()) {
+    *error = "Config is not a JSON object";
+    return false;
+  }
+  while (scanner.NextMember(&key)) {
+    if (key == "outbounds" && scanner.EnterArray()) {
+      while (scanner.NextElement()) {
+        if (scanner.Peek() != JsonType::kObject || !scanner.EnterObject()) {
+          scanner.Skip();
+          continue;
+        }
+        Outbound outbound;
+        ScanOutbound(&scanner, &outbound);
+        if (!outbound.members.empty() && outbound.now.empty()) {
+          outbound.now = outbound.members.front();
+        }
+        config->outbounds.push_back(std::move(outbound));
+      }
+    } else if (key == "log" && scanner.EnterObject()) {
+      std::string_view member;
+      while (scanner.NextMember(&member)) {
+        if (member == "level") {
+          config->log_level = ReadString(&scanner);
+        } else if (member == "disabled") {
+          scanner.ReadBool(&config->log_disabled);
+        } else if (member == "timestamp") {
+          scanner.ReadBool(&config->log_timestamp);
+        } else {
+          scanner.Skip();
+        }
+      }
+    } else if (key == "experimental" && scanner.EnterObject()) {
+      std::string_view member;
+      while (scanner.NextMember(&member)) {
+        if (member != "clash_api" || !scanner.EnterObject()) {
+          scanner.Skip();
+          continue;
+        }
+        std::string_view field;
+        while (scanner.NextMember(&field)) {
+          if (field == "default_mode") {
+            config->mode = ReadString(&scanner);
+          } else {
+            scanner.Skip();
+          }
+        }
+      }
+    } else {
+      scanner.Skip();
+    }
+  }
+  if (!scanner.ok()) {
+    *error = "Malformed JSON near offset " + std::to_string(scanner.offset());
+    return false;
+  }
+  std::transform(config->mode.begin(), config->mode.end(), config->mode.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return true;
+}
+
+bool LoadConfig(const std::string& path, LoadedConfig* config, std::string* error) {
+  jumper_sdk_platform::MappedFile file;
+  if (!file.Open(path, error)) {
+    return false;
+  }
+  *config = LoadedConfig();
+  return jumper_sdk_platform::ScanCoreConfig(file.view(), &config->core, error) &&
+         ScanExtras(file.view(), config, error);
+}
+
+// The first config a command line names: the first `-c`, or the first
+// JSON file in the first `-C` directory.
+std::string ConfigPathFrom(const std::vector<std::string>& configs,
+                           const std::vector<std::string>& config_directories) {
+  if (!configs.empty()) {
+    return configs.front();
+  }
+  if (config_directories.empty()) {
+    return "config.json";
+  }
+  std::vector<std::string> found;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(config_directories.front(), ec)) {
+    if (entry.path().extension() == ".json") {
+      found.push_back(entry.path().string());
+    }
+  }
+  std::sort(found.begin(), found.end());
+  return found.empty() ? std::string() : found.front();
+}
+
+// Log lines, as sing-box prints them, fanned out to the log output and to
+// /logs listeners. Listeners read from a bounded backlog by sequence
+// number, so a slow one misses lines rather than holding anyone up.
+class LogBus {
+ public:
+  void Open(const LoadedConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (output_ != nullptr && output_ != stderr) {
+      std::fclose(output_);
+    }
+    output_ = nullptr;
+    if (!config.log_disabled) {
+      output_ = config.core.log_output.empty()
+                    ? stderr
+                    : std::fopen(config.core.log_output.c_str(), "a");
+    }
+    timestamp_ = config.log_timestamp;
+    quiet_ = config.log_level == "warn" || config.log_level == "error" ||
+             config.log_level == "fatal" || config.log_level == "panic";
+  }
+
+  void Add(const char* level, const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AddLocked(level, message);
+    Flush();
+  }
+
+  // For floods: takes the lock and flushes once for the whole batch.
+  template <typename Generate>
+  void AddBatch(int64_t count, Generate generate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int64_t i = 0; i < count; ++i) {
+      AddLocked("info", generate());
+    }
+    Flush();
+  }
+
+  // Waits up to |timeout| for lines after |*cursor| and returns them as
+  // Clash API log objects, one per line.
+  std::string Wait(uint64_t* cursor, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    added_.wait_for(lock, timeout, [&] { return next_ > *cursor; });
+    std::string lines;
+    const uint64_t first = next_ - backlog_.size();
+    for (uint64_t seq = std::max(*cursor, first); seq < next_; ++seq) {
+      lines += backlog_[static_cast<size_t>(seq - first)];
+    }
+    *cursor = next_;
+    return lines;
+  }
+
+  uint64_t next() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_;
+  }
+
+  void Wake() { added_.notify_all(); }
+
+ private:
+  void AddLocked(const char* level, const std::string& message) {
+    const bool info = std::strcmp(level, "info") == 0;
+    if (output_ != nullptr && !(info && quiet_)) {
+      std::string upper(level);
+      std::transform(upper.begin(), upper.end(), upper.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+      if (timestamp_) {
+        char stamp[64];
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        localtime_r(&now, &local);
+        std::strftime(stamp, sizeof(stamp), "%z %Y-%m-%d %H:%M:%S", &local);
+        std::fprintf(output_, "%s %s %s\n", stamp, upper.c_str(), message.c_str());
+      } else {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::steady_clock::now() - started_at_)
+                                 .count();
+        std::fprintf(output_, "%s[%04lld] %s\n", upper.c_str(),
+                     static_cast<long long>(elapsed), message.c_str());
+      }
+    }
+    backlog_.push_back("{\"type\":" + QuoteJsonString(level) +
+                       ",\"payload\":" + QuoteJsonString(message) + "}\n");
+    if (backlog_.size() > kLogBacklog) {
+      backlog_.pop_front();
+    }
+    ++next_;
+  }
+
+  void Flush() {
+    if (output_ != nullptr) {
+      std::fflush(output_);
+    }
+    added_.notify_all();
+  }
+
+  std::mutex mutex_;
+  std::condition_variable added_;
+  FILE* output_ = stderr;
+  bool timestamp_ = true;
+  bool quiet_ = false;
+  std::deque<std::string> backlog_;
+  uint64_t next_ = 0;
+  const std::chrono::steady_clock::time_point started_at_ = std::chrono::steady_clock::now();
+};
+
+struct FakeConnection {
+  std::string id;
+  std::string host;
+  std::string network;
+  uint16_t source_port = 0;
+  uint16_t destination_port = 0;
+  std::string chain;
+  std::string start;
+  int64_t upload = 0;
+  int64_t download = 0;
+  int64_t upload_rate = 0;
+  int64_t download_rate = 0;
+};
+
+std::string Rfc3339Now() {
+  char stamp[32];
+  const std::time_t now = std::time(nullptr);
+  std::tm utc{};
+  gmtime_r(&now, &utc);
+  std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return stamp;
+}
+
+std::string ConnectionJson(const FakeConnection& connection) {
+  return "{\"id\":" + QuoteJsonString(connection.id) +
+         ",\"metadata\":{\"network\":" + QuoteJsonString(connection.network) +
+         ",\"type\":\"mixed/mixed-in\",\"sourceIP\":\"127.0.0.1\",\"destinationIP\":\"\","
+         "\"sourcePort\":\"" + std::to_string(connection.source_port) +
+         "\",\"destinationPort\":\"" + std::to_string(connection.destination_port) +
+         "\",\"host\":" + QuoteJsonString(connection.host) +
+         ",\"dnsMode\":\"normal\",\"processPath\":\"\"},\"upload\":" +
+         std::to_string(connection.upload) + ",\"download\":" +
+         std::to_string(connection.download) + ",\"start\":" + QuoteJsonString(connection.start) +
+         ",\"chains\":[" + QuoteJsonString(connection.chain) +
+         "],\"rule\":\"final\",\"rulePayload\":\"\"}";
+}
+
+// The Clash API's proxy type names for sing-box outbound types.
+std::string ClashProxyType(const std::string& type) {
+  static const std::map<std::string, std::string> kTypes = {
+      {"block", "Reject"},        {"direct", "Direct"},       {"dns", "Dns"},
+      {"http", "HTTP"},           {"hysteria", "Hysteria"},   {"hysteria2", "Hysteria2"},
+      {"selector", "Selector"},   {"shadowsocks", "Shadowsocks"}, {"socks", "Socks"},
+      {"ssh", "SSH"},             {"trojan", "Trojan"},       {"tuic", "TUIC"},
+      {"urltest", "URLTest"},     {"vless", "VLESS"},         {"vmess", "VMess"},
+      {"wireguard", "WireGuard"},
+  };
+  const auto found = kTypes.find(type);
+  return found == kTypes.end() ? type : found->second;
+}
+
+std::string ProxyJson(const Outbound& outbound) {
+  std::string json = "{\"type\":" + QuoteJsonString(ClashProxyType(outbound.type)) +
+                     ",\"name\":" + QuoteJsonString(outbound.tag) +
+                     ",\"udp\":true,\"history\":[]";
+  if (!outbound.members.empty()) {
+    json += ",\"now\":" + QuoteJsonString(outbound.now) + ",\"all\":[";
+    for (size_t i = 0; i < outbound.members.size(); ++i) {
+      json += (i > 0 ? "," : "") + QuoteJsonString(outbound.members[i]);
+    }
+    json += "]";
+  }
+  return json + "}";
+}
+
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::string query;
+  std::string authorization;
+  std::string body;
+};
+
+std::string QueryValue(const std::string& query, const std::string& name) {
+  size_t start = 0;
+  while (start < query.size()) {
+    size_t end = query.find('&', start);
+    if (end == std::string::npos) {
+      end = query.size();
+    }
+    const std::string pair = query.substr(start, end - start);
+    if (pair.compare(0, name.size() + 1, name + "=") == 0) {
+      return pair.substr(name.size() + 1);
+    }
+    start = end + 1;
+  }
+  return std::string();
+}
+
+std::string DecodePathSegment(const std::string& segment) {
+  std::string decoded;
+  for (size_t i = 0; i < segment.size(); ++i) {
+    if (segment[i] == '%' && i + 2 < segment.size()) {
+      decoded += static_cast<char>(std::strtol(segment.substr(i + 1, 2).c_str(), nullptr, 16));
+      i += 2;
+    } else {
+      decoded += segment[i];
+    }
+  }
+  return decoded;
+}
+
+bool ReadRequest(int fd, HttpRequest* request) {
+  std::string raw;
+  char buffer[4096];
+  size_t header_end = std::string::npos;
+  while ((header_end = raw.find("\r\n\r\n")) == std::string::npos) {
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0 || raw.size() > kMaxRequestBytes) {
+      return false;
+    }
+    raw.append(buffer, static_cast<size_t>(received));
+  }
+  const size_t line_end = raw.find("\r\n");
+  const std::string line = raw.substr(0, line_end);
+  const size_t method_end = line.find(' ');
+  const size_t target_end = line.find(' ', method_end + 1);
+  if (method_end == std::string::npos || target_end == std::string::npos) {
+    return false;
+  }
+  request->method = line.substr(0, method_end);
+  const std::string target = line.substr(method_end + 1, target_end - method_end - 1);
+  const size_t query_start = target.find('?');
+  request->path = target.substr(0, query_start);
+  request->query = query_start == std::string::npos ? "" : target.substr(query_start + 1);
+
+  size_t content_length = 0;
+  size_t offset = line_end + 2;
+  while (offset < header_end) {
+    const size_t end = raw.find("\r\n", offset);
+    const std::string header = raw.substr(offset, end - offset);
+    offset = end + 2;
+    const size_t colon = header.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string name = header.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const size_t value_start = header.find_first_not_of(' ', colon + 1);
+    const std::string value = value_start == std::string::npos ? "" : header.substr(value_start);
+    if (name == "authorization") {
+      request->authorization = value;
+    } else if (name == "content-length") {
+      content_length = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+    }
+  }
+  request->body = raw.substr(header_end + 4);
+  while (request->body.size() < content_length && content_length <= kMaxRequestBytes) {
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      return false;
+    }
+    request->body.append(buffer, static_cast<size_t>(received));
+  }
+  return true;
+}
+
+bool SendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (written <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(written);
+  }
+  return true;
+}
+
+const char* StatusText(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 204:
+      return "No Content";
+    case 400:
+      return "Bad Request";
+    case 401:
+      return "Unauthorized";
+    case 404:
+      return "Not Found";
+    default:
+      return "Error";
+  }
+}
+
+void SendResponse(int fd, int status, const std::string& body) {
+  std::string response = "HTTP/1.1 " + std::to_string(status) + " " + StatusText(status) +
+                         "\r\nContent-Type: application/json\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+  SendAll(fd, response + body);
+}
+
+bool SendChunk(int fd, const std::string& data) {
+  char size[32];
+  std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+  return SendAll(fd, size + data + "\r\n");
+}
+
+int Listen(const std::string& host, uint16_t port, std::string* error) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.empty() ? "127.0.0.1" : host.c_str(), &address.sin_addr) != 1) {
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+  const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  const int reuse = 1;
+  if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+      bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(fd, 128) != 0) {
+    *error = "listen " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return -1;
+  }
+  return fd;
+}
+
+[[noreturn]] void Die(const Knobs& knobs, LogBus* logs, const std::string& reason) {
+  logs->Add("fatal", reason);
+  if (knobs.exit_signal > 0) {
+    signal(static_cast<int>(knobs.exit_signal), SIG_DFL);
+    sigset_t unblock;
+    sigemptyset(&unblock);
+    sigaddset(&unblock, static_cast<int>(knobs.exit_signal));
+    pthread_sigmask(SIG_UNBLOCK, &unblock, nullptr);
+    raise(static_cast<int>(knobs.exit_signal));
+  }
+  std::_Exit(static_cast<int>(knobs.exit_code));
+}
+
+// One running instance: the inbound sockets, the Clash API and the state it
+// reports. Lives until the process exits; API threads are detached.
+class FakeCore {
+ public:
+  FakeCore(Knobs knobs, std::string config_path)
+      : knobs_(knobs), config_path_(std::move(config_path)), random_(getpid()) {}
+
+  bool Start(std::string* error) {
+    LoadedConfig config;
+    if (!LoadConfig(config_path_, &config, error)) {
+      return false;
+    }
+    logs_.Open(config);
+    logs_.Add("info", "fake-sing-box " + std::string(kVersion) + ": starting");
+    SleepMilliseconds(knobs_.startup_delay_ms);
+    std::vector<int> inbounds;
+    for (const uint16_t port : config.core.listen_ports) {
+      if (config.core.has_controller && port == config.core.controller.port) {
+        continue;
+      }
+      const int fd = Listen("127.0.0.1", port, error);
+      if (fd < 0) {
+        for (const int open : inbounds) {
+          close(open);
+        }
+        return false;
+      }
+      inbounds.push_back(fd);
+      logs_.Add("info", "inbound/mixed: tcp server started at 127.0.0.1:" + std::to_string(port));
+    }
+    int api = -1;
+    if (config.core.has_controller) {
+      api = Listen(config.core.controller.host, config.core.controller.port, error);
+      if (api < 0) {
+        for (const int open : inbounds) {
+          close(open);
+        }
+        return false;
+      }
+      logs_.Add("info", "clash-api: restful api listening at " + config.core.controller.host +
+                            ":" + std::to_string(config.core.controller.port));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Selections made through the API survive a reload, as sing-box
+      // keeps them in its cache file.
+      for (Outbound& outbound : config.outbounds) {
+        const auto chosen = selections_.find(outbound.tag);
+        if (chosen != selections_.end() &&
+            std::find(outbound.members.begin(), outbound.members.end(), chosen->second) !=
+                outbound.members.end()) {
+          outbound.now = chosen->second;
+        }
+      }
+      config_ = std::move(config);
+      inbound_fds_ = std::move(inbounds);
+      api_fd_ = api;
+      ready_at_ = std::chrono::steady_clock::now();
+      while (connections_.size() < static_cast<size_t>(std::max<int64_t>(knobs_.connections, 0))) {
+        connections_.push_back(NewConnection());
+      }
+    }
+    if (api >= 0) {
+      std::thread([this, api] { Accept(api); }).detach();
+    }
+    logs_.Add("info", "sing-box started");
+    return true;
+  }
+
+  // Closes the API and every stream on it, and releases the inbounds.
+  void StopServing() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (api_fd_ >= 0) {
+      shutdown(api_fd_, SHUT_RDWR);
+      close(api_fd_);
+      api_fd_ = -1;
+    }
+    for (const int fd : clients_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+    for (const int fd : inbound_fds_) {
+      close(fd);
+    }
+    inbound_fds_.clear();
+    ++generation_;
+    logs_.Wake();
+  }
+
+  void Reload() {
+    logs_.Add("info", "received SIGHUP, reloading");
+    StopServing();
+    std::string error;
+    if (!Start(&error)) {
+      Die(knobs_, &logs_, "reload: " + error);
+    }
+  }
+
+  // Called every 100 ms: moves bytes on every connection once a second,
+  // replaces some of them, and writes the log lines due.
+  void Tick() {
+    const auto now = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (now - last_second_ >= std::chrono::seconds(1)) {
+        last_second_ = now;
+        AdvanceConnections();
+      }
+      if (knobs_.exit_after_ms > 0 && api_fd_ >= 0 &&
+          now - ready_at_ >= std::chrono::milliseconds(knobs_.exit_after_ms)) {
+        Die(knobs_, &logs_, "exiting after " + std::to_string(knobs_.exit_after_ms) + "ms");
+      }
+    }
+    const double elapsed_s = std::chrono::duration<double>(now - log_started_at_).count();
+    const int64_t due = static_cast<int64_t>(elapsed_s * static_cast<double>(knobs_.log_rate));
+    if (due > logged_) {
+      logs_.AddBatch(due - logged_, [this] { return NextTrafficLog(); });
+      logged_ = due;
+    }
+  }
+
+  const Knobs& knobs() const { return knobs_; }
+  LogBus* logs() { return &logs_; }
+
+ private:
+  FakeConnection NewConnection() {
+    static const char* const kHosts[] = {"www.example.com", "cdn.example.net",
+                                         "api.example.org", "video.example.com",
+                                         "updates.example.io"};
+    std::uniform_int_distribution<int> host(0, 4);
+    std::uniform_int_distribution<int> rate(0, 256 * 1024);
+    FakeConnection connection;
+    char id[40];
+    std::snprintf(id, sizeof(id), "%08x-%04x-4%03x-8%03x-%012llx",
+                  static_cast<unsigned>(random_()), static_cast<unsigned>(random_() & 0xffff),
+                  static_cast<unsigned>(random_() & 0xfff),
+                  static_cast<unsigned>(random_() & 0xfff),
+                  static_cast<unsigned long long>(next_connection_++));
+    connection.id = id;
+    connection.host = kHosts[host(random_)];
+    connection.network = random_() % 8 == 0 ? "udp" : "tcp";
+    connection.source_port = static_cast<uint16_t>(40000 + random_() % 20000);
+    connection.destination_port = 443;
+    connection.chain = "direct";
+    for (const Outbound& outbound : config_.outbounds) {
+      if (!outbound.members.empty()) {
+        connection.chain = outbound.now;
+        break;
+      }
+    }
+    connection.start = Rfc3339Now();
+    connection.upload_rate = rate(random_) / 8;
+    connection.download_rate = rate(random_);
+    return connection;
+  }
+
+  // Requires |mutex_|.
+  void AdvanceConnections() {
+    for (FakeConnection& connection : connections_) {
+      connection.upload += connection.upload_rate;
+      connection.download += connection.download_rate;
+      upload_total_ += connection.upload_rate;
+      download_total_ += connection.download_rate;
+    }
+    const size_t target = static_cast<size_t>(std::max<int64_t>(knobs_.connections, 0));
+    size_t churn = connections_.size() * static_cast<size_t>(knobs_.churn_percent) / 100;
+    while (churn-- > 0 && !connections_.empty()) {
+      connections_.erase(connections_.begin() +
+                         static_cast<std::ptrdiff_t>(random_() % connections_.size()));
+    }
+    while (connections_.size() < target) {
+      connections_.push_back(NewConnection());
+    }
+  }
+
+  std::string NextTrafficLog() {
+    const uint64_t n = log_counter_++;
+    return "[" + std::to_string(1000000000ull + n) + " 0ms] inbound/mixed[mixed-in]: " +
+           "inbound connection from 127.0.0.1:" + std::to_string(40000 + n % 20000) +
+           " to updates.example.io:443";
+  }
+
+  void Accept(int api) {
+    for (;;) {
+      const int client = accept4(api, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      const timeval timeout{5, 0};
+      setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (api_fd_ != api) {
+          close(client);
+          return;
+        }
+        clients_.insert(client);
+      }
+      std::thread([this, client] {
+        Serve(client);
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.erase(client);
+        close(client);
+      }).detach();
+    }
+  }
+
+  void Serve(int fd) {
+    HttpRequest request;
+    if (!ReadRequest(fd, &request)) {
+      return;
+    }
+    const uint64_t count = ++requests_;
+    if (knobs_.exit_after_requests > 0 &&
+        count >= static_cast<uint64_t>(knobs_.exit_after_requests)) {
+      Die(knobs_, &logs_, "crashing on request " + std::to_string(count) + ": " +
+                              request.method + " " + request.path);
+    }
+    SleepMilliseconds(knobs_.latency_ms);
+    if (knobs_.stall_every > 0 && count % static_cast<uint64_t>(knobs_.stall_every) == 0) {
+      SleepMilliseconds(knobs_.stall_ms);
+    }
+    std::string secret;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      secret = config_.core.controller.secret;
+    }
+    if (!secret.empty() && request.authorization != "Bearer " + secret &&
+        QueryValue(request.query, "token") != secret) {
+      SendResponse(fd, 401, "{\"message\":\"Unauthorized\"}");
+      return;
+    }
+    if (request.method == "GET" &&
+        (request.path == "/traffic" || request.path == "/memory" || request.path == "/logs")) {
+      Stream(fd, request);
+      return;
+    }
+    std::string body;
+    const int status = Handle(request, &body);
+    SendResponse(fd, status, body);
+  }
+
+  int Handle(const HttpRequest& request, std::string* body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string& path = request.path;
+    const std::string& method = request.method;
+    if (method == "GET" && (path == "/" || path == "/version")) {
+      *body = path == "/" ? "{\"hello\":\"clash\"}"
+                          : "{\"meta\":true,\"premium\":true,\"version\":\"sing-box " +
+                                std::string(kVersion) + "\"}";
+      return 200;
+    }
+    if (path == "/configs") {
+      if (method == "GET") {
+        uint16_t mixed_port = 0;
+        for (const uint16_t port : config_.core.listen_ports) {
+          if (!config_.core.has_controller || port != config_.core.controller.port) {
+            mixed_port = port;
+            break;
+          }
+        }
+        *body = "{\"port\":0,\"socks-port\":0,\"redir-port\":0,\"tproxy-port\":0,"
+                "\"mixed-port\":" + std::to_string(mixed_port) +
+                ",\"allow-lan\":false,\"bind-address\":\"*\",\"mode\":" +
+                QuoteJsonString(config_.mode) +
+                ",\"mode-list\":[\"rule\",\"global\",\"direct\"],\"log-level\":" +
+                QuoteJsonString(config_.log_level) + ",\"ipv6\":false,\"tun\":null}";
+        return 200;
+      }
+      if (method == "PATCH") {
+        JsonScanner scanner(request.body);
+        std::string_view key;
+        if (scanner.EnterObject()) {
+          while (scanner.NextMember(&key)) {
+            if (key == "mode") {
+              config_.mode = ReadString(&scanner);
+            } else {
+              scanner.Skip();
+            }
+          }
+        }
+        std::transform(config_.mode.begin(), config_.mode.end(), config_.mode.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return 204;
+      }
+      if (method == "PUT") {
+        return 204;
+      }
+    }
+    if (path == "/proxies" && method == "GET") {
+      *body = "{\"proxies\":{";
+      bool has_global = false;
+      for (size_t i = 0; i < config_.outbounds.size(); ++i) {
+        const Outbound& outbound = config_.outbounds[i];
+        has_global = has_global || outbound.tag == "GLOBAL";
+        *body += (i > 0 ? "," : "") + QuoteJsonString(outbound.tag) + ":" + ProxyJson(outbound);
+      }
+      // sing-box adds a GLOBAL selector over every outbound unless the
+      // config has one.
+      if (!has_global) {
+        Outbound global;
+        global.type = "selector";
+        global.tag = "GLOBAL";
+        for (const Outbound& outbound : config_.outbounds) {
+          global.members.push_back(outbound.tag);
+        }
+        global.now = global.members.empty() ? "" : global.members.front();
+        *body += (config_.outbounds.empty() ? "\"GLOBAL\":" : ",\"GLOBAL\":") + ProxyJson(global);
+      }
+      *body += "}}";
+      return 200;
+    }
+    if (path.compare(0, 9, "/proxies/") == 0) {
+      std::string name = path.substr(9);
+      const bool delay = name.size() > 6 && name.compare(name.size() - 6, 6, "/delay") == 0;
+      if (delay) {
+        name.resize(name.size() - 6);
+      }
+      name = DecodePathSegment(name);
+      const auto outbound =
+          std::find_if(config_.outbounds.begin(), config_.outbounds.end(),
+                       [&name](const Outbound& candidate) { return candidate.tag == name; });
+      if (outbound == config_.outbounds.end()) {
+        *body = "{\"message\":\"Resource not found\"}";
+        return 404;
+      }
+      if (method == "GET") {
+        *body = delay ? "{\"delay\":" + std::to_string(std::max<int64_t>(knobs_.latency_ms, 1)) +
+                            "}"
+                      : ProxyJson(*outbound);
+        return 200;
+      }
+      if (method == "PUT" && !delay) {
+        if (outbound->type != "selector") {
+          *body = "{\"message\":\"Must be a Selector\"}";
+          return 400;
+        }
+        JsonScanner scanner(request.body);
+        std::string_view key;
+        std::string chosen;
+        if (scanner.EnterObject()) {
+          while (scanner.NextMember(&key)) {
+            if (key == "name") {
+              chosen = ReadString(&scanner);
+            } else {
+              scanner.Skip();
+            }
+          }
+        }
+        if (std::find(outbound->members.begin(), outbound->members.end(), chosen) ==
+            outbound->members.end()) {
+          *body = "{\"message\":\"Selector update error: not found\"}";
+          return 400;
+        }
+        outbound->now = chosen;
+        selections_[outbound->tag] = chosen;
+        return 204;
+      }
+    }
+    if (path == "/connections") {
+      if (method == "GET") {
+        *body = "{\"downloadTotal\":" + std::to_string(download_total_) +
+                ",\"uploadTotal\":" + std::to_string(upload_total_) + ",\"connections\":[";
+        for (size_t i = 0; i < connections_.size(); ++i) {
+          *body += (i > 0 ? "," : "") + ConnectionJson(connections_[i]);
+        }
+        *body += "],\"memory\":" + std::to_string(MemoryInUse()) + "}";
+        return 200;
+      }
+      if (method == "DELETE") {
+        connections_.clear();
+        return 204;
+      }
+    }
+    if (path.compare(0, 13, "/connections/") == 0 && method == "DELETE") {
+      const std::string id = path.substr(13);
+      connections_.erase(std::remove_if(connections_.begin(), connections_.end(),
+                                        [&id](const FakeConnection& connection) {
+                                          return connection.id == id;
+                                        }),
+                         connections_.end());
+      return 204;
+    }
+    *body = "404 page not found\n";
+    return 404;
+  }
+
+  // /traffic and /memory send a line a second, /logs the lines as they
+  // come, until the client goes or the API is closed.
+  void Stream(int fd, const HttpRequest& request) {
+    if (!SendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                     "Transfer-Encoding: chunked\r\n\r\n")) {
+      return;
+    }
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      generation = generation_;
+    }
+    const std::string level = QueryValue(request.query, "level");
+    const bool logs_wanted = level != "warning" && level != "error" && level != "silent";
+    uint64_t cursor = logs_.next();
+    for (;;) {
+      std::string chunk;
+      if (request.path == "/logs") {
+        chunk = logs_.Wait(&cursor, std::chrono::milliseconds(1000));
+        if (!logs_wanted) {
+          chunk.clear();
+        }
+      } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (request.path == "/traffic") {
+          int64_t up = 0;
+          int64_t down = 0;
+          for (const FakeConnection& connection : connections_) {
+            up += connection.upload_rate;
+            down += connection.download_rate;
+          }
+          chunk = "{\"up\":" + std::to_string(up) + ",\"down\":" + std::to_string(down) + "}\n";
+        } else {
+          chunk = "{\"inuse\":" + std::to_string(MemoryInUse()) + ",\"oslimit\":0}\n";
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation != generation_) {
+          return;
+        }
+      }
+      if (!chunk.empty() && !SendChunk(fd, chunk)) {
+        return;
+      }
+      if (request.path != "/logs") {
+        SleepMilliseconds(1000);
+      }
+    }
+  }
+
+  // Requires |mutex_|.
+  int64_t MemoryInUse() const {
+    return 24 * 1024 * 1024 + static_cast<int64_t>(connections_.size()) * 48 * 1024;
+  }
+
+  const Knobs knobs_;
+  const std::string config_path_;
+  LogBus logs_;
+  std::atomic<uint64_t> requests_{0};
+
+  std::mutex mutex_;
+  LoadedConfig config_;
+  std::map<std::string, std::string> selections_;
+  std::vector<int> inbound_fds_;
+  int api_fd_ = -1;
+  std::set<int> clients_;
+  // Bumped whenever the API closes, so streams opened before end.
+  uint64_t generation_ = 0;
+  std::chrono::steady_clock::time_point ready_at_;
+  std::vector<FakeConnection> connections_;
+  int64_t upload_total_ = 0;
+  int64_t download_total_ = 0;
+  std::mt19937 random_;
+  uint64_t next_connection_ = 1;
+  std::chrono::steady_clock::time_point last_second_ = std::chrono::steady_clock::now();
+
+  // Tick() only.
+  const std::chrono::steady_clock::time_point log_started_at_ = std::chrono::steady_clock::now();
+  int64_t logged_ = 0;
+  uint64_t log_counter_ = 0;
+};
+
+int PrintUsage() {
+  std::fprintf(stderr,
+               "Usage: fake-sing-box run|check|version [-c config.json]... [-C dir]... "
+               "[-D dir] [--disable-color]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string command;
+  std::vector<std::string> configs;
+  std::vector<std::string> config_directories;
+  std::string working_directory;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if ((arg == "-c" || arg == "--config") && has_value) {
+      configs.push_back(argv[++i]);
+    } else if ((arg == "-C" || arg == "--config-directory") && has_value) {
+      config_directories.push_back(argv[++i]);
+    } else if ((arg == "-D" || arg == "--directory") && has_value) {
+      working_directory = argv[++i];
+    } else if (arg == "--disable-color") {
+      continue;
+    } else if (command.empty() && arg[0] != '-') {
+      command = arg;
+    } else {
+      return PrintUsage();
+    }
+  }
+  if (command == "version") {
+    std::printf("sing-box version %s\n\nEnvironment: fake-sing-box\n", kVersion);
+    return 0;
+  }
+  if (command != "run" && command != "check") {
+    return PrintUsage();
+  }
+  // As sing-box does, config paths are taken relative to -D.
+  if (!working_directory.empty() && chdir(working_directory.c_str()) != 0) {
+    std::fprintf(stderr, "FATAL chdir %s: %s\n", working_directory.c_str(), std::strerror(errno));
+    return 1;
+  }
+  const std::string config_path = ConfigPathFrom(configs, config_directories);
+  if (command == "check") {
+    LoadedConfig config;
+    std::string error;
+    if (!LoadConfig(config_path, &config, &error)) {
+      std::fprintf(stderr, "FATAL decode config at %s: %s\n", config_path.c_str(), error.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
+  // Signals are taken synchronously by the main loop below; every thread
+  // started from here on inherits the mask.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGHUP);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  // Never destroyed: detached API threads use it until the process exits.
+  auto* core = new FakeCore(Knobs::FromEnvironment(), config_path);
+  std::string error;
+  if (!core->Start(&error)) {
+    std::fprintf(stderr, "FATAL start service: %s\n", error.c_str());
+    return 1;
+  }
+  const timespec tick{0, 100 * 1000 * 1000};
+  for (;;) {
+    siginfo_t info;
+    const int received = sigtimedwait(&signals, &info, &tick);
+    if (received == SIGHUP) {
+      core->Reload();
+    } else if (received == SIGTERM || received == SIGINT) {
+      if (core->knobs().ignore_sigterm) {
+        core->logs()->Add("warn", "ignoring signal " + std::to_string(received));
+        continue;
+      }
+      core->logs()->Add("info", "sing-box closing");
+      SleepMilliseconds(core->knobs().stop_delay_ms);
+      core->StopServing();
+      core->logs()->Add("info", "sing-box closed");
+      std::_Exit(0);
+    }
+    core->Tick();
+  }
+}
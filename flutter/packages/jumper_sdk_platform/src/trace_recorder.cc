@@ -0,0 +1,117 @@
+#include "trace_recorder.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "json_scanner.h"
+
+namespace jumper_sdk_platform {
+
+namespace {
+
+// Microseconds with the nanoseconds kept, as trace viewers take them.
+std::string FormatMicroseconds(int64_t nanoseconds) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+                static_cast<long long>(nanoseconds / 1000),
+                static_cast<long long>(nanoseconds % 1000));
+  return buffer;
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(size_t capacity) : events_(std::max<size_t>(capacity, 1)) {}
+
+void TraceRecorder::SetEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (enabled && !enabled_.load(std::memory_order_relaxed)) {
+    next_ = 0;
+  }
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::Add(char phase, std::string_view name, const char* category,
+                        int64_t timestamp_ns, int64_t duration_ns) {
+  const uint64_t thread_id = CurrentThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  TraceEvent& event = events_[next_++ % events_.size()];
+  event.phase = phase;
+  event.category = category;
+  const size_t length = std::min(name.size(), TraceEvent::kMaxNameBytes);
+  std::memcpy(event.name, name.data(), length);
+  event.name[length] = '\0';
+  event.timestamp_ns = timestamp_ns;
+  event.duration_ns = duration_ns;
+  event.thread_id = thread_id;
+}
+
+std::vector<TraceEvent> TraceRecorder::Events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t count = static_cast<size_t>(std::min<uint64_t>(next_, events_.size()));
+  std::vector<TraceEvent> events;
+  events.reserve(count);
+  for (uint64_t index = next_ - count; index < next_; ++index) {
+    events.push_back(events_[index % events_.size()]);
+  }
+  return events;
+}
+
+uint64_t TraceRecorder::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_ > events_.size() ? next_ - events_.size() : 0;
+}
+
+int64_t TraceRecorder::NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t TraceRecorder::CurrentThreadId() {
+#ifdef _WIN32
+  return GetCurrentThreadId();
+#else
+  // The kernel's id, which is what perf and /proc show for the thread.
+  static thread_local const uint64_t thread_id = static_cast<uint64_t>(syscall(SYS_gettid));
+  return thread_id;
+#endif
+}
+
+std::string FormatChromeTrace(const std::vector<TraceEvent>& events,
+                              int64_t pid,
+                              std::string_view process_name) {
+  const std::string pid_field = ",\"pid\":" + std::to_string(pid);
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  json += "{\"ph\":\"M\",\"name\":\"process_name\"" + pid_field +
+          ",\"tid\":0,\"args\":{\"name\":" + QuoteJsonString(process_name) + "}}";
+  for (const TraceEvent& event : events) {
+    json += ",{\"ph\":\"";
+    json += event.phase;
+    json += "\",\"cat\":" + QuoteJsonString(event.category) +
+            ",\"name\":" + QuoteJsonString(event.name) +
+            ",\"ts\":" + FormatMicroseconds(event.timestamp_ns) + pid_field +
+            ",\"tid\":" + std::to_string(event.thread_id);
+    if (event.phase == 'X') {
+      json += ",\"dur\":" + FormatMicroseconds(std::max<int64_t>(event.duration_ns, 0));
+    } else if (event.phase == 'i') {
+      json += ",\"s\":\"t\"";
+    }
+    json += "}";
+  }
+  json += "]}\n";
+  return json;
+}
+
+}  // namespace jumper_sdk_platform
@@ -0,0 +1,126 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TRACE_RECORDER_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+// One entry of the Chrome trace-event format: 'B' and 'E' bracket a span on
+// one thread, 'X' is a span recorded whole, 'i' a moment.
+struct TraceEvent {
+  static constexpr size_t kMaxNameBytes = 47;
+
+  char phase = 'i';
+  // A string literal; kept as a pointer.
+  const char* category = "";
+  // Cut to kMaxNameBytes.
+  char name[kMaxNameBytes + 1] = {};
+  // steady_clock, in nanoseconds since its epoch.
+  int64_t timestamp_ns = 0;
+  // 'X' events only.
+  int64_t duration_ns = 0;
+  uint64_t thread_id = 0;
+};
+
+// A fixed ring of trace events, off until enabled. While off, every call
+// costs one relaxed load and a branch; while on, a short lock, no
+// allocation. Once full, the oldest events are overwritten and counted as
+// dropped.
+class TraceRecorder {
+ public:
+  explicit TraceRecorder(size_t capacity);
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  // Turning tracing on starts from an empty buffer.
+  void SetEnabled(bool enabled);
+
+  void Begin(std::string_view name, const char* category) {
+    if (enabled()) {
+      Add('B', name, category, NowNanoseconds(), 0);
+    }
+  }
+  void End(std::string_view name, const char* category) {
+    if (enabled()) {
+      Add('E', name, category, NowNanoseconds(), 0);
+    }
+  }
+  // A span measured elsewhere, e.g. a queue wait that began on another
+  // thread. It is drawn on the calling thread.
+  void Complete(std::string_view name, const char* category, int64_t start_ns, int64_t end_ns) {
+    if (enabled()) {
+      Add('X', name, category, start_ns, end_ns - start_ns);
+    }
+  }
+  void Instant(std::string_view name, const char* category) {
+    if (enabled()) {
+      Add('i', name, category, NowNanoseconds(), 0);
+    }
+  }
+
+  // Oldest first.
+  std::vector<TraceEvent> Events() const;
+  uint64_t dropped() const;
+  size_t capacity() const { return events_.size(); }
+
+  static int64_t NowNanoseconds();
+  static uint64_t CurrentThreadId();
+
+ private:
+  void Add(char phase, std::string_view name, const char* category, int64_t timestamp_ns,
+           int64_t duration_ns);
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_;
+  uint64_t next_ = 0;
+};
+
+// Brackets a scope with 'B' and 'E' events. Whether it traces is decided
+// once, at construction, so a span is never left half open by tracing
+// being switched meanwhile.
+class TraceScope {
+ public:
+  TraceScope(TraceRecorder* recorder, std::string_view name, const char* category)
+      : recorder_(recorder->enabled() ? recorder : nullptr), name_(name), category_(category) {
+    if (recorder_ != nullptr) {
+      recorder_->Begin(name_, category_);
+    }
+  }
+  ~TraceScope() { Close(); }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  // Ends the span before the scope does.
+  void Close() {
+    if (recorder_ != nullptr) {
+      recorder_->End(name_, category_);
+      recorder_ = nullptr;
+    }
+  }
+
+ private:
+  TraceRecorder* recorder_;
+  std::string_view name_;
+  const char* category_;
+};
+
+// Chrome trace-event JSON, as Perfetto and chrome://tracing open it: a
+// `traceEvents` array in microseconds, attributed to |pid| and named
+// |process_name|.
+std::string FormatChromeTrace(const std::vector<TraceEvent>& events,
+                              int64_t pid,
+                              std::string_view process_name);
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_TRACE_RECORDER_H_
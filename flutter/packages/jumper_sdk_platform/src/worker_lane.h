@@ -0,0 +1,40 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_WORKER_LANE_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_WORKER_LANE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jumper_sdk_platform {
+
+// Fixed-size set of threads draining a FIFO queue. A lane with one thread
+// runs its tasks strictly in submission order.
+class WorkerLane {
+ public:
+  explicit WorkerLane(size_t thread_count);
+  ~WorkerLane();
+
+  WorkerLane(const WorkerLane&) = delete;
+  WorkerLane& operator=(const WorkerLane&) = delete;
+
+  void Post(std::function<void()> task);
+  // Runs the tasks that are already queued, then joins the threads.
+  void Shutdown();
+
+ private:
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_WORKER_LANE_H_
@@ -73,6 +73,45 @@ void main() {
     });
   });
 
+  test('reloadCore sends launch options', () async {
+    await platform.reloadCore(
+      launchOptions: const <String, Object?>{'binaryPath': '/tmp/sing-box'},
+    );
+    expect(lastCall?.method, 'reloadCore');
+    expect(lastCall?.arguments, <String, Object?>{
+      'launchOptions': <String, Object?>{'binaryPath': '/tmp/sing-box'},
+      'networkMode': null,
+      'stopTimeoutMs': null,
+    });
+  });
+
+  test('stopCore addresses an isolated core', () async {
+    await platform.stopCore(isolatedProfileId: 'candidate');
+    expect(lastCall?.method, 'stopCore');
+    expect(lastCall?.arguments, <String, Object?>{
+      'stopTimeoutMs': null,
+      'isolatedProfileId': 'candidate',
+    });
+  });
+
+  test('getPluginMetrics sends textfile path', () async {
+    await platform.getPluginMetrics(textfilePath: '/tmp/jumper.prom');
+    expect(lastCall?.method, 'getPluginMetrics');
+    expect(lastCall?.arguments, <String, Object?>{'textfilePath': '/tmp/jumper.prom'});
+  });
+
+  test('dumpTrace sends path', () async {
+    await platform.dumpTrace(path: '/tmp/jumper-trace.json');
+    expect(lastCall?.method, 'dumpTrace');
+    expect(lastCall?.arguments, <String, Object?>{'path': '/tmp/jumper-trace.json'});
+  });
+
+  test('getMainThreadStalls sends clear', () async {
+    await platform.getMainThreadStalls(clear: true);
+    expect(lastCall?.method, 'getMainThreadStalls');
+    expect(lastCall?.arguments, <String, Object?>{'clear': true});
+  });
+
   test('disableSystemProxy calls method', () async {
     await platform.disableSystemProxy();
     expect(lastCall?.method, 'disableSystemProxy');
@@ -11,24 +11,34 @@ class MockJumperSdkPlatformPlatform
   Future<String?> getPlatformVersion() => Future.value('42');
 
   @override
-  Future<Map<String, Object?>> getCoreState() async => <String, Object?>{'status': 'running'};
+  Future<Map<String, Object?>> getCoreState({String? isolatedProfileId}) async =>
+      <String, Object?>{'status': 'running'};
 
   @override
-  Future<void> restartCore({
+  Future<Map<String, Object?>> restartCore({
     String? reason,
     Map<String, Object?>? launchOptions,
     String? networkMode,
-  }) async {}
+    int? stopTimeoutMs,
+  }) async => <String, Object?>{};
+
+  @override
+  Future<Map<String, Object?>> reloadCore({
+    Map<String, Object?>? launchOptions,
+    String? networkMode,
+    int? stopTimeoutMs,
+  }) async => <String, Object?>{};
 
   @override
-  Future<void> startCore({
+  Future<Map<String, Object?>> startCore({
     required String profileId,
     Map<String, Object?>? launchOptions,
     String? networkMode,
-  }) async {}
+    bool isolated = false,
+  }) async => <String, Object?>{};
 
   @override
-  Future<void> stopCore() async {}
+  Future<void> stopCore({int? stopTimeoutMs, String? isolatedProfileId}) async {}
 
   @override
   Stream<Map<String, Object?>> watchCoreEvents() => const Stream.empty();
@@ -36,6 +46,21 @@ class MockJumperSdkPlatformPlatform
   @override
   Stream<Map<String, Object?>> watchKernelLogs() => const Stream.empty();
 
+  @override
+  Stream<List<int>> watchTraffic() => const Stream.empty();
+
+  @override
+  Stream<Map<String, Object?>> watchProcessStats({int intervalMs = 1000}) =>
+      const Stream.empty();
+
+  @override
+  Stream<Map<String, Object?>> watchConnectionDeltas({int intervalMs = 1000}) =>
+      const Stream.empty();
+
+  @override
+  Future<Map<String, Object?>> getRecentLogs({int sinceSeq = 0, String? isolatedProfileId}) async =>
+      <String, Object?>{'lines': <Object?>[]};
+
   @override
   Future<Map<String, Object?>> inspectRuntime({
     required String version,
@@ -50,6 +75,25 @@ class MockJumperSdkPlatformPlatform
     String? basePath,
   }) async => <String, Object?>{'installed': true};
 
+  @override
+  Future<Map<String, Object?>> rollbackRuntime() async =>
+      <String, Object?>{'rolledBack': true};
+
+  @override
+  Future<Map<String, Object?>> getPluginMetrics({String? textfilePath}) async =>
+      <String, Object?>{'methods': <String, Object?>{}};
+
+  @override
+  Future<void> setTracing({required bool enabled}) async {}
+
+  @override
+  Future<Map<String, Object?>> dumpTrace({String? path}) async =>
+      <String, Object?>{'events': 0};
+
+  @override
+  Future<Map<String, Object?>> getMainThreadStalls({bool clear = false}) async =>
+      <String, Object?>{'stalls': <Object?>[]};
+
   @override
   Future<void> enableSystemProxy({
     required String host,
@@ -4,18 +4,18 @@
 #include <VersionHelpers.h>
 #include <shlobj.h>
 
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <chrono>
 #include <filesystem>
-#include <fstream>
 #include <memory>
-#include <regex>
 #include <sstream>
 #include <string>
 #include <thread>
-#include <chrono>
 #include <vector>
 #include <cstdlib>
 #include <algorithm>
@@ -24,6 +24,136 @@
 namespace jumper_sdk_platform {
 
 namespace {
+// Upper bound for the core to become ready after spawn.
+constexpr int kCoreReadyTimeoutMs = 6000;
+// How long a stopped core gets to exit, unless the call passes
+// stopTimeoutMs.
+constexpr int kCoreStopDefaultTimeoutMs = 2000;
+constexpr int kCoreStopMaxTimeoutMs = 30000;
+// How long the next start waits for the stopped core's ports to free up.
+constexpr int kCorePortReleaseTimeoutMs = 1000;
+// Upper bound for `sing-box check` on a config about to be loaded.
+constexpr int kCoreConfigCheckTimeoutMs = 5000;
+// Per call, for config changes applied through the Clash API.
+constexpr int kConfigApiTimeoutMs = 1000;
+// Bounds for the polling cadence a connections listener may ask for.
+constexpr int kSampleDefaultIntervalMs = 1000;
+constexpr int kSampleMinIntervalMs = 100;
+constexpr int kSampleMaxIntervalMs = 60000;
+
+int64_t SteadyMilliseconds(std::chrono::steady_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// The clock TraceRecorder stamps its events with.
+int64_t SteadyNanoseconds(std::chrono::steady_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+flutter::EncodableValue LatencySnapshotValue(const LatencySnapshot& snapshot) {
+  flutter::EncodableMap value;
+  value[flutter::EncodableValue("count")] =
+      flutter::EncodableValue(static_cast<int64_t>(snapshot.count));
+  value[flutter::EncodableValue("sumMs")] = flutter::EncodableValue(snapshot.sum_ns / 1e6);
+  value[flutter::EncodableValue("maxMs")] = flutter::EncodableValue(snapshot.max_ns / 1e6);
+  value[flutter::EncodableValue("p50Ms")] =
+      flutter::EncodableValue(snapshot.ValueAtQuantile(0.5) / 1e6);
+  value[flutter::EncodableValue("p90Ms")] =
+      flutter::EncodableValue(snapshot.ValueAtQuantile(0.9) / 1e6);
+  value[flutter::EncodableValue("p99Ms")] =
+      flutter::EncodableValue(snapshot.ValueAtQuantile(0.99) / 1e6);
+  value[flutter::EncodableValue("p999Ms")] =
+      flutter::EncodableValue(snapshot.ValueAtQuantile(0.999) / 1e6);
+  return flutter::EncodableValue(value);
+}
+
+// Same shape as the Linux plugin's getMainThreadStalls reply.
+flutter::EncodableValue StallReportValue(const StallReport& report) {
+  flutter::EncodableList stalls;
+  for (const StallRecord& record : report.stalls) {
+    flutter::EncodableMap item;
+    if (!record.method.empty()) {
+      item[flutter::EncodableValue("method")] = flutter::EncodableValue(record.method);
+    }
+    item[flutter::EncodableValue("pluginAttributed")] =
+        flutter::EncodableValue(!record.method.empty());
+    item[flutter::EncodableValue("durationMs")] = flutter::EncodableValue(record.duration_ms);
+    item[flutter::EncodableValue("timestampMs")] = flutter::EncodableValue(record.timestamp_ms);
+    stalls.push_back(flutter::EncodableValue(item));
+  }
+  flutter::EncodableMap value;
+  value[flutter::EncodableValue("thresholdMs")] =
+      flutter::EncodableValue(report.options.threshold_ms);
+  value[flutter::EncodableValue("heartbeatIntervalMs")] =
+      flutter::EncodableValue(report.options.heartbeat_interval_ms);
+  value[flutter::EncodableValue("heartbeats")] =
+      flutter::EncodableValue(static_cast<int64_t>(report.heartbeats));
+  value[flutter::EncodableValue("heartbeatLatency")] =
+      LatencySnapshotValue(report.heartbeat_latency);
+  value[flutter::EncodableValue("stallDurations")] = LatencySnapshotValue(report.stall_durations);
+  value[flutter::EncodableValue("stalls")] = flutter::EncodableValue(stalls);
+  value[flutter::EncodableValue("dropped")] =
+      flutter::EncodableValue(static_cast<int64_t>(report.dropped));
+  value[flutter::EncodableValue("worstMethodStallMs")] =
+      flutter::EncodableValue(report.worst_method_stall_ms);
+  return flutter::EncodableValue(value);
+}
+
+int SampleIntervalFromArgs(const flutter::EncodableValue* arguments) {
+  const auto* args = arguments == nullptr ? nullptr : std::get_if<flutter::EncodableMap>(arguments);
+  if (args == nullptr) {
+    return kSampleDefaultIntervalMs;
+  }
+  const auto it = args->find(flutter::EncodableValue("intervalMs"));
+  if (it == args->end()) {
+    return kSampleDefaultIntervalMs;
+  }
+  int64_t interval_ms = kSampleDefaultIntervalMs;
+  if (const auto* value = std::get_if<int32_t>(&it->second)) {
+    interval_ms = *value;
+  } else if (const auto* value = std::get_if<int64_t>(&it->second)) {
+    interval_ms = *value;
+  }
+  return static_cast<int>(std::clamp<int64_t>(interval_ms, kSampleMinIntervalMs,
+                                              kSampleMaxIntervalMs));
+}
+
+// True for a call addressed to an isolated core, started with `isolated: true`
+// or named by `isolatedProfileId`.
+bool TargetsIsolatedCore(const flutter::EncodableValue* arguments) {
+  const auto* args = arguments == nullptr ? nullptr : std::get_if<flutter::EncodableMap>(arguments);
+  if (args == nullptr) {
+    return false;
+  }
+  const auto isolated = args->find(flutter::EncodableValue("isolated"));
+  if (isolated != args->end()) {
+    const auto* value = std::get_if<bool>(&isolated->second);
+    if (value != nullptr && *value) {
+      return true;
+    }
+  }
+  const auto profile = args->find(flutter::EncodableValue("isolatedProfileId"));
+  return profile != args->end() && std::holds_alternative<std::string>(profile->second);
+}
+
+int StopTimeoutFromArgs(const flutter::EncodableValue* arguments) {
+  const auto* args = arguments == nullptr ? nullptr : std::get_if<flutter::EncodableMap>(arguments);
+  if (args == nullptr) {
+    return kCoreStopDefaultTimeoutMs;
+  }
+  const auto it = args->find(flutter::EncodableValue("stopTimeoutMs"));
+  if (it == args->end()) {
+    return kCoreStopDefaultTimeoutMs;
+  }
+  int64_t timeout_ms = kCoreStopDefaultTimeoutMs;
+  if (const auto* value = std::get_if<int32_t>(&it->second)) {
+    timeout_ms = *value;
+  } else if (const auto* value = std::get_if<int64_t>(&it->second)) {
+    timeout_ms = *value;
+  }
+  return static_cast<int>(std::clamp<int64_t>(timeout_ms, 0, kCoreStopMaxTimeoutMs));
+}
+
 std::string QuoteWindowsArg(const std::string& arg) {
   if (arg.find_first_of(" \t\"") == std::string::npos) {
     return arg;
@@ -39,6 +169,16 @@ std::string QuoteWindowsArg(const std::string& arg) {
   out += "\"";
   return out;
 }
+
+std::string BuildCommandLine(const std::string& binary_path,
+                             const std::vector<std::string>& arguments) {
+  std::string cmdline = QuoteWindowsArg(binary_path);
+  for (const auto& arg : arguments) {
+    cmdline += " ";
+    cmdline += QuoteWindowsArg(arg);
+  }
+  return cmdline;
+}
 }  // namespace
 
 // static
@@ -49,19 +189,173 @@ void JumperSdkPlatformPlugin::RegisterWithRegistrar(
           registrar->messenger(), "jumper_sdk_platform",
           &flutter::StandardMethodCodec::GetInstance());
 
-  auto plugin = std::make_unique<JumperSdkPlatformPlugin>();
+  auto plugin = std::make_unique<JumperSdkPlatformPlugin>(registrar);
 
   channel->SetMethodCallHandler(
       [plugin_pointer = plugin.get()](const auto &call, auto result) {
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
+  auto traffic_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "jumper_sdk_platform/traffic",
+          &flutter::StandardMethodCodec::GetInstance());
+  traffic_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_pointer = plugin.get()](
+              const flutter::EncodableValue* arguments,
+              std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->traffic_sink_ = std::move(events);
+            plugin_pointer->traffic_stream_->SetActive(true);
+            return nullptr;
+          },
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->traffic_stream_->SetActive(false);
+            plugin_pointer->traffic_sink_.reset();
+            return nullptr;
+          }));
+
+  auto connections_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "jumper_sdk_platform/connections",
+          &flutter::StandardMethodCodec::GetInstance());
+  connections_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_pointer = plugin.get()](
+              const flutter::EncodableValue* arguments,
+              std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->connections_sink_ = std::move(events);
+            plugin_pointer->connections_poller_->SetActive(true,
+                                                           SampleIntervalFromArgs(arguments));
+            return nullptr;
+          },
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->connections_poller_->SetActive(false, kSampleDefaultIntervalMs);
+            plugin_pointer->connections_sink_.reset();
+            return nullptr;
+          }));
+
+  auto core_events_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "jumper_sdk_platform/core_events",
+          &flutter::StandardMethodCodec::GetInstance());
+  core_events_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_pointer = plugin.get()](
+              const flutter::EncodableValue* arguments,
+              std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->core_events_sink_ = std::move(events);
+            return nullptr;
+          },
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue* arguments)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->core_events_sink_.reset();
+            return nullptr;
+          }));
+
   registrar->AddPlugin(std::move(plugin));
 }
 
-JumperSdkPlatformPlugin::JumperSdkPlatformPlugin() {}
+JumperSdkPlatformPlugin::JumperSdkPlatformPlugin()
+    : JumperSdkPlatformPlugin(nullptr) {}
+
+JumperSdkPlatformPlugin::JumperSdkPlatformPlugin(
+    flutter::PluginRegistrarWindows* registrar)
+    : dispatcher_(std::make_unique<PlatformThreadDispatcher>(registrar)),
+      traffic_stream_(std::make_unique<ClashApiStream>(
+          "/traffic", [this](const std::string& line) { OnTrafficLine(line); })),
+      connections_poller_(std::make_unique<ConnectionsPoller>(
+          [this](const ConnectionsDelta& delta, bool reset, int64_t timestamp_ms) {
+            OnConnectionsDelta(delta, reset, timestamp_ms);
+          })),
+      stall_watchdog_(std::make_unique<StallWatchdog>(
+          StallWatchdogOptions(),
+          [this](std::function<void()> task) { dispatcher_->Post(std::move(task)); })) {
+  stall_watchdog_->Start();
+  // Set to trace from launch on, before the app can call setTracing.
+  if (GetEnvironmentVariableW(L"JUMPER_TRACE", nullptr, 0) > 0) {
+    trace_.SetEnabled(true);
+  }
+}
+
+JumperSdkPlatformPlugin::~JumperSdkPlatformPlugin() {
+  CancelPendingStarts();
+  lifecycle_lane_.Shutdown();
+  runtime_lane_.Shutdown();
+  // The platform thread does not wait for the core: closing the job kills it.
+  StopRealCore(0);
+  CancelAutomaticRestart();
+  if (restart_timer_ != nullptr) {
+    CloseThreadpoolTimer(restart_timer_);
+  }
+}
 
-JumperSdkPlatformPlugin::~JumperSdkPlatformPlugin() { StopRealCore(); }
+void JumperSdkPlatformPlugin::ScheduleMethodCall(
+    WorkerLane* lane,
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+    bool cancelled_by_stop) {
+  auto call = std::make_shared<flutter::MethodCall<flutter::EncodableValue>>(
+      method_call.method_name(),
+      method_call.arguments() == nullptr
+          ? nullptr
+          : std::make_unique<flutter::EncodableValue>(*method_call.arguments()));
+  auto token = std::make_shared<CancellationToken>();
+  if (cancelled_by_stop) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    pending_start_tokens_.push_back(token);
+  }
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  LatencyHistogram* queue_latency = metrics_.Find(kMethodQueueLatency, call->method_name());
+  LatencyHistogram* latency = metrics_.Find(kMethodLatency, call->method_name());
+  const auto queued_at = std::chrono::steady_clock::now();
+  lane->Post([this, call, token, shared_result, queue_latency, latency, queued_at]() {
+    const auto started_at = std::chrono::steady_clock::now();
+    if (queue_latency != nullptr) {
+      queue_latency->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                started_at - queued_at)
+                                .count());
+    }
+    trace_.Complete(call->method_name(), "queue", SteadyNanoseconds(queued_at),
+                    SteadyNanoseconds(started_at));
+    TraceScope trace(&trace_, call->method_name(), "method");
+    RunMethodCall(
+        *call,
+        std::make_unique<PlatformThreadResult>(dispatcher_.get(), shared_result),
+        token.get());
+    trace.Close();
+    if (latency != nullptr) {
+      latency->Record(NanosecondsSince(started_at));
+    }
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    pending_start_tokens_.erase(
+        std::remove(pending_start_tokens_.begin(), pending_start_tokens_.end(), token),
+        pending_start_tokens_.end());
+  });
+}
+
+void JumperSdkPlatformPlugin::CancelPendingStarts() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  for (const auto& token : pending_start_tokens_) {
+    token->Cancel();
+  }
+}
+
+void JumperSdkPlatformPlugin::SetCoreState(
+    bool is_running,
+    const std::string& runtime_mode,
+    int64_t pid) {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  is_running_ = is_running;
+  runtime_mode_ = runtime_mode;
+  pid_ = pid;
+}
 
 bool JumperSdkPlatformPlugin::ParseLaunchOptions(
     const flutter::EncodableMap& args,
@@ -115,6 +409,13 @@ bool JumperSdkPlatformPlugin::ParseLaunchOptions(
           std::get<std::string>(value));
     }
   }
+  // Cores run balanced unless told otherwise; an unknown name keeps that.
+  options->go_runtime_profile = GoRuntimeProfile::kBalanced;
+  const auto profile_it = launch.find(flutter::EncodableValue("goRuntimeProfile"));
+  if (profile_it != launch.end() && std::holds_alternative<std::string>(profile_it->second)) {
+    ParseGoRuntimeProfile(std::get<std::string>(profile_it->second),
+                          &options->go_runtime_profile);
+  }
   return true;
 }
 
@@ -195,123 +496,222 @@ std::string JumperSdkPlatformPlugin::RuntimeContainerRoot() const {
   return root;
 }
 
-bool JumperSdkPlatformPlugin::EnsureDirectory(const std::string& path, std::string* error) const {
+bool JumperSdkPlatformPlugin::FileExists(const std::string& path) const {
   try {
-    std::filesystem::create_directories(std::filesystem::u8path(path));
-    return true;
-  } catch (const std::exception& ex) {
-    if (error != nullptr) {
-      *error = ex.what();
-    }
+    return std::filesystem::exists(std::filesystem::u8path(path));
+  } catch (...) {
     return false;
   }
 }
 
-bool JumperSdkPlatformPlugin::CopyFileReplace(
-    const std::string& source,
-    const std::string& destination,
-    std::string* error) const {
-  try {
-    const auto source_path = std::filesystem::u8path(source);
-    const auto destination_path = std::filesystem::u8path(destination);
-    if (!std::filesystem::exists(source_path)) {
-      if (error != nullptr) {
-        *error = "Source file not found: " + source;
-      }
-      return false;
-    }
-    std::filesystem::create_directories(destination_path.parent_path());
-    if (std::filesystem::exists(destination_path)) {
-      std::filesystem::remove(destination_path);
-    }
-    std::filesystem::copy_file(source_path, destination_path);
-    return true;
-  } catch (const std::exception& ex) {
-    if (error != nullptr) {
-      *error = ex.what();
+std::string JumperSdkPlatformPlugin::LaunchConfigPath(
+    const std::vector<std::string>& arguments) const {
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    if (arguments[i] == "-c" && i + 1 < arguments.size()) {
+      return arguments[i + 1];
     }
-    return false;
   }
+  return "";
 }
 
-bool JumperSdkPlatformPlugin::WriteTextFile(
-    const std::string& path,
-    const std::string& value,
-    std::string* error) const {
-  std::ofstream output(path, std::ios::trunc);
-  if (!output.is_open()) {
+bool JumperSdkPlatformPlugin::IsTunnelEnabledInLaunchConfig(
+    const std::vector<std::string>& arguments) const {
+  return ReadLaunchConfig(arguments).tun_enabled;
+}
+
+CoreConfig JumperSdkPlatformPlugin::ReadLaunchConfig(
+    const std::vector<std::string>& arguments) const {
+  // A missing or malformed config leaves no controller or ports to check;
+  // sing-box reports the actual problem once spawned.
+  CoreConfig config;
+  const std::string config_path = LaunchConfigPath(arguments);
+  if (!config_path.empty()) {
+    ReadCoreConfig(config_path, &config, nullptr);
+  }
+  return config;
+}
+
+JumperSdkPlatformPlugin::CoreLaunchResult JumperSdkPlatformPlugin::LaunchCore(
+    const LaunchOptions& options,
+    int stop_timeout_ms,
+    const CancellationToken* cancellation,
+    std::chrono::steady_clock::time_point started_at,
+    ReadinessTimings* timings,
+    std::string* error) {
+  // The previous core has to be gone before its ports are checked.
+  StopRealCore(stop_timeout_ms);
+  TraceScope parse_trace(&trace_, "parse_config", "core");
+  const CoreConfig config = ReadLaunchConfig(options.arguments);
+  parse_trace.Close();
+  // A core stopped just before may still hold its sockets for a moment; the
+  // launch goes ahead as soon as they are gone.
+  TraceScope ports_trace(&trace_, "wait_ports", "core");
+  const uint16_t busy_port =
+      awaiting_port_release_
+          ? WaitForPortsReleased(config.listen_ports, kCorePortReleaseTimeoutMs,
+                                 [cancellation](int milliseconds) {
+                                   if (cancellation != nullptr) {
+                                     return !cancellation->WaitFor(
+                                         static_cast<DWORD>(milliseconds));
+                                   }
+                                   std::this_thread::sleep_for(
+                                       std::chrono::milliseconds(milliseconds));
+                                   return true;
+                                 })
+          : FindPortInUse(config.listen_ports);
+  ports_trace.Close();
+  awaiting_port_release_ = false;
+  if (busy_port != 0) {
     if (error != nullptr) {
-      *error = "Unable to write file: " + path;
+      *error = "Port " + std::to_string(busy_port) + " from the launch config is already in use";
     }
-    return false;
+    return CoreLaunchResult::kPortInUse;
   }
-  output << value;
-  if (!output.good()) {
-    if (error != nullptr) {
-      *error = "Failed writing file: " + path;
+  // A runtime from the container is checked against its install digest.
+  // The handle denies writers and deleters and stays open until the process
+  // is created, so what was verified is what starts.
+  ConfigShape shape;
+  std::string config_path;
+  const bool has_shape = SingleConfigPath(options.arguments, &config_path) &&
+                         ReadConfigShape(config_path, &shape, nullptr);
+  TraceScope verify_trace(&trace_, "verify_binary", "core");
+  PinnedFile binary;
+  if (binary.Open(options.binary_path, nullptr)) {
+    RuntimeStore store(RuntimeContainerRoot(), "sing-box.exe");
+    bool managed = false;
+    if (!store.VerifyBinary(options.binary_path, &binary, &managed, error)) {
+      return CoreLaunchResult::kIntegrityFailed;
     }
-    return false;
   }
-  return true;
+  verify_trace.Close();
+  TraceScope spawn_trace(&trace_, "spawn", "core");
+  const bool started = StartRealCore(options, error);
+  spawn_trace.Close();
+  binary.Close();
+  if (!started) {
+    return CoreLaunchResult::kSpawnFailed;
+  }
+  timings->spawn_ms = MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+  metrics_.RecordMilliseconds(kCorePhaseLatency, "spawn", timings->spawn_ms);
+  TraceScope ready_trace(&trace_, "wait_ready", "core");
+  const bool ready = WaitForCoreReady(config, cancellation, started_at, timings, error);
+  ready_trace.Close();
+  if (!ready) {
+    StopRealCore(kCoreStopDefaultTimeoutMs);
+    return CoreLaunchResult::kNotReady;
+  }
+  metrics_.RecordMilliseconds(kCorePhaseLatency, "first_byte", timings->first_byte_ms);
+  metrics_.RecordMilliseconds(kCorePhaseLatency, "ready", timings->ready_ms);
+  if (config.has_controller) {
+    traffic_stream_->SetEndpoint(config.controller);
+    connections_poller_->SetEndpoint(config.controller);
+  }
+  running_config_ = std::move(shape);
+  has_running_config_ = has_shape;
+  WatchCoreExit();
+  return CoreLaunchResult::kReady;
 }
 
-bool JumperSdkPlatformPlugin::FileExists(const std::string& path) const {
-  try {
-    return std::filesystem::exists(std::filesystem::u8path(path));
-  } catch (...) {
-    return false;
+void JumperSdkPlatformPlugin::OnConnectionsDelta(const ConnectionsDelta& delta,
+                                                 bool reset,
+                                                 int64_t timestamp_ms) {
+  // Added connections go out as the raw JSON the core sent; changed ones
+  // only as counters, four per id: upload, download, uploadRate,
+  // downloadRate.
+  flutter::EncodableList added;
+  added.reserve(delta.added.size());
+  for (const auto& entry : delta.added) {
+    added.emplace_back(entry.json);
+  }
+  flutter::EncodableList removed(delta.removed.begin(), delta.removed.end());
+  flutter::EncodableList changed_ids;
+  std::vector<int64_t> changed_counters;
+  changed_ids.reserve(delta.changed.size());
+  changed_counters.reserve(delta.changed.size() * 4);
+  for (const auto& change : delta.changed) {
+    changed_ids.emplace_back(change.id);
+    changed_counters.push_back(change.upload);
+    changed_counters.push_back(change.download);
+    changed_counters.push_back(change.upload_rate);
+    changed_counters.push_back(change.download_rate);
   }
+  auto event = std::make_shared<flutter::EncodableValue>(flutter::EncodableMap{
+      {flutter::EncodableValue("reset"), flutter::EncodableValue(reset)},
+      {flutter::EncodableValue("timestampMs"), flutter::EncodableValue(timestamp_ms)},
+      {flutter::EncodableValue("added"), flutter::EncodableValue(std::move(added))},
+      {flutter::EncodableValue("removed"), flutter::EncodableValue(std::move(removed))},
+      {flutter::EncodableValue("changedIds"), flutter::EncodableValue(std::move(changed_ids))},
+      {flutter::EncodableValue("changedCounters"),
+       flutter::EncodableValue(std::move(changed_counters))},
+  });
+  dispatcher_->Post([this, event]() {
+    if (connections_sink_) {
+      connections_sink_->Success(*event);
+    }
+  });
 }
 
-bool JumperSdkPlatformPlugin::IsTunnelEnabledInLaunchConfig(
-    const std::vector<std::string>& arguments) const {
-  std::string config_path;
-  for (size_t i = 0; i < arguments.size(); ++i) {
-    if (arguments[i] == "-c" && i + 1 < arguments.size()) {
-      config_path = arguments[i + 1];
-      break;
-    }
+void JumperSdkPlatformPlugin::OnTrafficLine(const std::string& line) {
+  TrafficSample sample;
+  const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+  if (!ParseTrafficSample(line, now_ms, &sample)) {
+    return;
   }
-  if (config_path.empty()) {
-    return false;
+  // Only the three numbers cross to the platform thread.
+  dispatcher_->Post([this, sample]() {
+    if (traffic_sink_) {
+      traffic_sink_->Success(flutter::EncodableValue(
+          std::vector<int64_t>{sample.up, sample.down, sample.timestamp_ms}));
+    }
+  });
+}
+
+flutter::EncodableMap JumperSdkPlatformPlugin::CoreStartedPayload(
+    int64_t pid,
+    const ReadinessTimings& timings) const {
+  flutter::EncodableMap timing_map;
+  timing_map[flutter::EncodableValue("spawnMs")] = flutter::EncodableValue(timings.spawn_ms);
+  if (timings.first_byte_ms >= 0) {
+    timing_map[flutter::EncodableValue("firstByteMs")] =
+        flutter::EncodableValue(timings.first_byte_ms);
   }
+  timing_map[flutter::EncodableValue("readyMs")] = flutter::EncodableValue(timings.ready_ms);
+  timing_map[flutter::EncodableValue("probeAttempts")] =
+      flutter::EncodableValue(timings.probe_attempts);
 
-  return IsTunInboundEnabledInConfig(config_path);
+  flutter::EncodableMap payload;
+  payload[flutter::EncodableValue("pid")] = flutter::EncodableValue(pid);
+  payload[flutter::EncodableValue("readiness")] =
+      flutter::EncodableValue(timings.probe_attempts > 0 ? "clashApi" : "processAlive");
+  payload[flutter::EncodableValue("timings")] = flutter::EncodableValue(timing_map);
+  return payload;
 }
 
 bool JumperSdkPlatformPlugin::StartRealCore(const LaunchOptions& options, std::string* error) {
-  StopRealCore();
+  StopRealCore(kCoreStopDefaultTimeoutMs);
 
-  std::string cmdline = QuoteWindowsArg(options.binary_path);
-  for (const auto& arg : options.arguments) {
-    cmdline += " ";
-    cmdline += QuoteWindowsArg(arg);
-  }
+  const std::string cmdline = BuildCommandLine(options.binary_path, options.arguments);
 
   STARTUPINFOA startup_info{};
   startup_info.cb = sizeof(startup_info);
   PROCESS_INFORMATION process_info{};
   std::vector<char> mutable_cmdline(cmdline.begin(), cmdline.end());
   mutable_cmdline.push_back('\0');
-  struct EnvBackup {
-    std::string key;
-    bool existed;
-    std::string value;
-  };
-  std::vector<EnvBackup> env_backups;
-  env_backups.reserve(options.environment.size());
-  for (const auto& [key, value] : options.environment) {
-    char* previous_value = nullptr;
-    size_t previous_len = 0;
-    const bool has_previous =
-        (_dupenv_s(&previous_value, &previous_len, key.c_str()) == 0 &&
-         previous_value != nullptr);
-    EnvBackup backup{key, has_previous, has_previous ? std::string(previous_value) : ""};
-    if (previous_value != nullptr) {
-      free(previous_value);
-    }
-    env_backups.push_back(std::move(backup));
-    _putenv_s(key.c_str(), value.c_str());
+  // GOMAXPROCS, GOMEMLIMIT and GOGC for the profile, unless the launch sets
+  // them itself. last_launch_options_ keeps what the app asked for.
+  std::map<std::string, std::string> overrides = options.environment;
+  GoRuntimeTuning go_runtime = TuneGoRuntime(options.go_runtime_profile, ReadMachineResources());
+  ApplyGoRuntimeTuning(&go_runtime, &overrides);
+  // An explicit block instead of editing our own environment around the
+  // call, which raced with every other thread reading it.
+  std::wstring environment;
+  // Started suspended so it is in the job before it can start anything.
+  DWORD creation_flags = CREATE_NO_WINDOW | CREATE_SUSPENDED;
+  if (!overrides.empty()) {
+    environment = BuildEnvironmentBlock(overrides);
+    creation_flags |= CREATE_UNICODE_ENVIRONMENT;
   }
 
   const char* cwd = options.working_directory.empty()
@@ -323,31 +723,126 @@ bool JumperSdkPlatformPlugin::StartRealCore(const LaunchOptions& options, std::s
       nullptr,
       nullptr,
       FALSE,
-      CREATE_NO_WINDOW,
-      nullptr,
+      creation_flags,
+      environment.empty() ? nullptr : environment.data(),
       cwd,
       &startup_info,
       &process_info);
-  for (auto it = env_backups.rbegin(); it != env_backups.rend(); ++it) {
-    if (it->existed) {
-      _putenv_s(it->key.c_str(), it->value.c_str());
-    } else {
-      _putenv_s(it->key.c_str(), "");
-    }
-  }
   if (!created) {
     if (error != nullptr) {
       *error = "CreateProcess failed with code " + std::to_string(GetLastError());
     }
     return false;
   }
+  // Without a job the core still runs; only its helpers may outlive a stop.
+  HANDLE job = CreateJobObjectW(nullptr, nullptr);
+  if (job != nullptr) {
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits{};
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits,
+                                 sizeof(limits)) ||
+        !AssignProcessToJobObject(job, process_info.hProcess)) {
+      CloseHandle(job);
+      job = nullptr;
+    }
+  }
+  ResumeThread(process_info.hThread);
 
+  core_started_at_ = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(state_mutex_);
   process_info_ = process_info;
+  core_job_ = job;
   has_real_process_ = true;
+  core_go_runtime_ = std::move(go_runtime);
   pid_ = static_cast<int64_t>(process_info.dwProcessId);
   return true;
 }
 
+bool JumperSdkPlatformPlugin::CheckCoreConfig(const LaunchOptions& options,
+                                              std::string* error) const {
+  std::vector<std::string> check_arguments;
+  if (!CheckArgumentsFor(options.arguments, &check_arguments)) {
+    return true;
+  }
+  const std::string cmdline = BuildCommandLine(options.binary_path, check_arguments);
+  std::vector<char> mutable_cmdline(cmdline.begin(), cmdline.end());
+  mutable_cmdline.push_back('\0');
+  std::wstring environment;
+  DWORD creation_flags = CREATE_NO_WINDOW;
+  if (!options.environment.empty()) {
+    environment = BuildEnvironmentBlock(options.environment);
+    creation_flags |= CREATE_UNICODE_ENVIRONMENT;
+  }
+  STARTUPINFOA startup_info{};
+  startup_info.cb = sizeof(startup_info);
+  PROCESS_INFORMATION process_info{};
+  if (!CreateProcessA(nullptr, mutable_cmdline.data(), nullptr, nullptr, FALSE, creation_flags,
+                      environment.empty() ? nullptr : environment.data(),
+                      options.working_directory.empty() ? nullptr
+                                                        : options.working_directory.c_str(),
+                      &startup_info, &process_info)) {
+    *error = "Cannot run sing-box check, CreateProcess failed with code " +
+             std::to_string(GetLastError());
+    return false;
+  }
+  const bool finished =
+      WaitForSingleObject(process_info.hProcess, kCoreConfigCheckTimeoutMs) == WAIT_OBJECT_0;
+  DWORD exit_code = 0;
+  if (finished) {
+    GetExitCodeProcess(process_info.hProcess, &exit_code);
+  } else {
+    TerminateProcess(process_info.hProcess, 1);
+  }
+  CloseHandle(process_info.hProcess);
+  CloseHandle(process_info.hThread);
+  if (!finished) {
+    *error = "sing-box check did not finish within " +
+             std::to_string(kCoreConfigCheckTimeoutMs) + " ms";
+    return false;
+  }
+  if (exit_code != 0) {
+    *error = "sing-box check exited with code " + std::to_string(exit_code);
+    return false;
+  }
+  return true;
+}
+
+bool JumperSdkPlatformPlugin::ApplyConfigLive(const LaunchOptions& options,
+                                              std::chrono::steady_clock::time_point started_at,
+                                              flutter::EncodableMap* payload,
+                                              std::string* reason) {
+  if (!has_real_process_) {
+    *reason = "No core is running";
+    return false;
+  }
+  const bool same_launch = has_last_launch_options_ && options == last_launch_options_;
+  ConfigShape next;
+  std::string config_path;
+  const bool has_next = same_launch && SingleConfigPath(options.arguments, &config_path) &&
+                        ReadConfigShape(config_path, &next, nullptr);
+  const ConfigPlan plan = PlanConfigChange(has_running_config_ ? &running_config_ : nullptr,
+                                           has_next ? &next : nullptr, same_launch, false);
+  if (plan.kind != ConfigPlanKind::kApi) {
+    *reason = plan.reason;
+    return false;
+  }
+  if (!ApplyClashApiCalls(running_config_.controller, plan.calls, kConfigApiTimeoutMs, reason)) {
+    return false;
+  }
+  running_config_ = std::move(next);
+  const double apply_ms = MillisecondsBetween(started_at, std::chrono::steady_clock::now());
+  flutter::EncodableMap event;
+  event[flutter::EncodableValue("pid")] = flutter::EncodableValue(pid_);
+  event[flutter::EncodableValue("applyMs")] = flutter::EncodableValue(apply_ms);
+  event[flutter::EncodableValue("changes")] =
+      flutter::EncodableValue(static_cast<int64_t>(plan.calls.size()));
+  *payload = event;
+  (*payload)[flutter::EncodableValue("mode")] =
+      flutter::EncodableValue(ConfigPlanKindName(plan.kind));
+  PostCoreEvent("core_config_applied", std::move(event));
+  return true;
+}
+
 bool JumperSdkPlatformPlugin::IsRealProcessAlive() const {
   if (!has_real_process_ || process_info_.hProcess == nullptr) {
     return false;
@@ -356,35 +851,69 @@ bool JumperSdkPlatformPlugin::IsRealProcessAlive() const {
   return wait_result == WAIT_TIMEOUT;
 }
 
+bool JumperSdkPlatformPlugin::DescribeCoreExit(std::string* reason) const {
+  if (IsRealProcessAlive()) {
+    return false;
+  }
+  DWORD exit_code = 0;
+  if (process_info_.hProcess != nullptr &&
+      GetExitCodeProcess(process_info_.hProcess, &exit_code) != 0 &&
+      exit_code != STILL_ACTIVE) {
+    *reason = "Core process exited during startup, exit code " + std::to_string(exit_code);
+  } else {
+    *reason = "Core process exited during startup";
+  }
+  return true;
+}
+
 bool JumperSdkPlatformPlugin::WaitForCoreReady(
-    const LaunchOptions& options,
+    const CoreConfig& config,
+    const CancellationToken* cancellation,
+    std::chrono::steady_clock::time_point started_at,
+    ReadinessTimings* timings,
     std::string* error) const {
-  (void)options;
-  // Gate success on process stability to avoid reporting connected
-  // for short-lived startup failures.
+  if (config.has_controller) {
+    ReadinessHooks hooks;
+    hooks.wait = [cancellation](int milliseconds) {
+      if (cancellation != nullptr) {
+        return !cancellation->WaitFor(static_cast<DWORD>(milliseconds));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+      return true;
+    };
+    hooks.has_exited = [this](std::string* reason) { return DescribeCoreExit(reason); };
+    return WaitForClashApi(config.controller, started_at, kCoreReadyTimeoutMs, hooks,
+                           timings, error) == ReadinessResult::kReady;
+  }
+
+  // Without a Clash API to ask, gate success on process stability to avoid
+  // reporting connected for short-lived startup failures.
   int stable_checks = 0;
   const int required_stable_checks = 12;  // ~1.2s
   const int max_checks = 60;              // ~6s
   for (int i = 0; i < max_checks; i++) {
-    if (!IsRealProcessAlive()) {
-      DWORD exit_code = 0;
-      if (process_info_.hProcess != nullptr &&
-          GetExitCodeProcess(process_info_.hProcess, &exit_code) != 0 &&
-          exit_code != STILL_ACTIVE) {
-        if (error != nullptr) {
-          *error = "Core process exited during startup, exit code " +
-                   std::to_string(exit_code);
-        }
-      } else if (error != nullptr) {
-        *error = "Core process exited during startup";
+    std::string exit_reason;
+    if (DescribeCoreExit(&exit_reason)) {
+      if (error != nullptr) {
+        *error = exit_reason;
       }
       return false;
     }
     stable_checks += 1;
     if (stable_checks >= required_stable_checks) {
+      timings->ready_ms = MillisecondsBetween(started_at, std::chrono::steady_clock::now());
       return true;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (cancellation != nullptr) {
+      if (cancellation->WaitFor(100)) {
+        if (error != nullptr) {
+          *error = "Core startup was cancelled by stopCore";
+        }
+        return false;
+      }
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
   }
 
   if (error != nullptr) {
@@ -393,164 +922,293 @@ bool JumperSdkPlatformPlugin::WaitForCoreReady(
   return false;
 }
 
-bool JumperSdkPlatformPlugin::IsTunInboundEnabledInConfig(
-    const std::string& config_path) const {
-  std::ifstream file(config_path);
-  if (!file.is_open()) {
-    return false;
+void JumperSdkPlatformPlugin::StopRealCore(int timeout_ms) {
+  // This exit is expected; nobody needs to be told about it.
+  ClearExitWait();
+  traffic_stream_->ClearEndpoint();
+  connections_poller_->ClearEndpoint();
+  PROCESS_INFORMATION process_info{};
+  HANDLE job = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (!has_real_process_) {
+      return;
+    }
+    process_info = process_info_;
+    process_info_ = PROCESS_INFORMATION{};
+    job = core_job_;
+    core_job_ = nullptr;
+    has_real_process_ = false;
+  }
+  // A windowless console process has no close request to honour, so the
+  // core is terminated; the deadline bounds how long its teardown may take.
+  const auto stop_started_at = std::chrono::steady_clock::now();
+  TraceScope trace(&trace_, "stop", "core");
+  if (process_info.hProcess != nullptr) {
+    if (job == nullptr || !TerminateJobObject(job, 0)) {
+      TerminateProcess(process_info.hProcess, 0);
+    }
+    WaitForSingleObject(process_info.hProcess, static_cast<DWORD>(timeout_ms));
+    CloseHandle(process_info.hProcess);
   }
-  const std::string content((std::istreambuf_iterator<char>(file)),
-                            std::istreambuf_iterator<char>());
-  file.close();
+  if (process_info.hThread != nullptr) {
+    CloseHandle(process_info.hThread);
+  }
+  if (job != nullptr) {
+    CloseHandle(job);
+  }
+  trace.Close();
+  awaiting_port_release_ = true;
+  const double stop_ms = MillisecondsBetween(stop_started_at, std::chrono::steady_clock::now());
+  metrics_.RecordMilliseconds(kCorePhaseLatency, "stop", stop_ms);
+  PostCoreEvent(
+      "core_stopped",
+      flutter::EncodableMap{
+          {flutter::EncodableValue("pid"),
+           flutter::EncodableValue(static_cast<int64_t>(process_info.dwProcessId))},
+          {flutter::EncodableValue("stopMs"), flutter::EncodableValue(stop_ms)},
+          {flutter::EncodableValue("timeoutMs"), flutter::EncodableValue(timeout_ms)},
+          {flutter::EncodableValue("killed"), flutter::EncodableValue(true)},
+      });
+}
 
-  const auto tun_inbound = ParseTunInboundFromConfig(content);
-  if (tun_inbound.empty()) {
-    return false;
+void JumperSdkPlatformPlugin::WatchCoreExit() {
+  ClearExitWait();
+  HANDLE process = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    process = process_info_.hProcess;
   }
-  const auto enable_it = tun_inbound.find("enable");
-  if (enable_it == tun_inbound.end()) {
-    // Missing "enable" means enabled by default in sing-box semantics.
-    return true;
+  if (process == nullptr ||
+      !RegisterWaitForSingleObject(&exit_wait_, process, OnCoreProcessExited, this, INFINITE,
+                                   WT_EXECUTEONLYONCE)) {
+    exit_wait_ = nullptr;
   }
-  std::string enable_value = Trim(enable_it->second);
-  std::transform(
-      enable_value.begin(),
-      enable_value.end(),
-      enable_value.begin(),
-      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-  return enable_value != "false";
-}
-
-std::unordered_map<std::string, std::string>
-JumperSdkPlatformPlugin::ParseFlatJsonObject(const std::string& json_object) const {
-  std::unordered_map<std::string, std::string> result;
-  const std::regex pair_regex(
-      "\"([^\"]+)\"\\s*:\\s*(\"(?:[^\"\\\\]|\\\\.)*\"|true|false|null|-?\\d+(?:\\.\\d+)?)");
-  for (std::sregex_iterator it(json_object.begin(), json_object.end(), pair_regex), end;
-       it != end; ++it) {
-    result[it->str(1)] = it->str(2);
-  }
-  return result;
-}
-
-std::unordered_map<std::string, std::string>
-JumperSdkPlatformPlugin::ParseTunInboundFromConfig(const std::string& content) const {
-  // Parse only top-level objects from inbounds array and locate type=tun.
-  const size_t inbounds_key = content.find("\"inbounds\"");
-  if (inbounds_key == std::string::npos) {
-    return {};
-  }
-  size_t array_start = content.find('[', inbounds_key);
-  if (array_start == std::string::npos) {
-    return {};
-  }
-  size_t index = array_start + 1;
-  int depth = 0;
-  bool in_string = false;
-  bool escape = false;
-  size_t object_start = std::string::npos;
-  while (index < content.size()) {
-    const char c = content[index];
-    if (escape) {
-      escape = false;
-      index++;
-      continue;
-    }
-    if (c == '\\' && in_string) {
-      escape = true;
-      index++;
-      continue;
-    }
-    if (c == '"') {
-      in_string = !in_string;
-      index++;
-      continue;
-    }
-    if (in_string) {
-      index++;
-      continue;
-    }
-    if (c == '[') {
-      depth++;
-      index++;
-      continue;
-    }
-    if (c == ']') {
-      if (depth == 0) {
-        break;
-      }
-      depth--;
-      index++;
-      continue;
+}
+
+void JumperSdkPlatformPlugin::ClearExitWait() {
+  if (exit_wait_ != nullptr) {
+    // Returns once a callback in flight has finished; it only queues work.
+    UnregisterWaitEx(exit_wait_, INVALID_HANDLE_VALUE);
+    exit_wait_ = nullptr;
+  }
+}
+
+// static
+VOID CALLBACK JumperSdkPlatformPlugin::OnCoreProcessExited(PVOID context, BOOLEAN timed_out) {
+  auto* plugin = static_cast<JumperSdkPlatformPlugin*>(context);
+  plugin->lifecycle_lane_.Post([plugin]() { plugin->HandleCoreExit(); });
+}
+
+void JumperSdkPlatformPlugin::HandleCoreExit() {
+  PROCESS_INFORMATION process_info{};
+  HANDLE job = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    // A notice for a core that has since been stopped and replaced.
+    if (!has_real_process_ || process_info_.hProcess == nullptr ||
+        WaitForSingleObject(process_info_.hProcess, 0) != WAIT_OBJECT_0) {
+      return;
     }
-    if (c == '{') {
-      if (depth == 0) {
-        object_start = index;
-      }
-      depth++;
-      index++;
-      continue;
-    }
-    if (c == '}') {
-      depth--;
-      if (depth == 0 && object_start != std::string::npos) {
-        const std::string object = content.substr(object_start, index - object_start + 1);
-        const auto object_map = ParseFlatJsonObject(object);
-        const auto type_it = object_map.find("type");
-        if (type_it != object_map.end()) {
-          std::string type_value = Trim(type_it->second);
-          if (!type_value.empty() && type_value.front() == '"' &&
-              type_value.back() == '"' && type_value.size() >= 2) {
-            type_value = type_value.substr(1, type_value.size() - 2);
-          }
-          std::transform(
-              type_value.begin(),
-              type_value.end(),
-              type_value.begin(),
-              [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
-          if (type_value == "tun") {
-            return object_map;
-          }
-        }
-      }
-      index++;
-      continue;
+    process_info = process_info_;
+    process_info_ = PROCESS_INFORMATION{};
+    job = core_job_;
+    core_job_ = nullptr;
+    has_real_process_ = false;
+    is_running_ = false;
+    pid_ = 0;
+  }
+  ClearExitWait();
+  traffic_stream_->ClearEndpoint();
+  connections_poller_->ClearEndpoint();
+  DWORD exit_code = 0;
+  GetExitCodeProcess(process_info.hProcess, &exit_code);
+  CloseHandle(process_info.hProcess);
+  if (process_info.hThread != nullptr) {
+    CloseHandle(process_info.hThread);
+  }
+  // Takes down whatever the core left running, before it is restarted.
+  if (job != nullptr) {
+    CloseHandle(job);
+  }
+  awaiting_port_release_ = true;
+
+  const auto now = std::chrono::steady_clock::now();
+  const int64_t uptime_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - core_started_at_).count();
+  const int64_t restart_in_ms = restart_backoff_.OnExit(SteadyMilliseconds(now), uptime_ms);
+  if (restart_in_ms >= 0) {
+    ScheduleAutomaticRestart(restart_in_ms);
+  }
+  // The core's output is not captured on Windows, so there are no last
+  // lines to attach.
+  flutter::EncodableMap payload{
+      {flutter::EncodableValue("pid"),
+       flutter::EncodableValue(static_cast<int64_t>(process_info.dwProcessId))},
+      {flutter::EncodableValue("exitCode"),
+       flutter::EncodableValue(static_cast<int64_t>(exit_code))},
+      {flutter::EncodableValue("uptimeMs"), flutter::EncodableValue(uptime_ms)},
+      {flutter::EncodableValue("crashLoop"), flutter::EncodableValue(restart_backoff_.open())},
+  };
+  if (restart_in_ms >= 0) {
+    payload[flutter::EncodableValue("restartInMs")] = flutter::EncodableValue(restart_in_ms);
+  }
+  PostCoreEvent("core_exited", std::move(payload));
+}
+
+void JumperSdkPlatformPlugin::ScheduleAutomaticRestart(int64_t delay_ms) {
+  if (restart_timer_ == nullptr) {
+    restart_timer_ = CreateThreadpoolTimer(OnRestartTimer, this, nullptr);
+    if (restart_timer_ == nullptr) {
+      return;
     }
-    index++;
   }
-  return {};
+  ++restart_generation_;
+  // Negative due times are relative, in 100 ns units.
+  const int64_t due = -delay_ms * 10000;
+  FILETIME due_time;
+  due_time.dwLowDateTime = static_cast<DWORD>(static_cast<uint64_t>(due) & 0xFFFFFFFF);
+  due_time.dwHighDateTime = static_cast<DWORD>(static_cast<uint64_t>(due) >> 32);
+  SetThreadpoolTimer(restart_timer_, &due_time, 0, 0);
 }
 
-std::string JumperSdkPlatformPlugin::Trim(const std::string& value) const {
-  const auto is_space = [](unsigned char c) { return std::isspace(c) != 0; };
-  auto begin = std::find_if_not(value.begin(), value.end(), is_space);
-  if (begin == value.end()) {
-    return "";
+void JumperSdkPlatformPlugin::CancelAutomaticRestart() {
+  ++restart_generation_;
+  if (restart_timer_ != nullptr) {
+    SetThreadpoolTimer(restart_timer_, nullptr, 0, 0);
+    WaitForThreadpoolTimerCallbacks(restart_timer_, TRUE);
   }
-  auto end = std::find_if_not(value.rbegin(), value.rend(), is_space).base();
-  return std::string(begin, end);
+  restart_backoff_.Reset();
 }
 
-void JumperSdkPlatformPlugin::StopRealCore() {
-  if (!has_real_process_) {
+// static
+VOID CALLBACK JumperSdkPlatformPlugin::OnRestartTimer(PTP_CALLBACK_INSTANCE instance,
+                                                      PVOID context,
+                                                      PTP_TIMER timer) {
+  auto* plugin = static_cast<JumperSdkPlatformPlugin*>(context);
+  const uint64_t generation = plugin->restart_generation_.load();
+  // Registered like a startCore call, so stopCore cancels it too.
+  auto token = std::make_shared<CancellationToken>();
+  {
+    std::lock_guard<std::mutex> lock(plugin->state_mutex_);
+    plugin->pending_start_tokens_.push_back(token);
+  }
+  plugin->lifecycle_lane_.Post([plugin, token, generation]() {
+    plugin->RestartExitedCore(generation, token.get());
+    std::lock_guard<std::mutex> lock(plugin->state_mutex_);
+    auto& tokens = plugin->pending_start_tokens_;
+    tokens.erase(std::remove(tokens.begin(), tokens.end(), token), tokens.end());
+  });
+}
+
+void JumperSdkPlatformPlugin::RestartExitedCore(uint64_t generation,
+                                                const CancellationToken* cancellation) {
+  // Superseded by a deliberate start or stop, or by a later schedule.
+  if (generation != restart_generation_.load() || !has_last_launch_options_ ||
+      cancellation->IsCancelled()) {
     return;
   }
-  if (process_info_.hProcess != nullptr) {
-    TerminateProcess(process_info_.hProcess, 0);
-    WaitForSingleObject(process_info_.hProcess, 2000);
-    CloseHandle(process_info_.hProcess);
-    process_info_.hProcess = nullptr;
+  const auto started_at = std::chrono::steady_clock::now();
+  const LaunchOptions launch_options = last_launch_options_;
+  std::string error;
+  ReadinessTimings timings;
+  const CoreLaunchResult launch = LaunchCore(launch_options, kCoreStopDefaultTimeoutMs,
+                                             cancellation, started_at, &timings, &error);
+  if (launch == CoreLaunchResult::kReady) {
+    SetCoreState(true, "real", pid_);
+    PostCoreEvent("core_restarted",
+                  flutter::EncodableMap{
+                      {flutter::EncodableValue("pid"), flutter::EncodableValue(pid_)},
+                      {flutter::EncodableValue("attempt"),
+                       flutter::EncodableValue(restart_backoff_.attempt())},
+                      {flutter::EncodableValue("readyMs"),
+                       flutter::EncodableValue(timings.ready_ms)},
+                  });
+    return;
+  }
+  SetCoreState(false, "real", 0);
+  // A stopCore issued meanwhile wins; the stop has reset the backoff.
+  if (cancellation->IsCancelled()) {
+    return;
   }
-  if (process_info_.hThread != nullptr) {
-    CloseHandle(process_info_.hThread);
-    process_info_.hThread = nullptr;
+  // A failed automatic restart counts as another crash.
+  const int64_t restart_in_ms =
+      restart_backoff_.OnExit(SteadyMilliseconds(std::chrono::steady_clock::now()), 0);
+  if (restart_in_ms >= 0) {
+    ScheduleAutomaticRestart(restart_in_ms);
   }
-  has_real_process_ = false;
+  flutter::EncodableMap payload{
+      {flutter::EncodableValue("message"), flutter::EncodableValue(error)},
+      {flutter::EncodableValue("attempt"), flutter::EncodableValue(restart_backoff_.attempt())},
+      {flutter::EncodableValue("crashLoop"), flutter::EncodableValue(restart_backoff_.open())},
+  };
+  if (restart_in_ms >= 0) {
+    payload[flutter::EncodableValue("restartInMs")] = flutter::EncodableValue(restart_in_ms);
+  }
+  PostCoreEvent("core_restart_failed", std::move(payload));
+}
+
+void JumperSdkPlatformPlugin::PostCoreEvent(const char* type, flutter::EncodableMap payload) {
+  const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+  auto event = std::make_shared<flutter::EncodableValue>(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue(type)},
+      {flutter::EncodableValue("timestampMs"), flutter::EncodableValue(now_ms)},
+      {flutter::EncodableValue("payload"), flutter::EncodableValue(std::move(payload))},
+  });
+  dispatcher_->Post([this, event]() {
+    if (core_events_sink_) {
+      core_events_sink_->Success(*event);
+    }
+  });
 }
 
 void JumperSdkPlatformPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Calls that spawn, wait on, or copy anything leave the platform thread.
+  const std::string& method = method_call.method_name();
+  StallWatchdogScope stall_scope(stall_watchdog_.get(), method);
+  // Isolated cores run beside the main one on Linux only; here a call for
+  // one must not reach the main core.
+  if ((method == "startCore" || method == "stopCore" || method == "getCoreState" ||
+       method == "getRecentLogs") &&
+      TargetsIsolatedCore(method_call.arguments())) {
+    result->Error("PLATFORM_CAPABILITY_NOT_IMPLEMENTED",
+                  "Isolated cores are not implemented on Windows plugin yet.",
+                  flutter::EncodableValue(method));
+    return;
+  }
+  if (method == "startCore" || method == "restartCore" || method == "reloadCore" ||
+      method == "resetTunnel") {
+    ScheduleMethodCall(&lifecycle_lane_, method_call, std::move(result), true);
+    return;
+  }
+  if (method == "stopCore") {
+    CancelPendingStarts();
+    ScheduleMethodCall(&lifecycle_lane_, method_call, std::move(result), false);
+    return;
+  }
+  if (method == "setupRuntime" || method == "inspectRuntime" || method == "rollbackRuntime" ||
+      method == "getPluginMetrics" || method == "dumpTrace") {
+    ScheduleMethodCall(&runtime_lane_, method_call, std::move(result), false);
+    return;
+  }
+  const auto started_at = std::chrono::steady_clock::now();
+  TraceScope trace(&trace_, method, "method");
+  RunMethodCall(method_call, std::move(result), nullptr);
+  trace.Close();
+  metrics_.Record(kMethodLatency, method, NanosecondsSince(started_at));
+}
+
+void JumperSdkPlatformPlugin::RunMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+    const CancellationToken* cancellation) {
+  const auto is_cancelled = [cancellation]() {
+    return cancellation != nullptr && cancellation->IsCancelled();
+  };
   const auto get_string_arg = [&](const flutter::EncodableMap &args,
                                   const char *key) -> std::string {
     const auto it = args.find(flutter::EncodableValue(key));
@@ -572,11 +1230,14 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
     }
     result->Success(flutter::EncodableValue(version_stream.str()));
   } else if (method_call.method_name().compare("startCore") == 0) {
+    const auto started_at = std::chrono::steady_clock::now();
+    CancelAutomaticRestart();
     LaunchOptions launch_options;
     bool has_launch_options = false;
     if (method_call.arguments() != nullptr &&
         std::holds_alternative<flutter::EncodableMap>(*method_call.arguments())) {
       const auto &args = std::get<flutter::EncodableMap>(*method_call.arguments());
+      std::lock_guard<std::mutex> lock(state_mutex_);
       const auto profile_id = get_string_arg(args, "profileId");
       if (!profile_id.empty()) {
         profile_id_ = profile_id;
@@ -587,6 +1248,10 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       }
       has_launch_options = ParseLaunchOptions(args, &launch_options);
     }
+    if (is_cancelled()) {
+      result->Error("START_CORE_CANCELLED", "Core start was cancelled by stopCore");
+      return;
+    }
     if (has_launch_options) {
       if (network_mode_ == "tunnel" &&
           !IsTunnelEnabledInLaunchConfig(launch_options.arguments)) {
@@ -598,45 +1263,59 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       }
 
       std::string error;
-      if (!StartRealCore(launch_options, &error)) {
-        is_running_ = false;
-        runtime_mode_ = "simulator";
-        pid_ = 0;
-        result->Error("START_CORE_FAILED", "Failed to start core process", error);
-        return;
-      }
-      if (!WaitForCoreReady(launch_options, &error)) {
-        StopRealCore();
-        is_running_ = false;
-        runtime_mode_ = "simulator";
-        pid_ = 0;
-        result->Error("START_CORE_FAILED", "Core started but failed readiness gate", error);
+      ReadinessTimings timings;
+      const CoreLaunchResult launch =
+          LaunchCore(launch_options, StopTimeoutFromArgs(method_call.arguments()), cancellation,
+                     started_at, &timings, &error);
+      if (launch != CoreLaunchResult::kReady) {
+        SetCoreState(false, "simulator", 0);
+        if (launch == CoreLaunchResult::kPortInUse) {
+          result->Error("CORE_PORT_IN_USE",
+                        "A port required by the launch config is already bound", error);
+        } else if (launch == CoreLaunchResult::kIntegrityFailed) {
+          result->Error("CORE_INTEGRITY_FAILED", "Runtime binary failed its integrity check",
+                        error);
+        } else if (launch == CoreLaunchResult::kSpawnFailed) {
+          result->Error("START_CORE_FAILED", "Failed to start core process", error);
+        } else if (is_cancelled()) {
+          result->Error("START_CORE_CANCELLED", "Core start was cancelled by stopCore", error);
+        } else {
+          result->Error("START_CORE_FAILED", "Core started but failed readiness gate", error);
+        }
         return;
       }
       last_launch_options_ = launch_options;
       has_last_launch_options_ = true;
-      runtime_mode_ = "real";
-      is_running_ = true;
-      result->Success();
+      SetCoreState(true, "real", pid_);
+      result->Success(flutter::EncodableValue(CoreStartedPayload(pid_, timings)));
       return;
     }
 
-    is_running_ = true;
-    runtime_mode_ = "simulator";
-    pid_ = static_cast<int64_t>(::GetCurrentProcessId());
+    SetCoreState(true, "simulator", static_cast<int64_t>(::GetCurrentProcessId()));
     result->Success();
   } else if (method_call.method_name().compare("stopCore") == 0) {
-    StopRealCore();
-    is_running_ = false;
-    pid_ = 0;
+    CancelAutomaticRestart();
+    StopRealCore(StopTimeoutFromArgs(method_call.arguments()));
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      is_running_ = false;
+      pid_ = 0;
+    }
     result->Success();
-  } else if (method_call.method_name().compare("restartCore") == 0) {
-    StopRealCore();
+  } else if (method_call.method_name().compare("restartCore") == 0 ||
+             method_call.method_name().compare("reloadCore") == 0) {
+    // sing-box has no reload signal on Windows. reloadCore applies selector
+    // and clash mode changes through the Clash API; anything else is checked
+    // while the running core keeps serving, then applied with a restart.
+    const bool reload = method_call.method_name().compare("reloadCore") == 0;
+    const auto started_at = std::chrono::steady_clock::now();
+    CancelAutomaticRestart();
     LaunchOptions launch_options;
     bool has_launch_options = false;
     if (method_call.arguments() != nullptr &&
         std::holds_alternative<flutter::EncodableMap>(*method_call.arguments())) {
       const auto &args = std::get<flutter::EncodableMap>(*method_call.arguments());
+      std::lock_guard<std::mutex> lock(state_mutex_);
       const auto network_mode = get_string_arg(args, "networkMode");
       if (!network_mode.empty()) {
         network_mode_ = network_mode;
@@ -647,6 +1326,32 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       launch_options = last_launch_options_;
       has_launch_options = true;
     }
+    std::string fallback_reason;
+    if (reload && has_launch_options) {
+      flutter::EncodableMap applied;
+      if (ApplyConfigLive(launch_options, started_at, &applied, &fallback_reason)) {
+        result->Success(flutter::EncodableValue(applied));
+        return;
+      }
+      // A failed live apply may have switched some selectors already; the
+      // reload below re-reads the whole config and repairs that.
+      std::string error;
+      const auto check_started_at = std::chrono::steady_clock::now();
+      TraceScope check_trace(&trace_, "check", "core");
+      const bool checked = CheckCoreConfig(launch_options, &error);
+      check_trace.Close();
+      metrics_.Record(kCorePhaseLatency, "check", NanosecondsSince(check_started_at));
+      if (!checked) {
+        result->Error("CORE_CONFIG_INVALID", "The launch config failed sing-box check", error);
+        return;
+      }
+    }
+    StopRealCore(StopTimeoutFromArgs(method_call.arguments()));
+    if (is_cancelled()) {
+      SetCoreState(false, "simulator", 0);
+      result->Error("RESTART_CORE_CANCELLED", "Core restart was cancelled by stopCore");
+      return;
+    }
     if (has_launch_options) {
       if (network_mode_ == "tunnel" &&
           !IsTunnelEnabledInLaunchConfig(launch_options.arguments)) {
@@ -658,52 +1363,65 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       }
 
       std::string error;
-      if (!StartRealCore(launch_options, &error)) {
-        is_running_ = false;
-        runtime_mode_ = "simulator";
-        pid_ = 0;
-        result->Error("RESTART_CORE_FAILED", "Failed to restart core process", error);
-        return;
-      }
-      if (!WaitForCoreReady(launch_options, &error)) {
-        StopRealCore();
-        is_running_ = false;
-        runtime_mode_ = "simulator";
-        pid_ = 0;
-        result->Error("RESTART_CORE_FAILED", "Core restarted but failed readiness gate", error);
+      ReadinessTimings timings;
+      const CoreLaunchResult launch =
+          LaunchCore(launch_options, StopTimeoutFromArgs(method_call.arguments()), cancellation,
+                     started_at, &timings, &error);
+      if (launch != CoreLaunchResult::kReady) {
+        SetCoreState(false, "simulator", 0);
+        if (launch == CoreLaunchResult::kPortInUse) {
+          result->Error("CORE_PORT_IN_USE",
+                        "A port required by the launch config is already bound", error);
+        } else if (launch == CoreLaunchResult::kIntegrityFailed) {
+          result->Error("CORE_INTEGRITY_FAILED", "Runtime binary failed its integrity check",
+                        error);
+        } else if (launch == CoreLaunchResult::kSpawnFailed) {
+          result->Error("RESTART_CORE_FAILED", "Failed to restart core process", error);
+        } else if (is_cancelled()) {
+          result->Error("RESTART_CORE_CANCELLED", "Core restart was cancelled by stopCore", error);
+        } else {
+          result->Error("RESTART_CORE_FAILED", "Core restarted but failed readiness gate", error);
+        }
         return;
       }
       last_launch_options_ = launch_options;
       has_last_launch_options_ = true;
-      runtime_mode_ = "real";
-      is_running_ = true;
-      result->Success();
+      SetCoreState(true, "real", pid_);
+      flutter::EncodableMap payload = CoreStartedPayload(pid_, timings);
+      if (reload) {
+        payload[flutter::EncodableValue("mode")] = flutter::EncodableValue("restart");
+        payload[flutter::EncodableValue("fallbackReason")] =
+            flutter::EncodableValue(fallback_reason);
+      }
+      result->Success(flutter::EncodableValue(payload));
       return;
     }
-    is_running_ = true;
-    runtime_mode_ = "simulator";
-    pid_ = static_cast<int64_t>(::GetCurrentProcessId());
+    SetCoreState(true, "simulator", static_cast<int64_t>(::GetCurrentProcessId()));
     result->Success();
   } else if (method_call.method_name().compare("resetTunnel") == 0) {
-    if (is_running_) {
-      // Simulate a tunnel reset as a non-disruptive restart marker.
-      pid_ = static_cast<int64_t>(::GetCurrentProcessId());
+    // Restarting the core rebuilds its tun adapter; the simulator has nothing
+    // to reset.
+    if (!has_real_process_ || !has_last_launch_options_) {
+      result->Success();
+      return;
     }
+    const auto started_at = std::chrono::steady_clock::now();
+    CancelAutomaticRestart();
+    std::string error;
+    ReadinessTimings timings;
+    const CoreLaunchResult launch = LaunchCore(last_launch_options_, kCoreStopDefaultTimeoutMs,
+                                               cancellation, started_at, &timings, &error);
+    if (launch != CoreLaunchResult::kReady) {
+      SetCoreState(false, "real", 0);
+      result->Error("RESET_TUNNEL_FAILED", "Failed to restart the core to reset its tunnel",
+                    error);
+      return;
+    }
+    SetCoreState(true, "real", pid_);
     result->Success();
   } else if (method_call.method_name().compare("getCoreState") == 0) {
-    if (has_real_process_ && !IsRealProcessAlive()) {
-      if (process_info_.hProcess != nullptr) {
-        CloseHandle(process_info_.hProcess);
-        process_info_.hProcess = nullptr;
-      }
-      if (process_info_.hThread != nullptr) {
-        CloseHandle(process_info_.hThread);
-        process_info_.hThread = nullptr;
-      }
-      has_real_process_ = false;
-      is_running_ = false;
-      pid_ = 0;
-    }
+    // The exit watch keeps this current; nothing is probed here.
+    std::lock_guard<std::mutex> lock(state_mutex_);
     flutter::EncodableMap state;
     state[flutter::EncodableValue("status")] =
         flutter::EncodableValue(is_running_ ? "running" : "stopped");
@@ -718,6 +1436,19 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       state[flutter::EncodableValue("profileId")] =
           flutter::EncodableValue(profile_id_);
     }
+    if (has_real_process_) {
+      flutter::EncodableMap go_runtime;
+      go_runtime[flutter::EncodableValue("profile")] =
+          flutter::EncodableValue(GoRuntimeProfileName(core_go_runtime_.profile));
+      for (const auto& [key, value] : core_go_runtime_.environment) {
+        go_runtime[flutter::EncodableValue(key)] = flutter::EncodableValue(value);
+      }
+      go_runtime[flutter::EncodableValue("cpus")] =
+          flutter::EncodableValue(core_go_runtime_.resources.cpus);
+      go_runtime[flutter::EncodableValue("memoryBytes")] = flutter::EncodableValue(
+          static_cast<int64_t>(core_go_runtime_.resources.memory_bytes));
+      state[flutter::EncodableValue("goRuntime")] = flutter::EncodableValue(go_runtime);
+    }
     result->Success(flutter::EncodableValue(state));
   } else if (method_call.method_name().compare("setupRuntime") == 0) {
     RuntimeRequest request;
@@ -733,24 +1464,48 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
     const std::string source_config =
         request.base_path + "\\engine\\runtime-assets\\" + request.platform_arch +
         "\\minimal-config.json";
-    const std::string target_binary = runtime_root + "\\sing-box.exe";
-    const std::string target_config = runtime_root + "\\config.json";
-    const std::string target_version = runtime_root + "\\VERSION";
 
+    // Assets without a checksums.json install unverified; a listed checksum
+    // that does not match fails the setup.
+    std::string expected_sha256;
+    ReadRuntimeChecksum(request.base_path + "\\engine\\runtime-assets\\checksums.json",
+                        request.platform_arch, request.version, &expected_sha256, nullptr);
+
+    // Runs at every app launch: when the version is already installed this
+    // is a few stat calls and an index write.
+    RuntimeStore store(runtime_root, "sing-box.exe");
+    RuntimeInstallResult install;
     std::string io_error;
-    if (!EnsureDirectory(runtime_root, &io_error) ||
-        !CopyFileReplace(source_binary, target_binary, &io_error) ||
-        !CopyFileReplace(source_config, target_config, &io_error) ||
-        !WriteTextFile(target_version, request.version + "\n", &io_error)) {
+    TraceScope install_trace(&trace_, "install_runtime", "runtime");
+    const bool installed = store.Install(request.version, request.platform_arch, source_binary,
+                                         source_config, expected_sha256, &install, &io_error);
+    install_trace.Close();
+    if (!installed) {
       result->Error("SETUP_RUNTIME_FAILED", "Failed to setup runtime in container", io_error);
       return;
     }
 
+    flutter::EncodableList collected;
+    for (const std::string& id : install.collected) {
+      collected.push_back(flutter::EncodableValue(id));
+    }
     flutter::EncodableMap payload;
     payload[flutter::EncodableValue("installed")] = flutter::EncodableValue(true);
-    payload[flutter::EncodableValue("binaryPath")] = flutter::EncodableValue(target_binary);
-    payload[flutter::EncodableValue("configPath")] = flutter::EncodableValue(target_config);
+    payload[flutter::EncodableValue("binaryPath")] =
+        flutter::EncodableValue(store.BinaryPath(install.version.id));
+    payload[flutter::EncodableValue("configPath")] =
+        flutter::EncodableValue(store.ConfigPath(install.version.id));
     payload[flutter::EncodableValue("runtimeRoot")] = flutter::EncodableValue(runtime_root);
+    payload[flutter::EncodableValue("runtimeId")] = flutter::EncodableValue(install.version.id);
+    payload[flutter::EncodableValue("reused")] = flutter::EncodableValue(install.reused);
+    payload[flutter::EncodableValue("binaryInstall")] =
+        flutter::EncodableValue(InstallMethodName(install.binary_install));
+    payload[flutter::EncodableValue("configInstall")] =
+        flutter::EncodableValue(InstallMethodName(install.config_install));
+    payload[flutter::EncodableValue("collectedVersions")] = flutter::EncodableValue(collected);
+    payload[flutter::EncodableValue("integrityVerified")] =
+        flutter::EncodableValue(install.integrity_verified);
+    payload[flutter::EncodableValue("sha256")] = flutter::EncodableValue(install.version.sha256);
     result->Success(flutter::EncodableValue(payload));
   } else if (method_call.method_name().compare("inspectRuntime") == 0) {
     RuntimeRequest request;
@@ -759,21 +1514,34 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
       result->Error("INSPECT_RUNTIME_FAILED", "Failed to inspect runtime", parse_error);
       return;
     }
-    const std::string runtime_root = RuntimeContainerRoot();
-    const std::string binary_path = runtime_root + "\\sing-box.exe";
-    const std::string config_path = runtime_root + "\\config.json";
-    const std::string version_path = runtime_root + "\\VERSION";
-    std::string runtime_version;
-    {
-      std::ifstream input(version_path);
-      if (input.is_open()) {
-        std::getline(input, runtime_version);
-      }
-    }
+    // Answered from the index; only the current version's files are
+    // stat'ed.
+    RuntimeStore store(RuntimeContainerRoot(), "sing-box.exe");
+    const RuntimeIndex index = store.LoadIndex();
+    const RuntimeVersion* current = index.Find(index.current);
+    const std::string binary_path = store.CurrentBinaryPath();
+    const std::string config_path = store.CurrentConfigPath();
+    const std::string runtime_version = current != nullptr ? current->version : "";
     const bool binary_exists = FileExists(binary_path);
     const bool config_exists = FileExists(config_path);
     const bool version_matches = runtime_version == request.version;
+    // Served from the digest cache unless the binary changed since install.
+    const bool integrity_verified = current != nullptr && !current->expected_sha256.empty() &&
+                                    current->sha256 == current->expected_sha256 &&
+                                    store.IsIntact(*current);
 
+    flutter::EncodableList versions;
+    for (const RuntimeVersion& entry : index.versions) {
+      flutter::EncodableMap item;
+      item[flutter::EncodableValue("id")] = flutter::EncodableValue(entry.id);
+      item[flutter::EncodableValue("version")] = flutter::EncodableValue(entry.version);
+      item[flutter::EncodableValue("platformArch")] = flutter::EncodableValue(entry.platform_arch);
+      item[flutter::EncodableValue("bytes")] =
+          flutter::EncodableValue(static_cast<int64_t>(entry.bytes));
+      item[flutter::EncodableValue("lastUsedMs")] = flutter::EncodableValue(entry.last_used_ms);
+      item[flutter::EncodableValue("current")] = flutter::EncodableValue(entry.id == index.current);
+      versions.push_back(flutter::EncodableValue(item));
+    }
     flutter::EncodableMap payload;
     payload[flutter::EncodableValue("ready")] =
         flutter::EncodableValue(binary_exists && config_exists && version_matches);
@@ -782,8 +1550,117 @@ void JumperSdkPlatformPlugin::HandleMethodCall(
     payload[flutter::EncodableValue("binaryExists")] = flutter::EncodableValue(binary_exists);
     payload[flutter::EncodableValue("configExists")] = flutter::EncodableValue(config_exists);
     payload[flutter::EncodableValue("runtimeVersion")] = flutter::EncodableValue(runtime_version);
+    payload[flutter::EncodableValue("runtimeId")] = flutter::EncodableValue(index.current);
     payload[flutter::EncodableValue("expectedVersion")] = flutter::EncodableValue(request.version);
     payload[flutter::EncodableValue("versionMatches")] = flutter::EncodableValue(version_matches);
+    payload[flutter::EncodableValue("integrityVerified")] =
+        flutter::EncodableValue(integrity_verified);
+    payload[flutter::EncodableValue("versionInstalled")] = flutter::EncodableValue(
+        index.FindVersion(request.version, request.platform_arch) != nullptr);
+    payload[flutter::EncodableValue("previousRuntimeId")] = flutter::EncodableValue(index.previous);
+    payload[flutter::EncodableValue("installedVersions")] = flutter::EncodableValue(versions);
+    result->Success(flutter::EncodableValue(payload));
+  } else if (method_call.method_name().compare("rollbackRuntime") == 0) {
+    RuntimeStore store(RuntimeContainerRoot(), "sing-box.exe");
+    RuntimeVersion current;
+    std::string rollback_error;
+    if (!store.Rollback(&current, &rollback_error)) {
+      result->Error("ROLLBACK_RUNTIME_FAILED", "Failed to roll back runtime", rollback_error);
+      return;
+    }
+    flutter::EncodableMap payload;
+    payload[flutter::EncodableValue("rolledBack")] = flutter::EncodableValue(true);
+    payload[flutter::EncodableValue("runtimeId")] = flutter::EncodableValue(current.id);
+    payload[flutter::EncodableValue("runtimeVersion")] = flutter::EncodableValue(current.version);
+    payload[flutter::EncodableValue("platformArch")] =
+        flutter::EncodableValue(current.platform_arch);
+    payload[flutter::EncodableValue("binaryPath")] =
+        flutter::EncodableValue(store.BinaryPath(current.id));
+    payload[flutter::EncodableValue("configPath")] =
+        flutter::EncodableValue(store.ConfigPath(current.id));
+    result->Success(flutter::EncodableValue(payload));
+  } else if (method_call.method_name().compare("getPluginMetrics") == 0) {
+    // Every histogram as {methods, queueWaits, phases}; with textfilePath
+    // also written there as OpenMetrics text, replaced whole.
+    const std::vector<LatencySeries> series = metrics_.Snapshot();
+    flutter::EncodableMap families;
+    for (const LatencyFamily* family :
+         {&kMethodLatency, &kMethodQueueLatency, &kCorePhaseLatency}) {
+      families[flutter::EncodableValue(family->key)] = flutter::EncodableValue(
+          flutter::EncodableMap());
+    }
+    for (const auto& entry : series) {
+      std::get<flutter::EncodableMap>(families[flutter::EncodableValue(entry.family->key)])
+          [flutter::EncodableValue(entry.label_value)] = LatencySnapshotValue(entry.snapshot);
+    }
+    const auto* args = method_call.arguments() == nullptr
+                           ? nullptr
+                           : std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const std::string path = args == nullptr ? "" : get_string_arg(*args, "textfilePath");
+    if (!path.empty()) {
+      bool changed = false;
+      std::string write_error;
+      families[flutter::EncodableValue("textfilePath")] = flutter::EncodableValue(path);
+      if (!InstallTextFile(path, FormatOpenMetrics(series), &changed, &write_error)) {
+        families[flutter::EncodableValue("textfileError")] = flutter::EncodableValue(write_error);
+      }
+    }
+    result->Success(flutter::EncodableValue(families));
+  } else if (method_call.method_name().compare("getMainThreadStalls") == 0) {
+    const flutter::EncodableValue report = StallReportValue(stall_watchdog_->Report());
+    const auto* args = method_call.arguments() == nullptr
+                           ? nullptr
+                           : std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (args != nullptr) {
+      const auto it = args->find(flutter::EncodableValue("clear"));
+      if (it != args->end() && std::holds_alternative<bool>(it->second) &&
+          std::get<bool>(it->second)) {
+        stall_watchdog_->Clear();
+      }
+    }
+    result->Success(report);
+  } else if (method_call.method_name().compare("setTracing") == 0) {
+    const auto* args = method_call.arguments() == nullptr
+                           ? nullptr
+                           : std::get_if<flutter::EncodableMap>(method_call.arguments());
+    bool enabled = false;
+    if (args != nullptr) {
+      const auto it = args->find(flutter::EncodableValue("enabled"));
+      if (it != args->end() && std::holds_alternative<bool>(it->second)) {
+        enabled = std::get<bool>(it->second);
+      }
+    }
+    trace_.SetEnabled(enabled);
+    result->Success();
+  } else if (method_call.method_name().compare("dumpTrace") == 0) {
+    // The events so far as Chrome trace-event JSON: written to `path`, or
+    // returned as `trace` without one.
+    const std::vector<TraceEvent> events = trace_.Events();
+    const std::string trace =
+        FormatChromeTrace(events, GetCurrentProcessId(), "jumper_sdk_platform");
+    flutter::EncodableMap payload;
+    payload[flutter::EncodableValue("enabled")] = flutter::EncodableValue(trace_.enabled());
+    payload[flutter::EncodableValue("events")] =
+        flutter::EncodableValue(static_cast<int64_t>(events.size()));
+    payload[flutter::EncodableValue("dropped")] =
+        flutter::EncodableValue(static_cast<int64_t>(trace_.dropped()));
+    payload[flutter::EncodableValue("capacity")] =
+        flutter::EncodableValue(static_cast<int64_t>(trace_.capacity()));
+    const auto* args = method_call.arguments() == nullptr
+                           ? nullptr
+                           : std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const std::string path = args == nullptr ? "" : get_string_arg(*args, "path");
+    if (!path.empty()) {
+      bool changed = false;
+      std::string write_error;
+      if (!InstallTextFile(path, trace, &changed, &write_error)) {
+        result->Error("DUMP_TRACE_FAILED", "Failed to write the trace", write_error);
+        return;
+      }
+      payload[flutter::EncodableValue("path")] = flutter::EncodableValue(path);
+    } else {
+      payload[flutter::EncodableValue("trace")] = flutter::EncodableValue(trace);
+    }
     result->Success(flutter::EncodableValue(payload));
   } else if (method_call.method_name().compare("enableSystemProxy") == 0 ||
              method_call.method_name().compare("disableSystemProxy") == 0 ||
@@ -6,16 +6,34 @@
 #endif
 #include <windows.h>
 
+#include <flutter/event_sink.h>
 #include <flutter/method_channel.h>
 #include <flutter/encodable_value.h>
 #include <flutter/plugin_registrar_windows.h>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <map>
-#include <unordered_map>
 #include <vector>
 
+#include "clash_api_stream.h"
+#include "config_planner.h"
+#include "connection_tracker.h"
+#include "core_config.h"
+#include "core_readiness.h"
+#include "core_supervisor.h"
+#include "file_install.h"
+#include "go_runtime_tuning.h"
+#include "latency_metrics.h"
+#include "method_executor.h"
+#include "process_launcher.h"
+#include "runtime_store.h"
+#include "stall_watchdog.h"
+#include "trace_recorder.h"
+
 namespace jumper_sdk_platform {
 
 class JumperSdkPlatformPlugin : public flutter::Plugin {
@@ -23,6 +41,7 @@ class JumperSdkPlatformPlugin : public flutter::Plugin {
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
 
   JumperSdkPlatformPlugin();
+  explicit JumperSdkPlatformPlugin(flutter::PluginRegistrarWindows* registrar);
 
   virtual ~JumperSdkPlatformPlugin();
 
@@ -41,6 +60,20 @@ class JumperSdkPlatformPlugin : public flutter::Plugin {
     std::vector<std::string> arguments;
     std::string working_directory;
     std::map<std::string, std::string> environment;
+    GoRuntimeProfile go_runtime_profile = GoRuntimeProfile::kBalanced;
+
+    bool operator==(const LaunchOptions& other) const {
+      return binary_path == other.binary_path && arguments == other.arguments &&
+             working_directory == other.working_directory && environment == other.environment &&
+             go_runtime_profile == other.go_runtime_profile;
+    }
+  };
+  enum class CoreLaunchResult {
+    kReady,
+    kPortInUse,
+    kIntegrityFailed,
+    kSpawnFailed,
+    kNotReady,
   };
   struct RuntimeRequest {
     std::string version;
@@ -48,17 +81,75 @@ class JumperSdkPlatformPlugin : public flutter::Plugin {
     std::string base_path;
   };
 
+  // Runs |method_call| on |lane| and replies on the platform thread. Start
+  // calls are registered so that a later stopCore can cancel them.
+  void ScheduleMethodCall(
+      WorkerLane* lane,
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+      bool cancelled_by_stop);
+  void CancelPendingStarts();
+  void RunMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+      const CancellationToken* cancellation);
+  void SetCoreState(bool is_running, const std::string& runtime_mode, int64_t pid);
+  // Runs on the traffic stream's thread.
+  void OnTrafficLine(const std::string& line);
+  // Runs on the connections poller's thread.
+  void OnConnectionsDelta(const ConnectionsDelta& delta, bool reset, int64_t timestamp_ms);
+
+  // Stops any running core, checks the configured ports, spawns the core and
+  // waits until it is ready. Fills |timings| for the phases it reached.
+  CoreLaunchResult LaunchCore(const LaunchOptions& options,
+                              int stop_timeout_ms,
+                              const CancellationToken* cancellation,
+                              std::chrono::steady_clock::time_point started_at,
+                              ReadinessTimings* timings,
+                              std::string* error);
   bool StartRealCore(const LaunchOptions& options, std::string* error);
-  void StopRealCore();
+  // Runs `sing-box check` on the configs |options| would load. Launches other
+  // than `run` have nothing to check.
+  bool CheckCoreConfig(const LaunchOptions& options, std::string* error) const;
+  // Applies |options| to the running core through the Clash API when the
+  // config planner finds the change limited to selectors and the clash
+  // mode. Otherwise returns false with the reason a restart is needed.
+  bool ApplyConfigLive(const LaunchOptions& options,
+                       std::chrono::steady_clock::time_point started_at,
+                       flutter::EncodableMap* payload,
+                       std::string* reason);
+  // Terminates the core's job, so helpers it started go with it, and waits up
+  // to |timeout_ms| for the core to exit. Reports the stop as core_stopped.
+  void StopRealCore(int timeout_ms);
+  // Supervision of a running core, all on the lifecycle lane. The process
+  // handle is waited on by the thread pool, so an exit nobody asked for is
+  // reported right away and the core is restarted with backoff.
+  void WatchCoreExit();
+  void ClearExitWait();
+  void HandleCoreExit();
+  void ScheduleAutomaticRestart(int64_t delay_ms);
+  // A deliberate start, restart or stop supersedes any automatic restart and
+  // gives the next core a fresh crash budget.
+  void CancelAutomaticRestart();
+  void RestartExitedCore(uint64_t generation, const CancellationToken* cancellation);
+  static VOID CALLBACK OnCoreProcessExited(PVOID context, BOOLEAN timed_out);
+  static VOID CALLBACK OnRestartTimer(PTP_CALLBACK_INSTANCE instance,
+                                      PVOID context,
+                                      PTP_TIMER timer);
+  // Sends a `{type, timestampMs, payload}` event to core_events listeners.
+  void PostCoreEvent(const char* type, flutter::EncodableMap payload);
   bool IsTunnelEnabledInLaunchConfig(const std::vector<std::string>& arguments) const;
   bool IsRealProcessAlive() const;
-  bool WaitForCoreReady(const LaunchOptions& options, std::string* error) const;
-  bool IsTunInboundEnabledInConfig(const std::string& config_path) const;
-  std::unordered_map<std::string, std::string> ParseFlatJsonObject(
-      const std::string& json_object) const;
-  std::unordered_map<std::string, std::string> ParseTunInboundFromConfig(
-      const std::string& content) const;
-  std::string Trim(const std::string& value) const;
+  bool WaitForCoreReady(const CoreConfig& config,
+                        const CancellationToken* cancellation,
+                        std::chrono::steady_clock::time_point started_at,
+                        ReadinessTimings* timings,
+                        std::string* error) const;
+  bool DescribeCoreExit(std::string* reason) const;
+  flutter::EncodableMap CoreStartedPayload(int64_t pid,
+                                           const ReadinessTimings& timings) const;
+  std::string LaunchConfigPath(const std::vector<std::string>& arguments) const;
+  CoreConfig ReadLaunchConfig(const std::vector<std::string>& arguments) const;
   bool ParseLaunchOptions(const flutter::EncodableMap& args, LaunchOptions* options);
   bool ParseRuntimeRequest(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
@@ -66,20 +157,68 @@ class JumperSdkPlatformPlugin : public flutter::Plugin {
       RuntimeRequest* request,
       std::string* error);
   std::string RuntimeContainerRoot() const;
-  bool EnsureDirectory(const std::string& path, std::string* error) const;
-  bool CopyFileReplace(const std::string& source, const std::string& destination, std::string* error) const;
-  bool WriteTextFile(const std::string& path, const std::string& value, std::string* error) const;
   bool FileExists(const std::string& path) const;
 
+  // Guards the reported core state and |process_info_|. Lifecycle calls write
+  // them from the lifecycle lane; getCoreState reads them on the platform
+  // thread.
+  std::mutex state_mutex_;
   bool is_running_ = false;
   int64_t pid_ = 0;
   std::string profile_id_;
   std::string runtime_mode_ = "simulator";
   std::string network_mode_ = "tunnel";
   PROCESS_INFORMATION process_info_{};
+  // Kill-on-close job holding the core and everything it starts.
+  HANDLE core_job_ = nullptr;
   bool has_real_process_ = false;
+  // The Go runtime variables the running core was started with.
+  GoRuntimeTuning core_go_runtime_;
   bool has_last_launch_options_ = false;
   LaunchOptions last_launch_options_{};
+  std::vector<std::shared_ptr<CancellationToken>> pending_start_tokens_;
+
+  // Lifecycle lane only.
+  HANDLE exit_wait_ = nullptr;
+  // Set when a core is stopped; the next launch waits for its ports to be
+  // released instead of failing on them.
+  bool awaiting_port_release_ = false;
+  // The config the running core was launched with, as the planner sees it.
+  ConfigShape running_config_;
+  bool has_running_config_ = false;
+  std::chrono::steady_clock::time_point core_started_at_;
+  RestartBackoff restart_backoff_{RestartBackoffOptions()};
+  PTP_TIMER restart_timer_ = nullptr;
+  // Bumped by every schedule and cancellation; read by the timer callback so
+  // a restart queued for a superseded schedule does nothing.
+  std::atomic<uint64_t> restart_generation_{0};
+
+  // Latency histograms of method calls and core lifecycle steps, recorded
+  // from any thread without locking.
+  LatencyRegistry metrics_;
+  // Begin/end events of method calls and lifecycle steps, for dumpTrace.
+  // Off unless setTracing or JUMPER_TRACE turned it on; a cold connect
+  // takes a few dozen events.
+  TraceRecorder trace_{16384};
+
+  // Platform thread only.
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> traffic_sink_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> connections_sink_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> core_events_sink_;
+
+  // Declared last so the lanes are drained before the state they use is
+  // destroyed.
+  std::unique_ptr<PlatformThreadDispatcher> dispatcher_;
+  // Follows the running core's /traffic endpoint while someone listens. Goes
+  // away before |dispatcher_|, which it posts samples to.
+  std::unique_ptr<ClashApiStream> traffic_stream_;
+  std::unique_ptr<ConnectionsPoller> connections_poller_;
+  // Heartbeats the platform thread through |dispatcher_| and records the
+  // times it was held up. Goes away before |dispatcher_|.
+  std::unique_ptr<StallWatchdog> stall_watchdog_;
+  // startCore/stopCore/restartCore run one at a time in submission order.
+  WorkerLane lifecycle_lane_{1};
+  WorkerLane runtime_lane_{2};
 };
 
 }  // namespace jumper_sdk_platform
@@ -0,0 +1,129 @@
+#include "method_executor.h"
+
+#include <utility>
+
+namespace jumper_sdk_platform {
+
+namespace {
+constexpr UINT kRunPlatformTasksMessage = WM_APP + 0x2F1;
+}  // namespace
+
+CancellationToken::CancellationToken()
+    : event_(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {}
+
+CancellationToken::~CancellationToken() {
+  if (event_ != nullptr) {
+    CloseHandle(event_);
+  }
+}
+
+void CancellationToken::Cancel() {
+  SetEvent(event_);
+}
+
+bool CancellationToken::IsCancelled() const {
+  return WaitForSingleObject(event_, 0) == WAIT_OBJECT_0;
+}
+
+bool CancellationToken::WaitFor(DWORD milliseconds) const {
+  return WaitForSingleObject(event_, milliseconds) == WAIT_OBJECT_0;
+}
+
+PlatformThreadDispatcher::PlatformThreadDispatcher(
+    flutter::PluginRegistrarWindows* registrar)
+    : registrar_(registrar) {
+  if (registrar_ == nullptr || registrar_->GetView() == nullptr) {
+    return;
+  }
+  window_ = GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        return HandleWindowProc(hwnd, message, wparam, lparam);
+      });
+}
+
+PlatformThreadDispatcher::~PlatformThreadDispatcher() {
+  if (registrar_ != nullptr && window_proc_id_ >= 0) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+  }
+}
+
+void PlatformThreadDispatcher::Post(std::function<void()> task) {
+  if (window_ == nullptr) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  PostMessage(window_, kRunPlatformTasksMessage, 0, 0);
+}
+
+std::optional<LRESULT> PlatformThreadDispatcher::HandleWindowProc(
+    HWND hwnd,
+    UINT message,
+    WPARAM wparam,
+    LPARAM lparam) {
+  (void)hwnd;
+  (void)wparam;
+  (void)lparam;
+  if (message != kRunPlatformTasksMessage) {
+    return std::nullopt;
+  }
+  Drain();
+  return 0;
+}
+
+void PlatformThreadDispatcher::Drain() {
+  std::deque<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready.swap(tasks_);
+  }
+  for (auto& task : ready) {
+    task();
+  }
+}
+
+PlatformThreadResult::PlatformThreadResult(
+    PlatformThreadDispatcher* dispatcher,
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result)
+    : dispatcher_(dispatcher), result_(std::move(result)) {}
+
+void PlatformThreadResult::SuccessInternal(const flutter::EncodableValue* result) {
+  std::optional<flutter::EncodableValue> value;
+  if (result != nullptr) {
+    value = *result;
+  }
+  dispatcher_->Post([target = result_, value = std::move(value)]() {
+    if (value.has_value()) {
+      target->Success(*value);
+    } else {
+      target->Success();
+    }
+  });
+}
+
+void PlatformThreadResult::ErrorInternal(
+    const std::string& error_code,
+    const std::string& error_message,
+    const flutter::EncodableValue* error_details) {
+  std::optional<flutter::EncodableValue> details;
+  if (error_details != nullptr) {
+    details = *error_details;
+  }
+  dispatcher_->Post([target = result_, error_code, error_message, details = std::move(details)]() {
+    if (details.has_value()) {
+      target->Error(error_code, error_message, *details);
+    } else {
+      target->Error(error_code, error_message);
+    }
+  });
+}
+
+void PlatformThreadResult::NotImplementedInternal() {
+  dispatcher_->Post([target = result_]() { target->NotImplemented(); });
+}
+
+}  // namespace jumper_sdk_platform
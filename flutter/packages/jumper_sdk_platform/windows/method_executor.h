@@ -0,0 +1,89 @@
+#ifndef FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_METHOD_EXECUTOR_H_
+#define FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_METHOD_EXECUTOR_H_
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_result.h>
+#include <flutter/plugin_registrar_windows.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "worker_lane.h"
+
+namespace jumper_sdk_platform {
+
+// Cancellation flag shared between the platform thread and a worker. Waits
+// on the underlying event wake up as soon as the token is cancelled.
+class CancellationToken {
+ public:
+  CancellationToken();
+  ~CancellationToken();
+
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  void Cancel();
+  bool IsCancelled() const;
+  // Sleeps for up to |milliseconds|. Returns true if the token was cancelled.
+  bool WaitFor(DWORD milliseconds) const;
+  HANDLE event() const { return event_; }
+
+ private:
+  HANDLE event_ = nullptr;
+};
+
+// Runs closures on the platform thread by posting a message to the Flutter
+// top-level window. Without a window (unit tests) closures run inline.
+class PlatformThreadDispatcher {
+ public:
+  explicit PlatformThreadDispatcher(flutter::PluginRegistrarWindows* registrar);
+  ~PlatformThreadDispatcher();
+
+  PlatformThreadDispatcher(const PlatformThreadDispatcher&) = delete;
+  PlatformThreadDispatcher& operator=(const PlatformThreadDispatcher&) = delete;
+
+  void Post(std::function<void()> task);
+
+ private:
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+  void Drain();
+
+  flutter::PluginRegistrarWindows* registrar_ = nullptr;
+  HWND window_ = nullptr;
+  int window_proc_id_ = -1;
+  std::mutex mutex_;
+  std::deque<std::function<void()>> tasks_;
+};
+
+// MethodResult handed to worker threads. Every reply is marshalled back to
+// the platform thread before it reaches the engine.
+class PlatformThreadResult : public flutter::MethodResult<flutter::EncodableValue> {
+ public:
+  PlatformThreadResult(
+      PlatformThreadDispatcher* dispatcher,
+      std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* result) override;
+  void ErrorInternal(const std::string& error_code,
+                     const std::string& error_message,
+                     const flutter::EncodableValue* error_details) override;
+  void NotImplementedInternal() override;
+
+ private:
+  PlatformThreadDispatcher* dispatcher_;
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result_;
+};
+
+}  // namespace jumper_sdk_platform
+
+#endif  // FLUTTER_PLUGIN_JUMPER_SDK_PLATFORM_METHOD_EXECUTOR_H_
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PLATFORM_ARCH="${1:-linux-amd64}"
+DURATION_SECONDS="${2:-10}"
+CONNECTIONS="${3:-8}"
+VERSIONS="${VERSIONS:-1.12.22 1.13.0}"
+BENCHMARK_BIN="${BENCHMARK_BIN:-${ROOT_DIR}/build/native/jumper_native_bench}"
+
+RUNTIME_DIR="${ROOT_DIR}/engine/runtime-assets/${PLATFORM_ARCH}"
+
+if [[ "${PLATFORM_ARCH}" != linux-* ]]; then
+  echo "[go-tuning] the benchmark runs on Linux only"
+  exit 1
+fi
+if [[ ! -x "${BENCHMARK_BIN}" ]]; then
+  echo "[go-tuning] benchmark binary missing: ${BENCHMARK_BIN}"
+  echo "[go-tuning] cmake -S flutter/packages/jumper_sdk_platform/src -B build/native -DCMAKE_BUILD_TYPE=Release"
+  echo "[go-tuning] cmake --build build/native --target jumper_native_bench, or set BENCHMARK_BIN"
+  exit 1
+fi
+
+binaries=()
+for version in ${VERSIONS}; do
+  binary_path="${RUNTIME_DIR}/sing-box-${version}-${PLATFORM_ARCH}/sing-box"
+  if [[ ! -x "${binary_path}" ]]; then
+    echo "[go-tuning] runtime binary missing: ${binary_path}"
+    echo "[go-tuning] run engine/runtime-assets/prepare-runtime-assets.sh ${PLATFORM_ARCH} ${version}"
+    exit 1
+  fi
+  binaries+=("--sing_box=${binary_path}")
+done
+
+echo "[go-tuning] ${DURATION_SECONDS}s per profile, ${CONNECTIONS} connections, versions: ${VERSIONS}"
+"${BENCHMARK_BIN}" --benchmark_filter=GoRuntime "--go_runtime_seconds=${DURATION_SECONDS}" \
+  "--go_runtime_connections=${CONNECTIONS}" "${binaries[@]}"
@@ -13,7 +13,9 @@ BINARY_NAME="sing-box"
 if [[ "${PLATFORM_ARCH}" == windows-* ]]; then
   BINARY_NAME="sing-box.exe"
 fi
-BINARY_PATH="${RUNTIME_DIR}/sing-box-${VERSION}-${PLATFORM_ARCH}/${BINARY_NAME}"
+# CORE_BIN swaps in another core, e.g. fake-sing-box built from
+# flutter/packages/jumper_sdk_platform/src, with its FAKE_SING_BOX_* knobs.
+BINARY_PATH="${CORE_BIN:-${RUNTIME_DIR}/sing-box-${VERSION}-${PLATFORM_ARCH}/${BINARY_NAME}}"
 CONFIG_PATH="${RUNTIME_DIR}/minimal-config.json"
 OUTPUT_DIR="${RUNTIME_DIR}/stability"
 TS="$(date +%Y%m%d-%H%M%S)"
@@ -4,7 +4,9 @@ set -euo pipefail
 ROOT_DIR="$(cd "$(dirname "$0")" && pwd)"
 RUNTIME_DIR="${ROOT_DIR}/engine/runtime-assets/darwin-arm64"
 VERSION="${1:-1.12.22}"
-BINARY_PATH="${RUNTIME_DIR}/sing-box-${VERSION}-darwin-arm64/sing-box"
+# CORE_BIN swaps in another core, e.g. fake-sing-box built from
+# flutter/packages/jumper_sdk_platform/src, with its FAKE_SING_BOX_* knobs.
+BINARY_PATH="${CORE_BIN:-${RUNTIME_DIR}/sing-box-${VERSION}-darwin-arm64/sing-box}"
 CONFIG_PATH="${RUNTIME_DIR}/minimal-config.json"
 
 if [[ ! -f "${BINARY_PATH}" ]]; then